@@ -0,0 +1,117 @@
+// bench/Bench.hpp
+#pragma once
+
+// utilitarios comuns dos benchmarks: cronometragem em lotes, percentis e saida
+// em JSON (uma linha por resultado) ou CSV, para acompanhar regressoes ao longo do tempo
+//
+// cada binario aceita --csv (padrao eh JSON) e --rapido (menos lotes, para smoke test)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+using Relogio = std::chrono::steady_clock;
+
+struct Opcoes {
+    bool csv    = false;
+    bool rapido = false;
+};
+
+inline Opcoes lerOpcoes(int argc, char** argv) {
+    Opcoes op;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0)         op.csv = true;
+        else if (std::strcmp(argv[i], "--rapido") == 0) op.rapido = true;
+        else std::fprintf(stderr, "[Bench] Opcao ignorada: %s\n", argv[i]);
+    }
+    return op;
+}
+
+inline double nsDesde(Relogio::time_point inicio) {
+    return std::chrono::duration<double, std::nano>(Relogio::now() - inicio).count();
+}
+
+// impede que o compilador descarte um resultado calculado so para o benchmark
+template <typename T>
+inline void naoOtimizar(const T& valor) {
+    asm volatile("" : : "r,m"(valor) : "memory");
+}
+
+// amostras em ns por operacao, uma por lote
+struct Amostras {
+    std::vector<double> nsPorOp;
+    std::uint64_t operacoes = 0;
+    double nsTotal          = 0.0;
+
+    void adicionar(double nsLote, std::uint64_t opsLote) {
+        nsPorOp.push_back(nsLote / static_cast<double>(opsLote));
+        operacoes += opsLote;
+        nsTotal   += nsLote;
+    }
+
+    void juntar(const Amostras& outra) {
+        nsPorOp.insert(nsPorOp.end(), outra.nsPorOp.begin(), outra.nsPorOp.end());
+        operacoes += outra.operacoes;
+        nsTotal   += outra.nsTotal;
+    }
+};
+
+// roda f() opsPorLote vezes em cada lote e cronometra o lote inteiro,
+// assim o custo do relogio nao entra na medida de operacoes curtas
+template <typename F>
+Amostras medirLotes(std::size_t lotes, std::size_t opsPorLote, F&& f) {
+    Amostras a;
+    a.nsPorOp.reserve(lotes);
+    for (std::size_t l = 0; l < lotes; ++l) {
+        auto inicio = Relogio::now();
+        for (std::size_t k = 0; k < opsPorLote; ++k) f();
+        a.adicionar(nsDesde(inicio), opsPorLote);
+    }
+    return a;
+}
+
+class Relatorio {
+public:
+    Relatorio(const char* bench, const Opcoes& op) : bench_(bench), csv_(op.csv) {
+        if (csv_) std::printf("bench,caso,parametro,operacoes,ns_op,p50_ns,p90_ns,p99_ns,max_ns\n");
+    }
+
+    // ns_op eh a media (tempo total / operacoes); percentis sao sobre as amostras por lote
+    void escrever(const std::string& caso, long long parametro, Amostras a) const {
+        if (a.nsPorOp.empty()) return;
+        std::sort(a.nsPorOp.begin(), a.nsPorOp.end());
+        double media = a.nsTotal / static_cast<double>(a.operacoes);
+
+        if (csv_) {
+            std::printf("%s,%s,%lld,%llu,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                        bench_, caso.c_str(), parametro, static_cast<unsigned long long>(a.operacoes),
+                        media, percentil(a.nsPorOp, 0.50), percentil(a.nsPorOp, 0.90),
+                        percentil(a.nsPorOp, 0.99), a.nsPorOp.back());
+        } else {
+            std::printf("{\"bench\":\"%s\",\"caso\":\"%s\",\"parametro\":%lld,\"operacoes\":%llu,"
+                        "\"ns_op\":%.2f,\"p50_ns\":%.2f,\"p90_ns\":%.2f,\"p99_ns\":%.2f,\"max_ns\":%.2f}\n",
+                        bench_, caso.c_str(), parametro, static_cast<unsigned long long>(a.operacoes),
+                        media, percentil(a.nsPorOp, 0.50), percentil(a.nsPorOp, 0.90),
+                        percentil(a.nsPorOp, 0.99), a.nsPorOp.back());
+        }
+        std::fflush(stdout);
+    }
+
+private:
+    // percentil pelo vizinho mais proximo, com o vetor ja ordenado
+    static double percentil(const std::vector<double>& ordenado, double p) {
+        std::size_t i = static_cast<std::size_t>(p * static_cast<double>(ordenado.size() - 1) + 0.5);
+        return ordenado[std::min(i, ordenado.size() - 1)];
+    }
+
+    const char* bench_;
+    bool csv_;
+};
+
+} // namespace Bench
@@ -0,0 +1,85 @@
+// bench/bench_buffer_circular.cpp
+// BufferCircular::inserir e tentarLerMaisRecente com 1 escritor e N leitores
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Bench.hpp"
+#include "BufferCircular.hpp"
+
+namespace {
+    RegistroBuffer registroExemplo(int i) {
+        RegistroBuffer r{};
+        r.tempoSimulacao_s      = i * 0.1;
+        r.id_caminhao           = 1;
+        r.sensores.i_posicao_x  = i;
+        r.sensores.i_posicao_y  = -i;
+        return r;
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("buffer_circular", op);
+
+    const std::size_t lotes      = op.rapido ? 50 : 2000;
+    const std::size_t opsPorLote = 256;
+
+    // sem concorrencia, custo basico de cada operacao
+    {
+        BufferCircular buf(100);
+        int i = 0;
+        rel.escrever("inserir", 0, Bench::medirLotes(lotes, opsPorLote, [&] { buf.inserir(registroExemplo(i++)); }));
+
+        RegistroBuffer out;
+        rel.escrever("ler_mais_recente", 0, Bench::medirLotes(lotes, opsPorLote, [&] {
+            buf.tentarLerMaisRecente(out);
+            Bench::naoOtimizar(out);
+        }));
+    }
+
+    // escritor inserindo sem pausa enquanto N leitores consultam o registro mais recente
+    for (int leitores : {1, 2, 4, 8}) {
+        BufferCircular buf(100);
+        buf.inserir(registroExemplo(0));
+
+        std::atomic<int> prontos{0};
+        std::atomic<bool> largar{false};
+        std::atomic<int> terminados{0};
+        std::vector<Bench::Amostras> amostrasLeitores(static_cast<std::size_t>(leitores));
+
+        std::vector<std::thread> ths;
+        for (int t = 0; t < leitores; ++t) {
+            ths.emplace_back([&, t] {
+                ++prontos;
+                while (!largar) std::this_thread::yield();
+                RegistroBuffer out;
+                amostrasLeitores[static_cast<std::size_t>(t)] = Bench::medirLotes(lotes, opsPorLote, [&] {
+                    buf.tentarLerMaisRecente(out);
+                    Bench::naoOtimizar(out);
+                });
+                ++terminados;
+            });
+        }
+
+        while (prontos < leitores) std::this_thread::yield();
+        largar = true;
+
+        // o escritor mede enquanto houver leitor ativo
+        Bench::Amostras escrita;
+        int i = 0;
+        while (terminados < leitores) {
+            auto inicio = Bench::Relogio::now();
+            for (std::size_t k = 0; k < opsPorLote; ++k) buf.inserir(registroExemplo(i++));
+            escrita.adicionar(Bench::nsDesde(inicio), opsPorLote);
+        }
+        for (auto& th : ths) th.join();
+
+        Bench::Amostras leitura;
+        for (const auto& a : amostrasLeitores) leitura.juntar(a);
+
+        rel.escrever("inserir_com_leitores", leitores, escrita);
+        rel.escrever("ler_com_escritor", leitores, leitura);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+// bench/bench_fila_eventos.cpp
+// vazao de postar/retirar/drenar da FilaEventos, custo do estouro por politica
+// e latencia postar -> esperarProximo
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Bench.hpp"
+#include "FilaEventos.hpp"
+
+namespace {
+    Evento eventoExemplo(double t) {
+        return Evento{TipoEvento::FalhaTemperaturaAlta, "Temperatura critica", t, 1};
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("fila_eventos", op);
+
+    const std::size_t lotes      = op.rapido ? 50 : 2000;
+    const std::size_t opsPorLote = 256;
+
+    // uma thread so: postar um lote e depois retirar o mesmo lote, medidos separadamente
+    {
+        FilaEventos fila(opsPorLote);
+        Bench::Amostras postar, retirar, drenar;
+        Evento ev{};
+        std::vector<Evento> lote;
+        lote.reserve(opsPorLote);
+        for (std::size_t l = 0; l < lotes; ++l) {
+            auto inicio = Bench::Relogio::now();
+            for (std::size_t k = 0; k < opsPorLote; ++k) fila.postar(eventoExemplo(0.0));
+            postar.adicionar(Bench::nsDesde(inicio), opsPorLote);
+
+            inicio = Bench::Relogio::now();
+            for (std::size_t k = 0; k < opsPorLote; ++k) fila.tentarRetirar(ev);
+            retirar.adicionar(Bench::nsDesde(inicio), opsPorLote);
+
+            for (std::size_t k = 0; k < opsPorLote; ++k) fila.postar(eventoExemplo(0.0));
+            inicio = Bench::Relogio::now();
+            fila.drenar(lote, opsPorLote);
+            drenar.adicionar(Bench::nsDesde(inicio), opsPorLote);
+        }
+        rel.escrever("postar", 0, postar);
+        rel.escrever("tentar_retirar", 0, retirar);
+        rel.escrever("drenar", 0, drenar);
+    }
+
+    // postar com a fila sempre cheia: custo de cada politica de estouro sem consumidor
+    // (Bloquear fica de fora, sem consumidor ele nao sai do lugar)
+    for (PoliticaEstouro politica : {PoliticaEstouro::DescartarNovo, PoliticaEstouro::DescartarMaisAntigo}) {
+        FilaEventos fila(opsPorLote, politica);
+        for (std::size_t k = 0; k < fila.capacidade(); ++k) fila.postar(eventoExemplo(0.0));
+        Bench::Amostras a = Bench::medirLotes(lotes, opsPorLote, [&] { fila.postar(eventoExemplo(0.0)); });
+        rel.escrever(politica == PoliticaEstouro::DescartarNovo ? "estouro_descartar_novo" : "estouro_descartar_antigo", 0, a);
+    }
+
+    // P produtores e um consumidor bloqueado em esperarProximo
+    // o evento carrega o instante da postagem, o consumidor mede a latencia de cada um
+    // e a vazao eh o tempo total dividido pelos eventos entregues
+    const std::size_t eventosPorProdutor = op.rapido ? 20000 : 500000;
+    // politica Bloquear para nao perder eventos quando o consumidor atrasa
+    for (int produtores : {1, 2, 4}) {
+        FilaEventos fila(1024, PoliticaEstouro::Bloquear);
+        const std::size_t total = eventosPorProdutor * static_cast<std::size_t>(produtores);
+        const auto origem = Bench::Relogio::now();
+
+        Bench::Amostras latencia;
+        latencia.nsPorOp.reserve(total);
+
+        auto inicio = Bench::Relogio::now();
+        std::thread consumidor([&] {
+            for (std::size_t n = 0; n < total; ++n) {
+                Evento ev = fila.esperarProximo();
+                double agora = std::chrono::duration<double, std::nano>(Bench::Relogio::now() - origem).count();
+                latencia.adicionar(agora - ev.tempoSimulacao_s, 1);
+            }
+        });
+
+        std::vector<std::thread> ths;
+        for (int p = 0; p < produtores; ++p) {
+            ths.emplace_back([&] {
+                for (std::size_t n = 0; n < eventosPorProdutor; ++n) {
+                    double t = std::chrono::duration<double, std::nano>(Bench::Relogio::now() - origem).count();
+                    fila.postar(eventoExemplo(t));
+                }
+            });
+        }
+        for (auto& th : ths) th.join();
+        consumidor.join();
+
+        Bench::Amostras vazao;
+        vazao.adicionar(Bench::nsDesde(inicio), total);
+
+        rel.escrever("produtor_consumidor_vazao", produtores, vazao);
+        rel.escrever("produtor_consumidor_latencia", produtores, latencia);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+// bench/bench_filtro.cpp
+// filtros do tratamento de sensores (Filtros.hpp), custo por amostra
+#include <random>
+#include <vector>
+
+#include "Bench.hpp"
+#include "Filtros.hpp"
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("filtro", op);
+
+    const std::size_t lotes      = op.rapido ? 50 : 2000;
+    const std::size_t opsPorLote = 1024;
+
+    // entrada com ruido pre-gerada, para nao medir o gerador junto
+    std::mt19937 rng(1);
+    std::normal_distribution<double> ruido(0.0, 0.2);
+    std::vector<double> entrada(4096);
+    for (std::size_t i = 0; i < entrada.size(); ++i) entrada[i] = 0.1 * static_cast<double>(i) + ruido(rng);
+
+    auto medir = [&](const char* caso, long long parametro, const ConfigFiltro& cfg) {
+        FiltroSensor filtro(cfg);
+        std::size_t i = 0;
+        rel.escrever(caso, parametro, Bench::medirLotes(lotes, opsPorLote, [&] {
+            double v = filtro.filtrar(entrada[i]);
+            i = (i + 1) % entrada.size();
+            Bench::naoOtimizar(v);
+        }));
+    };
+
+    // o custo por amostra nao deve depender da janela (10 eh a usada em Caminhao)
+    for (std::size_t janela : {10, 50, 250}) {
+        medir("media_movel", static_cast<long long>(janela), ConfigFiltro::mediaMovel(janela));
+    }
+    for (std::size_t janela : {5, 15, 31}) {
+        medir("mediana", static_cast<long long>(janela), ConfigFiltro::mediana(janela));
+    }
+    medir("exponencial", 0, ConfigFiltro::exponencial(0.2));
+    medir("kalman", 0, ConfigFiltro::kalman(0.1, 1.0, 0.04));
+    medir("sem_filtro", 0, ConfigFiltro::nenhum());
+    return 0;
+}
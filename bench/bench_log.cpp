@@ -0,0 +1,97 @@
+// bench/bench_log.cpp
+// custo de registrar uma linha no log assincrono (so a formatacao no anel da thread),
+// sozinho e com varias threads, contra escrever e descarregar a linha na hora
+// a saida do log vai para /dev/null, o terminal nao entra na medida
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Bench.hpp"
+#include "Log.hpp"
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("log", op);
+
+    const std::size_t lotes      = op.rapido ? 50 : 1000;
+    const std::size_t opsPorLote = 128;  // cabe no anel da thread: nada eh descartado
+
+    Log::Configuracao config;
+    config.arquivo = "/dev/null";
+    if (!Log::configurar(config)) {
+        std::fprintf(stderr, "[Bench] Nao foi possivel abrir /dev/null\n");
+        return 1;
+    }
+
+    // linhas diferentes a cada chamada, como a do coletor de dados, para nao cair na supressao
+    int x = 0;
+
+    // uma thread: o lote entra no anel e a descarga esvazia o anel fora da medida
+    {
+        Bench::Amostras a;
+        for (std::size_t l = 0; l < lotes; ++l) {
+            auto inicio = Bench::Relogio::now();
+            for (std::size_t k = 0; k < opsPorLote; ++k) {
+                ++x;
+                Log::info("[Caminhao %d] x=%d y=%d def=%d%s%s", 7, x, -x, 0, "", "");
+            }
+            a.adicionar(Bench::nsDesde(inicio), opsPorLote);
+            Log::descarregar();
+        }
+        rel.escrever("registrar", 1, a);
+    }
+
+    // mesma linha formatada e escrita na hora, com uma descarga por linha (um terminal
+    // com buffer de linha faz o mesmo)
+    {
+        std::FILE* f = std::fopen("/dev/null", "w");
+        if (!f) return 1;
+        Bench::Amostras a = Bench::medirLotes(lotes, opsPorLote, [&] {
+            ++x;
+            std::fprintf(f, "[Caminhao %d] x=%d y=%d def=%d%s%s\n", 7, x, -x, 0, "", "");
+            std::fflush(f);
+        });
+        std::fclose(f);
+        rel.escrever("fprintf_fflush", 1, a);
+    }
+
+    // T threads registrando juntas, cada uma no proprio anel: o custo por linha nao deve
+    // crescer com T, ja que as threads nao dividem nada no caminho do registro
+    for (int threads : {2, 4, 8}) {
+        std::vector<Bench::Amostras> porThread(static_cast<std::size_t>(threads));
+        std::vector<std::thread> ths;
+        std::atomic<bool> largada{false};
+        for (int t = 0; t < threads; ++t) {
+            ths.emplace_back([&, t] {
+                while (!largada.load(std::memory_order_acquire)) std::this_thread::yield();
+                int y = 0;
+                for (std::size_t l = 0; l < lotes / 4; ++l) {
+                    auto inicio = Bench::Relogio::now();
+                    for (std::size_t k = 0; k < opsPorLote; ++k) {
+                        ++y;
+                        Log::info("[Caminhao %d] x=%d y=%d def=%d%s%s", t, y, -y, 0, "", "");
+                    }
+                    porThread[static_cast<std::size_t>(t)].adicionar(Bench::nsDesde(inicio), opsPorLote);
+                    // da tempo para a descarga esvaziar o anel antes do proximo lote
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+            });
+        }
+        largada.store(true, std::memory_order_release);
+        for (auto& th : ths) th.join();
+
+        Bench::Amostras total;
+        for (const auto& a : porThread) total.juntar(a);
+        rel.escrever("registrar_concorrente", threads, total);
+    }
+
+    Log::descarregar();
+    Log::Estatisticas e = Log::estatisticas();
+    if (e.descartadas > 0) {
+        std::fprintf(stderr, "[Bench] %llu linhas descartadas com o anel cheio\n",
+                     static_cast<unsigned long long>(e.descartadas));
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// bench/bench_protocolo.cpp
+// codificacao e decodificacao das mensagens MQTT em binario e JSON/texto:
+// tempo por mensagem e tamanho do payload (em "n", bytes) de cada formato
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "ProtocoloMqtt.hpp"
+
+namespace {
+    ProtocoloMqtt::EstadoFio estadoExemplo(int i) {
+        return ProtocoloMqtt::EstadoFio{i + 1, i % 400 - 200, (i * 7) % 240 - 120, 40 + i % 60, i % 13 == 0, i % 3 != 0};
+    }
+
+    const char* nomeFormato(ProtocoloMqtt::Formato f) {
+        return f == ProtocoloMqtt::Formato::Binario ? "binario" : "json";
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("protocolo", op);
+
+    using ProtocoloMqtt::Formato;
+    const std::size_t lotes   = op.rapido ? 50 : 5000;
+    const std::size_t porLote = 64;
+    const Formato formatos[] = {Formato::Binario, Formato::Json};
+
+    // estado de um caminhao, como o coletor publica em mina/caminhao/<id>/estado
+    for (Formato f : formatos) {
+        std::string out;
+        ProtocoloMqtt::codificarEstado(estadoExemplo(7), f, out);
+        int i = 0;
+        rel.escrever(std::string("estado_") + nomeFormato(f), static_cast<long long>(out.size()),
+                     Bench::medirLotes(lotes, porLote, [&] {
+            for (std::size_t k = 0; k < porLote; ++k) ProtocoloMqtt::codificarEstado(estadoExemplo(i++), f, out);
+            Bench::naoOtimizar(out.data());
+        }));
+    }
+
+    // quadro agregado da frota com 20 e 200 caminhoes
+    for (int caminhoes : {20, 200}) {
+        for (Formato f : formatos) {
+            std::string q;
+            auto montar = [&] {
+                ProtocoloMqtt::iniciarQuadro(1700000000000LL, f, q);
+                for (int c = 0; c < caminhoes; ++c) ProtocoloMqtt::anexarAoQuadro(estadoExemplo(c), f, q);
+                ProtocoloMqtt::fecharQuadro(f, q);
+            };
+            montar();
+            rel.escrever("quadro_" + std::to_string(caminhoes) + "_" + nomeFormato(f),
+                         static_cast<long long>(q.size()), Bench::medirLotes(lotes, 1, [&] {
+                montar();
+                Bench::naoOtimizar(q.data());
+            }));
+        }
+    }
+
+    {
+        std::string q;
+        ProtocoloMqtt::iniciarQuadro(1700000000000LL, Formato::Binario, q);
+        for (int c = 0; c < 200; ++c) ProtocoloMqtt::anexarAoQuadro(estadoExemplo(c), Formato::Binario, q);
+        std::vector<ProtocoloMqtt::EstadoFio> frota;
+        std::int64_t t_ms = 0;
+        rel.escrever("decodificar_quadro_200_binario", static_cast<long long>(q.size()), Bench::medirLotes(lotes, 1, [&] {
+            Bench::naoOtimizar(ProtocoloMqtt::decodificarQuadro(q.data(), q.size(), t_ms, frota));
+        }));
+    }
+
+    // decodificacao dos comandos mais comuns da GUI e da central
+    ProtocoloMqtt::Comando rota;
+    rota.codigo = ProtocoloMqtt::CodigoComando::Rota;
+    rota.x1 = -120; rota.y1 = 35; rota.x2 = 50; rota.y2 = 38;
+    ProtocoloMqtt::Comando acelera;
+    acelera.codigo = ProtocoloMqtt::CodigoComando::Acelera;
+    acelera.valor  = 1;
+    const std::pair<const char*, ProtocoloMqtt::Comando> comandos[] = {{"rota", rota}, {"acelera", acelera}};
+
+    for (const auto& par : comandos) {
+        for (Formato f : formatos) {
+            std::string payload;
+            ProtocoloMqtt::codificarComando(par.second, f, payload);
+            ProtocoloMqtt::Comando cmd;
+            rel.escrever(std::string("decodificar_") + par.first + "_" + nomeFormato(f),
+                         static_cast<long long>(payload.size()), Bench::medirLotes(lotes, porLote, [&] {
+                for (std::size_t k = 0; k < porLote; ++k) {
+                    Bench::naoOtimizar(ProtocoloMqtt::decodificarComando(payload, cmd));
+                }
+            }));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// bench/bench_rotas.cpp
+// pedidos de rota ao planejador com o mapa padrao da mina (cava e britador), em ns por pedido
+// ciclo: partidas e chegadas repetidas de um ciclo de transporte (cava -> britador), o caso
+// do cache; aleatorio: pares sorteados na area de spawn, quase todo pedido vira uma busca A*
+#include <random>
+#include <vector>
+
+#include "Bench.hpp"
+#include "MapaMina.hpp"
+#include "PlanejadorRotas.hpp"
+
+namespace {
+    // mesmo mapa de SimulacaoMina
+    constexpr double MAPA_LIMITE = 640.0;
+    constexpr double MAPA_CELULA = 4.0;
+    constexpr double MAPA_MARGEM = 4.0;
+
+    struct Pedido {
+        GradeEspacial::Ponto de, para;
+    };
+
+    // pontos de carga em volta da cava e de descarga em volta do britador, em ida e volta
+    std::vector<Pedido> pedidosCiclo(std::size_t n, std::mt19937& rng) {
+        std::vector<GradeEspacial::Ponto> carga, descarga;
+        for (int i = 0; i < 8; ++i) {
+            carga.push_back({-90.0 + 4.0 * i, -80.0});
+            descarga.push_back({90.0, 20.0 + 4.0 * i});
+        }
+        std::uniform_int_distribution<std::size_t> distPonto(0, carga.size() - 1);
+        std::vector<Pedido> pedidos(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto& c = carga[distPonto(rng)];
+            const auto& d = descarga[distPonto(rng)];
+            pedidos[i] = (i % 2 == 0) ? Pedido{c, d} : Pedido{d, c};
+        }
+        return pedidos;
+    }
+
+    std::vector<Pedido> pedidosAleatorios(std::size_t n, std::mt19937& rng) {
+        std::uniform_real_distribution<double> distX(-220.0, 220.0);
+        std::uniform_real_distribution<double> distY(-120.0, 120.0);
+        std::vector<Pedido> pedidos(n);
+        for (auto& p : pedidos) p = {{distX(rng), distY(rng)}, {distX(rng), distY(rng)}};
+        return pedidos;
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("rotas", op);
+
+    MapaMina mapa(-MAPA_LIMITE, MAPA_LIMITE, -MAPA_LIMITE, MAPA_LIMITE, MAPA_CELULA, MAPA_MARGEM);
+    mapa.definirObstaculos(MapaMina::obstaculosPadrao());
+
+    const std::size_t lotes = op.rapido ? 20 : 500;
+    const std::size_t porLote = 16;
+    std::mt19937 rng(7);
+    const std::vector<Pedido> ciclo      = pedidosCiclo(lotes * porLote, rng);
+    const std::vector<Pedido> aleatorios = pedidosAleatorios(lotes * porLote, rng);
+
+    for (std::size_t capacidade : {std::size_t{0}, std::size_t{4096}}) {
+        const long long parametro = static_cast<long long>(capacidade);
+        for (int caso = 0; caso < 2; ++caso) {
+            const std::vector<Pedido>& pedidos = caso == 0 ? ciclo : aleatorios;
+            PlanejadorRotas planejador(mapa, capacidade);
+            std::size_t i = 0;
+            rel.escrever(caso == 0 ? "ciclo" : "aleatorio", parametro, Bench::medirLotes(lotes, porLote, [&] {
+                const Pedido& p = pedidos[i++ % pedidos.size()];
+                PlanejadorRotas::Rota r = planejador.planejar(p.de.x, p.de.y, p.para.x, p.para.y);
+                Bench::naoOtimizar(r.get());
+            }));
+        }
+    }
+    return 0;
+}
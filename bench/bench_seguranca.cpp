@@ -0,0 +1,86 @@
+// bench/bench_seguranca.cpp
+// ciclo do monitor anti-colisao (Anticolisao::avaliar, o que SimulacaoMina chama) de 10 a
+// 10k caminhoes, na densidade da area de spawn e com a frota espalhada pelo mapa inteiro
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Anticolisao.hpp"
+#include "Bench.hpp"
+#include "Log.hpp"
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    struct Cenario {
+        const char* nome;
+        double m2PorCaminhao;
+    };
+    // area de spawn (440 x 240 m) com 2000 caminhoes e o mapa inteiro (1340 x 1340 m) com 2000
+    constexpr Cenario CENARIOS[] = {
+        {"avaliar_spawn", 440.0 * 240.0 / 2000.0},
+        {"avaliar_mapa",  1340.0 * 1340.0 / 2000.0},
+    };
+
+    // frota em servico: a maioria em missao, em qualquer rumo, alguns parados no caminho
+    // (obstaculos a contornar) e alguns em manual; a velocidade vai ate a terminal, mas
+    // concentrada perto de zero como numa frota rodando (a maioria abaixo de 3 m/s, o limite
+    // de velocidade do anticolisao)
+    std::vector<Anticolisao::Amostra> gerarFrota(int n, double m2PorCaminhao, std::mt19937& rng) {
+        const double lado = std::sqrt(m2PorCaminhao * n);
+        std::uniform_real_distribution<double> pos(-lado / 2.0, lado / 2.0);
+        std::uniform_real_distribution<double> rumo(0.0, 360.0);
+        std::uniform_real_distribution<double> vel(0.0, FisicaFrota::A_MAX / FisicaFrota::FRICCAO);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+
+        std::vector<Anticolisao::Amostra> frota(static_cast<std::size_t>(n));
+        for (int k = 0; k < n; ++k) {
+            Anticolisao::Amostra& a = frota[static_cast<std::size_t>(k)];
+            a.id  = k + 1;
+            a.pos = {pos(rng), pos(rng)};
+            const double sorteio = u(rng);
+            const double r = rumo(rng);
+            const double lento = u(rng);
+            const double v = sorteio < 0.1 ? 0.0 : vel(rng) * lento * lento * lento;
+            a.vx = v * std::cos(r * PI / 180.0);
+            a.vy = v * std::sin(r * PI / 180.0);
+            a.emMissao   = sorteio >= 0.05 && sorteio < 0.9;
+            a.rumo_graus = r;
+        }
+        return frota;
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("seguranca", op);
+
+    // as paradas sao registradas no log; o terminal nao entra na medida
+    Log::Configuracao config;
+    config.arquivo = "/dev/null";
+    if (!Log::configurar(config)) {
+        std::fprintf(stderr, "[Bench] Nao foi possivel abrir /dev/null\n");
+        return 1;
+    }
+
+    for (const Cenario& c : CENARIOS) {
+        for (int n : {10, 100, 1000, 2000, 10000}) {
+            std::mt19937 rng(static_cast<std::mt19937::result_type>(n));
+            const std::vector<Anticolisao::Amostra> frota = gerarFrota(n, c.m2PorCaminhao, rng);
+
+            const std::size_t ciclos = op.rapido ? 3 : std::max<std::size_t>(10, 200000 / static_cast<std::size_t>(n));
+
+            // o monitor e as respostas sao reaproveitados entre ciclos, como em SimulacaoMina
+            Anticolisao anticolisao;
+            std::vector<Anticolisao::Resposta> respostas;
+            rel.escrever(c.nome, n, Bench::medirLotes(ciclos, 1, [&] {
+                anticolisao.avaliar(frota, 0.05, respostas);
+                Bench::naoOtimizar(respostas);
+            }));
+        }
+    }
+    Log::descarregar();
+    return 0;
+}
@@ -0,0 +1,65 @@
+// bench/bench_series.cpp
+// ingestao na SerieTemporalFrota e consultas por intervalo em cada resolucao
+#include <vector>
+
+#include "Bench.hpp"
+#include "SerieTemporalFrota.hpp"
+
+namespace {
+    RegistroBuffer registroExemplo(double t, int i) {
+        RegistroBuffer r{};
+        r.tempoSimulacao_s       = t;
+        r.sensores.i_posicao_x   = i % 400 - 200;
+        r.sensores.i_posicao_y   = (i * 7) % 240 - 120;
+        r.sensores.i_angulo_x    = i % 360 - 180;
+        r.sensores.i_temperatura = 40 + i % 60;
+        return r;
+    }
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("series", op);
+
+    const double PERIODO_S = 0.1;
+
+    // ingestao em lotes de 10 amostras (1 s de sensor), como a tarefa de ingestao faz
+    {
+        SerieTemporalFrota st;
+        const std::size_t lotes = op.rapido ? 200 : 20000;
+        std::vector<RegistroBuffer> lote(10);
+        int i = 0;
+        rel.escrever("inserir_lote_10", 0, Bench::medirLotes(lotes, 10, [&] {
+            for (auto& r : lote) { r = registroExemplo(i * PERIODO_S, i); ++i; }
+            Bench::naoOtimizar(st.inserir(1, lote.data(), lote.size()));
+        }));
+    }
+
+    // serie cheia de um caminhao: 24 h simulados, todos os niveis no limite de retencao
+    SerieTemporalFrota st;
+    const int total = op.rapido ? 36000 : 864000;
+    std::vector<RegistroBuffer> lote(1000);
+    for (int base = 0; base < total; base += 1000) {
+        for (int k = 0; k < 1000; ++k) lote[k] = registroExemplo((base + k) * PERIODO_S, base + k);
+        st.inserir(1, lote.data(), lote.size());
+    }
+    const double fim = st.ultimoTempo(1);
+
+    struct Caso { const char* nome; ResolucaoSerie res; double janela_s; };
+    const Caso casos[] = {
+        {"consultar_bruta_60s",     ResolucaoSerie::Bruta,       60.0},
+        {"consultar_segundo_10min", ResolucaoSerie::Segundo,     600.0},
+        {"consultar_10s_1h",        ResolucaoSerie::DezSegundos, 3600.0},
+        {"consultar_minuto_24h",    ResolucaoSerie::Minuto,      86400.0},
+    };
+
+    std::vector<PontoSerie> out;
+    const std::size_t lotes = op.rapido ? 50 : 2000;
+    for (const Caso& c : casos) {
+        std::size_t pontos = st.consultar(1, CanalSerie::Temperatura, c.res, fim - c.janela_s, fim, out);
+        rel.escrever(c.nome, static_cast<long long>(pontos), Bench::medirLotes(lotes, 1, [&] {
+            Bench::naoOtimizar(st.consultar(1, CanalSerie::Temperatura, c.res, fim - c.janela_s, fim, out));
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+// bench/bench_spawn.cpp
+// escolha de spawn de criarCaminhoes com a frota ja ocupando a mina: um caminhao por
+// chamada (criarNovoCaminhao) e lotes de 64 (criacao em massa), em ns por caminhao
+#include <random>
+#include <vector>
+
+#include "Bench.hpp"
+#include "PosicionadorSpawn.hpp"
+
+namespace {
+    // mesma area e parametros de SimulacaoMina
+    const PosicionadorSpawn::Area AREA_MINA{-220.0, 220.0, -120.0, 120.0};
+    constexpr double SPAWN_DIST_MIN  = 25.0;
+    constexpr int    SPAWN_MAX_TRIES = 200;
+}
+
+int main(int argc, char** argv) {
+    Bench::Opcoes op = Bench::lerOpcoes(argc, argv);
+    Bench::Relatorio rel("spawn", op);
+
+    PosicionadorSpawn posicionador(AREA_MINA, SPAWN_DIST_MIN, SPAWN_MAX_TRIES);
+
+    // com a mina cheia as vagas e os sorteios se esgotam e a escolha cai na garagem
+    for (int ocupados : {0, 10, 50, 100, 200, 1000}) {
+        std::mt19937 rngFrota(static_cast<std::mt19937::result_type>(ocupados));
+        std::uniform_real_distribution<double> distX(AREA_MINA.xMin, AREA_MINA.xMax);
+        std::uniform_real_distribution<double> distY(AREA_MINA.yMin, AREA_MINA.yMax);
+        std::vector<GradeEspacial::Ponto> frota(static_cast<std::size_t>(ocupados));
+        for (auto& p : frota) p = {distX(rngFrota), distY(rngFrota)};
+
+        std::mt19937 rng(7);
+        std::vector<PosicionadorSpawn::Vaga> out;
+
+        const std::size_t lotes = op.rapido ? 20 : (ocupados >= 200 ? 200 : 2000);
+        for (std::size_t porChamada : {std::size_t{1}, std::size_t{64}}) {
+            const char* nome = porChamada == 1 ? "escolher" : "escolher_lote64";
+            Bench::Amostras a;
+            for (std::size_t l = 0; l < lotes; ++l) {
+                out.clear();
+                auto inicio = Bench::Relogio::now();
+                posicionador.escolherLote(frota, rng, porChamada, out);
+                a.adicionar(Bench::nsDesde(inicio), porChamada);
+                Bench::naoOtimizar(out.data());
+            }
+            rel.escrever(nome, ocupados, a);
+        }
+    }
+    return 0;
+}
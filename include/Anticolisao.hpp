@@ -0,0 +1,119 @@
+// include/Anticolisao.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FisicaFrota.hpp"
+#include "GradeEspacial.hpp"
+#include "Tipos.hpp"
+
+// anticolisao preditivo da frota, avaliado a cada ciclo do monitor de seguranca
+// cada caminhao preve o proprio movimento pela rota (mesmo parado, se ainda vai andar) e o dos
+// outros pela velocidade medida; disso saem o instante de maior aproximacao (TCPA) e a distancia
+// nesse instante (DCPA) de cada par proximo
+// contra um caminhao em movimento a resposta eh graduada: limite de velocidade quando vao passar
+// perto, o de id maior cede quando vao passar perto demais, e frenagem forte quando o conflito eh
+// iminente; um caminhao parado eh um obstaculo, e quem vem na direcao dele contorna com o menor
+// desvio de rumo que libera a passagem (so espera se nenhum desvio serve)
+// o nivel sobe na hora e so desce depois de um tempo sem o conflito, para nao oscilar
+// tambem conta o que a regra antiga (parada de emergencia em MANUAL a menos de 20 m) teria
+// feito nas mesmas trajetorias, para comparar
+class Anticolisao {
+public:
+    struct Amostra {
+        int id;
+        GradeEspacial::Ponto pos;
+        double vx, vy;       // velocidade medida, m/s
+        bool   emMissao;     // em automatico e ainda longe do destino
+        double rumo_graus;   // direcao da rota (setpoint), se em missao
+    };
+
+    struct Resposta {
+        NivelSeguranca nivel;
+        int desvio_graus;  // somado a direcao da rota para contornar um caminhao parado
+    };
+
+    struct Conflito {
+        double tcpa_s;     // 0 quando o par nao esta se aproximando
+        double dcpa;       // distancia na maior aproximacao, limitada ao horizonte
+        bool   aproximando;
+    };
+
+    struct Resumo {
+        std::uint64_t limites   = 0;   // entradas em cada nivel, por caminhao
+        std::uint64_t cedencias = 0;
+        std::uint64_t paradas   = 0;
+        std::uint64_t desvios   = 0;   // contornos de caminhao parado iniciados
+        std::uint64_t paradasRegraAntiga = 0;  // entradas a menos de DIST_ALERTA de alguem
+        double tempoPreservado_s = 0.0;        // caminhao-segundos andando onde a regra antiga parava
+
+        // paradas que a regra antiga teria feito e que nao aconteceram; cada uma ainda
+        // exigia um operador para devolver o caminhao ao automatico
+        std::uint64_t paradasEvitadas() const {
+            return paradasRegraAntiga > paradas ? paradasRegraAntiga - paradas : 0;
+        }
+    };
+
+    Anticolisao();
+
+    // avalia a frota; respostas[k] eh a de amostras[k]
+    // dt_s eh o tempo desde o ciclo anterior; so chamado pelo monitor de seguranca
+    void avaliar(const std::vector<Amostra>& amostras, double dt_s, std::vector<Resposta>& respostas);
+
+    // thread-safe
+    Resumo resumo() const;
+
+    // movimento em linha reta e velocidade constante, com a maior aproximacao limitada ao horizonte
+    static Conflito preverConflito(const GradeEspacial::Ponto& pa, double vax, double vay,
+                                   const GradeEspacial::Ponto& pb, double vbx, double vby);
+
+    static constexpr double DIST_ALERTA  = 20.0;
+    static constexpr double DIST_CRITICA = 12.0;
+    static constexpr double HORIZONTE_S  = 6.0;
+    // velocidade prevista para um caminhao parado que ainda vai andar
+    static constexpr double V_INTENCAO   = 3.0;
+    // um par mais longe que isso nao chega a DIST_ALERTA dentro do horizonte, nem com os
+    // dois na velocidade terminal do modelo fisico; eh a largura da borda entre shards
+    // a avaliacao usa o alcance de cada caminhao pela propria velocidade, bem menor
+    static constexpr double RAIO_PREDICAO =
+        DIST_ALERTA + 2.0 * (FisicaFrota::A_MAX / FisicaFrota::FRICCAO) * HORIZONTE_S;
+
+private:
+    struct EstadoNivel {
+        NivelSeguranca nivel = NivelSeguranca::Livre;
+        double abaixo_s = 0.0;       // tempo seguido com o alvo abaixo do nivel atual
+        int desvio_graus = 0;
+        bool regraAntiga = false;    // a regra antiga estaria parando este caminhao
+        std::uint64_t ciclo = 0;     // ultimo ciclo em que apareceu
+    };
+
+    struct Obstaculo {
+        std::size_t caminhao;
+        std::size_t parado;     // parado no caminho dele
+        double dist;            // calculada uma vez, para ordenar e para cada desvio tentado
+    };
+
+    // procura o menor desvio de rumo de amostras[k] que passa longe dos obstaculos
+    // obstaculos_[inicio, fim), todos dele
+    bool escolherDesvio(const std::vector<Amostra>& amostras, std::size_t k,
+                        std::size_t inicio, std::size_t fim, int anterior, int& desvio) const;
+
+    GradeEspacial grade_;  // celulas de DIST_ALERTA, consultadas pelo alcance de cada caminhao
+    std::vector<GradeEspacial::Ponto> posicoes_;
+    std::vector<GradeEspacial::Ponto> intencoes_;  // velocidade pretendida, sem desvio
+    std::vector<double> alcances_;
+    std::vector<NivelSeguranca> alvos_;
+    std::vector<NivelSeguranca> semDesvio_;  // nivel se nenhum desvio servir
+    std::vector<int> desvios_;
+    std::vector<char> regraAntiga_;
+    std::vector<Obstaculo> obstaculos_;
+    std::unordered_map<int, EstadoNivel> estados_;
+    std::uint64_t ciclo_;
+
+    mutable std::mutex mtxResumo_;
+    Resumo resumo_;
+};
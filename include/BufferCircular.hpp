@@ -3,34 +3,105 @@
 
 #include <vector>
 #include <mutex>
+#include <array>
+#include <atomic>
 #include <cstddef>   // tipo size_t da biblioteca padrao
+#include <cstdint>
+#include <type_traits>
 #include "Tipos.hpp"
 
+// trecho do historico visto dentro do proprio anel, sem copia: ate dois blocos contiguos
+// (fim e comeco do vetor quando o trecho da a volta), do mais antigo ao mais recente
+struct VisaoHistorico {
+    const RegistroBuffer* bloco1 = nullptr;
+    std::size_t           tam1   = 0;
+    const RegistroBuffer* bloco2 = nullptr;
+    std::size_t           tam2   = 0;
+
+    std::size_t tamanho() const { return tam1 + tam2; }
+    bool vazia() const { return tamanho() == 0; }
+
+    const RegistroBuffer& operator[](std::size_t i) const {
+        return i < tam1 ? bloco1[i] : bloco2[i - tam1];
+    }
+
+    template <typename F>
+    void paraCada(F&& f) const {
+        for (std::size_t i = 0; i < tam1; ++i) f(bloco1[i]);
+        for (std::size_t i = 0; i < tam2; ++i) f(bloco2[i]);
+    }
+};
+
 // buffer circular monitorado para compartilhar dados dentro de um caminhao
-// varias tarefas podem escrever e ler, acesso protegido por mutex
+// o historico eh protegido por mutex, e o registro mais recente tambem fica em um
+// slot com seqlock, que os leitores consultam sem travar e sem bloquear quem escreve
 class BufferCircular {
 public:
     explicit BufferCircular(std::size_t capacidade);
 
     // insere um novo registro no buffer
     // se estiver cheio, sobrescreve o mais antigo, comportamento tipico de buffer circular
-    void inserir(const RegistroBuffer& registro);
+    // retorna a sequencia do registro inserido (1 para o primeiro, crescente)
+    std::uint64_t inserir(const RegistroBuffer& registro);
 
-    // tenta ler o registro mais recente
+    // tenta ler o registro mais recente, sem lock (leitura pelo seqlock)
     // retorna true quando consegue, retorna false quando o buffer esta vazio
     bool tentarLerMaisRecente(RegistroBuffer& out) const;
+    // idem, informando tambem a sequencia do registro lido
+    bool tentarLerMaisRecente(RegistroBuffer& out, std::uint64_t& sequencia) const;
+
+    // sequencia do ultimo registro inserido, zero se vazio
+    std::uint64_t sequenciaAtual() const;
 
     // retorna uma copia de todos os registros atualmente no buffer
     // em ordem do mais antigo para o mais recente
     std::vector<RegistroBuffer> snapshot() const;
 
+    // chama f(const VisaoHistorico&) sobre o historico inteiro, sem copiar o anel
+    // o buffer fica travado durante f: f deve ser curta e nao pode guardar a visao
+    template <typename F>
+    void visitar(F&& f) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        f(trecho(0, quantidade_));
+    }
+
+    // idem, so com os registros de desde_s <= tempoSimulacao_s <= ate_s
+    // as amostras entram em ordem de tempo, entao os limites saem por busca binaria
+    template <typename F>
+    void visitarJanela(double desde_s, double ate_s, F&& f) const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::size_t primeiro = primeiroComTempoAPartirDe(desde_s);
+        std::size_t fim      = primeiroComTempoDepoisDe(ate_s);
+        f(trecho(primeiro, fim > primeiro ? fim - primeiro : 0));
+    }
+
+    // copia para 'out' (limpo antes) os registros da janela; retorna quantos foram copiados
+    std::size_t copiarJanela(double desde_s, double ate_s, std::vector<RegistroBuffer>& out) const;
+
     std::size_t tamanho() const;
     std::size_t capacidade() const;
 
 private:
+    // funcoes auxiliares das visoes, chamadas com mtx_ travado
+    // indices logicos: 0 eh o registro mais antigo, quantidade_-1 o mais recente
+    VisaoHistorico trecho(std::size_t primeiro, std::size_t n) const;
+    std::size_t primeiroComTempoAPartirDe(double t_s) const;
+    std::size_t primeiroComTempoDepoisDe(double t_s) const;
+
     mutable std::mutex mtx_;
     std::vector<RegistroBuffer> dados_;
     std::size_t capacidade_;
     std::size_t inicio_; // indice do elemento mais antigo
     std::size_t quantidade_; // quantidade de elementos validos no buffer
+
+    // slot do registro mais recente, copiado palavra a palavra em atomicos
+    // para que a leitura concorrente com a escrita seja bem definida
+    static_assert(std::is_trivially_copyable<RegistroBuffer>::value,
+                  "RegistroBuffer precisa ser copiavel byte a byte para o seqlock");
+    static constexpr std::size_t PALAVRAS_REGISTRO =
+        (sizeof(RegistroBuffer) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    // sequencia par indica slot estavel, impar indica escrita em andamento, zero indica vazio
+    std::atomic<std::uint64_t> seqUltimo_;
+    std::array<std::atomic<std::uint64_t>, PALAVRAS_REGISTRO> ultimo_;
 };
\ No newline at end of file
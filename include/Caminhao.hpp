@@ -1,33 +1,82 @@
 // include/Caminhao.hpp
 #pragma once
 
-#include <thread>
 #include <atomic>
 #include <mutex>
 #include <cstddef>
-#include <fstream>
 #include <string>
 #include <random>
 #include <memory> 
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "Tipos.hpp"
 #include "BufferCircular.hpp"
-#include "FilaEventos.hpp"
 #include "MqttInterface.hpp" // Necessário para comunicação
+#include "ExecutorPeriodico.hpp"
+#include "RegistradorTelemetria.hpp"
+#include "FisicaFrota.hpp"
+#include "Filtros.hpp"
+#include "SessaoGravada.hpp"
+#include "ProtocoloMqtt.hpp"
+#include "PlanejadorRotas.hpp"
 
 class Caminhao {
     friend class SimulacaoMina;
 
 public:
-    Caminhao(int id, std::size_t capacidadeBuffer = 100);
+    // filtro de cada canal do tratamento de sensores
+    // o padrao eh media movel de 10 amostras em todos, o comportamento original
+    struct ConfigFiltros {
+        ConfigFiltro posicao_x   = ConfigFiltro::mediaMovel(10);
+        ConfigFiltro posicao_y   = ConfigFiltro::mediaMovel(10);
+        ConfigFiltro angulo      = ConfigFiltro::mediaMovel(10);
+        ConfigFiltro temperatura = ConfigFiltro::mediaMovel(10);
+    };
+
+    // o estado fisico do caminhao vive em um indice de FisicaFrota, integrado pela frota
+    // telemetria pode ser nulo, nesse caso as amostras do coletor nao sao gravadas
+    Caminhao(int id, FisicaFrota& fisica, std::size_t capacidadeBuffer = 100,
+             RegistradorTelemetria* telemetria = nullptr);
     ~Caminhao();
 
-    void iniciar();
+    // troca os filtros dos sensores; deve ser chamado antes de iniciar()
+    void configurarFiltros(const ConfigFiltros& cfg);
+
+    // registra as tarefas periodicas do caminhao no executor compartilhado da frota
+    // mqttProprio cria o cliente MQTT do caminhao (topicos mina/caminhao/<id>/...)
+    // com estatisticas nao nulo, cada tarefa alimenta os histogramas do seu tipo
+    // e o controle registra a latencia sensor -> atuador de cada amostra
+    void iniciar(ExecutorPeriodico& executor, bool mqttProprio = true,
+                 EstatisticasFrota* estatisticas = nullptr);
     void parar();
+
+    // modo lockstep: relogio virtual de passo fixo, sem executor, sem MQTT e sem sleeps
+    // o RNG dos sensores passa a ser semeado com semente + id, tornando a execucao reprodutivel
+    void iniciarLockstep(std::uint32_t semente);
+    // avanca o caminhao ate o passo indicado, rodando as tarefas que vencem nele
+    // cada passo vale PASSO_LOCKSTEP_MS milissegundos
+    void avancarLockstep(std::uint64_t passo);
+
+    static constexpr int    PASSO_LOCKSTEP_MS = 50;
+    static constexpr double PASSO_LOCKSTEP_S  = PASSO_LOCKSTEP_MS / 1000.0;
     int getId() const;
 
     EstadoCaminhao lerEstadoLogico() const;
     bool lerUltimoRegistro(RegistroBuffer& out) const;
+    // posicao e estado do modelo fisico; existe desde a criacao, antes da primeira amostra no buffer
+    FisicaFrota::EstadoFisico estadoFisico() const;
+
+    // historico do buffer com desde_s <= tempoSimulacao_s <= ate_s
+    // visitarHistorico entrega a VisaoHistorico sobre o anel sem copiar, com o buffer
+    // travado durante f; copiarHistorico copia a janela para 'out' e retorna quantos vieram
+    template <typename F>
+    void visitarHistorico(double desde_s, double ate_s, F&& f) const {
+        buffer_.visitarJanela(desde_s, ate_s, std::forward<F>(f));
+    }
+    std::size_t copiarHistorico(double desde_s, double ate_s, std::vector<RegistroBuffer>& out) const;
 
     // Comandos
     void comandarAutomatico();
@@ -37,8 +86,11 @@ public:
     void setComandoDireita(bool ativo);
     void setComandoEsquerda(bool ativo);
     
-    // NOVO: Segurança (Sistema Anticolisão chama isso)
-    void setReducaoSeguranca(bool ativar);
+    // nivel pedido pelo anticolisao da mina; o controle freia ou limita a aceleracao sem
+    // tirar o caminhao do automatico, e volta ao normal sozinho quando o nivel cai
+    // desvio_graus eh somado a direcao da rota no automatico, para contornar um caminhao parado
+    void definirNivelSeguranca(NivelSeguranca nivel, int desvio_graus = 0);
+    NivelSeguranca nivelSeguranca() const;
 
     // Injeção de Falhas
     void injetarFalhaTemperaturaAlta();
@@ -47,13 +99,38 @@ public:
 
     void definirRota(int x_inicial, int y_inicial, int x_destino, int y_destino);
 
+    // planejador compartilhado da frota; com ele a rota vira uma lista de waypoints que
+    // contorna os obstaculos do mapa, sem ele o caminhao vai em linha reta ao destino
+    // deve ser chamado antes de iniciar()
+    void definirPlanejador(PlanejadorRotas* planejador);
+
+    // waypoints que faltam da rota planejada, do corrente ao destino exato, para desenho;
+    // vazio sem rota definida ou antes do primeiro planejamento
+    std::size_t copiarRestoDaRota(std::vector<GradeEspacial::Ponto>& out) const;
+
+    // aplica um comando do topico cmd, binario ou na sintaxe de texto (CMD:AUTO, CMD:MANUAL,
+    // CMD:REARME, CMD:ACELERA:<0|1>, CMD:DIREITA:<0|1>, CMD:ESQUERDA:<0|1>, ROTA:x1,y1,x2,y2)
+    // retorna false se o comando nao for reconhecido ou nao for de caminhao
+    bool aplicarComando(const std::string& comando);
+    bool aplicarComando(const ProtocoloMqtt::Comando& comando);
+
+    // formato do topico mina/caminhao/<id>/estado; deve ser chamado antes de iniciar()
+    void definirFormatoEstado(ProtocoloMqtt::Formato formato);
+
+    // migracao entre shards: exportarEstado depois de parar() no shard de origem,
+    // importarEstado antes de iniciar() no de destino, que replaneja a rota da posicao atual
+    EstadoMigracao exportarEstado() const;
+    void importarEstado(const EstadoMigracao& estado);
+
 private:
     // MQTT
     void processarMensagemMqtt(const std::string& topico, const std::string& payload);
     std::unique_ptr<MqttInterface> mqtt_;
+    ProtocoloMqtt::Formato formatoEstado_;
+    std::string topicoEstado_;
+    std::string payloadEstado_;  // reaproveitado a cada publicacao do coletor
 
-    // Tarefas
-    void comandarParadaEmergencia();
+    // Tarefas (cada chamada executa um ciclo, o executor cuida da periodicidade)
     void tarefaTratamentoSensores();
     void tarefaLogicaComando();
     void tarefaMonitoramentoFalhas();
@@ -61,10 +138,12 @@ private:
     void tarefaPlanejamentoRota();
     void tarefaColetorDados();
 
+    // tempo da simulacao em segundos, real desde iniciar() ou virtual no lockstep
+    double tempoAtual_s() const;
+
     // Identificação e Infra
     int id_;
     BufferCircular buffer_;
-    FilaEventos filaEventos_;
 
     // Estados Internos (Protegidos por Mutex)
     mutable std::mutex mtxComandos_;
@@ -77,15 +156,16 @@ private:
     mutable std::mutex mtxEstados_;
     EstadosCaminhao estados_;
 
-    mutable std::mutex mtxFisico_;
-    double fis_pos_x_, fis_pos_y_, fis_vel_, fis_ang_deg_, fis_temp_C_;
+    // Estado fisico (arrays da frota, protegidos pelo mutex da propria FisicaFrota)
+    FisicaFrota& fisica_;
+    std::size_t idxFisico_;
 
     std::atomic<bool> fis_forcarFalhaTemp_;
     std::atomic<bool> fis_forcarFalhaElec_;
     std::atomic<bool> fis_forcarFalhaHid_;
     
-    // NOVO: Flag para o sistema anticolisão reduzir a velocidade
-    std::atomic<bool> em_reducao_seguranca_{false};
+    std::atomic<NivelSeguranca> nivelSeguranca_;
+    std::atomic<int> desvioSeguranca_;
 
     mutable std::mutex mtxAtuadores_;
     AtuadoresCaminhao atuadores_;
@@ -96,17 +176,57 @@ private:
     mutable std::mutex mtxRota_;
     bool rota_definida_;
     int rota_origem_x_, rota_origem_y_, rota_destino_x_, rota_destino_y_;
-
-    // Log
-    std::ofstream arquivoLog_;
-    mutable std::mutex mtxLog_;
-
-    // Threads
+    std::uint64_t geracaoRota_;  // incrementada a cada definirRota
+
+    // rota seguida pelo planejamento (so alterada pela tarefa de planejamento): o controle
+    // aponta para waypoints_[proximoWaypoint_] e o ultimo eh o destino exato
+    // a tarefa le sem trava; mtxWaypoints_ so serializa as escritas com copiarRestoDaRota
+    void replanejarRota(double x0, double y0, int destX, int destY);
+    bool restoDaRotaLivre(const MapaMina::Grade& grade, double px, double py) const;
+    PlanejadorRotas* planejador_;
+    std::uint64_t geracaoPlanejada_;
+    std::uint64_t versaoMapaRota_;
+    std::vector<GradeEspacial::Ponto> waypoints_;
+    std::size_t proximoWaypoint_;
+    mutable std::mutex mtxWaypoints_;
+
+    // Log (gravador binario compartilhado pela frota, pertence a SimulacaoMina)
+    RegistradorTelemetria* telemetria_;
+    // sessao gravada da mina, quando houver; so os comandos do MQTT proprio passam por aqui
+    GravadorSessao* gravador_;
+
+    // Estado mantido entre ciclos das tarefas (cada um so eh tocado pela propria tarefa)
+    std::chrono::steady_clock::time_point inicio_;
+    FiltroSensor filtroX_, filtroY_, filtroAng_, filtroTemp_;
+    std::mt19937 rngSensores_;
+    std::normal_distribution<double> ruidoSensores_;
+    bool coletorDefeitoAnterior_;
+    bool coletorManualAnterior_;
+    bool coletorAlertaTempAnterior_;
+
+    // Pipeline sensores -> logica -> planejamento -> controle: cada insercao no buffer dispara
+    // o proximo estagio, e cada estagio guarda a sequencia do ultimo registro que processou
+    std::uint64_t seqLogica_;
+    std::uint64_t seqPlanejamento_;
+    std::uint64_t seqControle_;
+    std::atomic<std::uint64_t> seqPlanejado_;   // amostra com setpoints prontos, lida pelo controle
+    std::atomic<double> tempoPlanejado_s_;      // instante de leitura dessa amostra
+    NivelSeguranca nivelControle_;
+    int desvioControle_;
+    HistogramaLogLinear* latenciaPipeline_;
+
+    // Relogio virtual do modo lockstep
+    bool relogioVirtual_;
+    double tempoVirtual_s_;
+    double tempoImportado_s_;  // tempo da simulacao trazido de outro shard, base do relogio real
+
+    // Tarefas periodicas registradas no executor da frota
     std::atomic<bool> rodando_;
-    std::thread thTratamentoSensores_;
-    std::thread thLogicaComando_;
-    std::thread thMonitoramentoFalhas_;
-    std::thread thControleNavegacao_;
-    std::thread thPlanejamentoRota_;
-    std::thread thColetorDados_;
+    ExecutorPeriodico* executor_;
+    ExecutorPeriodico::IdTarefa tarTratamentoSensores_;
+    ExecutorPeriodico::IdTarefa tarLogicaComando_;
+    ExecutorPeriodico::IdTarefa tarMonitoramentoFalhas_;
+    ExecutorPeriodico::IdTarefa tarControleNavegacao_;
+    ExecutorPeriodico::IdTarefa tarPlanejamentoRota_;
+    ExecutorPeriodico::IdTarefa tarColetorDados_;
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+// include/EstatisticasTarefas.hpp
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "HistogramaLogLinear.hpp"
+
+// tipos de tarefa periodica medidos; cada tipo agrega as execucoes de todos os caminhoes
+enum class TipoTarefa : std::uint8_t {
+    TratamentoSensores = 0,
+    LogicaComando,
+    MonitoramentoFalhas,
+    ControleNavegacao,
+    PlanejamentoRota,
+    ColetorDados,
+    MonitoramentoSeguranca,
+    FisicaFrota,
+    PublicacaoFrota,
+    Quantidade
+};
+
+const char* tipoTarefaToString(TipoTarefa tipo);
+
+// medidas de um tipo de tarefa, todas em microssegundos:
+// periodo real (inicio a inicio), tempo de execucao, jitter (atraso do inicio em relacao
+// ao prazo) e estouros (execucao que terminou depois do prazo seguinte)
+class EstatisticasTarefa {
+public:
+    using Relogio = std::chrono::steady_clock;
+
+    // primeiroCiclo indica que nao ha inicio anterior, o periodo nao eh registrado
+    void registrarCiclo(Relogio::time_point prazo, Relogio::time_point inicio,
+                        Relogio::time_point fim, Relogio::time_point inicioAnterior,
+                        Relogio::duration periodoNominal, bool primeiroCiclo);
+
+    const HistogramaLogLinear& periodo() const  { return periodo_us_; }
+    const HistogramaLogLinear& execucao() const { return execucao_us_; }
+    const HistogramaLogLinear& jitter() const   { return jitter_us_; }
+    std::uint64_t estouros() const { return estouros_.load(std::memory_order_relaxed); }
+
+    void zerar();
+
+private:
+    HistogramaLogLinear periodo_us_;
+    HistogramaLogLinear execucao_us_;
+    HistogramaLogLinear jitter_us_;
+    std::atomic<std::uint64_t> estouros_{0};
+};
+
+// foto das estatisticas de um tipo de tarefa, para consulta e publicacao
+struct ResumoTarefa {
+    std::string   tarefa;
+    std::uint64_t ciclos;
+    std::uint64_t estouros;
+    double        periodoMedio_us;
+    std::uint64_t periodoP50_us, periodoP99_us, periodoMax_us;
+    double        execucaoMedia_us;
+    std::uint64_t execucaoP50_us, execucaoP99_us, execucaoMax_us;
+    std::uint64_t jitterP50_us, jitterP99_us, jitterMax_us;
+};
+
+// latencia de ponta a ponta do pipeline sensores -> logica -> planejamento -> controle
+struct ResumoLatencia {
+    std::uint64_t amostras;
+    double        media_us;
+    std::uint64_t p50_us, p99_us, max_us;
+};
+
+// conjunto de estatisticas da frota, um EstatisticasTarefa por TipoTarefa
+class EstatisticasFrota {
+public:
+    EstatisticasTarefa& de(TipoTarefa tipo) { return porTipo_[static_cast<std::size_t>(tipo)]; }
+
+    // tempo entre a leitura dos sensores e a aplicacao dos atuadores calculados com ela
+    HistogramaLogLinear& latenciaSensorAtuador() { return latenciaSensorAtuador_us_; }
+
+    // so os tipos que ja rodaram pelo menos uma vez
+    std::vector<ResumoTarefa> resumo() const;
+    ResumoLatencia resumoLatencia() const;
+
+    // objeto JSON compacto {"t":..., "tarefas":[{...}, ...], "latencia_sensor_atuador_us":{...}}
+    std::string json() const;
+
+    void zerar();
+
+private:
+    std::array<EstatisticasTarefa, static_cast<std::size_t>(TipoTarefa::Quantidade)> porTipo_;
+    HistogramaLogLinear latenciaSensorAtuador_us_;
+};
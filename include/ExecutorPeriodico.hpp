@@ -0,0 +1,88 @@
+// include/ExecutorPeriodico.hpp
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include "EstatisticasTarefas.hpp"
+
+// executor periodico compartilhado pela frota inteira
+// um pool fixo de threads (uma por nucleo) atende todas as tarefas periodicas
+// de todos os caminhoes, ordenadas por prazo em um heap de deadlines
+class ExecutorPeriodico {
+public:
+    using Relogio   = std::chrono::steady_clock;
+    using IdTarefa  = std::uint64_t;
+    using Funcao    = std::function<void()>;
+
+    // numThreads igual a zero usa a quantidade de nucleos da maquina
+    explicit ExecutorPeriodico(std::size_t numThreads = 0);
+    ~ExecutorPeriodico();
+
+    ExecutorPeriodico(const ExecutorPeriodico&) = delete;
+    ExecutorPeriodico& operator=(const ExecutorPeriodico&) = delete;
+
+    // registra uma tarefa executada a cada periodo, a primeira execucao eh imediata
+    // uma mesma tarefa nunca roda em duas threads ao mesmo tempo
+    // com estatisticas nao nulo, cada ciclo registra periodo, execucao, jitter e estouro
+    IdTarefa registrar(Funcao funcao, std::chrono::milliseconds periodo,
+                       EstatisticasTarefa* estatisticas = nullptr);
+
+    // antecipa a proxima execucao da tarefa para agora (encadeamento por evento)
+    // se ela estiver rodando, roda de novo logo ao terminar; o periodo continua
+    // valendo a partir dessa execucao, como rede de seguranca
+    void disparar(IdTarefa id);
+
+    // remove a tarefa e espera a execucao em andamento terminar, se houver
+    // depois do retorno a funcao nao sera mais chamada
+    void cancelar(IdTarefa id);
+
+    // encerra as threads do pool, tarefas ainda registradas deixam de rodar
+    void parar();
+
+    std::size_t numThreads() const;
+    std::size_t tarefasRegistradas() const;
+
+private:
+    struct Tarefa {
+        Funcao funcao;
+        Relogio::duration periodo;
+        bool executando = false;
+        bool cancelada  = false;
+        bool disparoPendente = false;
+        // prazo da entrada valida no heap; entradas com outro prazo foram substituidas
+        Relogio::time_point prazoAgendado;
+
+        // so acessados pela thread que esta executando a tarefa
+        EstatisticasTarefa* estatisticas = nullptr;
+        Relogio::time_point inicioAnterior;
+        bool jaExecutou = false;
+    };
+
+    // entrada do heap, o menor prazo fica no topo
+    struct Agendamento {
+        Relogio::time_point prazo;
+        IdTarefa id;
+        bool operator>(const Agendamento& o) const { return prazo > o.prazo; }
+    };
+
+    void lacoTrabalhador();
+
+    mutable std::mutex mtx_;
+    std::condition_variable cvTrabalho_;   // acorda trabalhadores quando o topo do heap muda
+    std::condition_variable cvConclusao_;  // acorda quem esta cancelando uma tarefa em execucao
+    std::priority_queue<Agendamento, std::vector<Agendamento>, std::greater<Agendamento>> agenda_;
+    std::unordered_map<IdTarefa, Tarefa> tarefas_;
+    IdTarefa proximoId_;
+    bool rodando_;
+    std::vector<std::thread> trabalhadores_;
+};
@@ -1,33 +1,96 @@
 // include/FilaEventos.hpp
 #pragma once
 
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "Tipos.hpp"
 
+// o que fazer quando um evento chega com a fila cheia
+enum class PoliticaEstouro {
+    DescartarNovo,        // o evento novo eh descartado e contado
+    DescartarMaisAntigo,  // o evento mais antigo sai (e eh contado) para dar lugar ao novo
+    Bloquear              // o produtor espera ate o consumidor liberar espaco
+};
+
 // fila de eventos thread safe usada pra troca de eventos entre tarefas
-// uma tarefa posta eventos aqui e outras podem esperar ou tentar ler sem travar
+// varios produtores e um consumidor sobre um anel preallocado de capacidade fixa:
+// postar e retirar nao alocam e nao travam mutex; o mutex so eh usado para dormir
+// quando o consumidor espera evento (ou o produtor espera espaco, na politica Bloquear)
 class FilaEventos {
 public:
-    FilaEventos() = default;
+    // a capacidade eh arredondada para a proxima potencia de dois
+    explicit FilaEventos(std::size_t capacidade = 256,
+                         PoliticaEstouro politica = PoliticaEstouro::DescartarNovo);
+
+    FilaEventos(const FilaEventos&) = delete;
+    FilaEventos& operator=(const FilaEventos&) = delete;
 
-    // posta um novo evento na fila e acorda quem estiver esperando
-    void postar(const Evento& evento);
+    // posta um novo evento na fila e acorda o consumidor se ele estiver esperando
+    // retorna false se o evento foi descartado (fila cheia com DescartarNovo)
+    bool postar(const Evento& evento);
 
     // bloqueia ate existir pelo menos um evento na fila e retorna o primeiro
     Evento esperarProximo();
 
+    // espera no maximo 'espera' por um evento; retorna false se o tempo acabou sem evento
+    bool esperarProximo(Evento& out, std::chrono::milliseconds espera);
+
     // tenta retirar um evento sem bloquear
     // retorna true se conseguiu pegar algum evento
     bool tentarRetirar(Evento& out);
 
-    // retorna o tamanho atual da fila de eventos
+    // retira de uma vez ate 'maximo' eventos para 'lote' (que eh limpo antes)
+    // a capacidade do vetor eh reaproveitada entre chamadas; retorna quantos vieram
+    std::size_t drenar(std::vector<Evento>& lote, std::size_t maximo);
+
+    // como drenar, mas espera no maximo 'espera' pelo primeiro evento se a fila estiver vazia
+    // permite ao consumidor intercalar a espera por eventos com o seu trabalho periodico
+    std::size_t drenar(std::vector<Evento>& lote, std::size_t maximo, std::chrono::milliseconds espera);
+
+    // retorna o tamanho atual da fila de eventos (aproximado com produtores concorrentes)
     std::size_t tamanho() const;
 
+    std::size_t capacidade() const { return mascara_ + 1; }
+    PoliticaEstouro politica() const { return politica_; }
+
+    // eventos perdidos por estouro desde a criacao da fila
+    std::uint64_t descartados() const { return descartados_.load(std::memory_order_relaxed); }
+
 private:
-    mutable std::mutex mtx_;
-    std::condition_variable cv_;
-    std::queue<Evento> fila_;
-};
\ No newline at end of file
+    // celula do anel: 'sequencia' diz se a celula esta livre para a volta 'pos'
+    // (sequencia == pos) ou se ja tem o evento da volta 'pos' (sequencia == pos + 1)
+    struct alignas(64) Celula {
+        std::atomic<std::size_t> sequencia;
+        Evento evento;
+    };
+
+    bool tentarEnfileirar(const Evento& evento);
+    bool tentarDesenfileirar(Evento& out);
+    bool temEvento() const;
+    bool temEspaco() const;
+
+    // dorme ate haver evento ou ate o limite (nullptr = sem limite); retorna se ha evento
+    bool esperarEvento(const std::chrono::steady_clock::time_point* limite);
+    void acordarConsumidor();
+    void acordarProdutores();
+
+    std::unique_ptr<Celula[]> celulas_;
+    std::size_t mascara_;
+    PoliticaEstouro politica_;
+
+    alignas(64) std::atomic<std::size_t> cauda_;   // proxima posicao de escrita
+    alignas(64) std::atomic<std::size_t> cabeca_;  // proxima posicao de leitura
+    alignas(64) std::atomic<std::uint64_t> descartados_;
+
+    std::atomic<int> consumidoresEsperando_;
+    std::atomic<int> produtoresEsperando_;
+    std::mutex mtx_;
+    std::condition_variable cvEvento_;
+    std::condition_variable cvEspaco_;
+};
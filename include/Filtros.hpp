@@ -0,0 +1,253 @@
+// include/Filtros.hpp
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <variant>
+
+// filtros de sensor em fluxo: sem alocacao e com custo constante por amostra
+// a janela de cada filtro eh escolhida na construcao, limitada por uma capacidade fixa
+
+// media movel das ultimas N amostras sobre um anel de capacidade fixa
+// a soma corrente eh compensada (Neumaier) para nao acumular erro de arredondamento
+// com o soma/subtrai de cada amostra
+class MediaMovel {
+public:
+    static constexpr std::size_t JANELA_MAXIMA = 256;
+
+    explicit MediaMovel(std::size_t janela)
+        : janela_(janela == 0 ? 1 : (janela > JANELA_MAXIMA ? JANELA_MAXIMA : janela)) {}
+
+    // insere a amostra e retorna a media da janela atual
+    double filtrar(double v) {
+        if (quantidade_ == janela_) {
+            acumular(-anel_[proximo_]);
+        } else {
+            ++quantidade_;
+        }
+        anel_[proximo_] = v;
+        acumular(v);
+        proximo_ = (proximo_ + 1 == janela_) ? 0 : proximo_ + 1;
+        return (soma_ + compensacao_) / static_cast<double>(quantidade_);
+    }
+
+    void limpar() {
+        quantidade_  = 0;
+        proximo_     = 0;
+        soma_        = 0.0;
+        compensacao_ = 0.0;
+    }
+
+    std::size_t janela() const { return janela_; }
+
+private:
+    void acumular(double x) {
+        double t = soma_ + x;
+        if (std::fabs(soma_) >= std::fabs(x)) compensacao_ += (soma_ - t) + x;
+        else                                  compensacao_ += (x - t) + soma_;
+        soma_ = t;
+    }
+
+    std::array<double, JANELA_MAXIMA> anel_{};
+    std::size_t janela_;
+    std::size_t quantidade_ = 0;
+    std::size_t proximo_    = 0;
+    double soma_        = 0.0;
+    double compensacao_ = 0.0;
+};
+
+// media movel exponencial: y += alfa * (x - y), a primeira amostra inicializa a saida
+class MediaExponencial {
+public:
+    explicit MediaExponencial(double alfa)
+        : alfa_(alfa <= 0.0 ? 1e-6 : (alfa > 1.0 ? 1.0 : alfa)) {}
+
+    double filtrar(double v) {
+        if (!iniciado_) {
+            saida_    = v;
+            iniciado_ = true;
+        } else {
+            saida_ += alfa_ * (v - saida_);
+        }
+        return saida_;
+    }
+
+    void limpar() { iniciado_ = false; }
+
+private:
+    double alfa_;
+    double saida_   = 0.0;
+    bool   iniciado_ = false;
+};
+
+// mediana das ultimas N amostras, bom contra picos isolados
+// mantem o anel e uma copia ordenada; com N limitado a JANELA_MAXIMA cada amostra
+// custa no maximo um deslocamento de N posicoes
+class Mediana {
+public:
+    static constexpr std::size_t JANELA_MAXIMA = 31;
+
+    explicit Mediana(std::size_t janela)
+        : janela_(janela == 0 ? 1 : (janela > JANELA_MAXIMA ? JANELA_MAXIMA : janela)) {}
+
+    double filtrar(double v) {
+        if (quantidade_ == janela_) {
+            remover(anel_[proximo_]);
+        }
+        anel_[proximo_] = v;
+        inserir(v);
+        proximo_ = (proximo_ + 1 == janela_) ? 0 : proximo_ + 1;
+
+        if (quantidade_ % 2 == 1) return ordenado_[quantidade_ / 2];
+        return 0.5 * (ordenado_[quantidade_ / 2 - 1] + ordenado_[quantidade_ / 2]);
+    }
+
+    void limpar() {
+        quantidade_ = 0;
+        proximo_    = 0;
+    }
+
+    std::size_t janela() const { return janela_; }
+
+private:
+    void remover(double v) {
+        std::size_t i = 0;
+        while (i < quantidade_ && ordenado_[i] != v) ++i;
+        for (; i + 1 < quantidade_; ++i) ordenado_[i] = ordenado_[i + 1];
+        --quantidade_;
+    }
+
+    void inserir(double v) {
+        std::size_t i = quantidade_;
+        while (i > 0 && ordenado_[i - 1] > v) {
+            ordenado_[i] = ordenado_[i - 1];
+            --i;
+        }
+        ordenado_[i] = v;
+        ++quantidade_;
+    }
+
+    std::array<double, JANELA_MAXIMA> anel_{};
+    std::array<double, JANELA_MAXIMA> ordenado_{};
+    std::size_t janela_;
+    std::size_t quantidade_ = 0;
+    std::size_t proximo_    = 0;
+};
+
+// filtro de Kalman de velocidade constante (estado posicao e velocidade, mede so a posicao)
+// dt eh o periodo de amostragem, q a intensidade do ruido de processo (aceleracao)
+// e r a variancia do ruido de medida
+class KalmanVelocidadeConstante {
+public:
+    KalmanVelocidadeConstante(double dt, double q, double r)
+        : dt_(dt), q_(q), r_(r) {}
+
+    double filtrar(double z) {
+        if (!iniciado_) {
+            x_ = z;
+            v_ = 0.0;
+            p00_ = r_;  p01_ = 0.0;
+            p10_ = 0.0; p11_ = 1.0;
+            iniciado_ = true;
+            return x_;
+        }
+
+        // predicao: x = F x, P = F P F' + Q, com F = [1 dt; 0 1]
+        const double dt  = dt_;
+        const double dt2 = dt * dt;
+        x_ += v_ * dt;
+        double n00 = p00_ + dt * (p10_ + p01_) + dt2 * p11_ + q_ * dt2 * dt2 / 4.0;
+        double n01 = p01_ + dt * p11_ + q_ * dt2 * dt / 2.0;
+        double n10 = p10_ + dt * p11_ + q_ * dt2 * dt / 2.0;
+        double n11 = p11_ + q_ * dt2;
+
+        // atualizacao com H = [1 0]
+        double s  = n00 + r_;
+        double k0 = n00 / s;
+        double k1 = n10 / s;
+        double y  = z - x_;
+        x_ += k0 * y;
+        v_ += k1 * y;
+
+        p00_ = (1.0 - k0) * n00;
+        p01_ = (1.0 - k0) * n01;
+        p10_ = n10 - k1 * n00;
+        p11_ = n11 - k1 * n01;
+        return x_;
+    }
+
+    void limpar() { iniciado_ = false; }
+
+    double velocidade() const { return v_; }
+
+private:
+    double dt_, q_, r_;
+    double x_ = 0.0, v_ = 0.0;
+    double p00_ = 0.0, p01_ = 0.0, p10_ = 0.0, p11_ = 0.0;
+    bool iniciado_ = false;
+};
+
+// sem filtragem, devolve a amostra
+class SemFiltro {
+public:
+    double filtrar(double v) { return v; }
+    void limpar() {}
+};
+
+enum class TipoFiltro {
+    Nenhum,
+    MediaMovel,
+    Exponencial,
+    Mediana,
+    Kalman
+};
+
+// escolha do filtro de um canal; use as funcoes de fabrica para preencher
+struct ConfigFiltro {
+    TipoFiltro  tipo    = TipoFiltro::MediaMovel;
+    std::size_t janela  = 10;    // MediaMovel e Mediana
+    double      alfa    = 0.2;   // Exponencial
+    double      dt      = 0.1;   // Kalman
+    double      q       = 1.0;   // Kalman
+    double      r       = 0.04;  // Kalman
+
+    static ConfigFiltro nenhum()                           { ConfigFiltro c; c.tipo = TipoFiltro::Nenhum; return c; }
+    static ConfigFiltro mediaMovel(std::size_t janela)     { ConfigFiltro c; c.tipo = TipoFiltro::MediaMovel; c.janela = janela; return c; }
+    static ConfigFiltro exponencial(double alfa)           { ConfigFiltro c; c.tipo = TipoFiltro::Exponencial; c.alfa = alfa; return c; }
+    static ConfigFiltro mediana(std::size_t janela)        { ConfigFiltro c; c.tipo = TipoFiltro::Mediana; c.janela = janela; return c; }
+    static ConfigFiltro kalman(double dt, double q, double r) {
+        ConfigFiltro c; c.tipo = TipoFiltro::Kalman; c.dt = dt; c.q = q; c.r = r; return c;
+    }
+};
+
+// filtro de um canal de sensor com o tipo escolhido em tempo de execucao
+// guarda o filtro concreto por valor, sem alocacao
+class FiltroSensor {
+public:
+    explicit FiltroSensor(const ConfigFiltro& cfg = ConfigFiltro{}) : filtro_(criar(cfg)) {}
+
+    double filtrar(double v) {
+        return std::visit([v](auto& f) { return f.filtrar(v); }, filtro_);
+    }
+
+    void limpar() {
+        std::visit([](auto& f) { f.limpar(); }, filtro_);
+    }
+
+private:
+    using Variante = std::variant<SemFiltro, MediaMovel, MediaExponencial, Mediana, KalmanVelocidadeConstante>;
+
+    static Variante criar(const ConfigFiltro& cfg) {
+        switch (cfg.tipo) {
+            case TipoFiltro::MediaMovel:  return MediaMovel(cfg.janela);
+            case TipoFiltro::Exponencial: return MediaExponencial(cfg.alfa);
+            case TipoFiltro::Mediana:     return Mediana(cfg.janela);
+            case TipoFiltro::Kalman:      return KalmanVelocidadeConstante(cfg.dt, cfg.q, cfg.r);
+            case TipoFiltro::Nenhum:      break;
+        }
+        return SemFiltro{};
+    }
+
+    Variante filtro_;
+};
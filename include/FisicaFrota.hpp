@@ -0,0 +1,80 @@
+// include/FisicaFrota.hpp
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+// modelo fisico de todos os caminhoes em estrutura de arrays (SoA)
+// cada caminhao ocupa um indice fixo e a integracao percorre a frota inteira
+// em uma unica passada vetorizada (AVX2 quando o processador suporta, senao escalar)
+// indices liberados por caminhoes que sairam sao reaproveitados pelos proximos e pulados
+// na integracao; os do fim dos arrays sao devolvidos, entao os arrays acompanham a frota
+class FisicaFrota {
+public:
+    struct EstadoFisico {
+        double pos_x;
+        double pos_y;
+        double vel;
+        double ang_deg;
+        double temp_C;
+    };
+
+    FisicaFrota();
+
+    // reserva um indice para um novo caminhao e retorna esse indice
+    // reaproveita o menor indice livre antes de crescer os arrays
+    std::size_t adicionar(double pos_x, double pos_y, double ang_deg, double temp_C);
+
+    // devolve o indice de um caminhao que saiu da frota (destruido ou passado para outro
+    // shard); o indice nao pode mais ser usado por quem o liberou
+    void liberar(std::size_t indice);
+
+    EstadoFisico ler(std::size_t indice) const;
+    double velocidade(std::size_t indice) const;
+
+    // reposiciona o caminhao parado na posicao dada (usado ao definir rota)
+    void reposicionar(std::size_t indice, double pos_x, double pos_y, double ang_deg);
+    void zerarVelocidade(std::size_t indice);
+    // estado completo trazido de outro processo (caminhao que mudou de shard)
+    void restaurar(std::size_t indice, const EstadoFisico& estado);
+
+    // atuacao aplicada na proxima integracao: aceleracao em % e direcao absoluta em graus
+    void definirAtuacao(std::size_t indice, int aceleracao, int direcao);
+
+    // integra todos os caminhoes por dt segundos
+    void integrar(double dt);
+
+    // indices em uso, sem os livres
+    std::size_t tamanho() const;
+
+    // true quando a passada vetorizada AVX2 esta em uso nesta maquina
+    static bool usandoAvx2();
+
+    // parametros do modelo, os mesmos do antigo controle por caminhao
+    static constexpr double A_MAX       = 2.0;  // aceleracao maxima em m/s2 para 100%
+    static constexpr double FRICCAO     = 0.2;  // atrito proporcional a velocidade
+    static constexpr double TEMP_BASE_C = 40.0;
+
+private:
+    void integrarEscalar(std::size_t inicio, std::size_t fim, double dt);
+    std::size_t integrarAvx2(std::size_t n, double dt);
+
+    mutable std::mutex mtx_;
+
+    std::vector<double> pos_x_;
+    std::vector<double> pos_y_;
+    std::vector<double> vel_;
+    std::vector<double> ang_deg_;
+    std::vector<double> temp_C_;
+    std::vector<std::int32_t> acel_;
+    std::vector<std::int32_t> dir_;
+    std::vector<std::uint8_t> livre_;    // 1 nos indices liberados, pulados na integracao
+    std::vector<std::size_t> livres_;    // heap de minimo dos indices liberados
+
+    // cos e sin das direcoes inteiras de -180 a 180 graus, indexados por dir + 180
+    // a direcao comandada eh sempre inteira, entao a tabela da o mesmo valor de std::cos/std::sin
+    std::vector<double> tabCos_;
+    std::vector<double> tabSin_;
+};
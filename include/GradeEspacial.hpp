@@ -0,0 +1,197 @@
+// include/GradeEspacial.hpp
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+// grade espacial uniforme para busca de vizinhos proximos
+// cada ponto cai em uma celula quadrada de lado tamanhoCelula, e pares com
+// distancia menor que tamanhoCelula so podem estar na mesma celula ou em celulas vizinhas
+class GradeEspacial {
+public:
+    struct Ponto {
+        double x;
+        double y;
+    };
+
+    explicit GradeEspacial(double tamanhoCelula);
+
+    // recalcula a grade a partir das posicoes atuais
+    // os indices passados ao callback sao os indices do vetor pontos
+    void reconstruir(const std::vector<Ponto>& pontos);
+
+    // chama f(i, j, dist) uma vez para cada par i < j com distancia menor que raio
+    // raio deve ser menor ou igual ao tamanho da celula
+    template <typename F>
+    void paraCadaParProximo(double raio, F&& f) const;
+
+    // chama f(i, j, dist2) uma vez para cada par i < j com distancia menor que
+    // alcances[i] + alcances[j] (um alcance por ponto, do tamanho que for); dist2 eh o
+    // quadrado da distancia, a raiz fica para quem precisar dela
+    // o par eh achado pelo ponto de maior alcance, que so procura nas celulas a menos de
+    // 2 * alcance dele; um ponto lento no meio de muitos nao paga pelo mais rapido da grade
+    // usa os pontos do ultimo reconstruir, numa grade densa propria
+    template <typename F>
+    void paraCadaParAoAlcance(const std::vector<double>& alcances, F&& f);
+
+    double tamanhoCelula() const { return tamanhoCelula_; }
+
+private:
+    using Chave = std::uint64_t;
+
+    Chave chaveCelula(std::int32_t cx, std::int32_t cy) const {
+        return (static_cast<Chave>(static_cast<std::uint32_t>(cx)) << 32) |
+                static_cast<Chave>(static_cast<std::uint32_t>(cy));
+    }
+    std::int32_t celula(double v) const {
+        return static_cast<std::int32_t>(std::floor(v / tamanhoCelula_));
+    }
+
+    double tamanhoCelula_;
+    std::vector<Ponto> pontos_;
+    // pares (chave da celula, indice do ponto) ordenados por chave
+    // pontos da mesma celula ficam contiguos, o que permite achar a celula por busca binaria
+    std::vector<std::pair<Chave, std::size_t>> ordenados_;
+    // grade densa de paraCadaParAoAlcance, refeita a cada chamada
+    std::vector<std::size_t> inicioDenso_;    // primeiro ponto de cada celula, coluna a coluna
+    std::vector<std::size_t> posicaoDensa_;
+    std::vector<std::size_t> indicesDensos_;
+    std::vector<Ponto> pontosDensos_;
+    std::vector<double> alcancesDensos_;
+};
+
+template <typename F>
+void GradeEspacial::paraCadaParProximo(double raio, F&& f) const {
+    const double raio2 = raio * raio;
+
+    // so metade da vizinhanca eh visitada para nao repetir pares: a propria celula
+    // e as celulas a direita, acima-esquerda, acima e acima-direita
+    static const int VIZINHOS[4][2] = { {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
+
+    auto compara = [](const std::pair<Chave, std::size_t>& a, Chave c) { return a.first < c; };
+
+    std::size_t inicioCelula = 0;
+    while (inicioCelula < ordenados_.size()) {
+        const Chave chave = ordenados_[inicioCelula].first;
+        std::size_t fimCelula = inicioCelula;
+        while (fimCelula < ordenados_.size() && ordenados_[fimCelula].first == chave) ++fimCelula;
+
+        const std::int32_t cx = static_cast<std::int32_t>(static_cast<std::uint32_t>(chave >> 32));
+        const std::int32_t cy = static_cast<std::int32_t>(static_cast<std::uint32_t>(chave));
+
+        // faixas das celulas vizinhas no vetor ordenado, buscadas uma vez por celula
+        std::pair<std::size_t, std::size_t> faixas[4];
+        for (int v = 0; v < 4; ++v) {
+            const Chave vizinha = chaveCelula(cx + VIZINHOS[v][0], cy + VIZINHOS[v][1]);
+            auto it = std::lower_bound(ordenados_.begin(), ordenados_.end(), vizinha, compara);
+            std::size_t ini = static_cast<std::size_t>(it - ordenados_.begin());
+            std::size_t fim = ini;
+            while (fim < ordenados_.size() && ordenados_[fim].first == vizinha) ++fim;
+            faixas[v] = {ini, fim};
+        }
+
+        for (std::size_t a = inicioCelula; a < fimCelula; ++a) {
+            const std::size_t i = ordenados_[a].second;
+            const Ponto& pi = pontos_[i];
+
+            auto testa = [&](std::size_t j) {
+                const Ponto& pj = pontos_[j];
+                double dx = pi.x - pj.x;
+                double dy = pi.y - pj.y;
+                double d2 = dx*dx + dy*dy;
+                if (d2 < raio2) {
+                    if (i < j) f(i, j, std::sqrt(d2));
+                    else       f(j, i, std::sqrt(d2));
+                }
+            };
+
+            for (std::size_t b = a + 1; b < fimCelula; ++b) testa(ordenados_[b].second);
+
+            for (const auto& faixa : faixas) {
+                for (std::size_t b = faixa.first; b < faixa.second; ++b) testa(ordenados_[b].second);
+            }
+        }
+
+        inicioCelula = fimCelula;
+    }
+}
+
+template <typename F>
+void GradeEspacial::paraCadaParAoAlcance(const std::vector<double>& alcances, F&& f) {
+    const std::size_t n = pontos_.size();
+    if (n < 2) return;
+
+    // grade densa na caixa dos pontos, coluna a coluna, para achar as celulas por indice em
+    // vez de busca binaria; numa caixa grande e vazia a celula cresce para a tabela nao
+    // passar de algumas celulas por ponto
+    double minX = pontos_[0].x, maxX = minX, minY = pontos_[0].y, maxY = minY;
+    for (const Ponto& p : pontos_) {
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+    const double limiteCelulas = 4.0 * static_cast<double>(n) + 64.0;
+    double lado = tamanhoCelula_;
+    while ((std::floor((maxX - minX) / lado) + 1.0) * (std::floor((maxY - minY) / lado) + 1.0) > limiteCelulas) {
+        lado *= 2.0;
+    }
+    const std::int64_t nx = static_cast<std::int64_t>((maxX - minX) / lado) + 1;
+    const std::int64_t ny = static_cast<std::int64_t>((maxY - minY) / lado) + 1;
+    auto colunaDe = [&](double x) { return static_cast<std::int64_t>((x - minX) / lado); };
+    auto linhaDe  = [&](double y) { return static_cast<std::int64_t>((y - minY) / lado); };
+
+    // contagem por celula e distribuicao; pontos, alcances e indices na ordem das celulas,
+    // lidos em sequencia
+    inicioDenso_.assign(static_cast<std::size_t>(nx * ny) + 1, 0);
+    for (const Ponto& p : pontos_) ++inicioDenso_[static_cast<std::size_t>(colunaDe(p.x) * ny + linhaDe(p.y)) + 1];
+    for (std::size_t c = 1; c < inicioDenso_.size(); ++c) inicioDenso_[c] += inicioDenso_[c - 1];
+    indicesDensos_.resize(n);
+    pontosDensos_.resize(n);
+    alcancesDensos_.resize(n);
+    posicaoDensa_.assign(inicioDenso_.begin(), inicioDenso_.end() - 1);
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::size_t b = posicaoDensa_[static_cast<std::size_t>(colunaDe(pontos_[k].x) * ny + linhaDe(pontos_[k].y))]++;
+        indicesDensos_[b]  = k;
+        pontosDensos_[b]   = pontos_[k];
+        alcancesDensos_[b] = alcances[k];
+    }
+
+    for (std::size_t a = 0; a < n; ++a) {
+        const std::size_t i = indicesDensos_[a];
+        const Ponto& pi = pontosDensos_[a];
+        const double ai = alcancesDensos_[a];
+        const double raio = 2.0 * ai;
+
+        // celulas a menos de 2 * ai de i: em cada coluna, so as linhas que o circulo corta,
+        // que ficam contiguas
+        const std::int64_t x0 = std::max<std::int64_t>(colunaDe(std::max(pi.x - raio, minX)), 0);
+        const std::int64_t x1 = std::min<std::int64_t>(colunaDe(std::min(pi.x + raio, maxX)), nx - 1);
+        for (std::int64_t vx = x0; vx <= x1; ++vx) {
+            const double esquerda = minX + static_cast<double>(vx) * lado;
+            const double bordaX = std::max({esquerda - pi.x, pi.x - (esquerda + lado), 0.0});
+            const double meiaCorda = std::sqrt(std::max(raio * raio - bordaX * bordaX, 0.0));
+            const std::int64_t y0 = std::max<std::int64_t>(linhaDe(std::max(pi.y - meiaCorda, minY)), 0);
+            const std::int64_t y1 = std::min<std::int64_t>(linhaDe(std::min(pi.y + meiaCorda, maxY)), ny - 1);
+
+            const std::size_t fim = inicioDenso_[static_cast<std::size_t>(vx * ny + y1) + 1];
+            for (std::size_t b = inicioDenso_[static_cast<std::size_t>(vx * ny + y0)]; b < fim; ++b) {
+                const double dx = pi.x - pontosDensos_[b].x;
+                const double dy = pi.y - pontosDensos_[b].y;
+                const double d2 = dx*dx + dy*dy;
+                const double aj = alcancesDensos_[b];
+                const double lim = ai + aj;
+                // cada par uma vez, do lado de maior alcance (no empate, o de menor posicao);
+                // os testes sao combinados sem desvio, so o par que passa desvia
+                const bool deste = (aj < ai) | ((aj == ai) & (b > a));
+                if (deste & (d2 < lim * lim)) {
+                    const std::size_t j = indicesDensos_[b];
+                    if (i < j) f(i, j, d2);
+                    else       f(j, i, d2);
+                }
+            }
+        }
+    }
+}
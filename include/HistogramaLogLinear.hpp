@@ -0,0 +1,40 @@
+// include/HistogramaLogLinear.hpp
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// histograma log-linear de valores inteiros (microssegundos nas estatisticas de tarefas)
+// cada potencia de 2 eh dividida em 16 faixas iguais, entao o erro relativo fica abaixo de 6.25%
+// em qualquer escala; registrar() eh lock-free (so fetch_add relaxado) e pode ser chamado
+// por varias threads ao mesmo tempo, as leituras sao aproximadas durante a escrita
+class HistogramaLogLinear {
+public:
+    static constexpr int BITS_SUB = 4;
+    static constexpr std::size_t FAIXAS_POR_GRUPO = std::size_t(1) << BITS_SUB;
+    static constexpr std::size_t NUM_FAIXAS = (64 - BITS_SUB + 1) * FAIXAS_POR_GRUPO;
+
+    HistogramaLogLinear();
+
+    void registrar(std::uint64_t valor);
+
+    std::uint64_t contagem() const;
+    std::uint64_t maximo() const;
+    double media() const;
+
+    // limite superior da faixa que contem o percentil p (0 a 1), zero se vazio
+    std::uint64_t percentil(double p) const;
+
+    void zerar();
+
+private:
+    static std::size_t indiceFaixa(std::uint64_t valor);
+    static std::uint64_t limiteSuperior(std::size_t indice);
+
+    std::array<std::atomic<std::uint64_t>, NUM_FAIXAS> faixas_;
+    std::atomic<std::uint64_t> contagem_;
+    std::atomic<std::uint64_t> soma_;
+    std::atomic<std::uint64_t> maximo_;
+};
@@ -0,0 +1,61 @@
+// include/Log.hpp
+#pragma once
+
+#include <cstdarg>
+#include <cstdint>
+#include <string>
+
+enum class NivelLog : std::uint8_t {
+    Depuracao,
+    Info,
+    Aviso,
+    Erro
+};
+
+// log de console assincrono para as tarefas dos caminhoes e da simulacao
+// cada thread que registra ganha um anel proprio (um produtor, um consumidor, sem trava),
+// e uma unica thread de descarga junta os aneis, ordena por instante e escreve em lote
+// registrar so formata no slot do anel da thread, com tamanho limitado e sem alocar
+// (a primeira chamada de cada thread aloca o anel); com o anel cheio a mensagem eh
+// descartada e contada, a tarefa nunca espera pelo terminal
+// mensagens identicas repetidas mais de LIMITE_REPETICOES vezes numa janela de
+// JANELA_REPETICOES_S sao suprimidas, com uma linha de resumo no fim da janela
+// Info e Depuracao saem no stdout, Aviso e Erro no stderr (coloridos num terminal), ou
+// tudo num arquivo com configurar()
+namespace Log {
+    struct Configuracao {
+        NivelLog nivelMinimo = NivelLog::Info;
+        std::string arquivo;   // vazio: terminal
+        bool cores = true;     // so quando a saida eh um terminal
+    };
+
+    struct Estatisticas {
+        std::uint64_t escritas    = 0;
+        std::uint64_t descartadas = 0;  // anel da thread cheio
+        std::uint64_t suprimidas  = 0;  // repeticoes
+    };
+
+    constexpr std::size_t TAM_MENSAGEM      = 232;  // o resto eh truncado
+    constexpr std::size_t CAPACIDADE_ANEL   = 512;  // mensagens por thread
+    constexpr int         LIMITE_REPETICOES = 3;
+    constexpr double      JANELA_REPETICOES_S = 10.0;
+
+    // pode ser chamado a qualquer momento; false se o arquivo nao abrir (o log segue no terminal)
+    bool configurar(const Configuracao& configuracao);
+
+    bool habilitado(NivelLog nivel);
+
+    void registrar(NivelLog nivel, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+    void registrarV(NivelLog nivel, const char* formato, va_list args);
+
+    void depuracao(const char* formato, ...) __attribute__((format(printf, 1, 2)));
+    void info(const char* formato, ...)      __attribute__((format(printf, 1, 2)));
+    void aviso(const char* formato, ...)     __attribute__((format(printf, 1, 2)));
+    void erro(const char* formato, ...)      __attribute__((format(printf, 1, 2)));
+
+    // espera a thread de descarga escrever tudo o que ja foi registrado
+    // para quem vai escrever direto no terminal em seguida (resumos no fim da execucao)
+    void descarregar();
+
+    Estatisticas estatisticas();
+}
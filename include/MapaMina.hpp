@@ -0,0 +1,81 @@
+// include/MapaMina.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "GradeEspacial.hpp"
+
+// mapa de ocupacao da mina usado pelo planejamento de rotas, compartilhado pela frota
+// os obstaculos (cava, britador, ...) sao rasterizados numa grade de celulas quadradas,
+// inflados por uma margem para que o caminhao passe ao largo e nao raspando
+// cada mudanca de obstaculos publica uma grade nova e imutavel com versao maior; quem
+// planeja pega a grade atual uma vez e le sem trava, e compara versoes para saber se a
+// rota que ja tem foi feita sobre um mapa antigo
+class MapaMina {
+public:
+    struct Obstaculo {
+        enum class Forma { Circulo, Retangulo };
+
+        Forma  forma;
+        double cx, cy;            // centro
+        double raio;              // Circulo
+        double largura, altura;   // Retangulo, alinhado aos eixos
+
+        static Obstaculo circulo(double cx, double cy, double raio) {
+            return {Forma::Circulo, cx, cy, raio, 0.0, 0.0};
+        }
+        static Obstaculo retangulo(double cx, double cy, double largura, double altura) {
+            return {Forma::Retangulo, cx, cy, 0.0, largura, altura};
+        }
+    };
+
+    struct Grade {
+        double x0, y0;   // canto inferior esquerdo da celula 0
+        double celula;
+        int nx, ny;
+        std::uint64_t versao;
+        std::vector<std::uint8_t> bloqueada;  // nx * ny, linha a linha a partir de y0
+
+        bool dentro(int cx, int cy) const { return cx >= 0 && cx < nx && cy >= 0 && cy < ny; }
+        int indice(int cx, int cy) const { return cy * nx + cx; }
+        bool livre(int cx, int cy) const {
+            return dentro(cx, cy) && !bloqueada[static_cast<std::size_t>(indice(cx, cy))];
+        }
+
+        // celula de um ponto do mundo; false fora do mapa
+        bool celulaDe(double x, double y, int& cx, int& cy) const;
+        GradeEspacial::Ponto centro(int cx, int cy) const {
+            return {x0 + (cx + 0.5) * celula, y0 + (cy + 0.5) * celula};
+        }
+    };
+
+    MapaMina(double xMin, double xMax, double yMin, double yMax, double celula, double margem);
+
+    // cava ("AREA DE LAVRA") e britador primario, nas posicoes e tamanhos desenhados pela GUI
+    static std::vector<Obstaculo> obstaculosPadrao();
+
+    // troca todos os obstaculos / acrescenta um; cada chamada publica uma grade nova
+    void definirObstaculos(std::vector<Obstaculo> obstaculos);
+    void adicionarObstaculo(const Obstaculo& obstaculo);
+
+    // grade publicada; continua valida enquanto o chamador segurar o ponteiro
+    std::shared_ptr<const Grade> grade() const;
+    // sem trava: lido a cada ciclo de planejamento de cada caminhao
+    std::uint64_t versao() const { return versao_.load(std::memory_order_acquire); }
+
+private:
+    void publicar();  // chamado com mtx_
+
+    double xMin_, xMax_, yMin_, yMax_;
+    double celula_;
+    double margem_;
+
+    mutable std::mutex mtx_;
+    std::vector<Obstaculo> obstaculos_;
+    std::shared_ptr<const Grade> grade_;
+    std::atomic<std::uint64_t> versao_;
+};
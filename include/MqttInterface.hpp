@@ -54,10 +54,14 @@ public:
         }
     }
 
-    void publicar(const std::string& topico, const std::string& payload) {
+    bool conectado() const {
+        return client_.is_connected();
+    }
+
+    void publicar(const std::string& topico, const std::string& payload, int qos = QOS) {
         if (!client_.is_connected()) return;
         try {
-            client_.publish(topico, payload, QOS, false);
+            client_.publish(topico, payload, qos, false);
         }
         catch (const mqtt::exception& exc) {
             std::cerr << "[MQTT] Erro ao publicar: " << exc.what() << std::endl;
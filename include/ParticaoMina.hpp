@@ -0,0 +1,37 @@
+// include/ParticaoMina.hpp
+#pragma once
+
+#include <vector>
+
+// divisao da mina em faixas verticais, uma por shard (processo de backend)
+// os cortes dividem [xMin, xMax] em faixas iguais; a primeira e a ultima faixa se estendem
+// ate o infinito, entao todo ponto tem dono
+// um caminhao so muda de dono depois de passar margemMigracao do corte, para nao ir e
+// voltar quando anda junto dele; cada shard tambem enxerga os caminhoes dos outros ate
+// larguraBorda alem da propria faixa, que deve cobrir o raio do anticolisao mais a margem
+class ParticaoMina {
+public:
+    ParticaoMina(int shards, double xMin, double xMax, double margemMigracao, double larguraBorda);
+
+    int quantidade() const { return shards_; }
+    double margemMigracao() const { return margemMigracao_; }
+    double larguraBorda() const { return larguraBorda_; }
+
+    // dono de um ponto, sem histerese
+    int shardDe(double x) const;
+    // dono de um caminhao que hoje pertence a 'atual'
+    int donoDe(double x, int atual) const;
+
+    // shards diferentes de 'dono' que enxergam um caminhao em x
+    void vizinhosDe(double x, int dono, std::vector<int>& out) const;
+
+private:
+    // limites da faixa s; -inf e +inf nas pontas
+    double inicio(int s) const;
+    double fim(int s) const;
+
+    int shards_;
+    double xMin_, largura_;
+    double margemMigracao_;
+    double larguraBorda_;
+};
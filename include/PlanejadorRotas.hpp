@@ -0,0 +1,71 @@
+// include/PlanejadorRotas.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "GradeEspacial.hpp"
+#include "MapaMina.hpp"
+
+// planejamento de rotas da frota sobre o MapaMina
+// A* 8-conexo (sem cortar quina de celula bloqueada) com heuristica octil; o caminho de
+// celulas eh encurtado por linha de visada, entao a rota sai com poucos waypoints nas quinas
+// as rotas ficam num cache LRU da frota inteira, chaveado por (celula de partida, celula de
+// chegada): caminhoes no mesmo ciclo de transporte reaproveitam a rota sem nova busca
+// o cache eh descartado quando a versao do mapa muda
+// a rota depende so das duas celulas e do mapa, nunca de quem a pediu antes, entao acertar
+// ou errar o cache nao muda o resultado (o lockstep continua reprodutivel)
+class PlanejadorRotas {
+public:
+    // waypoints em coordenadas do mundo, sem o ponto de partida e terminando no centro da
+    // celula de chegada (ou na celula livre mais proxima, se ela estiver bloqueada)
+    using Rota = std::shared_ptr<const std::vector<GradeEspacial::Ponto>>;
+
+    struct Estatisticas {
+        std::uint64_t pedidos      = 0;
+        std::uint64_t acertosCache = 0;
+        std::uint64_t semCaminho   = 0;   // fora do mapa ou sem ligacao entre as celulas
+        double        buscaMedia_us = 0.0; // por busca A*, so as que erraram o cache
+    };
+
+    explicit PlanejadorRotas(const MapaMina& mapa, std::size_t capacidadeCache = 4096);
+
+    // thread-safe; nullptr quando nao ha rota (o chamador segue em linha reta)
+    Rota planejar(double x0, double y0, double x1, double y1);
+
+    // true se o segmento atravessa so celulas livres do mapa atual (pontos fora do mapa
+    // contam como livres: o mapa nao sabe nada deles)
+    static bool segmentoLivre(const MapaMina::Grade& grade, const GradeEspacial::Ponto& a,
+                              const GradeEspacial::Ponto& b);
+
+    const MapaMina& mapa() const { return mapa_; }
+
+    Estatisticas estatisticas() const;
+
+private:
+    Rota buscar(const MapaMina::Grade& grade, int origem, int destino) const;
+
+    struct EntradaCache {
+        std::uint64_t chave;
+        Rota rota;
+    };
+
+    const MapaMina& mapa_;
+    const std::size_t capacidadeCache_;
+
+    std::mutex mtxCache_;
+    std::uint64_t versaoCache_;
+    std::list<EntradaCache> lru_;  // mais recente na frente
+    std::unordered_map<std::uint64_t, std::list<EntradaCache>::iterator> indice_;
+
+    std::atomic<std::uint64_t> pedidos_{0};
+    std::atomic<std::uint64_t> acertos_{0};
+    std::atomic<std::uint64_t> semCaminho_{0};
+    mutable std::atomic<std::uint64_t> buscas_{0};
+    mutable std::atomic<std::uint64_t> nsBusca_{0};
+};
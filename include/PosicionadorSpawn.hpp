@@ -0,0 +1,51 @@
+// include/PosicionadorSpawn.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <random>
+#include "GradeEspacial.hpp"
+
+// escolhe onde caminhoes novos aparecem, sempre a pelo menos distMin de todos os caminhoes
+// ja existentes e uns dos outros
+// os ocupados vao para uma grade de ocupacao com celulas de lado distMin/sqrt(2), entao
+// testar um ponto custa uma vizinhanca fixa de celulas, e nao uma passada pela frota
+// as vagas candidatas sao pre-geradas uma vez por amostragem de Poisson-disk (Bridson) sobre
+// a area; cada escolha percorre as vagas em ordem sorteada, depois tenta pontos livres
+// sorteados (espacos deixados por caminhoes que sairam das vagas) e, com a area cheia, usa a
+// garagem: fileiras espacadas de distMin acima e abaixo da area, dentro do retangulo da
+// garagem (o mapa, para as rotas alcancarem os caminhoes estacionados), das mais proximas
+// da area para as mais distantes; com o retangulo cheio, fileiras abaixo dele, que sempre
+// tem lugar
+class PosicionadorSpawn {
+public:
+    struct Area {
+        double xMin, xMax;
+        double yMin, yMax;
+    };
+
+    struct Vaga {
+        GradeEspacial::Ponto ponto;
+        bool garagem;  // fora da area, por falta de lugar livre nela
+    };
+
+    // sem garagem, as fileiras comecam logo abaixo da area e tem a largura dela
+    PosicionadorSpawn(Area area, double distMin, int maxTentativas);
+    PosicionadorSpawn(Area area, double distMin, int maxTentativas, Area garagem);
+
+    // acrescenta n vagas a 'out'; custo O(ocupados + vagas pre-geradas + n) por chamada,
+    // entao um lote de centenas de caminhoes sai perto de O(1) por caminhao
+    // maxTentativas limita os sorteios livres da chamada inteira
+    void escolherLote(const std::vector<GradeEspacial::Ponto>& ocupados, std::mt19937& rng,
+                      std::size_t n, std::vector<Vaga>& out) const;
+
+    // numero de vagas pre-geradas dentro da area
+    std::size_t capacidade() const { return vagas_.size(); }
+
+private:
+    Area area_;
+    Area garagem_;
+    double distMin_;
+    int maxTentativas_;
+    std::vector<GradeEspacial::Ponto> vagas_;
+};
@@ -0,0 +1,140 @@
+// include/ProtocoloMqtt.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Tipos.hpp"
+
+// codificacao das mensagens MQTT de estado e de comando
+// cada topico usa um formato: binario de layout fixo (padrao) ou JSON/texto para ferramentas
+// humanas; a codificacao escreve num std::string reaproveitado pelo chamador, sem alocar
+// depois que ele atinge o tamanho da maior mensagem
+//
+// formato binario v1, inteiros little endian:
+//   cabecalho:      'T' 'P', uint8 versao, uint8 tipo (TipoMensagem)
+//   EstadoCaminhao: cabecalho + registro
+//   QuadroFrota:    cabecalho + int64 t_ms (epoch) + uint16 n + n registros
+//   registro:       uint16 id, int16 x, int16 y, int16 temp, uint8 flags (bit0 defeito, bit1 auto)
+//   Comando:        cabecalho + uint8 codigo, uint8 valor, uint16 id, int16 x1, y1, x2, y2
+//                   (em CriarCaminhoes o campo id leva a quantidade)
+// posicao e temperatura saturam em int16 e ids vao ate 65535
+//
+// troca entre shards da mina (so binario, ponto flutuante em IEEE 754 de 64 bits):
+//   Presenca:    cabecalho + uint8 origem + uint8 completo (ja ouviu todos os shards)
+//   QuadroBorda: cabecalho + uint8 origem + uint64 passo + uint16 n + n amostras
+//   amostra:     int32 id, int16 x, int16 y, f64 vx, f64 vy, int16 rumo, uint8 flags (bit0 em missao)
+//   Migracao:    cabecalho + uint8 origem + uint64 passo + EstadoMigracao de layout fixo
+//                (int32 id primeiro)
+// nas mensagens entre shards o id vai em int32, sem o limite de 65535 do estado publicado
+namespace ProtocoloMqtt {
+    constexpr char         MAGICO[2] = {'T', 'P'};
+    constexpr std::uint8_t VERSAO    = 1;
+
+    enum class TipoMensagem : std::uint8_t {
+        EstadoCaminhao = 1, QuadroFrota = 2, Comando = 3,
+        Presenca = 4, QuadroBorda = 5, Migracao = 6
+    };
+    enum class Formato { Binario, Json };
+
+    constexpr std::size_t TAM_CABECALHO     = 4;
+    constexpr std::size_t TAM_REGISTRO      = 9;
+    constexpr std::size_t TAM_ESTADO        = TAM_CABECALHO + TAM_REGISTRO;
+    constexpr std::size_t TAM_QUADRO_FIXO   = TAM_CABECALHO + 8 + 2;
+    constexpr std::size_t TAM_COMANDO       = TAM_CABECALHO + 12;
+    constexpr std::size_t MAX_CAMINHOES_QUADRO = 65535;
+    constexpr std::size_t TAM_PRESENCA      = TAM_CABECALHO + 2;
+    constexpr std::size_t TAM_BORDA_FIXO    = TAM_CABECALHO + 1 + 8 + 2;
+    constexpr std::size_t TAM_AMOSTRA_BORDA = 27;
+    constexpr std::size_t TAM_MIGRACAO      = TAM_CABECALHO + 1 + 8 + 113;
+
+    // campos publicados de um caminhao, os mesmos do JSON historico
+    struct EstadoFio {
+        int  id;
+        int  x;
+        int  y;
+        int  temp;
+        bool defeito;
+        bool automatico;
+    };
+
+    EstadoFio estadoDe(int id, const RegistroBuffer& reg);
+
+    // comandos de caminhao (CMD:AUTO ... ROTA:) e da simulacao (CMD:CRIAR_CAMINHAO[S], falhas, remocao)
+    enum class CodigoComando : std::uint8_t {
+        Nenhum = 0,
+        Automatico,
+        Manual,
+        Rearme,
+        Acelera,          // valor 0 ou 1
+        Direita,          // valor 0 ou 1
+        Esquerda,         // valor 0 ou 1
+        Rota,             // x1, y1, x2, y2
+        CriarCaminhao,
+        RemoverCaminhao,  // idCaminhao
+        FalhaTemperatura, // idCaminhao
+        FalhaEletrica,    // idCaminhao
+        FalhaHidraulica,  // idCaminhao
+        CriarCaminhoes    // quantidade
+    };
+
+    struct Comando {
+        CodigoComando codigo     = CodigoComando::Nenhum;
+        int           valor      = 0;
+        int           idCaminhao = 0;
+        int           x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        int           quantidade = 0;
+    };
+
+    // estado de um caminhao; em JSON: { "id": 1, "x": 2, "y": 3, "temp": 40, "defeito": false, "auto": true }
+    void codificarEstado(const EstadoFio& e, Formato f, std::string& out);
+
+    // quadro da frota montado em tres passos; em JSON:
+    // {"t":<ms>,"campos":["id","x","y","temp","defeito","auto"],"frota":[[id,x,y,temp,defeito,auto],...]}
+    // no binario, caminhoes alem de MAX_CAMINHOES_QUADRO sao descartados
+    void iniciarQuadro(std::int64_t t_ms, Formato f, std::string& out);
+    void anexarAoQuadro(const EstadoFio& e, Formato f, std::string& out);
+    void fecharQuadro(Formato f, std::string& out);
+
+    // em Json escreve a sintaxe de texto do topico cmd (CMD:AUTO, CMD:ACELERA:1, ROTA:x1,y1,x2,y2, ...)
+    void codificarComando(const Comando& c, Formato f, std::string& out);
+
+    // aceita as duas formas: binaria (reconhecida pelo cabecalho) ou texto
+    // retorna false para mensagem truncada, versao desconhecida ou comando nao reconhecido
+    bool decodificarComando(const char* dados, std::size_t n, Comando& out);
+    inline bool decodificarComando(const std::string& payload, Comando& out) {
+        return decodificarComando(payload.data(), payload.size(), out);
+    }
+
+    // so a forma binaria; para ferramentas e verificacao
+    bool decodificarEstado(const char* dados, std::size_t n, EstadoFio& out);
+    bool decodificarQuadro(const char* dados, std::size_t n, std::int64_t& t_ms, std::vector<EstadoFio>& out);
+
+    bool ehBinario(const char* dados, std::size_t n);
+    // tipo de uma mensagem binaria da versao atual; false para texto ou versao desconhecida
+    bool tipoDe(const char* dados, std::size_t n, TipoMensagem& out);
+
+    // caminhao de um shard perto da faixa de outro, como o monitor de seguranca o ve
+    struct AmostraBorda {
+        int    id;
+        int    x, y;        // posicao reportada, m
+        double vx, vy;      // velocidade do modelo fisico, m/s
+        int    rumo_graus;  // direcao da rota
+        bool   emMissao;
+    };
+
+    void codificarPresenca(int origem, bool completo, std::string& out);
+    bool decodificarPresenca(const char* dados, std::size_t n, int& origem, bool& completo);
+
+    // quadro de borda montado como o quadro da frota; amostras alem de MAX_CAMINHOES_QUADRO
+    // sao descartadas
+    void iniciarBorda(int origem, std::uint64_t passo, std::string& out);
+    void anexarABorda(const AmostraBorda& a, std::string& out);
+    bool decodificarBorda(const char* dados, std::size_t n, int& origem, std::uint64_t& passo,
+                          std::vector<AmostraBorda>& out);
+
+    void codificarMigracao(int origem, std::uint64_t passo, const EstadoMigracao& e, std::string& out);
+    bool decodificarMigracao(const char* dados, std::size_t n, int& origem, std::uint64_t& passo,
+                             EstadoMigracao& out);
+}
@@ -0,0 +1,99 @@
+// include/RegistradorTelemetria.hpp
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <fstream>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "Tipos.hpp"
+
+// uma amostra do coletor de dados, mesmas colunas do antigo caminhao_<id>.csv
+struct AmostraTelemetria {
+    double           tempo_s;
+    std::int32_t     id_caminhao;
+    EstadoCaminhao   estado;
+    bool             e_defeito;
+    bool             e_automatico;
+    std::int32_t     i_posicao_x;
+    std::int32_t     i_posicao_y;
+    std::int32_t     i_angulo_x;
+    std::int32_t     i_temperatura;
+    std::int32_t     o_aceleracao;
+    std::int32_t     o_direcao;
+    EventoTelemetria evento;
+};
+
+// formato do arquivo (little endian, como o host):
+//   cabecalho: "TPATRTLM", uint32 versao, uint32 numColunas,
+//              e para cada coluna: uint8 tipo, uint8 tamanho do nome, nome
+//   blocos:    uint32 marcador "BLOC", uint32 n, depois cada coluna inteira com n valores
+namespace FormatoTelemetria {
+    constexpr char          MAGICO[8]      = {'T','P','A','T','R','T','L','M'};
+    constexpr std::uint32_t VERSAO         = 1;
+    constexpr std::uint32_t MARCADOR_BLOCO = 0x434F4C42u; // "BLOC"
+
+    enum class TipoColuna : std::uint8_t { F64 = 1, I32 = 2, U8 = 3 };
+}
+
+// gravador de telemetria unico para a frota inteira
+// os caminhoes so enfileiram amostras; uma thread de I/O monta blocos colunares de
+// largura fixa e grava em lote, mantendo um unico descritor de arquivo
+class RegistradorTelemetria {
+public:
+    explicit RegistradorTelemetria(const std::string& caminhoArquivo,
+                                   std::size_t amostrasPorBloco = 4096,
+                                   std::chrono::milliseconds intervaloDescarga = std::chrono::milliseconds(1000));
+    ~RegistradorTelemetria();
+
+    RegistradorTelemetria(const RegistradorTelemetria&) = delete;
+    RegistradorTelemetria& operator=(const RegistradorTelemetria&) = delete;
+
+    // enfileira uma amostra, barato e sem I/O, pode ser chamado de qualquer tarefa
+    void registrar(const AmostraTelemetria& amostra);
+
+    // grava o que estiver pendente e encerra a thread de I/O
+    void encerrar();
+
+    bool aberto() const;
+    std::uint64_t amostrasGravadas() const;
+
+private:
+    void lacoEscrita();
+    void escreverCabecalho();
+    void escreverBloco(const AmostraTelemetria* amostras, std::size_t n);
+
+    std::ofstream arquivo_;
+    std::size_t amostrasPorBloco_;
+    std::chrono::milliseconds intervaloDescarga_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<AmostraTelemetria> pendentes_;
+    bool rodando_;
+    std::uint64_t gravadas_;
+
+    std::vector<char> bufferBloco_; // reaproveitado entre blocos, so a thread de I/O usa
+    std::thread thEscrita_;
+};
+
+// leitura sequencial de um arquivo de telemetria, bloco a bloco
+class LeitorTelemetria {
+public:
+    // abre o arquivo e valida cabecalho e esquema de colunas
+    bool abrir(const std::string& caminhoArquivo);
+
+    // le o proximo bloco em out, retorna false no fim do arquivo ou em erro
+    bool proximoBloco(std::vector<AmostraTelemetria>& out);
+
+    const std::string& erro() const { return erro_; }
+
+private:
+    std::ifstream arquivo_;
+    std::vector<char> bufferBloco_;
+    std::string erro_;
+};
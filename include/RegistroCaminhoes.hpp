@@ -0,0 +1,98 @@
+// include/RegistroCaminhoes.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Caminhao;
+
+// frota da simulacao indexada por id, com leitura sem trava
+// os leitores enxergam uma tabela imutavel publicada por um ponteiro atomico; adicionar e
+// remover montam uma tabela nova, publicam e so liberam a antiga (e o caminhao removido)
+// depois que todo leitor que podia estar com ela saiu da secao de leitura
+// a espera segue o esquema de RCU com dois contadores: cada leitor se conta na paridade da
+// epoca em que entrou, o escritor vira a epoca e espera o contador da paridade antiga zerar
+// leitores nunca esperam; so os escritores, que sao serializados entre si, esperam leitores
+class RegistroCaminhoes {
+public:
+    struct Tabela {
+        std::vector<Caminhao*> porId;  // posicao id - 1, nullptr para ids removidos
+        std::vector<Caminhao*> frota;  // caminhoes vivos em ordem de criacao
+    };
+
+    // secao de leitura: enquanto existir, a tabela e os caminhoes nela continuam vivos
+    // deve ser curta e nao pode envolver adicionar/remover na mesma thread, que esperaria por ela
+    class Leitura {
+    public:
+        ~Leitura();
+
+        Leitura(const Leitura&) = delete;
+        Leitura& operator=(const Leitura&) = delete;
+
+        const std::vector<Caminhao*>& frota() const { return tabela_->frota; }
+
+        // O(1); nullptr se o id nunca existiu ou ja foi removido
+        Caminhao* buscar(int id) const;
+
+    private:
+        friend class RegistroCaminhoes;
+        Leitura(const RegistroCaminhoes& registro, unsigned paridade, const Tabela* tabela);
+
+        const RegistroCaminhoes& registro_;
+        unsigned paridade_;
+        const Tabela* tabela_;
+    };
+
+    RegistroCaminhoes();
+    ~RegistroCaminhoes();
+
+    RegistroCaminhoes(const RegistroCaminhoes&) = delete;
+    RegistroCaminhoes& operator=(const RegistroCaminhoes&) = delete;
+
+    Leitura ler() const;
+
+    // ids comecam em 1 e nunca sao reaproveitados; o caminhao passado a adicionar deve ter
+    // o id de proximoId(), entao quem cria caminhoes precisa serializar as duas chamadas
+    int proximoId() const;
+    void adicionar(std::unique_ptr<Caminhao> caminhao);
+
+    // publica varios caminhoes de uma vez, com ids seguidos na sequencia a partir de
+    // proximoId(): uma unica tabela nova e uma unica espera pelos leitores para o lote inteiro
+    void adicionarLote(std::vector<std::unique_ptr<Caminhao>>& lote);
+
+    // sequencia dos ids criados aqui: primeiro, primeiro + passo, ...; com a mina dividida
+    // em shards cada processo usa a sua (primeiro = shard + 1, passo = numero de shards)
+    // e os ids continuam unicos na mina inteira; so com o registro vazio
+    void definirSequenciaIds(int primeiro, int passo);
+    int passoIds() const;
+
+    // publica um caminhao criado em outro shard, com o id que ele ja tinha
+    // false se o id ja esta na frota
+    bool adotar(std::unique_ptr<Caminhao> caminhao);
+
+    // tira o caminhao da tabela publicada e devolve a posse quando nenhum leitor pode mais
+    // enxerga-lo; nullptr se o id nao existe
+    std::unique_ptr<Caminhao> remover(int id);
+
+private:
+    // troca a tabela publicada e espera os leitores da antiga; chamado com mtxEscrita_
+    void publicar(std::unique_ptr<Tabela> nova);
+
+    // contadores em linhas de cache separadas: leitores de epocas diferentes nao disputam a mesma
+    struct alignas(64) ContadorLeitores {
+        std::atomic<std::uint64_t> n{0};
+    };
+
+    mutable ContadorLeitores leitores_[2];
+    std::atomic<std::uint64_t> epoca_;
+    std::atomic<const Tabela*> tabela_;
+
+    mutable std::mutex mtxEscrita_;
+    std::vector<std::unique_ptr<Caminhao>> donos_;  // posicao id - 1, vazia para ids removidos
+    int proximoId_;
+    int passoIds_;
+};
@@ -0,0 +1,36 @@
+// include/ReprodutorSessao.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SessaoGravada.hpp"
+
+struct ResultadoReproducao {
+    bool              ok = false;            // reproducao chegou ao fim sem divergencia
+    std::string       erro;                  // sessao invalida ou entrada que nao pode ser aplicada
+    std::size_t       entradasAplicadas = 0;
+    std::size_t       pontosVerificados = 0;
+    DivergenciaSessao divergencia;           // primeira divergencia, se houver
+    double            tempoFinal_s = 0.0;
+    std::uint64_t     resumoFinal  = 0;      // SimulacaoMina::resumoEstado no fim
+};
+
+// re-executa uma sessao gravada numa SimulacaoMina em lockstep
+// cada entrada eh aplicada no passo do seu tempo (tempo_s / PASSO_LOCKSTEP_S), na ordem
+// em que foi gravada; cada ponto de controle eh comparado com o hash obtido no mesmo passo
+// sessoes gravadas em lockstep reproduzem bit a bit; as gravadas em tempo real reaplicam
+// as mesmas entradas nos mesmos instantes, mas sem pontos de controle para verificar
+class ReprodutorSessao {
+public:
+    explicit ReprodutorSessao(std::vector<EntradaSessao> entradas);
+
+    // velocidade 1 reproduz em tempo real, N em N vezes o tempo real e 0 o mais rapido possivel
+    // com 'arquivoGravacao' a reproducao grava a propria sessao, para comparar com compararSessoes
+    // para na primeira divergencia
+    ResultadoReproducao reproduzir(double velocidade, const std::string& arquivoGravacao = "");
+
+private:
+    std::vector<EntradaSessao> entradas_;
+};
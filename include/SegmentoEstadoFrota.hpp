@@ -0,0 +1,167 @@
+// include/SegmentoEstadoFrota.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Tipos.hpp"
+
+// estado de um caminhao no segmento compartilhado, com layout fixo: so tipos de largura
+// fixa, sem padding implicito, para que outro programa (ou outra linguagem) leia os bytes
+struct EstadoCaminhaoSegmento {
+    std::int32_t id;               // 0 no slot livre
+    std::uint8_t estado;           // EstadoCaminhao
+    std::uint8_t nivelSeguranca;   // NivelSeguranca
+    std::uint8_t bits;             // BIT_*
+    std::uint8_t reservado0;
+    double tempoSimulacao_s;       // do ultimo registro do buffer
+
+    double pos_x, pos_y, vel, ang_deg, temp_C;  // modelo fisico
+
+    std::int32_t i_posicao_x, i_posicao_y, i_angulo_x, i_temperatura;  // sensores tratados
+    std::int32_t o_aceleracao, o_direcao;
+    std::int32_t sp_posicao_x, sp_posicao_y, sp_angulo_x;
+    std::int32_t reservado1;
+
+    static constexpr std::uint8_t BIT_AUTOMATICO       = 1u << 0;
+    static constexpr std::uint8_t BIT_DEFEITO          = 1u << 1;
+    static constexpr std::uint8_t BIT_BLOQUEIO_REARME  = 1u << 2;
+    static constexpr std::uint8_t BIT_FALHA_ELETRICA   = 1u << 3;
+    static constexpr std::uint8_t BIT_FALHA_HIDRAULICA = 1u << 4;
+};
+
+static_assert(sizeof(EstadoCaminhaoSegmento) == 96, "layout do estado no segmento mudou: suba SegmentoFrota::VERSAO");
+static_assert(std::is_trivially_copyable<EstadoCaminhaoSegmento>::value &&
+              std::is_standard_layout<EstadoCaminhaoSegmento>::value,
+              "o slot do segmento eh copiado byte a byte");
+
+// ultimo estado de cada caminhao num segmento de memoria compartilhada POSIX (shm_open),
+// para leitores de outros processos no mesmo host (GUI, gravador, analise) lerem a frota
+// inteira sem broker e sem trava, a centenas de Hz
+// layout: cabecalho de 64 bytes e 'capacidade' slots de 128 bytes; cada slot tem o
+// proprio seqlock (par estavel, impar em escrita, zero nunca escrito) e guarda um
+// EstadoCaminhaoSegmento; a geracao do cabecalho muda quando um caminhao entra ou sai, e
+// enquanto ela nao muda o leitor pode guardar o slot de cada id
+// o escritor cria o segmento e o apaga ao sair; um nome que ja existe (outro escritor, ou
+// o que sobrou de uma execucao interrompida) so eh tomado com abrir(true)
+namespace SegmentoFrota {
+    constexpr std::uint32_t MAGICO = 0x52465054u;  // "TPFR"
+    constexpr std::uint32_t VERSAO = 1;
+    constexpr std::size_t   TAM_CABECALHO = 64;
+    constexpr std::size_t   CAPACIDADE_PADRAO = 4096;  // slots, quando quem publica nao escolhe
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "o seqlock entre processos precisa de atomicos sem trava");
+
+    struct Cabecalho {
+        std::atomic<std::uint32_t> magico;     // gravado por ultimo pelo escritor
+        std::uint32_t versao;
+        std::uint32_t capacidade;              // slots
+        std::uint32_t tamanhoEstado;           // sizeof(EstadoCaminhaoSegmento)
+        std::int32_t  criador;                 // pid do escritor
+        std::atomic<std::uint32_t> slotsEmUso; // slots [0, slotsEmUso) ja foram usados
+        std::atomic<std::uint64_t> geracao;    // muda quando a frota muda
+        std::atomic<std::uint64_t> publicacoes;
+    };
+    static_assert(sizeof(Cabecalho) <= TAM_CABECALHO, "cabecalho do segmento cresceu");
+
+    constexpr std::size_t PALAVRAS_ESTADO =
+        (sizeof(EstadoCaminhaoSegmento) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    // o estado vai palavra a palavra em atomicos, como no slot do BufferCircular
+    // um escritor so por slot: sequencia e estado dividem as linhas de cache do slot
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> seq;
+        std::atomic<std::uint64_t> palavras[PALAVRAS_ESTADO];
+    };
+    static_assert(sizeof(Slot) == 128, "slot do segmento mudou de tamanho");
+
+    inline std::size_t tamanhoSegmento(std::size_t capacidade) {
+        return TAM_CABECALHO + capacidade * sizeof(Slot);
+    }
+}
+
+// lado da simulacao; usado por uma thread so (a tarefa de publicacao ou o passo do lockstep)
+// a cada publicacao: iniciarPublicacao, um escrever por caminhao e concluirPublicacao, que
+// libera o slot de quem nao apareceu (caminhao removido ou que passou para outro shard)
+class SegmentoEstadoFrota {
+public:
+    // nome no formato de shm_open, com a barra inicial ("/tp_atr_frota")
+    SegmentoEstadoFrota(const std::string& nome, std::size_t capacidade);
+    ~SegmentoEstadoFrota();
+
+    SegmentoEstadoFrota(const SegmentoEstadoFrota&) = delete;
+    SegmentoEstadoFrota& operator=(const SegmentoEstadoFrota&) = delete;
+
+    // false se o nome ja existir, a menos que 'assumir': ai o segmento antigo eh desligado
+    // do nome (quem o tiver mapeado continua com ele) e um novo eh criado no lugar
+    bool abrir(bool assumir = false);
+    const std::string& nome() const { return nome_; }
+
+    void iniciarPublicacao();
+    // false se o segmento estiver cheio (o caminhao fica fora ate um slot vagar)
+    bool escrever(const EstadoCaminhaoSegmento& estado);
+    void concluirPublicacao();
+
+    // monta o estado do segmento a partir do registro do buffer e do modelo fisico
+    static EstadoCaminhaoSegmento estadoDe(int id, const RegistroBuffer& reg,
+                                           double pos_x, double pos_y, double vel, double ang_deg, double temp_C,
+                                           NivelSeguranca nivel);
+
+private:
+    void escreverSlot(std::size_t slot, const EstadoCaminhaoSegmento& estado);
+
+    std::string nome_;
+    std::size_t capacidade_;
+    int fd_;
+    void* base_;
+    std::size_t tamanho_;
+
+    std::vector<std::int32_t> slotDoId_;        // -1 sem slot; indexado pelo id
+    std::vector<std::int32_t> idDoSlot_;        // 0 no slot livre
+    std::vector<std::uint64_t> rodadaDoSlot_;   // ultima publicacao em que o slot foi escrito
+    std::vector<std::size_t> livres_;           // slots liberados, reaproveitados antes dos novos
+    std::uint64_t rodada_;
+    std::uint32_t emUso_;
+    bool frotaMudou_;
+};
+
+// lado de quem le, em outro processo; o segmento eh mapeado so para leitura
+class LeitorEstadoFrota {
+public:
+    LeitorEstadoFrota();
+    ~LeitorEstadoFrota();
+
+    LeitorEstadoFrota(const LeitorEstadoFrota&) = delete;
+    LeitorEstadoFrota& operator=(const LeitorEstadoFrota&) = delete;
+
+    // false se o segmento nao existe ou nao tem o layout esperado; ver erro()
+    bool abrir(const std::string& nome);
+    const std::string& erro() const { return erro_; }
+
+    std::size_t capacidade() const;
+    std::size_t slotsEmUso() const;
+    std::uint64_t geracao() const;
+    std::uint64_t publicacoes() const;
+
+    // copia um slot pelo seqlock; false se o slot esta livre ou nunca foi escrito
+    // 'sequencia' muda a cada escrita no slot, para pular os que nao mudaram
+    bool lerSlot(std::size_t slot, EstadoCaminhaoSegmento& out, std::uint64_t& sequencia) const;
+    bool lerSlot(std::size_t slot, EstadoCaminhaoSegmento& out) const;
+
+    // a frota inteira em 'out' (limpo antes), na ordem dos slots; retorna a geracao lida
+    // antes da copia: se geracao() ainda for a mesma, nenhum caminhao entrou ou saiu no meio
+    std::uint64_t lerFrota(std::vector<EstadoCaminhaoSegmento>& out) const;
+
+private:
+    const SegmentoFrota::Cabecalho* cabecalho() const;
+    const SegmentoFrota::Slot* slot(std::size_t i) const;
+
+    int fd_;
+    const void* base_;
+    std::size_t tamanho_;
+    std::string erro_;
+};
@@ -0,0 +1,177 @@
+// include/SerieTemporalFrota.hpp
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Tipos.hpp"
+
+// canais numericos guardados na serie de cada caminhao
+enum class CanalSerie {
+    PosicaoX,
+    PosicaoY,
+    Angulo,
+    Temperatura,
+    Aceleracao,
+    Direcao,
+    Quantidade
+};
+
+// niveis de resolucao, do mais fino ao mais grosso
+enum class ResolucaoSerie {
+    Bruta,        // cada amostra do sensor
+    Segundo,      // baldes de 1 s
+    DezSegundos,  // baldes de 10 s
+    Minuto,       // baldes de 60 s
+    Quantidade
+};
+
+// um ponto devolvido pelas consultas; na resolucao bruta minimo == maximo == media
+struct PontoSerie {
+    double        tempo_s;   // instante da amostra ou inicio do balde
+    float         minimo;
+    float         maximo;
+    float         media;
+    std::uint32_t amostras;
+};
+
+// retencao de cada nivel e orcamento de memoria da frota; os aneis de um caminhao crescem
+// com as amostras ate a retencao (bytesPorCaminhao) e dai em diante so sobrescrevem
+// quando a frota inteira nao cabe em bytesMaximos, todos os niveis de todos os caminhoes
+// retem a mesma fracao (metade, um quarto...) da retencao configurada; a soma dos aneis
+// nunca passa de bytesMaximos
+struct ConfigSerieTemporal {
+    double      periodoAmostra_s      = 0.1;     // periodo do tratamento de sensores
+    double      retencaoBruta_s       = 300.0;   // 5 min em resolucao cheia
+    double      retencaoSegundo_s     = 3600.0;  // 1 h em baldes de 1 s
+    double      retencaoDezSegundos_s = 21600.0; // 6 h em baldes de 10 s
+    double      retencaoMinuto_s      = 86400.0; // 24 h em baldes de 1 min
+    std::size_t bytesMaximos          = std::size_t(256) << 20; // 256 MiB: a retencao inteira
+                                                                // de uns 380 caminhoes
+};
+
+// historico de telemetria da frota inteira, em memoria, com varias resolucoes
+// cada nivel eh um anel colunar de capacidade fixa (uma coluna de tempo e uma por canal);
+// a amostra bruta entra no nivel bruto e atualiza o balde aberto de cada nivel agregado,
+// que vai para o anel quando o tempo passa para o proximo balde
+// consultas por intervalo usam busca binaria no tempo e varrem so as colunas pedidas
+class SerieTemporalFrota {
+public:
+    explicit SerieTemporalFrota(const ConfigSerieTemporal& cfg = ConfigSerieTemporal{});
+
+    SerieTemporalFrota(const SerieTemporalFrota&) = delete;
+    SerieTemporalFrota& operator=(const SerieTemporalFrota&) = delete;
+
+    // insere as amostras de um caminhao em ordem de tempo; amostras com tempo menor ou igual
+    // ao ultimo ja inserido sao descartadas, entao reenviar uma janela sobreposta eh seguro
+    // retorna quantas foram aceitas
+    std::size_t inserir(int idCaminhao, const RegistroBuffer* registros, std::size_t n);
+
+    // tempo da ultima amostra aceita do caminhao, negativo se nao houver nenhuma
+    double ultimoTempo(int idCaminhao) const;
+
+    // false se inserir ignoraria o caminhao (sem serie e sem orcamento para nem um ponto por
+    // nivel); quem copia as amostras de algum lugar pode pular a copia
+    bool aceita(int idCaminhao) const;
+
+    // libera a serie do caminhao (removido da frota ou passado para outro shard)
+    // false se ele nao tinha serie
+    bool remover(int idCaminhao);
+
+    // pontos de um canal com desde_s <= tempo <= ate_s na resolucao pedida, em ordem de tempo
+    // 'out' eh limpo antes; o balde ainda aberto de cada nivel entra como ultimo ponto parcial
+    std::size_t consultar(int idCaminhao, CanalSerie canal, ResolucaoSerie resolucao,
+                          double desde_s, double ate_s, std::vector<PontoSerie>& out) const;
+
+    // resolucao mais fina que ainda retem desde_s e devolve no maximo maxPontos no intervalo
+    // (pela retencao que o caminhao tem de fato, menor que a configurada com a frota grande)
+    ResolucaoSerie resolucaoPara(int idCaminhao, double desde_s, double ate_s, std::size_t maxPontos) const;
+
+    // memoria reservada pelos aneis dos caminhoes com serie, o orcamento da frota e o que um
+    // caminhao ocupa com a retencao inteira
+    std::size_t bytesReservados() const;
+    std::size_t bytesMaximos() const;
+    std::size_t bytesPorCaminhao() const;
+
+    std::size_t quantidadeCaminhoes() const;
+    std::uint64_t amostrasIgnoradas() const; // sem orcamento para guardar
+
+private:
+    static constexpr std::size_t NUM_CANAIS = static_cast<std::size_t>(CanalSerie::Quantidade);
+    static constexpr std::size_t NUM_NIVEIS = static_cast<std::size_t>(ResolucaoSerie::Quantidade);
+
+    static constexpr std::size_t SEM_POSICAO = static_cast<std::size_t>(-1);
+
+    // o que sobra do orcamento da frota, para um anel que precisa crescer
+    struct Limite {
+        std::atomic<std::size_t>& reservadosFrota;
+        std::size_t maximoFrota;
+        std::size_t& bytesSerie;
+    };
+
+    // anel colunar de um nivel; no nivel bruto so a coluna 'media' eh usada
+    struct Nivel {
+        double        resolucao_s = 0.0; // zero no nivel bruto
+        std::size_t   capacidade  = 0;
+        std::size_t   inicio      = 0;
+        std::size_t   quantidade  = 0;
+        std::size_t   reservados  = 0;   // posicoes reservadas em cada coluna
+        std::vector<double>        tempo;
+        std::vector<std::uint32_t> contagem;
+        std::array<std::vector<float>, NUM_CANAIS> minimo, maximo, media;
+
+        // balde aberto, ainda acumulando
+        bool          abertoValido = false;
+        std::int64_t  abertoIndice = 0;
+        std::uint32_t abertoContagem = 0;
+        std::array<float,  NUM_CANAIS> abertoMinimo{}, abertoMaximo{};
+        std::array<double, NUM_CANAIS> abertoSoma{};
+
+        std::size_t bytesPorPonto() const;
+        std::size_t bytes() const { return reservados * bytesPorPonto(); }
+        std::size_t posicao(std::size_t logico) const { return (inicio + logico) % capacidade; }
+        // SEM_POSICAO se o anel esta vazio e o limite nao deixa reservar nem um ponto
+        std::size_t proximaEscrita(Limite& lim);
+        bool crescer(Limite& lim);
+        void redimensionar(std::size_t novaCapacidade);
+        void fecharAberto(Limite& lim);
+        void acumular(double t_s, const std::array<float, NUM_CANAIS>& v, Limite& lim);
+        std::size_t primeiroAPartirDe(double t_s) const;
+        std::size_t primeiroDepoisDe(double t_s) const;
+    };
+
+    struct SerieCaminhao {
+        mutable std::mutex mtx;
+        double ultimoTempo_s = -1.0;
+        std::size_t bytes = 0;      // soma dos niveis, ja contada em reservados_
+        unsigned    reducao = 0;    // cada nivel retem a retencao configurada >> reducao
+        bool        removida = false; // fora do mapa e do orcamento; nao aceita mais amostras
+        std::array<Nivel, NUM_NIVEIS> niveis;
+    };
+
+    // posse compartilhada: uma serie removida continua valida para quem ja a buscou
+    std::shared_ptr<SerieCaminhao> buscar(int idCaminhao) const;
+    // reducao: a que a frota atual cabe no orcamento
+    std::shared_ptr<SerieCaminhao> buscarOuCriar(int idCaminhao, unsigned& reducao);
+    double retencao(ResolucaoSerie r) const;
+    unsigned reducaoPara(std::size_t series) const;
+    // leva os aneis da serie para a retencao >> reducao
+    void ajustarRetencao(SerieCaminhao& s, unsigned reducao);
+
+    ConfigSerieTemporal cfg_;
+    std::array<std::size_t, NUM_NIVEIS> capacidadeCheia_; // pontos de cada nivel na retencao configurada
+    std::size_t bytesPorCaminhao_;
+    std::size_t bytesMinimos_;  // um ponto por nivel
+
+    mutable std::mutex mtx_; // protege o mapa; cada serie tem o seu mutex
+    std::unordered_map<int, std::shared_ptr<SerieCaminhao>> series_;
+    std::uint64_t ignoradas_;
+    // bytes de todas as series, somados por quem cresce ou encolhe um anel sob o mutex da
+    // serie, sem precisar do mapa nem dos mutexes das outras
+    std::atomic<std::size_t> reservados_;
+};
@@ -0,0 +1,78 @@
+// include/SessaoGravada.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// tipos de entrada de uma sessao gravada
+enum class TipoEntradaSessao {
+    Inicio,           // parametros da sessao: modo, sementes, frota inicial
+    Mqtt,             // mensagem MQTT recebida (so registro, a reproducao usa as acoes abaixo)
+    CriarCaminhao,    // caminhao criado, dados = capacidade do buffer
+    RemoverCaminhao,  // caminhao removido da frota
+    Falha,            // falha injetada, dados = TEMP, ELET ou HIDR
+    Comando,          // comando de caminhao na sintaxe do topico cmd (CMD:AUTO, ROTA:x1,y1,x2,y2, ...)
+    PontoControle,    // hash do estado de cada caminhao, dados = id:hash,id:hash,...
+    Fim
+};
+
+const char* tipoEntradaSessaoToString(TipoEntradaSessao t);
+
+struct EntradaSessao {
+    double            tempo_s;     // tempo da sessao (passo * PASSO_LOCKSTEP_S no lockstep)
+    TipoEntradaSessao tipo;
+    int               idCaminhao;  // zero quando nao se aplica
+    std::string       dados;
+};
+
+// formato: texto, uma entrada por linha, campos separados por tab
+//   <tempo_s>\t<TIPO>\t<idCaminhao>\t<dados>
+// a primeira linha eh o cabecalho MAGICO_SESSAO; '\', tab e quebra de linha nos dados
+// sao escapados como \\, \t e \n
+constexpr const char* MAGICO_SESSAO = "TPATR-SESSAO 1";
+
+// grava as entradas externas de uma SimulacaoMina; thread safe
+// o relogio eh fornecido pela simulacao para que todas as fontes usem a mesma base de tempo
+class GravadorSessao {
+public:
+    explicit GravadorSessao(const std::string& caminhoArquivo);
+
+    GravadorSessao(const GravadorSessao&) = delete;
+    GravadorSessao& operator=(const GravadorSessao&) = delete;
+
+    bool aberto() const { return arquivo_.is_open(); }
+
+    void definirRelogio(std::function<double()> relogio);
+
+    // grava com o tempo do relogio; entradas de acao vao direto para o disco,
+    // pontos de controle ficam no buffer do arquivo
+    void registrar(TipoEntradaSessao tipo, int idCaminhao, const std::string& dados);
+
+private:
+    std::mutex mtx_;
+    std::ofstream arquivo_;
+    std::function<double()> relogio_;
+};
+
+// le uma sessao inteira; retorna false e preenche 'erro' se o arquivo for invalido
+bool lerSessao(const std::string& caminhoArquivo, std::vector<EntradaSessao>& out, std::string& erro);
+
+// primeira diferenca entre duas sequencias de entradas (ou entre o ponto de controle
+// gravado e o obtido numa reproducao); as mensagens Mqtt sao ignoradas na comparacao
+struct DivergenciaSessao {
+    bool        encontrada = false;
+    double      tempo_s    = 0.0;
+    int         idCaminhao = 0;   // caminhao cujo hash diferiu, zero se a diferenca foi na entrada
+    std::string esperado;
+    std::string obtido;
+};
+
+DivergenciaSessao compararSessoes(const std::vector<EntradaSessao>& a, const std::vector<EntradaSessao>& b);
+
+// compara os dados de dois pontos de controle caminhao a caminhao
+DivergenciaSessao compararPontosControle(double tempo_s, const std::string& esperado, const std::string& obtido);
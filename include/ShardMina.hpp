@@ -0,0 +1,101 @@
+// include/ShardMina.hpp
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Anticolisao.hpp"
+#include "ParticaoMina.hpp"
+#include "ProtocoloMqtt.hpp"
+#include "TransporteShards.hpp"
+#include "Tipos.hpp"
+
+// lado de um processo de backend na mina dividida em faixas (ParticaoMina)
+// a cada passo o shard manda para cada outro shard um quadro com os seus caminhoes que o
+// outro enxerga (vazio se nenhum) e, antes dele, os caminhoes que passaram para a faixa do
+// outro; do que chega saem os caminhoes adotados e os fantasmas, caminhoes dos vizinhos
+// que entram no anticolisao sem receber resposta daqui
+// no lockstep cada passo espera o quadro do mesmo passo de todos os outros, entao os
+// shards avancam juntos e a execucao continua reprodutivel; em tempo real vale o quadro
+// mais recente de cada vizinho, enquanto nao ficar velho demais
+// usado por uma thread so (o passo do lockstep ou o monitor de seguranca)
+class ShardMina {
+public:
+    struct Estatisticas {
+        std::uint64_t migracoesEnviadas  = 0;
+        std::uint64_t migracoesRecebidas = 0;
+        std::uint64_t quadrosEnviados    = 0;
+        std::uint64_t quadrosRecebidos   = 0;
+        std::uint64_t fantasmas          = 0;  // amostras de borda recebidas
+        std::uint64_t falhasEnvio        = 0;
+        std::uint64_t descartadas        = 0;  // mensagens invalidas
+        std::uint64_t esperasVencidas    = 0;  // passos do lockstep que seguiram sem algum vizinho
+        double espera_s = 0.0;                 // tempo parado esperando os vizinhos
+    };
+
+    ShardMina(const ParticaoMina& particao, int indice, std::unique_ptr<TransporteShards> transporte);
+
+    int indice() const { return indice_; }
+    const ParticaoMina& particao() const { return particao_; }
+
+    // abre o transporte e espera todos os shards se anunciarem; false se o prazo vencer
+    bool conectar(std::chrono::milliseconds prazo);
+
+    // false se o transporte nao aceitou a mensagem; o caminhao continua sendo de quem enviou
+    bool enviarMigracao(int destino, std::uint64_t passo, const EstadoMigracao& estado);
+
+    // um quadro para cada outro shard, com as amostras a menos da largura da borda da faixa dele
+    void publicarBorda(std::uint64_t passo, const std::vector<Anticolisao::Amostra>& amostras);
+
+    // trata o que chegou: caminhoes adotados vao para 'chegadas' e os quadros viram fantasmas
+    // com esperarPasso so retorna depois de tratar o quadro 'passo' de cada outro shard,
+    // ou depois de PRAZO_PASSO; false nesse caso
+    bool receber(bool esperarPasso, std::uint64_t passo, std::vector<EstadoMigracao>& chegadas);
+
+    // fantasmas do ultimo quadro de cada vizinho, sem os ids em 'ignorar' (caminhoes que
+    // acabaram de chegar e ainda aparecem no quadro de quem os mandou)
+    void anexarFantasmas(std::vector<Anticolisao::Amostra>& amostras, const std::vector<int>& ignorar) const;
+
+    // thread-safe
+    Estatisticas estatisticas() const;
+
+    // um passo do lockstep espera os vizinhos no maximo isso
+    static constexpr std::chrono::seconds PRAZO_PASSO{10};
+    // em tempo real, quadros mais velhos que isso sao ignorados
+    static constexpr double VALIDADE_FANTASMAS_S = 0.5;
+
+private:
+    struct Vizinho {
+        std::deque<std::string> pendentes;  // recebidas e ainda nao tratadas, em ordem
+        std::vector<Anticolisao::Amostra> fantasmas;
+        std::uint64_t passoQuadro = 0;
+        bool temQuadro = false;
+        bool perdido   = false;  // nao respondeu dentro de PRAZO_PASSO; o lockstep nao espera mais
+        std::chrono::steady_clock::time_point chegadaQuadro;
+    };
+
+    // separa as mensagens recebidas por origem
+    void distribuir();
+    // trata as pendentes de um vizinho ate (e inclusive) o quadro de borda 'ate'
+    void tratarPendentes(int origem, bool limitar, std::uint64_t ate, std::vector<EstadoMigracao>& chegadas);
+
+    ParticaoMina particao_;
+    int indice_;
+    std::unique_ptr<TransporteShards> transporte_;
+    std::vector<Vizinho> vizinhos_;  // por indice de shard; o proprio fica vazio
+    bool lockstep_;                  // modo e passo do ultimo receber()
+    std::uint64_t passoAtual_;
+
+    std::vector<std::string> recebidas_;
+    std::vector<std::string> quadros_;  // quadro em montagem para cada shard, reaproveitado
+    std::string mensagem_;
+    std::vector<int> destinos_;
+    std::vector<ProtocoloMqtt::AmostraBorda> amostrasBorda_;
+
+    mutable std::mutex mtxEstatisticas_;
+    Estatisticas estatisticas_;
+};
@@ -4,51 +4,306 @@
 #include <memory>
 #include <cstddef>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <atomic>
 #include <thread>
+#include <random>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <utility>
 #include "Caminhao.hpp"
 #include "MqttInterface.hpp" 
+#include "ExecutorPeriodico.hpp"
+#include "GradeEspacial.hpp"
+#include "RegistradorTelemetria.hpp"
+#include "FisicaFrota.hpp"
+#include "PosicionadorSpawn.hpp"
+#include "EstatisticasTarefas.hpp"
+#include "SerieTemporalFrota.hpp"
+#include "SessaoGravada.hpp"
+#include "RegistroCaminhoes.hpp"
+#include "ProtocoloMqtt.hpp"
+#include "MapaMina.hpp"
+#include "PlanejadorRotas.hpp"
+#include "Anticolisao.hpp"
+#include "ShardMina.hpp"
+#include "TransporteShards.hpp"
+#include "SegmentoEstadoFrota.hpp"
+
+// resultado de SimulacaoMina::criarCaminhoes
+struct ResultadoCriacao {
+    std::vector<int> ids;      // em ordem de criacao
+    double duracao_s = 0.0;    // do pedido ate o ultimo caminhao iniciado
+
+    double caminhoesPorSegundo() const {
+        return duracao_s > 0.0 ? static_cast<double>(ids.size()) / duracao_s : 0.0;
+    }
+};
 
 class SimulacaoMina {
 public:
-    SimulacaoMina(int numCaminhoes = 0, std::size_t capacidadeBufferPadrao = 200);
+    // arquivoTelemetria: log binario da frota (RegistradorTelemetria), truncado na criacao;
+    // vazio desliga a telemetria
+    SimulacaoMina(int numCaminhoes = 0, std::size_t capacidadeBufferPadrao = 200,
+                  const std::string& arquivoTelemetria = "telemetria_frota.tlm");
 
     ~SimulacaoMina();
 
     void iniciar();
     void parar();
 
+    // liga os clientes MQTT individuais de cada caminhao (topicos mina/caminhao/<id>/...)
+    // desligado por padrao: a central publica o quadro agregado em mina/frota/estado
+    // e repassa os comandos de mina/caminhao/+/cmd; deve ser chamado antes de iniciar()
+    void habilitarTopicosPorCaminhao(bool habilitar);
+
+    // formato dos topicos de estado: mina/frota/estado e mina/caminhao/+/estado (todos os
+    // caminhoes); binario por padrao, JSON para ferramentas humanas
+    // os comandos sao aceitos nos dois formatos; deve ser chamado antes de iniciar()
+    // retorna false para um topico sem formato configuravel
+    bool definirFormatoTopico(const std::string& topico, ProtocoloMqtt::Formato formato);
+
+    // modo headless de passo fixo: sem MQTT, sem threads de tarefa e sem sleeps
+    // todos os caminhoes e o monitor de seguranca avancam juntos a cada passo
+    void iniciarLockstep(std::uint32_t semente);
+    void avancarLockstep(std::uint64_t passos = 1);
+    double tempoLockstep_s() const;
+
+    // hash do ultimo registro de cada caminhao, para comparar execucoes bit a bit
+    std::uint64_t resumoEstado() const;
+    // o mesmo hash calculado caminhao a caminhao, na ordem de criacao
+    std::vector<std::pair<int, std::uint64_t>> resumoPorCaminhao() const;
+    std::uint64_t passoLockstep() const;
+
+    // grava as entradas externas da sessao (MQTT, comandos da GUI, falhas injetadas,
+    // criacao de caminhoes e sementes) para reproducao com ReprodutorSessao
+    // no lockstep grava tambem um ponto de controle por segundo com o hash de cada caminhao
+    // deve ser chamado antes de iniciar() ou iniciarLockstep()
+    bool gravarSessao(const std::string& arquivo);
+
+    // base de tempo da sessao: tempo do lockstep, ou segundos desde iniciar() em tempo real
+    double tempoSessao_s() const;
+
+    // semente do sorteio de posicoes de spawn; sem esta chamada, iniciarLockstep usa a propria
+    // semente (e o tempo real, uma semente aleatoria); deve ser chamado antes de iniciar()
+    // ou iniciarLockstep(), que posicionam os caminhoes criados antes da partida
+    void definirSementeSpawn(std::uint32_t semente);
+
+    // roda esta instancia como o shard 'indice' da mina dividida em 'shards' faixas
+    // verticais (ParticaoMina), cada uma num processo: o caminhao que sai da faixa passa
+    // para o processo do vizinho, e o anticolisao enxerga os caminhoes dos vizinhos perto da
+    // borda; no lockstep os shards avancam juntos, passo a passo
+    // espera todos os shards se conectarem; cada um publica so os proprios caminhoes em
+    // mina/frota/estado, e os comandos de caminhao valem no shard que tem o caminhao
+    // deve ser chamado antes de criar caminhoes e de iniciar()/iniciarLockstep(), e nao
+    // combina com gravarSessao (a chegada de caminhoes depende dos outros processos)
+    bool configurarShards(int indice, int shards, std::unique_ptr<TransporteShards> transporte);
+    // nulo sem shards
+    const ShardMina* shard() const;
+
+    // publica o ultimo estado de cada caminhao no segmento de memoria compartilhada 'nome'
+    // (SegmentoEstadoFrota), para outros processos do host lerem a frota com LeitorEstadoFrota
+    // a cada 10 ms em tempo real e a cada passo no lockstep; com shards cada shard publica
+    // so os proprios caminhoes, num segmento dele; deve ser chamado antes de iniciar()
+    // falha se o nome ja existir, a menos que 'assumir' (ver SegmentoEstadoFrota::abrir)
+    bool publicarEstadoCompartilhado(const std::string& nome,
+                                     std::size_t capacidade = SegmentoFrota::CAPACIDADE_PADRAO,
+                                     bool assumir = false);
+
+    // periodo, execucao, jitter e estouros de cada tipo de tarefa, agregados na frota
+    // so medidos em tempo real; tambem publicados periodicamente em mina/frota/estatisticas
+    std::vector<ResumoTarefa> estatisticasTarefas() const;
+    std::string estatisticasTarefasJson() const;
+    void zerarEstatisticasTarefas();
+
+    // latencia sensor -> atuador do pipeline por eventos (leitura do sensor ate o controle
+    // escrever os atuadores com base nessa amostra), agregada na frota
+    ResumoLatencia latenciaSensorAtuador() const;
+
+    // historico de um caminhao com desde_s <= t <= ate_s, em JSON no formato do quadro da frota
+    // montado direto do anel do buffer; lanca std::out_of_range se o id nao existir
+    // tambem respondido por MQTT: pedido em mina/historico/req, resposta em mina/historico/resp/<correlacao>
+    std::string historicoCaminhaoJson(int idCaminhao, double desde_s, double ate_s) const;
+
+    // historico longo da frota (bruto por alguns minutos, agregados de 1 s, 10 s e 1 min por horas)
+    // alimentado a cada segundo a partir dos buffers dos caminhoes, fora das tarefas de sensor
+    const SerieTemporalFrota& seriesFrota() const;
+
+    // mapa de obstaculos usado no planejamento de rotas; comeca com a cava e o britador
+    // mudar os obstaculos faz os caminhoes cuja rota passou a cruzar algum replanejarem
+    MapaMina& mapa();
+    PlanejadorRotas::Estatisticas estatisticasRotas() const;
+
+    // respostas do anticolisao preditivo e o que a parada de emergencia antiga (MANUAL a
+    // menos de 20 m) teria custado nas mesmas trajetorias
+    Anticolisao::Resumo resumoAnticolisao() const;
+
     int criarNovoCaminhao(std::size_t capacidadeBuffer = 0);
 
-    Caminhao& getCaminhaoPorId(int id);
-    const Caminhao& getCaminhaoPorId(int id) const;
+    // cria n caminhoes em lotes: cada lote sorteia os spawns e constroi os caminhoes sob a
+    // trava de criacao e entra na frota com uma unica publicacao no registro; a partida
+    // (tarefas e, com topicos por caminhao, a conexao MQTT) acontece fora da trava
+    // tambem pedido por MQTT com CMD:CRIAR_CAMINHOES:<n>, resposta em mina/simulacao/criacao
+    ResultadoCriacao criarCaminhoes(std::size_t n, std::size_t capacidadeBuffer = 0);
+
+    // para as tarefas do caminhao e o tira da frota; o id nao eh reaproveitado
+    // espera os leitores da frota (monitor de seguranca, publicacao, GUI) largarem o caminhao,
+    // entao nao pode ser chamado de dentro de paraCadaCaminhao; false se o id nao existe
+    bool removerCaminhao(int idCaminhao);
+
+    // comando para um caminhao na sintaxe do topico cmd: CMD:AUTO, CMD:MANUAL, CMD:REARME,
+    // CMD:ACELERA:<0|1>, CMD:DIREITA:<0|1>, CMD:ESQUERDA:<0|1> e ROTA:x1,y1,x2,y2
+    // texto, binario ou ja decodificado; a GUI e a central passam por aqui para que o comando
+    // entre na sessao gravada (sempre na forma de texto)
+    // false se o comando nao foi aplicado: texto invalido ou caminhao inexistente (removido
+    // por MQTT ou passado para outro shard desde que o chamador o viu)
+    bool comandarCaminhao(int idCaminhao, const std::string& comando);
+    bool comandarCaminhao(int idCaminhao, const ProtocoloMqtt::Comando& comando);
 
-    void injetarFalhaTemperatura(int idCaminhao);
-    void injetarFalhaEletrica(int idCaminhao);
-    void injetarFalhaHidraulica(int idCaminhao);
+    bool existeCaminhao(int id) const;
 
-    void definirRotaCaminhao(int idCaminhao,
+    // roda f(caminhao) dentro de uma secao de leitura do registro, sem trava: enquanto f roda
+    // o caminhao nao pode ser removido nem migrar para outro shard
+    // false, sem chamar f, se o id nao existe; f deve ser curta, nao pode criar nem remover
+    // caminhoes e nao pode guardar a referencia depois de retornar
+    template <typename F>
+    bool comCaminhao(int id, F&& f) {
+        auto leitura = registro_.ler();
+        Caminhao* c = leitura.buscar(id);
+        if (!c) return false;
+        f(*c);
+        return true;
+    }
+
+    template <typename F>
+    bool comCaminhao(int id, F&& f) const {
+        auto leitura = registro_.ler();
+        const Caminhao* c = leitura.buscar(id);
+        if (!c) return false;
+        f(*c);
+        return true;
+    }
+
+    // false se o caminhao nao existe
+    bool injetarFalhaTemperatura(int idCaminhao);
+    bool injetarFalhaEletrica(int idCaminhao);
+    bool injetarFalhaHidraulica(int idCaminhao);
+
+    bool definirRotaCaminhao(int idCaminhao,
                              int x_inicial, int y_inicial,
                              int x_destino, int y_destino);
 
     void imprimirMapaTexto() const;
     void rodarPorSegundos(int segundos);
 
-    Caminhao& getCaminhao(std::size_t indice);
-    const Caminhao& getCaminhao(std::size_t indice) const;
-
     std::size_t quantidadeCaminhoes() const;
 
+    // percorre a frota dentro de uma secao de leitura do registro, sem trava
+    template <typename F>
+    void paraCadaCaminhao(F&& f) const {
+        auto leitura = registro_.ler();
+        for (Caminhao* c : leitura.frota()) f(*c);
+    }
+
 private:
     void processarMensagemCentral(const std::string& topico, const std::string& payload);
     void tarefaMonitoramentoSeguranca();
+    void cicloMonitoramentoSeguranca(double dt_s);
+    void iniciarCaminhao(Caminhao& caminhao);
+    void publicarEstadoFrota();
+    void passoFisica();
+    void publicarEstatisticas();
+    void responderHistorico(const std::string& payload);
+    void ingerirSeries();
+    // emExecucao: rodando_ lido uma vez pelo lote; so um lote posicionado da a partida
+    std::vector<int> criarLote(std::size_t n, std::size_t capacidadeBuffer, bool& emExecucao);
+    void iniciarLote(const std::vector<int>& ids);
+    void posicionarCaminhoesIniciais();
+    void registrarInicioSessao();
+    void registrarPontoControle();
+    void publicarSegmentoEstado();
+    void migrarSaidas(std::uint64_t passo);
+    void adotarChegadas();
+    void pedirCriacao(std::size_t n, bool responder);
+    void tarefaCriacao();
+
+    // declarados antes de registro_ para serem destruidos depois dos caminhoes
+    // (e as estatisticas antes do executor, que guarda ponteiros para elas)
+    EstatisticasFrota estatisticas_;
+    ExecutorPeriodico executor_;
+    std::unique_ptr<RegistradorTelemetria> telemetria_;  // nulo com a telemetria desligada
+    FisicaFrota fisica_;
+    SerieTemporalFrota series_;
+    MapaMina mapa_;                 // cava e britador; lido pelo planejamento de todos os caminhoes
+    PlanejadorRotas planejador_;
 
-    std::vector<std::unique_ptr<Caminhao>> caminhoes_;
+    RegistroCaminhoes registro_;
     std::size_t capacidadeBufferPadrao_;
     
     std::atomic<bool> rodando_; 
-    mutable std::mutex mtxCaminhoes_; 
+    std::mutex mtxCriacao_;  // serializa criar/remover: o id e o spawn dependem da frota atual
+    // caminhoes dando a partida em iniciarLote, fora de mtxCriacao_ e de secao de leitura;
+    // removerCaminhao espera a partida do caminhao terminar e migrarSaidas deixa ele para o
+    // proximo passo (protegidos por mtxCriacao_)
+    std::vector<int> idsEmPartida_;
+    std::condition_variable cvPartida_;
     std::thread thSeguranca_; 
+
+    // pedidos de criacao vindos do MQTT, atendidos em ordem por uma thread da simulacao
+    // (a criacao espera a trava de criacao e, com topicos por caminhao, o broker, entao nao
+    // roda no callback do MQTT); iniciada em iniciar() e encerrada em parar()
+    struct PedidoCriacao {
+        std::size_t n;
+        bool responder;  // publica o resultado em mina/simulacao/criacao
+    };
+    std::mutex mtxPedidosCriacao_;
+    std::condition_variable cvPedidosCriacao_;
+    std::deque<PedidoCriacao> pedidosCriacao_;
+    bool encerrarCriacao_;
+    std::thread thCriacao_;
     
     std::unique_ptr<MqttInterface> mqtt_;
+    bool topicosPorCaminhao_;
+    ExecutorPeriodico::IdTarefa tarPublicacaoFrota_;
+    ProtocoloMqtt::Formato formatoQuadro_;
+    ProtocoloMqtt::Formato formatoEstadoCaminhoes_;
+    std::string quadroFrota_;               // quadro agregado, reaproveitado a cada publicacao
+    ExecutorPeriodico::IdTarefa tarFisica_;
+    ExecutorPeriodico::IdTarefa tarPublicacaoEstatisticas_;
+    ExecutorPeriodico::IdTarefa tarIngestaoSeries_;
+    std::vector<RegistroBuffer> loteSeries_;  // janela copiada do buffer, reaproveitada
+    std::unique_ptr<SegmentoEstadoFrota> segmentoEstado_;
+    ExecutorPeriodico::IdTarefa tarSegmentoEstado_;
+    std::chrono::steady_clock::time_point fisicaAnterior_;
+
+    bool modoLockstep_;
+    std::uint32_t sementeLockstep_;
+    std::uint64_t passoLockstep_;
+    std::uint32_t sementeSpawn_;
+    bool sementeSpawnDefinida_;
+    std::mt19937 rngSpawn_;
+    PosicionadorSpawn posicionadorSpawn_;
+    std::vector<int> idsSemPosicao_;  // criados antes da partida, posicionados nela
+
+    // estruturas do monitor de seguranca reaproveitadas entre ciclos
+    Anticolisao anticolisao_;
+    std::vector<Anticolisao::Amostra> amostrasSeguranca_;
+    std::vector<std::size_t> indiceSeguranca_;
+    std::vector<Anticolisao::Resposta> respostasSeguranca_;
+
+    // mina dividida em shards; as estruturas abaixo so sao usadas pelo monitor de seguranca
+    // (ou pelo passo do lockstep)
+    std::unique_ptr<ShardMina> shard_;
+    std::uint64_t cicloShard_;
+    std::chrono::steady_clock::time_point ultimaBorda_;
+    std::vector<std::pair<int, int>> saidas_;      // (id, shard de destino)
+    std::vector<EstadoMigracao> emigrados_;        // sairam neste ciclo, ainda vistos como fantasmas
+    std::vector<EstadoMigracao> chegadas_;         // adotados no fim do ciclo
+    std::vector<Anticolisao::Resposta> respostasChegadas_;
+    std::vector<int> idsChegadas_;
+
+    std::unique_ptr<GravadorSessao> gravador_;
+    std::chrono::steady_clock::time_point inicioSessao_;
 };
\ No newline at end of file
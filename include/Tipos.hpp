@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 // tabela 1 sensores e atuadores
 
@@ -49,6 +52,15 @@ enum class EstadoCaminhao {
     EmFalha
 };
 
+// resposta do anticolisao, em ordem crescente de severidade; o caminhao continua em
+// automatico em todos os niveis e volta a andar sozinho quando o nivel cai para Livre
+enum class NivelSeguranca : std::uint8_t {
+    Livre,
+    LimiteVelocidade, // velocidade limitada, segue a rota
+    Ceder,            // freia ate parar para o outro passar
+    Parar             // frenagem forte, conflito iminente
+};
+
 // setpoints definidos pelo planejamento de rota
 struct SetpointsCaminhao {
     int sp_posicao_x; // posição alvo no eixo x
@@ -71,6 +83,27 @@ struct RegistroBuffer {
     SetpointsCaminhao setpoints;// setpoints em uso no instante
 };
 
+// estado que acompanha um caminhao quando ele passa de um shard da mina para outro
+// modelo fisico, atuacao, destino da rota, logica de comando e a ultima amostra do buffer;
+// filtros, RNG dos sensores e o historico ficam no shard de origem
+struct EstadoMigracao {
+    int    id_caminhao;
+    double tempoSimulacao_s;
+
+    double pos_x, pos_y, vel, ang_deg, temp_C;  // modelo fisico
+    AtuadoresCaminhao atuadores;                // atuacao aplicada na proxima integracao
+
+    bool rota_definida;                         // o shard de destino replaneja da posicao atual
+    int  rota_destino_x, rota_destino_y;
+
+    EstadoCaminhao   estado;
+    EstadosCaminhao  estados;
+    ComandosCaminhao comandos;
+    bool falha_temperatura, falha_eletrica, falha_hidraulica;  // falhas injetadas ainda ativas
+
+    RegistroBuffer ultimo;  // o monitor de seguranca enxerga o caminhao desde a chegada
+};
+
 // eventos usados entre monitoramento de falhas lógica de comando e outros blocos
 
 enum class TipoEvento {
@@ -81,13 +114,49 @@ enum class TipoEvento {
     Outro
 };
 
+// texto curto de tamanho fixo, truncado em CAPACIDADE-1 caracteres
+// mantem o Evento copiavel sem alocacao, para caber direto nas celulas da fila
+struct TextoEvento {
+    static constexpr std::size_t CAPACIDADE = 48;
+
+    TextoEvento() { texto_[0] = '\0'; }
+    TextoEvento(const char* s) { atribuir(s, s ? std::strlen(s) : 0); }
+    TextoEvento(const std::string& s) { atribuir(s.data(), s.size()); }
+
+    const char* c_str() const { return texto_; }
+    std::string str() const { return std::string(texto_); }
+
+private:
+    void atribuir(const char* s, std::size_t n) {
+        if (n >= CAPACIDADE) n = CAPACIDADE - 1;
+        if (n > 0) std::memcpy(texto_, s, n);
+        texto_[n] = '\0';
+    }
+
+    char texto_[CAPACIDADE];
+};
+
 struct Evento {
     TipoEvento   tipo;
-    std::string  descricao;         // texto livre com um resumo do que aconteceu
+    TextoEvento  descricao;         // resumo curto do que aconteceu
     double       tempoSimulacao_s;  // tempo da simulação em que o evento foi gerado
     int          id_caminhao;       // identificador do caminhão associado ao evento
 };
 
+// eventos registrados pelo coletor de dados na telemetria de cada amostra
+// gravados como codigo de um byte no log binario, o texto sai de eventoTelemetriaToString
+enum class EventoTelemetria : std::uint8_t {
+    Nenhum = 0,
+    FalhaEletrica,
+    FalhaHidraulica,
+    Sobreaquecimento,
+    FalhaCriticaGenerica,
+    Rearme,
+    AlertaTemperatura,
+    ModoManualEmergencia,
+    ModoAuto
+};
+
 // funções auxiliares para montar texto de log a partir dos estados
 
 inline std::string estadoToString(EstadoCaminhao e) {
@@ -109,3 +178,19 @@ inline std::string tipoEventoToString(TipoEvento t) {
         default:                               return "Evento Desconhecido";
     }
 }
+
+// texto fixo, sem alocar: usado pelo coletor de dados a cada amostra
+inline const char* eventoTelemetriaToString(EventoTelemetria e) {
+    switch (e) {
+        case EventoTelemetria::Nenhum:               return "";
+        case EventoTelemetria::FalhaEletrica:        return "FALHA ELETRICA";
+        case EventoTelemetria::FalhaHidraulica:      return "FALHA HIDRAULICA";
+        case EventoTelemetria::Sobreaquecimento:     return "SOBREAQUECIMENTO (>120C)";
+        case EventoTelemetria::FalhaCriticaGenerica: return "FALHA CRITICA GENERICA";
+        case EventoTelemetria::Rearme:               return "REARME";
+        case EventoTelemetria::AlertaTemperatura:    return "ALERTA TEMP (>95C)";
+        case EventoTelemetria::ModoManualEmergencia: return "MODO MANUAL / EMERGENCIA";
+        case EventoTelemetria::ModoAuto:             return "MODO AUTO";
+        default:                                     return "EVENTO DESCONHECIDO";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// include/TransporteShards.hpp
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class MqttInterface;
+
+// canal de mensagens entre os processos de shard da mina (ver ShardMina)
+// cada mensagem eh um bloco de bytes opaco; as de uma mesma origem chegam na ordem em que
+// foram enviadas, e o protocolo dos shards depende disso (as migracoes de um passo chegam
+// antes do quadro de borda do mesmo passo)
+// enviar, receber e esperar sao chamados por uma unica thread do shard
+class TransporteShards {
+public:
+    virtual ~TransporteShards() = default;
+
+    // false se o canal nao pode ser aberto
+    virtual bool abrir() = 0;
+    // false se o canal caiu ou a mensagem nao coube
+    virtual bool enviar(int destino, const std::string& mensagem) = 0;
+    // acrescenta em 'out' as mensagens que ja chegaram, sem esperar; retorna quantas
+    virtual std::size_t receber(std::vector<std::string>& out) = 0;
+    // espera chegar alguma mensagem ate o prazo; true se ha mensagem para receber
+    virtual bool esperar(std::chrono::microseconds prazo) = 0;
+};
+
+// pelo broker MQTT local: cada shard assina mina/shard/<indice>/entrada
+class TransporteShardsMqtt : public TransporteShards {
+public:
+    TransporteShardsMqtt(int indice, int shards);
+    ~TransporteShardsMqtt() override;
+
+    bool abrir() override;
+    bool enviar(int destino, const std::string& mensagem) override;
+    std::size_t receber(std::vector<std::string>& out) override;
+    bool esperar(std::chrono::microseconds prazo) override;
+
+private:
+    int indice_;
+    int shards_;
+    std::unique_ptr<MqttInterface> mqtt_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<std::string> chegadas_;  // preenchido pela thread de callback do cliente
+};
+
+// por um segmento de memoria compartilhada POSIX (shm_open), para shards no mesmo host
+// o segmento tem um anel de bytes por par (origem, destino), cada um com um so produtor e
+// um so consumidor, sem trava; o shard 0 cria o segmento (apagando o de uma execucao
+// anterior) e o apaga ao sair, os outros esperam ele existir para abrir
+class TransporteShardsMemoria : public TransporteShards {
+public:
+    static constexpr std::size_t CAPACIDADE_ANEL = 256 * 1024;
+
+    // nome do segmento no formato de shm_open, com a barra inicial ("/tp_atr_mina")
+    TransporteShardsMemoria(const std::string& nome, int indice, int shards);
+    ~TransporteShardsMemoria() override;
+
+    bool abrir() override;
+    bool enviar(int destino, const std::string& mensagem) override;
+    std::size_t receber(std::vector<std::string>& out) override;
+    bool esperar(std::chrono::microseconds prazo) override;
+
+private:
+    struct Cabecalho;
+    struct Anel;
+
+    Anel* anel(int origem, int destino) const;
+    bool haMensagem() const;
+
+    std::string nome_;
+    int indice_;
+    int shards_;
+    int fd_;
+    void* base_;
+    std::size_t tamanho_;
+};
@@ -0,0 +1,300 @@
+// src/Anticolisao.cpp
+#include "Anticolisao.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // passagem prevista a menos de DIST_CONTATO com a maior aproximacao a menos de
+    // TCPA_PARAR_S: frenagem forte, se o caminhao estiver rapido o bastante para precisar
+    constexpr double DIST_CONTATO   = 8.0;
+    constexpr double TCPA_PARAR_S   = 2.5;
+    constexpr double V_FREIO_FORTE  = 1.0;
+    // tempo sem o conflito antes de o nivel baixar
+    constexpr double LIBERACAO_S = 1.0;
+    constexpr double V_PARADO2   = 1e-6;
+    // abaixo disso o caminhao esta parado: eh obstaculo para os outros, e segurar basta
+    constexpr double V_PARADO = 0.1;
+
+    // folga no alcance de cada caminhao, e no filtro de cada lado do par, contra o
+    // arredondamento no limite
+    constexpr double FOLGA_ALCANCE = 0.5;
+    constexpr double FOLGA_FILTRO  = 1e-6;
+
+    // desvios de rumo tentados para contornar um caminhao parado
+    constexpr int PASSO_DESVIO  = 15;
+    constexpr int DESVIO_MAXIMO = 120;
+
+    void elevar(NivelSeguranca& nivel, NivelSeguranca novo) {
+        if (novo > nivel) nivel = novo;
+    }
+
+    bool parado(const Anticolisao::Amostra& a) {
+        return a.vx*a.vx + a.vy*a.vy < V_PARADO * V_PARADO;
+    }
+
+    bool devagar(const Anticolisao::Amostra& a) {
+        return a.vx*a.vx + a.vy*a.vy < V_FREIO_FORTE * V_FREIO_FORTE;
+    }
+
+    double distancia(const Anticolisao::Amostra& a, const Anticolisao::Amostra& b) {
+        return std::hypot(b.pos.x - a.pos.x, b.pos.y - a.pos.y);
+    }
+
+    NivelSeguranca nivelDoConflito(const Anticolisao::Conflito& c, double dist, bool cede) {
+        using A = Anticolisao;
+        if (!c.aproximando) {
+            // ja se afastando: perto demais ainda anda, mas devagar
+            return dist < A::DIST_CRITICA ? NivelSeguranca::LimiteVelocidade : NivelSeguranca::Livre;
+        }
+        if (c.tcpa_s > A::HORIZONTE_S) return NivelSeguranca::Livre;
+        if (c.dcpa < DIST_CONTATO && c.tcpa_s < TCPA_PARAR_S) return NivelSeguranca::Parar;
+        // ja perto demais e fechando: os dois esperam, nao so quem cede
+        if (c.dcpa < A::DIST_CRITICA && (cede || dist < A::DIST_CRITICA)) return NivelSeguranca::Ceder;
+        if (c.dcpa < A::DIST_CRITICA) return NivelSeguranca::LimiteVelocidade;
+        if (c.dcpa < A::DIST_ALERTA)  return NivelSeguranca::LimiteVelocidade;
+        return NivelSeguranca::Livre;
+    }
+
+    // a ve b sair de Livre: o mesmo criterio de nivelDoConflito sobre preverConflito, mas so
+    // com produtos (tcpa <= H vira -rv <= H * v2, dcpa < DIST_ALERTA vira r2 * v2 - rv^2 <
+    // DIST_ALERTA^2 * v2), com folga para nunca descartar um par que o criterio pegaria
+    bool podeSairDeLivre(const GradeEspacial::Ponto& pa, const GradeEspacial::Ponto& ia,
+                         const Anticolisao::Amostra& b, double dist2) {
+        using A = Anticolisao;
+        const double rx = b.pos.x - pa.x;
+        const double ry = b.pos.y - pa.y;
+        const double vx = b.vx - ia.x;
+        const double vy = b.vy - ia.y;
+        const double v2 = vx*vx + vy*vy;
+        const double rv = rx*vx + ry*vy;
+        const double lim = v2 * (1.0 + FOLGA_FILTRO);
+        return (dist2 < A::DIST_CRITICA * A::DIST_CRITICA * (1.0 + FOLGA_FILTRO)) |
+               ((rv < 0.0) & (-rv <= A::HORIZONTE_S * lim) &
+                (dist2 * v2 - rv * rv < A::DIST_ALERTA * A::DIST_ALERTA * lim));
+    }
+
+    // velocidade que o caminhao pretende ter: pela rota girada de desvio_graus, ou a medida
+    // fora de missao
+    void intencao(const Anticolisao::Amostra& a, int desvio_graus, double& ix, double& iy) {
+        if (!a.emMissao) {
+            ix = a.vx;
+            iy = a.vy;
+            return;
+        }
+        const double v   = std::max(std::hypot(a.vx, a.vy), Anticolisao::V_INTENCAO);
+        const double rad = (a.rumo_graus + desvio_graus) * PI / 180.0;
+        ix = v * std::cos(rad);
+        iy = v * std::sin(rad);
+    }
+}
+
+Anticolisao::Anticolisao()
+    : grade_(DIST_ALERTA),
+      ciclo_(0)
+{
+}
+
+Anticolisao::Conflito Anticolisao::preverConflito(const GradeEspacial::Ponto& pa, double vax, double vay,
+                                                  const GradeEspacial::Ponto& pb, double vbx, double vby) {
+    // movimento relativo de b visto de a
+    const double rx = pb.x - pa.x;
+    const double ry = pb.y - pa.y;
+    const double vx = vbx - vax;
+    const double vy = vby - vay;
+    const double v2 = vx*vx + vy*vy;
+    const double rv = rx*vx + ry*vy;
+
+    Conflito c;
+    c.aproximando = rv < 0.0 && v2 > V_PARADO2;
+    c.tcpa_s = c.aproximando ? -rv / v2 : 0.0;
+    const double t = std::min(c.tcpa_s, HORIZONTE_S);
+    const double dx = rx + vx * t;
+    const double dy = ry + vy * t;
+    c.dcpa = std::sqrt(dx*dx + dy*dy);
+    return c;
+}
+
+bool Anticolisao::escolherDesvio(const std::vector<Amostra>& amostras, std::size_t k,
+                                 std::size_t inicio, std::size_t fim, int anterior, int& desvio) const {
+    const Amostra& a = amostras[k];
+
+    auto passaLivre = [&](int d) {
+        double ix, iy;
+        intencao(a, d, ix, iy);
+        for (std::size_t o = inicio; o < fim; ++o) {
+            const Amostra& b = amostras[obstaculos_[o].parado];
+            Conflito c = preverConflito(a.pos, ix, iy, b.pos, 0.0, 0.0);
+            if (nivelDoConflito(c, obstaculos_[o].dist, true) >= NivelSeguranca::Ceder) return false;
+        }
+        return true;
+    };
+
+    // o desvio do ciclo anterior, se ainda serve, evita trocar de lado no meio do contorno
+    if (anterior != 0 && passaLivre(anterior)) {
+        desvio = anterior;
+        return true;
+    }
+
+    // primeiro o lado oposto ao do obstaculo mais proximo
+    const Amostra& b = amostras[obstaculos_[inicio].parado];
+    double ix, iy;
+    intencao(a, 0, ix, iy);
+    const double cruz = ix * (b.pos.y - a.pos.y) - iy * (b.pos.x - a.pos.x);
+    const int lado = cruz > 0.0 ? -1 : 1;
+
+    for (int d = PASSO_DESVIO; d <= DESVIO_MAXIMO; d += PASSO_DESVIO) {
+        if (passaLivre(lado * d))  { desvio = lado * d;  return true; }
+        if (passaLivre(-lado * d)) { desvio = -lado * d; return true; }
+    }
+    return false;
+}
+
+void Anticolisao::avaliar(const std::vector<Amostra>& amostras, double dt_s, std::vector<Resposta>& respostas) {
+    const std::size_t n = amostras.size();
+    ++ciclo_;
+
+    // a intencao de cada caminhao limita ate onde ele chega no horizonte: a velocidade
+    // medida nunca passa dela, entao um par a mais de DIST_ALERTA + os dois alcances nao
+    // chega a DIST_ALERTA (nem a DIST_CRITICA parado) e fica Livre sem ser avaliado
+    posicoes_.clear();
+    intencoes_.clear();
+    alcances_.clear();
+    for (const Amostra& a : amostras) {
+        double ix, iy;
+        intencao(a, 0, ix, iy);
+        posicoes_.push_back(a.pos);
+        intencoes_.push_back({ix, iy});
+        alcances_.push_back(DIST_ALERTA / 2.0 + std::hypot(ix, iy) * HORIZONTE_S + FOLGA_ALCANCE);
+    }
+    grade_.reconstruir(posicoes_);
+
+    alvos_.assign(n, NivelSeguranca::Livre);
+    semDesvio_.assign(n, NivelSeguranca::Livre);
+    desvios_.assign(n, 0);
+    regraAntiga_.assign(n, 0);
+    obstaculos_.clear();
+
+    // 'a' avaliando 'b': a pela propria rota, b pela velocidade medida
+    auto avaliarLado = [&](std::size_t ka, std::size_t kb, double dist) {
+        const Amostra& a = amostras[ka];
+        const Amostra& b = amostras[kb];
+        const GradeEspacial::Ponto& ia = intencoes_[ka];
+        Conflito c = preverConflito(a.pos, ia.x, ia.y, b.pos, b.vx, b.vy);
+
+        // prioridade fixa e igual nos dois lados do par: o caminhao mais novo cede
+        NivelSeguranca nivel = nivelDoConflito(c, dist, a.id > b.id);
+        if (nivel == NivelSeguranca::Parar && devagar(a)) nivel = NivelSeguranca::Ceder;
+
+        if (parado(b) && nivel >= NivelSeguranca::Ceder && a.emMissao) {
+            obstaculos_.push_back({ka, kb, distancia(a, b)});
+            elevar(semDesvio_[ka], nivel);
+        } else {
+            elevar(alvos_[ka], nivel);
+        }
+    };
+
+    grade_.paraCadaParAoAlcance(alcances_, [&](std::size_t i, std::size_t j, double dist2) {
+        // a maior parte dos pares fica Livre dos dois lados e para no filtro, sem desvio
+        const bool alerta = dist2 < DIST_ALERTA * DIST_ALERTA;
+        const bool ladoI  = podeSairDeLivre(posicoes_[i], intencoes_[i], amostras[j], dist2);
+        const bool ladoJ  = podeSairDeLivre(posicoes_[j], intencoes_[j], amostras[i], dist2);
+        if (!(alerta | ladoI | ladoJ)) return;
+
+        const double dist = std::sqrt(dist2);
+        if (alerta) {
+            regraAntiga_[i] = 1;
+            regraAntiga_[j] = 1;
+        }
+        if (ladoI) avaliarLado(i, j, dist);
+        if (ladoJ) avaliarLado(j, i, dist);
+    });
+
+    // contorno dos caminhoes parados no caminho, agrupados por caminhao e do mais proximo
+    // para o mais longe (o mais proximo decide o lado)
+    std::sort(obstaculos_.begin(), obstaculos_.end(), [](const Obstaculo& x, const Obstaculo& y) {
+        if (x.caminhao != y.caminhao) return x.caminhao < y.caminhao;
+        return x.dist != y.dist ? x.dist < y.dist : x.parado < y.parado;
+    });
+    for (std::size_t ini = 0; ini < obstaculos_.size();) {
+        const std::size_t k = obstaculos_[ini].caminhao;
+        std::size_t fim = ini;
+        while (fim < obstaculos_.size() && obstaculos_[fim].caminhao == k) ++fim;
+
+        auto it = estados_.find(amostras[k].id);
+        const int anterior = it != estados_.end() ? it->second.desvio_graus : 0;
+        if (escolherDesvio(amostras, k, ini, fim, anterior, desvios_[k])) {
+            elevar(alvos_[k], NivelSeguranca::LimiteVelocidade);
+        } else {
+            elevar(alvos_[k], semDesvio_[k]);
+        }
+        ini = fim;
+    }
+
+    Resumo delta;
+    respostas.resize(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        EstadoNivel& e = estados_[amostras[k].id];
+        e.ciclo = ciclo_;
+
+        const NivelSeguranca alvo = alvos_[k];
+        if (alvo >= e.nivel) {
+            if (alvo > e.nivel) {
+                switch (alvo) {
+                    case NivelSeguranca::LimiteVelocidade: ++delta.limites;   break;
+                    case NivelSeguranca::Ceder:            ++delta.cedencias; break;
+                    case NivelSeguranca::Parar:
+                        ++delta.paradas;
+                        Log::aviso("[Anticolisao] PARADA do caminhao %d", amostras[k].id);
+                        break;
+                    default: break;
+                }
+            }
+            e.nivel    = alvo;
+            e.abaixo_s = 0.0;
+        } else {
+            e.abaixo_s += dt_s;
+            // contornando, o nivel segue o alvo na hora: segurado, o caminhao nao contorna
+            if (e.abaixo_s >= LIBERACAO_S || desvios_[k] != 0) {
+                e.nivel    = alvo;
+                e.abaixo_s = 0.0;
+            }
+        }
+
+        if (desvios_[k] != 0 && e.desvio_graus == 0) ++delta.desvios;
+        e.desvio_graus = desvios_[k];
+
+        // a regra antiga parava em MANUAL ao entrar no alerta; aqui so conta o tempo ate o
+        // alerta acabar, o operador ainda teria que rearmar depois
+        if (regraAntiga_[k] && !e.regraAntiga) ++delta.paradasRegraAntiga;
+        e.regraAntiga = regraAntiga_[k] != 0;
+        if (e.regraAntiga && !parado(amostras[k])) delta.tempoPreservado_s += dt_s;
+
+        respostas[k].nivel        = e.nivel;
+        respostas[k].desvio_graus = e.desvio_graus;
+    }
+
+    // caminhoes removidos da frota
+    if (estados_.size() > n) {
+        for (auto it = estados_.begin(); it != estados_.end();) {
+            if (it->second.ciclo != ciclo_) it = estados_.erase(it);
+            else ++it;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtxResumo_);
+    resumo_.limites            += delta.limites;
+    resumo_.cedencias          += delta.cedencias;
+    resumo_.paradas            += delta.paradas;
+    resumo_.desvios            += delta.desvios;
+    resumo_.paradasRegraAntiga += delta.paradasRegraAntiga;
+    resumo_.tempoPreservado_s  += delta.tempoPreservado_s;
+}
+
+Anticolisao::Resumo Anticolisao::resumo() const {
+    std::lock_guard<std::mutex> lock(mtxResumo_);
+    return resumo_;
+}
@@ -1,17 +1,23 @@
 // src/BufferCircular.cpp
 #include "BufferCircular.hpp"
 
+#include <cstring>
+
 BufferCircular::BufferCircular(std::size_t capacidade)
     : dados_(capacidade),
       capacidade_(capacidade),
       inicio_(0),
-      quantidade_(0) {}
+      quantidade_(0),
+      seqUltimo_(0)
+{
+    for (auto& palavra : ultimo_) palavra.store(0, std::memory_order_relaxed);
+}
 
-void BufferCircular::inserir(const RegistroBuffer& registro) {
+std::uint64_t BufferCircular::inserir(const RegistroBuffer& registro) {
     std::lock_guard<std::mutex> lock(mtx_);
 
     if (capacidade_ == 0) {
-        return; // capacidade zero entao nao faz nada
+        return 0; // capacidade zero entao nao faz nada
     }
 
     // indice onde vamos escrever eh inicio mais quantidade modulo capacidade
@@ -24,33 +30,117 @@ void BufferCircular::inserir(const RegistroBuffer& registro) {
         // se o buffer estiver cheio avancamos o indice inicio e jogamos fora o registro mais antigo
         inicio_ = (inicio_ + 1) % capacidade_;
     }
+
+    // publica no slot do seqlock, as escritas ja sao serializadas pelo mtx_
+    std::uint64_t palavras[PALAVRAS_REGISTRO] = {};
+    std::memcpy(palavras, &registro, sizeof(RegistroBuffer));
+
+    const std::uint64_t seq = seqUltimo_.load(std::memory_order_relaxed);
+    seqUltimo_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::size_t i = 0; i < PALAVRAS_REGISTRO; ++i) {
+        ultimo_[i].store(palavras[i], std::memory_order_relaxed);
+    }
+
+    seqUltimo_.store(seq + 2, std::memory_order_release);
+    return (seq + 2) / 2;
 }
 
 bool BufferCircular::tentarLerMaisRecente(RegistroBuffer& out) const {
-    std::lock_guard<std::mutex> lock(mtx_);
+    std::uint64_t sequencia;
+    return tentarLerMaisRecente(out, sequencia);
+}
+
+std::uint64_t BufferCircular::sequenciaAtual() const {
+    // o contador do seqlock avanca 2 por insercao, par quando estavel
+    return seqUltimo_.load(std::memory_order_acquire) / 2;
+}
+
+bool BufferCircular::tentarLerMaisRecente(RegistroBuffer& out, std::uint64_t& sequencia) const {
+    std::uint64_t palavras[PALAVRAS_REGISTRO];
+    std::uint64_t antes = 0;
+
+    for (;;) {
+        antes = seqUltimo_.load(std::memory_order_acquire);
+        if (antes == 0) {
+            return false; // nada foi inserido ainda
+        }
+        if (antes & 1u) {
+            continue; // escritor no meio da copia, tenta de novo
+        }
+
+        for (std::size_t i = 0; i < PALAVRAS_REGISTRO; ++i) {
+            palavras[i] = ultimo_[i].load(std::memory_order_relaxed);
+        }
 
-    if (quantidade_ == 0 || capacidade_ == 0) {
-        return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seqUltimo_.load(std::memory_order_relaxed) == antes) {
+            break; // nenhuma escrita aconteceu durante a copia
+        }
     }
 
-    // indice do registro mais recente eh inicio mais quantidade menos um modulo capacidade
-    std::size_t idxMaisRecente = (inicio_ + quantidade_ - 1) % capacidade_;
-    out = dados_[idxMaisRecente];
+    std::memcpy(&out, palavras, sizeof(RegistroBuffer));
+    sequencia = antes / 2;
     return true;
 }
 
 std::vector<RegistroBuffer> BufferCircular::snapshot() const {
-    std::lock_guard<std::mutex> lock(mtx_);
-
     std::vector<RegistroBuffer> copia;
-    copia.reserve(quantidade_);
+    visitar([&](const VisaoHistorico& v) {
+        copia.reserve(v.tamanho());
+        copia.insert(copia.end(), v.bloco1, v.bloco1 + v.tam1);
+        copia.insert(copia.end(), v.bloco2, v.bloco2 + v.tam2);
+    });
+    return copia;
+}
+
+std::size_t BufferCircular::copiarJanela(double desde_s, double ate_s, std::vector<RegistroBuffer>& out) const {
+    out.clear();
+    visitarJanela(desde_s, ate_s, [&](const VisaoHistorico& v) {
+        out.insert(out.end(), v.bloco1, v.bloco1 + v.tam1);
+        out.insert(out.end(), v.bloco2, v.bloco2 + v.tam2);
+    });
+    return out.size();
+}
+
+VisaoHistorico BufferCircular::trecho(std::size_t primeiro, std::size_t n) const {
+    VisaoHistorico v;
+    if (n == 0 || primeiro >= quantidade_) return v;
+    if (n > quantidade_ - primeiro) n = quantidade_ - primeiro;
 
-    for (std::size_t i = 0; i < quantidade_; ++i) {
-        std::size_t idx = (inicio_ + i) % capacidade_;
-        copia.push_back(dados_[idx]);
+    // o trecho comeca em inicio_+primeiro e pode passar do fim do vetor
+    std::size_t idx = (inicio_ + primeiro) % capacidade_;
+    std::size_t ateOFim = capacidade_ - idx;
+    v.bloco1 = dados_.data() + idx;
+    v.tam1   = n < ateOFim ? n : ateOFim;
+    if (v.tam1 < n) {
+        v.bloco2 = dados_.data();
+        v.tam2   = n - v.tam1;
     }
+    return v;
+}
 
-    return copia;
+// busca binaria sobre os indices logicos, o mesmo que std::lower_bound no anel
+std::size_t BufferCircular::primeiroComTempoAPartirDe(double t_s) const {
+    std::size_t lo = 0, hi = quantidade_;
+    while (lo < hi) {
+        std::size_t meio = lo + (hi - lo) / 2;
+        if (dados_[(inicio_ + meio) % capacidade_].tempoSimulacao_s < t_s) lo = meio + 1;
+        else hi = meio;
+    }
+    return lo;
+}
+
+// o mesmo que std::upper_bound
+std::size_t BufferCircular::primeiroComTempoDepoisDe(double t_s) const {
+    std::size_t lo = 0, hi = quantidade_;
+    while (lo < hi) {
+        std::size_t meio = lo + (hi - lo) / 2;
+        if (dados_[(inicio_ + meio) % capacidade_].tempoSimulacao_s <= t_s) lo = meio + 1;
+        else hi = meio;
+    }
+    return lo;
 }
 
 std::size_t BufferCircular::tamanho() const {
@@ -1,11 +1,9 @@
 #include "Caminhao.hpp"
 
-#include <iostream>
+#include "Log.hpp"
 #include <chrono>
-#include <thread>
 #include <cmath>
 #include <random>
-#include <deque>
 #include <cstdio>
 #include <mutex>
 #include <algorithm>
@@ -14,25 +12,41 @@ using namespace std::chrono_literals;
 
 namespace {
     constexpr double PI = 3.14159265358979323846;
+
+    // periodos das tarefas, usados pelo executor e convertidos em passos no lockstep
+    constexpr auto PERIODO_SENSORES     = 100ms;
+    constexpr auto PERIODO_LOGICA       = 50ms;
+    constexpr auto PERIODO_FALHAS       = 200ms;
+    constexpr auto PERIODO_CONTROLE     = 50ms;
+    constexpr auto PERIODO_PLANEJAMENTO = 100ms;
+    constexpr auto PERIODO_COLETOR      = 500ms;
+
+    // o waypoint conta como alcancado a menos disto, em metros; maior que a celula do
+    // mapa para nao frear em cada quina
+    constexpr double RAIO_WAYPOINT = 6.0;
+
+    // quantos passos de lockstep cabem em um periodo
+    constexpr std::uint64_t passos(std::chrono::milliseconds periodo) {
+        return static_cast<std::uint64_t>(periodo.count() / Caminhao::PASSO_LOCKSTEP_MS);
+    }
 }
 
-Caminhao::Caminhao(int id, std::size_t capacidadeBuffer)
-    : id_(id),
+Caminhao::Caminhao(int id, FisicaFrota& fisica, std::size_t capacidadeBuffer, RegistradorTelemetria* telemetria)
+    : formatoEstado_(ProtocoloMqtt::Formato::Binario),
+      topicoEstado_("mina/caminhao/" + std::to_string(id) + "/estado"),
+      id_(id),
       buffer_(capacidadeBuffer),
-      filaEventos_(),
       comandos_{},
       estadoLogico_(EstadoCaminhao::Parado),
       tempoNoEstado_s_(0.0),
       estados_{false, true, false},
-      fis_pos_x_(0.0),
-      fis_pos_y_(0.0),
-      fis_vel_(0.0),
-      fis_ang_deg_(0.0),
-      fis_temp_C_(40.0),
+      fisica_(fisica),
+      idxFisico_(fisica.adicionar(0.0, 0.0, 0.0, FisicaFrota::TEMP_BASE_C)),
       fis_forcarFalhaTemp_(false),
       fis_forcarFalhaElec_(false),
       fis_forcarFalhaHid_(false),
-      em_reducao_seguranca_(false), 
+      nivelSeguranca_(NivelSeguranca::Livre),
+      desvioSeguranca_(0),
       atuadores_{0, 0},
       setpoints_{0, 0, 0},
       rota_definida_(false),
@@ -40,62 +54,162 @@ Caminhao::Caminhao(int id, std::size_t capacidadeBuffer)
       rota_origem_y_(0),
       rota_destino_x_(0),
       rota_destino_y_(0),
-      rodando_(false)
+      geracaoRota_(0),
+      planejador_(nullptr),
+      geracaoPlanejada_(0),
+      versaoMapaRota_(0),
+      proximoWaypoint_(0),
+      telemetria_(telemetria),
+      gravador_(nullptr),
+      filtroX_(ConfigFiltros{}.posicao_x),
+      filtroY_(ConfigFiltros{}.posicao_y),
+      filtroAng_(ConfigFiltros{}.angulo),
+      filtroTemp_(ConfigFiltros{}.temperatura),
+      rngSensores_(static_cast<std::mt19937::result_type>(
+          id_ + std::chrono::system_clock::now().time_since_epoch().count())),
+      ruidoSensores_(0.0, 0.2),
+      coletorDefeitoAnterior_(false),
+      coletorManualAnterior_(false),
+      coletorAlertaTempAnterior_(false),
+      seqLogica_(0),
+      seqPlanejamento_(0),
+      seqControle_(0),
+      seqPlanejado_(0),
+      tempoPlanejado_s_(0.0),
+      nivelControle_(NivelSeguranca::Livre),
+      desvioControle_(0),
+      latenciaPipeline_(nullptr),
+      relogioVirtual_(false),
+      tempoVirtual_s_(0.0),
+      tempoImportado_s_(0.0),
+      rodando_(false),
+      executor_(nullptr),
+      tarTratamentoSensores_(0),
+      tarLogicaComando_(0),
+      tarMonitoramentoFalhas_(0),
+      tarControleNavegacao_(0),
+      tarPlanejamentoRota_(0),
+      tarColetorDados_(0)
 {
-    std::string nomeArquivo = "caminhao_" + std::to_string(id_) + ".csv";
-    arquivoLog_.open(nomeArquivo, std::ios::out);
-    
-    if (arquivoLog_.is_open()) {
-        arquivoLog_ << "tempo_s;id_caminhao;estado;e_defeito;e_automatico;"
-                    << "i_posicao_x;i_posicao_y;i_angulo_x;i_temperatura;"
-                    << "o_aceleracao;o_direcao;evento\n";
-        arquivoLog_.flush();
-        std::cout << "[Caminhao " << id_ << "] Log em arquivo: " << nomeArquivo << "\n";
-    }
 }
 
 Caminhao::~Caminhao() {
     parar();
+    // com as tarefas paradas ninguem mais usa o indice; o proximo caminhao o reaproveita
+    fisica_.liberar(idxFisico_);
 }
 
-void Caminhao::iniciar() {
-    if (rodando_) return;
+void Caminhao::configurarFiltros(const ConfigFiltros& cfg) {
+    filtroX_    = FiltroSensor(cfg.posicao_x);
+    filtroY_    = FiltroSensor(cfg.posicao_y);
+    filtroAng_  = FiltroSensor(cfg.angulo);
+    filtroTemp_ = FiltroSensor(cfg.temperatura);
+}
 
-    std::string clientId = "caminhao_" + std::to_string(id_);
-    mqtt_ = std::make_unique<MqttInterface>(clientId, 
-        [this](const std::string& topico, const std::string& payload) {
-            this->processarMensagemMqtt(topico, payload);
-        }
-    );
+void Caminhao::iniciar(ExecutorPeriodico& executor, bool mqttProprio, EstatisticasFrota* estatisticas) {
+    if (rodando_) return;
 
-    mqtt_->conectar();
-    mqtt_->assinar("mina/caminhao/" + std::to_string(id_) + "/cmd");
+    // sem cliente proprio, os comandos chegam pela SimulacaoMina e o estado
+    // sai no quadro agregado da frota
+    if (mqttProprio) {
+        std::string clientId = "caminhao_" + std::to_string(id_);
+        mqtt_ = std::make_unique<MqttInterface>(clientId, 
+            [this](const std::string& topico, const std::string& payload) {
+                this->processarMensagemMqtt(topico, payload);
+            }
+        );
 
-    rodando_ = true;
+        mqtt_->conectar();
+        mqtt_->assinar("mina/caminhao/" + std::to_string(id_) + "/cmd");
+    }
 
-    thTratamentoSensores_  = std::thread(&Caminhao::tarefaTratamentoSensores,  this);
-    thLogicaComando_       = std::thread(&Caminhao::tarefaLogicaComando,       this);
-    thMonitoramentoFalhas_ = std::thread(&Caminhao::tarefaMonitoramentoFalhas, this);
-    thControleNavegacao_   = std::thread(&Caminhao::tarefaControleNavegacao,   this);
-    thPlanejamentoRota_    = std::thread(&Caminhao::tarefaPlanejamentoRota,    this);
-    thColetorDados_        = std::thread(&Caminhao::tarefaColetorDados,       this);
+    rodando_  = true;
+    executor_ = &executor;
+    relogioVirtual_     = false;
+    inicio_             = std::chrono::steady_clock::now() -
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double>(tempoImportado_s_));
+    latenciaPipeline_   = estatisticas ? &estatisticas->latenciaSensorAtuador() : nullptr;
+
+    // mesmos periodos das antigas threads dedicadas; nos estagios do pipeline o periodo
+    // passa a ser so uma rede de seguranca, quem os aciona eh o estagio anterior
+    auto est = [estatisticas](TipoTarefa tipo) -> EstatisticasTarefa* {
+        return estatisticas ? &estatisticas->de(tipo) : nullptr;
+    };
 
-    std::cout << "[Caminhao " << id_ << "] Tarefas iniciadas e MQTT conectado.\n";
+    // do fim para o comeco do pipeline: cada estagio so roda depois que o id
+    // do estagio seguinte, que ele dispara, ja foi gravado
+    tarControleNavegacao_   = executor.registrar([this] { tarefaControleNavegacao();   }, PERIODO_CONTROLE,
+                                                 est(TipoTarefa::ControleNavegacao));
+    tarPlanejamentoRota_    = executor.registrar([this] { tarefaPlanejamentoRota();    }, PERIODO_PLANEJAMENTO,
+                                                 est(TipoTarefa::PlanejamentoRota));
+    tarLogicaComando_       = executor.registrar([this] { tarefaLogicaComando();       }, PERIODO_LOGICA,
+                                                 est(TipoTarefa::LogicaComando));
+    tarTratamentoSensores_  = executor.registrar([this] { tarefaTratamentoSensores();  }, PERIODO_SENSORES,
+                                                 est(TipoTarefa::TratamentoSensores));
+    tarMonitoramentoFalhas_ = executor.registrar([this] { tarefaMonitoramentoFalhas(); }, PERIODO_FALHAS,
+                                                 est(TipoTarefa::MonitoramentoFalhas));
+    tarColetorDados_        = executor.registrar([this] { tarefaColetorDados();        }, PERIODO_COLETOR,
+                                                 est(TipoTarefa::ColetorDados));
+
+    Log::info("[Caminhao %d] Tarefas iniciadas%s", id_, mqttProprio ? " e MQTT conectado." : " (MQTT pela central).");
 }
 
 void Caminhao::parar() {
-    rodando_ = false;
-
-    if (thTratamentoSensores_.joinable())  thTratamentoSensores_.join();
-    if (thLogicaComando_.joinable())       thLogicaComando_.join();
-    if (thMonitoramentoFalhas_.joinable()) thMonitoramentoFalhas_.join();
-    if (thControleNavegacao_.joinable())   thControleNavegacao_.join();
-    if (thPlanejamentoRota_.joinable())    thPlanejamentoRota_.join();
-    if (thColetorDados_.joinable())        thColetorDados_.join();
-    
+    bool expected = true;
+    if (!rodando_.compare_exchange_strong(expected, false)) {
+        if (mqtt_) mqtt_->desconectar();
+        return;
+    }
+
+    // cancelar() so retorna depois que o ciclo em andamento de cada tarefa termina
+    // no lockstep nao ha executor, as tarefas so rodam dentro de avancarLockstep()
+    if (executor_) {
+        executor_->cancelar(tarTratamentoSensores_);
+        executor_->cancelar(tarLogicaComando_);
+        executor_->cancelar(tarMonitoramentoFalhas_);
+        executor_->cancelar(tarControleNavegacao_);
+        executor_->cancelar(tarPlanejamentoRota_);
+        executor_->cancelar(tarColetorDados_);
+        executor_ = nullptr;
+    }
+
+    Log::info("[Caminhao %d] Tarefas encerradas.", id_);
+
     if (mqtt_) mqtt_->desconectar();
 }
 
+void Caminhao::iniciarLockstep(std::uint32_t semente) {
+    if (rodando_) return;
+
+    rodando_            = true;
+    relogioVirtual_     = true;
+    tempoVirtual_s_     = 0.0;
+    rngSensores_.seed(static_cast<std::mt19937::result_type>(semente + static_cast<std::uint32_t>(id_)));
+    ruidoSensores_.reset();
+
+    Log::info("[Caminhao %d] Modo lockstep (semente %u).", id_, static_cast<unsigned>(semente));
+}
+
+void Caminhao::avancarLockstep(std::uint64_t passo) {
+    if (!rodando_ || !relogioVirtual_) return;
+
+    tempoVirtual_s_ = static_cast<double>(passo) * PASSO_LOCKSTEP_S;
+
+    // ordem fixa dentro do passo: sensores -> logica -> planejamento -> controle
+    if (passo % passos(PERIODO_SENSORES)     == 0) tarefaTratamentoSensores();
+    if (passo % passos(PERIODO_LOGICA)       == 0) tarefaLogicaComando();
+    if (passo % passos(PERIODO_FALHAS)       == 0) tarefaMonitoramentoFalhas();
+    if (passo % passos(PERIODO_PLANEJAMENTO) == 0) tarefaPlanejamentoRota();
+    if (passo % passos(PERIODO_CONTROLE)     == 0) tarefaControleNavegacao();
+    if (passo % passos(PERIODO_COLETOR)      == 0) tarefaColetorDados();
+}
+
+double Caminhao::tempoAtual_s() const {
+    if (relogioVirtual_) return tempoVirtual_s_;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio_).count();
+}
+
 int Caminhao::getId() const { return id_; }
 
 EstadoCaminhao Caminhao::lerEstadoLogico() const {
@@ -107,26 +221,35 @@ bool Caminhao::lerUltimoRegistro(RegistroBuffer& out) const {
     return buffer_.tentarLerMaisRecente(out);
 }
 
-void Caminhao::setReducaoSeguranca(bool ativar) {
-    em_reducao_seguranca_ = ativar;
-    
-    if (ativar) {
-        comandarParadaEmergencia();
-    }
+FisicaFrota::EstadoFisico Caminhao::estadoFisico() const {
+    return fisica_.ler(idxFisico_);
+}
+
+std::size_t Caminhao::copiarHistorico(double desde_s, double ate_s, std::vector<RegistroBuffer>& out) const {
+    return buffer_.copiarJanela(desde_s, ate_s, out);
+}
+
+void Caminhao::definirNivelSeguranca(NivelSeguranca nivel, int desvio_graus) {
+    nivelSeguranca_.store(nivel, std::memory_order_relaxed);
+    desvioSeguranca_.store(desvio_graus, std::memory_order_relaxed);
+}
+
+NivelSeguranca Caminhao::nivelSeguranca() const {
+    return nivelSeguranca_.load(std::memory_order_relaxed);
 }
 
 void Caminhao::comandarAutomatico() {
     std::lock_guard<std::mutex> lock(mtxComandos_);
     comandos_.c_automatico = true;
     comandos_.c_man        = false;
-    std::cout << "[Caminhao " << id_ << "] Comando do operador: modo AUTOMATICO.\n";
+    Log::info("[Caminhao %d] Comando do operador: modo AUTOMATICO.", id_);
 }
 
 void Caminhao::comandarManual() {
     std::lock_guard<std::mutex> lock(mtxComandos_);
     comandos_.c_man        = true;
     comandos_.c_automatico = false;
-    std::cout << "[Caminhao " << id_ << "] Comando do operador: modo MANUAL.\n";
+    Log::info("[Caminhao %d] Comando do operador: modo MANUAL.", id_);
 }
 
 void Caminhao::comandarRearme() {
@@ -138,20 +261,7 @@ void Caminhao::comandarRearme() {
     fis_forcarFalhaElec_ = false;
     fis_forcarFalhaHid_  = false;
 
-    std::cout << "[Caminhao " << id_ << "] Comando do operador: REARME.\n";
-}
-
-void Caminhao::comandarParadaEmergencia() {
-    std::lock_guard<std::mutex> lock(mtxComandos_);
-    
-    comandos_.c_man        = true;
-    comandos_.c_automatico = false;
-    
-    comandos_.c_acelera  = false;
-    comandos_.c_direita  = false;
-    comandos_.c_esquerda = false;
-
-    std::cerr << "[Caminhao " << id_ << "] !!! PARADA DE EMERGENCIA (ANTI-COLISAO) !!!\n";
+    Log::info("[Caminhao %d] Comando do operador: REARME.", id_);
 }
 
 void Caminhao::setComandoAcelerar(bool ativo)  { std::lock_guard<std::mutex> l(mtxComandos_); comandos_.c_acelera  = ativo; }
@@ -160,29 +270,27 @@ void Caminhao::setComandoEsquerda(bool ativo)  { std::lock_guard<std::mutex> l(m
 
 void Caminhao::injetarFalhaTemperaturaAlta() {
     fis_forcarFalhaTemp_ = true;
-    std::cout << "[Caminhao " << id_ << "] [TESTE] Falha Temperatura.\n";
+    Log::aviso("[Caminhao %d] [TESTE] Falha Temperatura.", id_);
 }
 void Caminhao::injetarFalhaEletrica() {
     fis_forcarFalhaElec_ = true;
-    std::cout << "[Caminhao " << id_ << "] [TESTE] Falha Eletrica.\n";
+    Log::aviso("[Caminhao %d] [TESTE] Falha Eletrica.", id_);
 }
 void Caminhao::injetarFalhaHidraulica() {
     fis_forcarFalhaHid_ = true;
-    std::cout << "[Caminhao " << id_ << "] [TESTE] Falha Hidraulica.\n";
+    Log::aviso("[Caminhao %d] [TESTE] Falha Hidraulica.", id_);
 }
 
 void Caminhao::definirRota(int x1, int y1, int x2, int y2) {
     {
-        std::lock_guard<std::mutex> lf(mtxFisico_);
-        fis_pos_x_ = static_cast<double>(x1);
-        fis_pos_y_ = static_cast<double>(y1);
-        fis_vel_   = 0.0;
+        double ang = fisica_.ler(idxFisico_).ang_deg;
         
         double dx = static_cast<double>(x2 - x1);
         double dy = static_cast<double>(y2 - y1);
         if (dx != 0.0 || dy != 0.0) {
-            fis_ang_deg_ = std::atan2(dy, dx) * 180.0 / PI;
+            ang = std::atan2(dy, dx) * 180.0 / PI;
         }
+        fisica_.reposicionar(idxFisico_, static_cast<double>(x1), static_cast<double>(y1), ang);
     }
     {
         std::lock_guard<std::mutex> lr(mtxRota_);
@@ -191,6 +299,7 @@ void Caminhao::definirRota(int x1, int y1, int x2, int y2) {
         rota_destino_x_ = x2;
         rota_destino_y_ = y2;
         rota_definida_  = true;
+        ++geracaoRota_;
     }
     
     {
@@ -198,405 +307,585 @@ void Caminhao::definirRota(int x1, int y1, int x2, int y2) {
         estadoLogico_ = EstadoCaminhao::Parado;
     }
     
-    std::cout << "[Caminhao " << id_ << "] Rota definida (" << x1 << "," << y1
-              << ") -> (" << x2 << "," << y2 << ")\n";
+    Log::info("[Caminhao %d] Rota definida (%d,%d) -> (%d,%d)", id_, x1, y1, x2, y2);
 }
 
-void Caminhao::tarefaTratamentoSensores() {
-    auto inicio = std::chrono::steady_clock::now();
-    const int M = 10;
-    std::deque<double> hist_x, hist_y, hist_ang, hist_temp;
-    std::mt19937 rng(id_ + std::chrono::system_clock::now().time_since_epoch().count());
-    std::normal_distribution<double> noise(0.0, 0.2);
-
-    auto filtra = [&](std::deque<double>& h, double v) {
-        h.push_back(v); 
-        if (h.size() > static_cast<std::size_t>(M)) h.pop_front();
-        double s = 0.0; 
-        for (auto x : h) s += x; 
-        return s / h.size();
-    };
+EstadoMigracao Caminhao::exportarEstado() const {
+    EstadoMigracao e{};
+    e.id_caminhao      = id_;
+    e.tempoSimulacao_s = tempoAtual_s();
+
+    FisicaFrota::EstadoFisico fis = fisica_.ler(idxFisico_);
+    e.pos_x   = fis.pos_x;
+    e.pos_y   = fis.pos_y;
+    e.vel     = fis.vel;
+    e.ang_deg = fis.ang_deg;
+    e.temp_C  = fis.temp_C;
+    {
+        std::lock_guard<std::mutex> l(mtxAtuadores_);
+        e.atuadores = atuadores_;
+    }
+    {
+        std::lock_guard<std::mutex> lr(mtxRota_);
+        e.rota_definida  = rota_definida_;
+        e.rota_destino_x = rota_destino_x_;
+        e.rota_destino_y = rota_destino_y_;
+    }
+    e.estado = lerEstadoLogico();
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        e.estados = estados_;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxComandos_);
+        e.comandos = comandos_;
+    }
+    e.falha_temperatura = fis_forcarFalhaTemp_;
+    e.falha_eletrica    = fis_forcarFalhaElec_;
+    e.falha_hidraulica  = fis_forcarFalhaHid_;
 
-    while (rodando_) {
-        double px, py, ang, temp;
-        {
-            std::lock_guard<std::mutex> l(mtxFisico_);
-            px   = fis_pos_x_;
-            py   = fis_pos_y_;
-            ang  = fis_ang_deg_;
-            temp = fis_temp_C_;
-        }
+    if (!buffer_.tentarLerMaisRecente(e.ultimo)) e.ultimo.tempoSimulacao_s = -1.0;
+    return e;
+}
 
-        px   = filtra(hist_x,   px   + noise(rng));
-        py   = filtra(hist_y,   py   + noise(rng));
-        ang  = filtra(hist_ang, ang);
-        temp = filtra(hist_temp,temp);
+void Caminhao::importarEstado(const EstadoMigracao& e) {
+    if (rodando_) return;
 
-        SensoresCaminhao s;
-        s.i_posicao_x      = static_cast<int>(std::lround(px));
-        s.i_posicao_y      = static_cast<int>(std::lround(py));
-        s.i_angulo_x       = static_cast<int>(std::lround(ang));
-        s.i_temperatura    = static_cast<int>(std::lround(temp));
-        
-        if (fis_forcarFalhaTemp_) s.i_temperatura = 130;
-        s.i_falha_eletrica   = fis_forcarFalhaElec_;
-        s.i_falha_hidraulica = fis_forcarFalhaHid_;
-
-        RegistroBuffer reg;
-        reg.tempoSimulacao_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
-        reg.id_caminhao      = id_;
-        reg.sensores         = s;
-        {
-            std::lock_guard<std::mutex> l(mtxEstados_);
-            reg.estados = estados_;
-        }
-        {
-            std::lock_guard<std::mutex> l(mtxComandos_);
-            reg.comandos = comandos_;
-        }
-        {
-            std::lock_guard<std::mutex> l(mtxAtuadores_);
-            reg.atuadores = atuadores_;
-        }
-        {
-            std::lock_guard<std::mutex> l(mtxSetpoints_);
-            reg.setpoints = setpoints_;
-        }
-        {
-            std::lock_guard<std::mutex> l(mtxEstadoLogico_);
-            reg.estado = estadoLogico_;
-        }
+    fisica_.restaurar(idxFisico_, {e.pos_x, e.pos_y, e.vel, e.ang_deg, e.temp_C});
+    fisica_.definirAtuacao(idxFisico_, e.atuadores.o_aceleracao, e.atuadores.o_direcao);
+    {
+        std::lock_guard<std::mutex> l(mtxAtuadores_);
+        atuadores_ = e.atuadores;
+    }
+    {
+        // a rota do shard de origem comecava em outro ponto; a nova comeca aqui
+        std::lock_guard<std::mutex> lr(mtxRota_);
+        rota_definida_  = e.rota_definida;
+        rota_origem_x_  = static_cast<int>(std::lround(e.pos_x));
+        rota_origem_y_  = static_cast<int>(std::lround(e.pos_y));
+        rota_destino_x_ = e.rota_destino_x;
+        rota_destino_y_ = e.rota_destino_y;
+        ++geracaoRota_;
+    }
+    {
+        std::lock_guard<std::mutex> le(mtxEstadoLogico_);
+        estadoLogico_ = e.estado;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        estados_ = e.estados;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxComandos_);
+        comandos_ = e.comandos;
+    }
+    fis_forcarFalhaTemp_ = e.falha_temperatura;
+    fis_forcarFalhaElec_ = e.falha_eletrica;
+    fis_forcarFalhaHid_  = e.falha_hidraulica;
 
+    if (e.ultimo.tempoSimulacao_s >= 0.0) {
+        RegistroBuffer reg = e.ultimo;
+        reg.id_caminhao = id_;
         buffer_.inserir(reg);
-        std::this_thread::sleep_for(100ms);
     }
+    tempoImportado_s_ = e.tempoSimulacao_s;
+}
+
+void Caminhao::definirPlanejador(PlanejadorRotas* planejador) {
+    planejador_ = planejador;
+}
+
+void Caminhao::tarefaTratamentoSensores() {
+    FisicaFrota::EstadoFisico fis = fisica_.ler(idxFisico_);
+    double px   = fis.pos_x;
+    double py   = fis.pos_y;
+    double ang  = fis.ang_deg;
+    double temp = fis.temp_C;
+
+    px   = filtroX_.filtrar(px + ruidoSensores_(rngSensores_));
+    py   = filtroY_.filtrar(py + ruidoSensores_(rngSensores_));
+    ang  = filtroAng_.filtrar(ang);
+    temp = filtroTemp_.filtrar(temp);
+
+    SensoresCaminhao s;
+    s.i_posicao_x      = static_cast<int>(std::lround(px));
+    s.i_posicao_y      = static_cast<int>(std::lround(py));
+    s.i_angulo_x       = static_cast<int>(std::lround(ang));
+    s.i_temperatura    = static_cast<int>(std::lround(temp));
+    
+    if (fis_forcarFalhaTemp_) s.i_temperatura = 130;
+    s.i_falha_eletrica   = fis_forcarFalhaElec_;
+    s.i_falha_hidraulica = fis_forcarFalhaHid_;
+
+    RegistroBuffer reg;
+    reg.tempoSimulacao_s = tempoAtual_s();
+    reg.id_caminhao      = id_;
+    reg.sensores         = s;
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        reg.estados = estados_;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxComandos_);
+        reg.comandos = comandos_;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxAtuadores_);
+        reg.atuadores = atuadores_;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxSetpoints_);
+        reg.setpoints = setpoints_;
+    }
+    {
+        std::lock_guard<std::mutex> l(mtxEstadoLogico_);
+        reg.estado = estadoLogico_;
+    }
+
+    buffer_.inserir(reg);
+    if (executor_) executor_->disparar(tarLogicaComando_);
 }
 
 void Caminhao::tarefaLogicaComando() {
-    while (rodando_) {
-        RegistroBuffer reg{};
-        if (!buffer_.tentarLerMaisRecente(reg)) {
-            std::this_thread::sleep_for(50ms);
-            continue;
-        }
+    RegistroBuffer reg{};
+    std::uint64_t seq = 0;
+    if (!buffer_.tentarLerMaisRecente(reg, seq)) {
+        return;
+    }
+    // os comandos e sensores vem do registro, reprocessar o mesmo registro nao muda nada
+    if (seq == seqLogica_) return;
+    seqLogica_ = seq;
 
-        bool autoCmd = reg.comandos.c_automatico;
-        bool manCmd  = reg.comandos.c_man;
-        bool rearm   = reg.comandos.c_rearme;
+    bool autoCmd = reg.comandos.c_automatico;
+    bool manCmd  = reg.comandos.c_man;
+    bool rearm   = reg.comandos.c_rearme;
 
-        {
-            std::lock_guard<std::mutex> l(mtxEstados_);
-            bool &autoMode = estados_.e_automatico;
-            bool &defeito  = estados_.e_defeito;
-            bool &bloqueio = estados_.e_bloqueio_rearme;
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        bool &autoMode = estados_.e_automatico;
+        bool &defeito  = estados_.e_defeito;
+        bool &bloqueio = estados_.e_bloqueio_rearme;
+
+        if (manCmd) {
+            autoMode = false;
+            bloqueio = false; 
+        }
 
-            if (manCmd) {
+        if (autoCmd) {
+            if (!autoMode && !bloqueio) {
+                bloqueio = true;
                 autoMode = false;
-                bloqueio = false; 
             }
-
-            if (autoCmd) {
-                if (!autoMode && !bloqueio) {
-                    bloqueio = true;
-                    autoMode = false;
-                }
-                else if (!bloqueio) {
-                    autoMode = true;
-                }
-                else {
-                    autoMode = false;
-                }
+            else if (!bloqueio) {
+                autoMode = true;
             }
+            else {
+                autoMode = false;
+            }
+        }
 
-            if (rearm) {
-                defeito = false;
-                if (bloqueio) {
-                    bloqueio = false;
-
-                    if (autoCmd) {
-                        autoMode = true;
-                    }
-                }
+        if (rearm) {
+            defeito = false;
+            if (bloqueio) {
+                bloqueio = false;
 
-                {
-                    std::lock_guard<std::mutex> l_cmd(mtxComandos_);
-                    comandos_.c_rearme = false;
+                if (autoCmd) {
+                    autoMode = true;
                 }
             }
 
-            if (reg.sensores.i_falha_eletrica ||
-                reg.sensores.i_falha_hidraulica ||
-                reg.sensores.i_temperatura > 120) 
             {
-                defeito  = true;
-                autoMode = false;
-                bloqueio = true; 
+                std::lock_guard<std::mutex> l_cmd(mtxComandos_);
+                comandos_.c_rearme = false;
             }
         }
 
-        EstadosCaminhao estadosAtuais;
+        if (reg.sensores.i_falha_eletrica ||
+            reg.sensores.i_falha_hidraulica ||
+            reg.sensores.i_temperatura > 120) 
         {
-            std::lock_guard<std::mutex> l(mtxEstados_);
-            estadosAtuais = estados_;
+            defeito  = true;
+            autoMode = false;
+            bloqueio = true; 
         }
+    }
 
-        EstadoCaminhao novoEstado = EstadoCaminhao::Parado;
+    EstadosCaminhao estadosAtuais;
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        estadosAtuais = estados_;
+    }
 
-        double velocidadeAtual = 0.0;
-        {
-            std::lock_guard<std::mutex> lf(mtxFisico_);
-            velocidadeAtual = fis_vel_;
-        }
+    EstadoCaminhao novoEstado = EstadoCaminhao::Parado;
 
-        bool estaAcelerar = (reg.atuadores.o_aceleracao != 0);
-        bool estaAAndar   = (std::abs(velocidadeAtual) > 0.1);
+    double velocidadeAtual = fisica_.velocidade(idxFisico_);
 
-        if (estadosAtuais.e_defeito) {
-            novoEstado = EstadoCaminhao::EmFalha;
-        }
-        else if (estaAAndar || estaAcelerar) {
-            novoEstado = EstadoCaminhao::EmMovimento;
-        }
-        else {
-            novoEstado = EstadoCaminhao::Parado;
-        }
+    bool estaAcelerar = (reg.atuadores.o_aceleracao != 0);
+    bool estaAAndar   = (std::abs(velocidadeAtual) > 0.1);
 
-        {
-            std::lock_guard<std::mutex> le(mtxEstadoLogico_);
-            estadoLogico_ = novoEstado;
-        }
+    if (estadosAtuais.e_defeito) {
+        novoEstado = EstadoCaminhao::EmFalha;
+    }
+    else if (estaAAndar || estaAcelerar) {
+        novoEstado = EstadoCaminhao::EmMovimento;
+    }
+    else {
+        novoEstado = EstadoCaminhao::Parado;
+    }
 
-        std::this_thread::sleep_for(50ms);
+    {
+        std::lock_guard<std::mutex> le(mtxEstadoLogico_);
+        estadoLogico_ = novoEstado;
     }
 
-    std::cout << "[Caminhao " << id_ << "] Tarefa LogicaComando encerrada.\n";
+    if (executor_) executor_->disparar(tarPlanejamentoRota_);
 }
 
 void Caminhao::tarefaMonitoramentoFalhas() {
-    while (rodando_) std::this_thread::sleep_for(200ms);
+    // ainda sem logica propria, mantida no executor com o periodo original
 }
 
 void Caminhao::tarefaControleNavegacao() {
-    auto anterior = std::chrono::steady_clock::now();
-    const double a_max   = 2.0;
-    const double fric    = 0.2;
+    // a integracao fisica saiu daqui: FisicaFrota integra a frota inteira em uma passada
+    // e este ciclo so calcula os atuadores que a proxima passada vai aplicar
     const double Kp_dist = 1.0;
     const double DIST_PARAR = 1.0;
 
     const int MANUAL_ACEL_VAL  = 50;
     const int MANUAL_DIR_PASSO = 10;
 
-    while (rodando_) {
-        auto agora = std::chrono::steady_clock::now();
-        double dt = std::chrono::duration<double>(agora - anterior).count();
-        anterior = agora; 
-        if (dt <= 0.0) dt = 0.01;
+    // anticolisao: frenagem proporcional a velocidade (nunca inverte o sentido no periodo)
+    // e, no limite, aceleracao cuja velocidade terminal eh V_LIMITE
+    const double V_LIMITE      = 3.0;
+    const double GANHO_CEDER   = 40.0;
+    const double GANHO_PARAR   = 100.0;
+    const int    ACEL_LIMITE   = static_cast<int>(V_LIMITE * FisicaFrota::FRICCAO / FisicaFrota::A_MAX * 100.0);
 
-        AtuadoresCaminhao atu;
-        {
-            std::lock_guard<std::mutex> l(mtxAtuadores_);
-            atu = atuadores_;
-        }
+    // ultimo estagio do pipeline: sensores e comandos vem do registro mais recente, estados
+    // e setpoints sao os que a logica e o planejamento acabaram de calcular
+    const std::uint64_t seq = seqPlanejado_.load(std::memory_order_acquire);
+    if (seq == 0) return; // planejamento ainda nao processou nenhuma amostra
 
-        {
-            std::lock_guard<std::mutex> l(mtxFisico_);
-            
-            fis_ang_deg_ = static_cast<double>(atu.o_direcao); 
-
-            double rad = fis_ang_deg_ * PI / 180.0;
-            double a   = (static_cast<double>(atu.o_aceleracao) / 100.0) * a_max;
-            
-            fis_vel_   += a * dt;
-            fis_vel_   -= fric * fis_vel_ * dt; 
-            
-            fis_pos_x_ += fis_vel_ * std::cos(rad) * dt;
-            fis_pos_y_ += fis_vel_ * std::sin(rad) * dt;
-            
-            double alvoTemp = 40.0 + 2.0 * std::fabs(fis_vel_);
-            fis_temp_C_    += 0.5 * (alvoTemp - fis_temp_C_) * dt;
-        }
+    RegistroBuffer reg{};
+    if (!buffer_.tentarLerMaisRecente(reg)) return;
 
-        RegistroBuffer reg{};
-        if (buffer_.tentarLerMaisRecente(reg)) {
-            EstadosCaminhao   ests   = reg.estados;
-            SetpointsCaminhao sp     = reg.setpoints;
-            SensoresCaminhao  s      = reg.sensores;
-            ComandosCaminhao  cmds = reg.comandos;
+    EstadosCaminhao ests;
+    {
+        std::lock_guard<std::mutex> l(mtxEstados_);
+        ests = estados_;
+    }
+    bool temDefeito = ests.e_defeito || (lerEstadoLogico() == EstadoCaminhao::EmFalha);
+
+    // em automatico ou em falha a saida so depende da amostra e do nivel de seguranca;
+    // no manual o passo de direcao eh aplicado a cada ciclo, entao o periodo continua valendo
+    NivelSeguranca nivel = nivelSeguranca_.load(std::memory_order_relaxed);
+    int desvio = desvioSeguranca_.load(std::memory_order_relaxed);
+    bool manual  = !ests.e_automatico && !temDefeito;
+    if (seq == seqControle_ && nivel == nivelControle_ && desvio == desvioControle_ && !manual) return;
+    bool amostraNova = (seq != seqControle_);
+    seqControle_    = seq;
+    nivelControle_  = nivel;
+    desvioControle_ = desvio;
+
+    SetpointsCaminhao sp;
+    {
+        std::lock_guard<std::mutex> l(mtxSetpoints_);
+        sp = setpoints_;
+    }
+    SensoresCaminhao s    = reg.sensores;
+    ComandosCaminhao cmds = reg.comandos;
 
-            AtuadoresCaminhao novosAtu = atu;
-            bool temDefeito = ests.e_defeito || (reg.estado == EstadoCaminhao::EmFalha);
+    AtuadoresCaminhao novosAtu;
+    {
+        std::lock_guard<std::mutex> l(mtxAtuadores_);
+        novosAtu = atuadores_;
+    }
 
-            if (em_reducao_seguranca_ || temDefeito) { 
-                novosAtu.o_aceleracao = 0; 
-            }
-            else if (ests.e_automatico && !temDefeito) {
-                double dx = static_cast<double>(sp.sp_posicao_x - s.i_posicao_x);
-                double dy = static_cast<double>(sp.sp_posicao_y - s.i_posicao_y);
-                double dist = std::sqrt(dx*dx + dy*dy);
-                
-                double cmd_dir = static_cast<double>(sp.sp_angulo_x);
-                while (cmd_dir >  180.0) cmd_dir -= 360.0;
-                while (cmd_dir < -180.0) cmd_dir += 360.0;
-                novosAtu.o_direcao = static_cast<int>(std::lround(cmd_dir));
-                
-                double cmd_acel = Kp_dist * dist;
-                if (cmd_acel > 100.0) cmd_acel = 100.0;
-                if (cmd_acel <   0.0) cmd_acel = 0.0;
-                
-                if (dist <= DIST_PARAR) cmd_acel = 0.0;
-                
-                novosAtu.o_aceleracao = static_cast<int>(std::lround(cmd_acel));
-            } 
-            else if (!ests.e_automatico && !temDefeito) {
-                int dir = novosAtu.o_direcao;
-                if (cmds.c_direita)   dir -= MANUAL_DIR_PASSO;
-                if (cmds.c_esquerda)  dir += MANUAL_DIR_PASSO;
-                if (dir >  180) dir =  180;
-                if (dir < -180) dir = -180;
-                novosAtu.o_direcao    = dir;
-
-                novosAtu.o_aceleracao = cmds.c_acelera ? MANUAL_ACEL_VAL : 0;
-            } 
-            else {
-                novosAtu.o_aceleracao = 0;
-                
-                {
-                    std::lock_guard<std::mutex> lf(mtxFisico_);
-                    fis_vel_ = 0.0; 
-                }
-            }
+    if (temDefeito) { 
+        novosAtu.o_aceleracao = 0; 
+    }
+    else if (ests.e_automatico) {
+        double dx = static_cast<double>(sp.sp_posicao_x - s.i_posicao_x);
+        double dy = static_cast<double>(sp.sp_posicao_y - s.i_posicao_y);
+        double dist = std::sqrt(dx*dx + dy*dy);
+        
+        double cmd_dir = static_cast<double>(sp.sp_angulo_x + desvio);
+        while (cmd_dir >  180.0) cmd_dir -= 360.0;
+        while (cmd_dir < -180.0) cmd_dir += 360.0;
+        novosAtu.o_direcao = static_cast<int>(std::lround(cmd_dir));
+        
+        double cmd_acel = Kp_dist * dist;
+        if (cmd_acel > 100.0) cmd_acel = 100.0;
+        if (cmd_acel <   0.0) cmd_acel = 0.0;
+        
+        if (dist <= DIST_PARAR) cmd_acel = 0.0;
+        
+        novosAtu.o_aceleracao = static_cast<int>(std::lround(cmd_acel));
+    } 
+    else {
+        int dir = novosAtu.o_direcao;
+        if (cmds.c_direita)   dir -= MANUAL_DIR_PASSO;
+        if (cmds.c_esquerda)  dir += MANUAL_DIR_PASSO;
+        if (dir >  180) dir =  180;
+        if (dir < -180) dir = -180;
+        novosAtu.o_direcao    = dir;
+
+        novosAtu.o_aceleracao = cmds.c_acelera ? MANUAL_ACEL_VAL : 0;
+    } 
+
+    // o anticolisao vale nos dois modos e so mexe na aceleracao: a direcao continua a da rota
+    // ou a do operador
+    if (nivel != NivelSeguranca::Livre) {
+        const double v = fisica_.velocidade(idxFisico_);
+        auto frear = [](double f) { return -static_cast<int>(std::lround(std::min(std::max(f, 0.0), 100.0))); };
+
+        if (nivel == NivelSeguranca::Parar)      novosAtu.o_aceleracao = frear(GANHO_PARAR * v);
+        else if (nivel == NivelSeguranca::Ceder) novosAtu.o_aceleracao = frear(GANHO_CEDER * v);
+        else if (v > V_LIMITE)                   novosAtu.o_aceleracao = frear(GANHO_CEDER * (v - V_LIMITE));
+        else if (novosAtu.o_aceleracao > ACEL_LIMITE) novosAtu.o_aceleracao = ACEL_LIMITE;
+    }
 
-            {
-                std::lock_guard<std::mutex> l(mtxAtuadores_);
-                atuadores_ = novosAtu;
-            }
-        }
-        std::this_thread::sleep_for(50ms);
+    {
+        std::lock_guard<std::mutex> l(mtxAtuadores_);
+        atuadores_ = novosAtu;
+    }
+    fisica_.definirAtuacao(idxFisico_, novosAtu.o_aceleracao, novosAtu.o_direcao);
+
+    // latencia sensor -> atuador da amostra planejada, so faz sentido no relogio real
+    if (amostraNova && latenciaPipeline_ && !relogioVirtual_) {
+        double latencia_s = tempoAtual_s() - tempoPlanejado_s_.load(std::memory_order_relaxed);
+        latenciaPipeline_->registrar(static_cast<std::uint64_t>(latencia_s > 0.0 ? latencia_s * 1e6 : 0.0));
     }
-    std::cout << "[Caminhao " << id_ << "] Tarefa ControleNavegacao encerrada.\n";
 }
 
 void Caminhao::tarefaPlanejamentoRota() {
-    while (rodando_) {
-        RegistroBuffer reg{};
-        if (buffer_.tentarLerMaisRecente(reg)) {
-            std::lock_guard<std::mutex> l(mtxSetpoints_);
-            
-            if (rota_definida_) {
-                setpoints_.sp_posicao_x = rota_destino_x_;
-                setpoints_.sp_posicao_y = rota_destino_y_;
-                
-                double dx = static_cast<double>(rota_destino_x_ - reg.sensores.i_posicao_x);
-                double dy = static_cast<double>(rota_destino_y_ - reg.sensores.i_posicao_y);
-                if (std::abs(dx) > 1.0 || std::abs(dy) > 1.0) {
-                    double ang_rad = std::atan2(dy, dx);
-                    setpoints_.sp_angulo_x = static_cast<int>(std::lround(ang_rad * 180.0 / PI));
-                }
-            } else {
-                setpoints_.sp_posicao_x = reg.sensores.i_posicao_x;
-                setpoints_.sp_posicao_y = reg.sensores.i_posicao_y;
-                setpoints_.sp_angulo_x  = reg.sensores.i_angulo_x;
+    RegistroBuffer reg{};
+    std::uint64_t seq = 0;
+    if (!buffer_.tentarLerMaisRecente(reg, seq)) return;
+
+    // rota nova sem amostra nova espera a proxima amostra, no maximo um periodo de sensores
+    if (seq == seqPlanejamento_) return;
+    seqPlanejamento_ = seq;
+
+    bool definida;
+    int origemX, origemY, destX, destY;
+    std::uint64_t geracao;
+    {
+        std::lock_guard<std::mutex> lr(mtxRota_);
+        definida = rota_definida_;
+        origemX  = rota_origem_x_;
+        origemY  = rota_origem_y_;
+        destX    = rota_destino_x_;
+        destY    = rota_destino_y_;
+        geracao  = geracaoRota_;
+    }
+
+    const double px = static_cast<double>(reg.sensores.i_posicao_x);
+    const double py = static_cast<double>(reg.sensores.i_posicao_y);
+
+    if (definida && geracao != geracaoPlanejada_) {
+        geracaoPlanejada_ = geracao;
+        replanejarRota(origemX, origemY, destX, destY);
+    } else if (definida && planejador_ && planejador_->mapa().versao() != versaoMapaRota_) {
+        // mapa mudou: so replaneja se o que falta da rota passou a cruzar obstaculo
+        std::shared_ptr<const MapaMina::Grade> grade = planejador_->mapa().grade();
+        if (restoDaRotaLivre(*grade, px, py)) versaoMapaRota_ = grade->versao;
+        else                                  replanejarRota(px, py, destX, destY);
+    }
+
+    while (proximoWaypoint_ + 1 < waypoints_.size()) {
+        double wx = waypoints_[proximoWaypoint_].x - px;
+        double wy = waypoints_[proximoWaypoint_].y - py;
+        if (wx*wx + wy*wy >= RAIO_WAYPOINT * RAIO_WAYPOINT) break;
+        std::lock_guard<std::mutex> l(mtxWaypoints_);
+        ++proximoWaypoint_;
+    }
+
+    {
+        std::lock_guard<std::mutex> l(mtxSetpoints_);
+        
+        if (definida) {
+            // a posicao alvo continua sendo o destino (o controle freia pela distancia a ele);
+            // a direcao aponta para o waypoint corrente
+            setpoints_.sp_posicao_x = destX;
+            setpoints_.sp_posicao_y = destY;
+
+            double alvoX = static_cast<double>(destX);
+            double alvoY = static_cast<double>(destY);
+            if (proximoWaypoint_ < waypoints_.size()) {
+                alvoX = waypoints_[proximoWaypoint_].x;
+                alvoY = waypoints_[proximoWaypoint_].y;
             }
+            double dx = alvoX - px;
+            double dy = alvoY - py;
+            if (std::abs(dx) > 1.0 || std::abs(dy) > 1.0) {
+                double ang_rad = std::atan2(dy, dx);
+                setpoints_.sp_angulo_x = static_cast<int>(std::lround(ang_rad * 180.0 / PI));
+            }
+        } else {
+            setpoints_.sp_posicao_x = reg.sensores.i_posicao_x;
+            setpoints_.sp_posicao_y = reg.sensores.i_posicao_y;
+            setpoints_.sp_angulo_x  = reg.sensores.i_angulo_x;
         }
-        std::this_thread::sleep_for(100ms);
     }
+
+    // publica para o controle a amostra cujos setpoints estao prontos
+    tempoPlanejado_s_.store(reg.tempoSimulacao_s, std::memory_order_relaxed);
+    seqPlanejado_.store(seq, std::memory_order_release);
+    if (executor_) executor_->disparar(tarControleNavegacao_);
 }
 
-void Caminhao::tarefaColetorDados() {
-    bool defeitoAnterior     = false;
-    bool manualAnterior      = false;
-    bool alertaTempAnterior  = false;
-
-    const std::string COR_AMARELA  = "\033[1;33m";
-    const std::string COR_VERMELHA = "\033[1;31m";
-    const std::string COR_RESET    = "\033[0m";
-
-    while (rodando_) {
-        RegistroBuffer reg{};
-        if (buffer_.tentarLerMaisRecente(reg)) {
-            std::string textoEvento;
-            int temp = reg.sensores.i_temperatura;
-
-            if (!defeitoAnterior && reg.estados.e_defeito) {
-                if (reg.sensores.i_falha_eletrica)        textoEvento = "FALHA ELETRICA";
-                else if (reg.sensores.i_falha_hidraulica) textoEvento = "FALHA HIDRAULICA";
-                else if (temp > 120)                      textoEvento = "SOBREAQUECIMENTO (>120C)";
-                else                                      textoEvento = "FALHA CRITICA GENERICA";
-            }
-            else if (defeitoAnterior && !reg.estados.e_defeito) {
-                textoEvento = "REARME";
-            }
-            
-            else if (temp > 95 && temp <= 120) {
-                if (!alertaTempAnterior) {
-                    textoEvento = "ALERTA TEMP (>95C)";
-                    alertaTempAnterior = true;
-                }
-            }
-            else {
-                alertaTempAnterior = false; 
-            }
+void Caminhao::replanejarRota(double x0, double y0, int destX, int destY) {
+    // o planejamento roda fora da trava; so a troca da lista eh vista pela GUI
+    std::vector<GradeEspacial::Ponto> novos;
+    if (planejador_) {
+        versaoMapaRota_ = planejador_->mapa().versao();
+        if (PlanejadorRotas::Rota rota = planejador_->planejar(x0, y0, destX, destY)) {
+            novos.assign(rota->begin(), rota->end());
+        }
+    }
+    // a rota termina no centro da celula de chegada; o ultimo trecho vai ao destino exato
+    novos.push_back({static_cast<double>(destX), static_cast<double>(destY)});
 
-            if (textoEvento.empty()) {
-                if (!manualAnterior && reg.comandos.c_man) {
-                    textoEvento = "MODO MANUAL / EMERGENCIA";
-                }
-                else if (manualAnterior && reg.comandos.c_automatico) {
-                    textoEvento = "MODO AUTO";
-                }
-            }
+    std::lock_guard<std::mutex> l(mtxWaypoints_);
+    waypoints_.swap(novos);
+    proximoWaypoint_ = 0;
+}
 
-            defeitoAnterior = reg.estados.e_defeito;
-            manualAnterior  = reg.comandos.c_man;
+std::size_t Caminhao::copiarRestoDaRota(std::vector<GradeEspacial::Ponto>& out) const {
+    out.clear();
+    {
+        std::lock_guard<std::mutex> l(mtxRota_);
+        if (!rota_definida_) return 0;
+    }
+    std::lock_guard<std::mutex> l(mtxWaypoints_);
+    if (proximoWaypoint_ < waypoints_.size()) {
+        out.assign(waypoints_.begin() + static_cast<std::ptrdiff_t>(proximoWaypoint_), waypoints_.end());
+    }
+    return out.size();
+}
 
-            std::cout << (reg.estados.e_defeito ? COR_VERMELHA : "") 
-                      << "[Caminhao " << id_ << "] "
-                      << "x=" << reg.sensores.i_posicao_x << " "
-                      << "y=" << reg.sensores.i_posicao_y << " "
-                      << "def=" << reg.estados.e_defeito
-                      << (textoEvento.empty() ? "" : (" | " + textoEvento)) 
-                      << (reg.estados.e_defeito ? COR_RESET : "") << "\n";
+bool Caminhao::restoDaRotaLivre(const MapaMina::Grade& grade, double px, double py) const {
+    GradeEspacial::Ponto anterior{px, py};
+    for (std::size_t i = proximoWaypoint_; i < waypoints_.size(); ++i) {
+        if (!PlanejadorRotas::segmentoLivre(grade, anterior, waypoints_[i])) return false;
+        anterior = waypoints_[i];
+    }
+    return true;
+}
 
-            {
-                std::lock_guard<std::mutex> lock(mtxLog_);
-                if (arquivoLog_.is_open()) {
-                    arquivoLog_ << reg.tempoSimulacao_s << ";" << id_ << ";"
-                                << estadoToString(reg.estado) << ";"
-                                << reg.estados.e_defeito << ";" << reg.estados.e_automatico << ";"
-                                << reg.sensores.i_posicao_x << ";" << reg.sensores.i_posicao_y << ";"
-                                << reg.sensores.i_angulo_x << ";" << reg.sensores.i_temperatura << ";"
-                                << reg.atuadores.o_aceleracao << ";" << reg.atuadores.o_direcao << ";"
-                                << textoEvento << "\n";
-                    arquivoLog_.flush(); 
-                }
+void Caminhao::tarefaColetorDados() {
+    bool& defeitoAnterior    = coletorDefeitoAnterior_;
+    bool& manualAnterior     = coletorManualAnterior_;
+    bool& alertaTempAnterior = coletorAlertaTempAnterior_;
+
+    RegistroBuffer reg{};
+    if (buffer_.tentarLerMaisRecente(reg)) {
+        EventoTelemetria evento = EventoTelemetria::Nenhum;
+        int temp = reg.sensores.i_temperatura;
+
+        if (!defeitoAnterior && reg.estados.e_defeito) {
+            if (reg.sensores.i_falha_eletrica)        evento = EventoTelemetria::FalhaEletrica;
+            else if (reg.sensores.i_falha_hidraulica) evento = EventoTelemetria::FalhaHidraulica;
+            else if (temp > 120)                      evento = EventoTelemetria::Sobreaquecimento;
+            else                                      evento = EventoTelemetria::FalhaCriticaGenerica;
+        }
+        else if (defeitoAnterior && !reg.estados.e_defeito) {
+            evento = EventoTelemetria::Rearme;
+        }
+        
+        else if (temp > 95 && temp <= 120) {
+            if (!alertaTempAnterior) {
+                evento = EventoTelemetria::AlertaTemperatura;
+                alertaTempAnterior = true;
             }
-            
-            if (mqtt_) {
-                std::string json = "{ \"id\": " + std::to_string(id_) + 
-                ", \"x\": " + std::to_string(reg.sensores.i_posicao_x) +
-                ", \"y\": " + std::to_string(reg.sensores.i_posicao_y) +
-                ", \"temp\": " + std::to_string(reg.sensores.i_temperatura) + 
-                ", \"defeito\": " + (reg.estados.e_defeito ? "true" : "false") +
-                ", \"auto\": " + (reg.estados.e_automatico ? "true" : "false") + " }";
-                mqtt_->publicar("mina/caminhao/" + std::to_string(id_) + "/estado", json);
+        }
+        else {
+            alertaTempAnterior = false; 
+        }
+
+        if (evento == EventoTelemetria::Nenhum) {
+            if (!manualAnterior && reg.comandos.c_man) {
+                evento = EventoTelemetria::ModoManualEmergencia;
+            }
+            else if (manualAnterior && reg.comandos.c_automatico) {
+                evento = EventoTelemetria::ModoAuto;
             }
         }
-        std::this_thread::sleep_for(500ms);
+        const char* textoEvento = eventoTelemetriaToString(evento);
+
+        defeitoAnterior = reg.estados.e_defeito;
+        manualAnterior  = reg.comandos.c_man;
+
+        // com defeito a linha sai como erro, em vermelho no terminal
+        Log::registrar(reg.estados.e_defeito ? NivelLog::Erro : NivelLog::Info,
+                       "[Caminhao %d] x=%d y=%d def=%d%s%s", id_,
+                       reg.sensores.i_posicao_x, reg.sensores.i_posicao_y, reg.estados.e_defeito ? 1 : 0,
+                       textoEvento[0] ? " | " : "", textoEvento);
+
+        if (telemetria_) {
+            AmostraTelemetria a;
+            a.tempo_s       = reg.tempoSimulacao_s;
+            a.id_caminhao   = id_;
+            a.estado        = reg.estado;
+            a.e_defeito     = reg.estados.e_defeito;
+            a.e_automatico  = reg.estados.e_automatico;
+            a.i_posicao_x   = reg.sensores.i_posicao_x;
+            a.i_posicao_y   = reg.sensores.i_posicao_y;
+            a.i_angulo_x    = reg.sensores.i_angulo_x;
+            a.i_temperatura = reg.sensores.i_temperatura;
+            a.o_aceleracao  = reg.atuadores.o_aceleracao;
+            a.o_direcao     = reg.atuadores.o_direcao;
+            a.evento        = evento;
+            telemetria_->registrar(a); // a gravacao em disco fica com a thread de I/O da frota
+        }
+        
+        if (mqtt_) {
+            ProtocoloMqtt::codificarEstado(ProtocoloMqtt::estadoDe(id_, reg), formatoEstado_, payloadEstado_);
+            mqtt_->publicar(topicoEstado_, payloadEstado_);
+        }
     }
-    std::cout << "[Caminhao " << id_ << "] Tarefa ColetorDados encerrada.\n";
 }
 
 void Caminhao::processarMensagemMqtt(const std::string& topico, const std::string& payload) {
-    (void)topico; 
-    std::cout << "[MQTT Recv " << id_ << "] " << payload << std::endl;
+    ProtocoloMqtt::Comando cmd;
+    if (!ProtocoloMqtt::decodificarComando(payload, cmd)) {
+        Log::aviso("[MQTT Recv %d] Comando nao reconhecido (%zu bytes)", id_, payload.size());
+        return;
+    }
 
-    if (payload.rfind("ROTA:", 0) == 0) {
-        int x1, y1, x2, y2;
-        if (std::sscanf(payload.c_str() + 5, "%d,%d,%d,%d", &x1, &y1, &x2, &y2) == 4) {
-            definirRota(x1, y1, x2, y2);
-        }
+    // log e sessao sempre na forma de texto, mesmo quando o comando chega em binario
+    std::string texto;
+    ProtocoloMqtt::codificarComando(cmd, ProtocoloMqtt::Formato::Json, texto);
+    Log::info("[MQTT Recv %d] %s", id_, texto.c_str());
+
+    if (gravador_) {
+        gravador_->registrar(TipoEntradaSessao::Mqtt, id_, topico + " " + texto);
+        gravador_->registrar(TipoEntradaSessao::Comando, id_, texto);
     }
-    else if (payload == "CMD:AUTO")   comandarAutomatico();
-    else if (payload == "CMD:MANUAL") comandarManual();
-    else if (payload == "CMD:REARME") comandarRearme();
-}
\ No newline at end of file
+    aplicarComando(cmd);
+}
+
+bool Caminhao::aplicarComando(const std::string& comando) {
+    ProtocoloMqtt::Comando cmd;
+    return ProtocoloMqtt::decodificarComando(comando, cmd) && aplicarComando(cmd);
+}
+
+bool Caminhao::aplicarComando(const ProtocoloMqtt::Comando& c) {
+    using ProtocoloMqtt::CodigoComando;
+    switch (c.codigo) {
+        case CodigoComando::Automatico: comandarAutomatico();              return true;
+        case CodigoComando::Manual:     comandarManual();                  return true;
+        case CodigoComando::Rearme:     comandarRearme();                  return true;
+        // conducao manual com o estado da tecla: CMD:ACELERA:1 ao apertar, CMD:ACELERA:0 ao soltar
+        case CodigoComando::Acelera:    setComandoAcelerar(c.valor != 0);  return true;
+        case CodigoComando::Direita:    setComandoDireita(c.valor != 0);   return true;
+        case CodigoComando::Esquerda:   setComandoEsquerda(c.valor != 0);  return true;
+        case CodigoComando::Rota:       definirRota(c.x1, c.y1, c.x2, c.y2); return true;
+        default:                        return false;
+    }
+}
+
+void Caminhao::definirFormatoEstado(ProtocoloMqtt::Formato formato) {
+    formatoEstado_ = formato;
+}
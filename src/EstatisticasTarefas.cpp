@@ -0,0 +1,117 @@
+// src/EstatisticasTarefas.cpp
+#include "EstatisticasTarefas.hpp"
+
+#include <cstdio>
+
+namespace {
+    std::uint64_t microssegundos(std::chrono::steady_clock::duration d) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        return us > 0 ? static_cast<std::uint64_t>(us) : 0;
+    }
+}
+
+const char* tipoTarefaToString(TipoTarefa tipo) {
+    switch (tipo) {
+        case TipoTarefa::TratamentoSensores:     return "tratamento_sensores";
+        case TipoTarefa::LogicaComando:          return "logica_comando";
+        case TipoTarefa::MonitoramentoFalhas:    return "monitoramento_falhas";
+        case TipoTarefa::ControleNavegacao:      return "controle_navegacao";
+        case TipoTarefa::PlanejamentoRota:       return "planejamento_rota";
+        case TipoTarefa::ColetorDados:           return "coletor_dados";
+        case TipoTarefa::MonitoramentoSeguranca: return "monitoramento_seguranca";
+        case TipoTarefa::FisicaFrota:            return "fisica_frota";
+        case TipoTarefa::PublicacaoFrota:        return "publicacao_frota";
+        case TipoTarefa::Quantidade:             break;
+    }
+    return "desconhecida";
+}
+
+void EstatisticasTarefa::registrarCiclo(Relogio::time_point prazo, Relogio::time_point inicio,
+                                        Relogio::time_point fim, Relogio::time_point inicioAnterior,
+                                        Relogio::duration periodoNominal, bool primeiroCiclo) {
+    if (!primeiroCiclo) periodo_us_.registrar(microssegundos(inicio - inicioAnterior));
+    execucao_us_.registrar(microssegundos(fim - inicio));
+    jitter_us_.registrar(microssegundos(inicio - prazo));
+    if (fim > prazo + periodoNominal) estouros_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EstatisticasTarefa::zerar() {
+    periodo_us_.zerar();
+    execucao_us_.zerar();
+    jitter_us_.zerar();
+    estouros_.store(0, std::memory_order_relaxed);
+}
+
+std::vector<ResumoTarefa> EstatisticasFrota::resumo() const {
+    std::vector<ResumoTarefa> out;
+    for (std::size_t i = 0; i < porTipo_.size(); ++i) {
+        const EstatisticasTarefa& e = porTipo_[i];
+        if (e.execucao().contagem() == 0) continue;
+
+        ResumoTarefa r;
+        r.tarefa           = tipoTarefaToString(static_cast<TipoTarefa>(i));
+        r.ciclos           = e.execucao().contagem();
+        r.estouros         = e.estouros();
+        r.periodoMedio_us  = e.periodo().media();
+        r.periodoP50_us    = e.periodo().percentil(0.50);
+        r.periodoP99_us    = e.periodo().percentil(0.99);
+        r.periodoMax_us    = e.periodo().maximo();
+        r.execucaoMedia_us = e.execucao().media();
+        r.execucaoP50_us   = e.execucao().percentil(0.50);
+        r.execucaoP99_us   = e.execucao().percentil(0.99);
+        r.execucaoMax_us   = e.execucao().maximo();
+        r.jitterP50_us     = e.jitter().percentil(0.50);
+        r.jitterP99_us     = e.jitter().percentil(0.99);
+        r.jitterMax_us     = e.jitter().maximo();
+        out.push_back(r);
+    }
+    return out;
+}
+
+ResumoLatencia EstatisticasFrota::resumoLatencia() const {
+    const HistogramaLogLinear& h = latenciaSensorAtuador_us_;
+    return ResumoLatencia{h.contagem(), h.media(), h.percentil(0.50), h.percentil(0.99), h.maximo()};
+}
+
+std::string EstatisticasFrota::json() const {
+    std::string s;
+    s += "{\"t\":";
+    s += std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch()).count());
+    s += ",\"tarefas\":[";
+
+    bool primeiro = true;
+    char linha[512];
+    for (const auto& r : resumo()) {
+        int n = std::snprintf(linha, sizeof(linha),
+            "%s{\"tarefa\":\"%s\",\"ciclos\":%llu,\"estouros\":%llu,"
+            "\"periodo_us\":{\"media\":%.1f,\"p50\":%llu,\"p99\":%llu,\"max\":%llu},"
+            "\"execucao_us\":{\"media\":%.1f,\"p50\":%llu,\"p99\":%llu,\"max\":%llu},"
+            "\"jitter_us\":{\"p50\":%llu,\"p99\":%llu,\"max\":%llu}}",
+            primeiro ? "" : ",", r.tarefa.c_str(),
+            static_cast<unsigned long long>(r.ciclos), static_cast<unsigned long long>(r.estouros),
+            r.periodoMedio_us, static_cast<unsigned long long>(r.periodoP50_us),
+            static_cast<unsigned long long>(r.periodoP99_us), static_cast<unsigned long long>(r.periodoMax_us),
+            r.execucaoMedia_us, static_cast<unsigned long long>(r.execucaoP50_us),
+            static_cast<unsigned long long>(r.execucaoP99_us), static_cast<unsigned long long>(r.execucaoMax_us),
+            static_cast<unsigned long long>(r.jitterP50_us), static_cast<unsigned long long>(r.jitterP99_us),
+            static_cast<unsigned long long>(r.jitterMax_us));
+        if (n > 0) s.append(linha, static_cast<std::size_t>(n) < sizeof(linha) ? static_cast<std::size_t>(n) : sizeof(linha) - 1);
+        primeiro = false;
+    }
+    s += "]";
+
+    ResumoLatencia lat = resumoLatencia();
+    int n = std::snprintf(linha, sizeof(linha),
+        ",\"latencia_sensor_atuador_us\":{\"amostras\":%llu,\"media\":%.1f,\"p50\":%llu,\"p99\":%llu,\"max\":%llu}}",
+        static_cast<unsigned long long>(lat.amostras), lat.media_us,
+        static_cast<unsigned long long>(lat.p50_us), static_cast<unsigned long long>(lat.p99_us),
+        static_cast<unsigned long long>(lat.max_us));
+    if (n > 0) s.append(linha, static_cast<std::size_t>(n) < sizeof(linha) ? static_cast<std::size_t>(n) : sizeof(linha) - 1);
+    return s;
+}
+
+void EstatisticasFrota::zerar() {
+    for (auto& e : porTipo_) e.zerar();
+    latenciaSensorAtuador_us_.zerar();
+}
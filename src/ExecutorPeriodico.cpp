@@ -0,0 +1,165 @@
+// src/ExecutorPeriodico.cpp
+#include "ExecutorPeriodico.hpp"
+
+ExecutorPeriodico::ExecutorPeriodico(std::size_t numThreads)
+    : proximoId_(1),
+      rodando_(true)
+{
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1; // plataforma nao informou os nucleos
+    }
+
+    trabalhadores_.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        trabalhadores_.emplace_back(&ExecutorPeriodico::lacoTrabalhador, this);
+    }
+}
+
+ExecutorPeriodico::~ExecutorPeriodico() {
+    parar();
+}
+
+ExecutorPeriodico::IdTarefa ExecutorPeriodico::registrar(Funcao funcao, std::chrono::milliseconds periodo,
+                                                        EstatisticasTarefa* estatisticas) {
+    IdTarefa id;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        id = proximoId_++;
+
+        Tarefa t;
+        t.funcao  = std::move(funcao);
+        t.periodo = periodo;
+        t.estatisticas = estatisticas;
+        t.prazoAgendado = Relogio::now();
+        agenda_.push(Agendamento{t.prazoAgendado, id});
+        tarefas_.emplace(id, std::move(t));
+    }
+    cvTrabalho_.notify_one();
+    return id;
+}
+
+void ExecutorPeriodico::disparar(IdTarefa id) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        auto it = tarefas_.find(id);
+        if (it == tarefas_.end() || it->second.cancelada) return;
+
+        Tarefa& tarefa = it->second;
+        if (tarefa.executando) {
+            tarefa.disparoPendente = true;
+            return;
+        }
+
+        Relogio::time_point agora = Relogio::now();
+        if (tarefa.prazoAgendado <= agora) return; // ja esta vencida no heap
+
+        // a entrada antiga fica no heap e eh descartada por ter outro prazo
+        tarefa.prazoAgendado = agora;
+        agenda_.push(Agendamento{agora, id});
+    }
+    cvTrabalho_.notify_one();
+}
+
+void ExecutorPeriodico::cancelar(IdTarefa id) {
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    auto it = tarefas_.find(id);
+    if (it == tarefas_.end()) return;
+
+    // marca como cancelada para nao ser reagendada e espera a execucao atual acabar
+    it->second.cancelada = true;
+    cvConclusao_.wait(lock, [&] { return !it->second.executando; });
+    tarefas_.erase(it);
+    // a entrada que ainda estiver no heap eh descartada quando chegar ao topo
+}
+
+void ExecutorPeriodico::parar() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!rodando_) return;
+        rodando_ = false;
+    }
+    cvTrabalho_.notify_all();
+
+    for (auto& th : trabalhadores_) {
+        if (th.joinable()) th.join();
+    }
+}
+
+std::size_t ExecutorPeriodico::numThreads() const {
+    return trabalhadores_.size();
+}
+
+std::size_t ExecutorPeriodico::tarefasRegistradas() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return tarefas_.size();
+}
+
+void ExecutorPeriodico::lacoTrabalhador() {
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    while (rodando_) {
+        if (agenda_.empty()) {
+            cvTrabalho_.wait(lock);
+            continue;
+        }
+
+        Agendamento proximo = agenda_.top();
+        if (Relogio::now() < proximo.prazo) {
+            // dorme ate o prazo do topo, ou ate alguem registrar algo mais urgente
+            cvTrabalho_.wait_until(lock, proximo.prazo);
+            continue;
+        }
+        agenda_.pop();
+
+        auto it = tarefas_.find(proximo.id);
+        if (it == tarefas_.end() || it->second.cancelada) {
+            continue; // tarefa removida depois de agendada
+        }
+        if (it->second.executando || it->second.prazoAgendado != proximo.prazo) {
+            continue; // entrada substituida por um disparo
+        }
+
+        // referencias de unordered_map continuam validas ate o erase, que so ocorre
+        // em cancelar() depois de executando voltar a false
+        Tarefa& tarefa = it->second;
+        tarefa.executando = true;
+
+        // o topo mudou, outro trabalhador pode assumir o proximo prazo
+        if (!agenda_.empty()) cvTrabalho_.notify_one();
+
+        lock.unlock();
+        if (tarefa.estatisticas) {
+            Relogio::time_point inicio = Relogio::now();
+            tarefa.funcao();
+            Relogio::time_point fim = Relogio::now();
+
+            tarefa.estatisticas->registrarCiclo(proximo.prazo, inicio, fim, tarefa.inicioAnterior,
+                                                tarefa.periodo, !tarefa.jaExecutou);
+            tarefa.inicioAnterior = inicio;
+            tarefa.jaExecutou     = true;
+        } else {
+            tarefa.funcao();
+        }
+        lock.lock();
+
+        tarefa.executando = false;
+
+        if (tarefa.cancelada) {
+            cvConclusao_.notify_all();
+            continue;
+        }
+
+        // taxa fixa: o proximo prazo conta a partir do prazo anterior
+        // se a execucao estourou o periodo, reagenda a partir de agora sem rajada de recuperacao
+        Relogio::time_point novoPrazo = proximo.prazo + tarefa.periodo;
+        Relogio::time_point agora = Relogio::now();
+        if (novoPrazo < agora || tarefa.disparoPendente) novoPrazo = agora;
+        tarefa.disparoPendente = false;
+
+        tarefa.prazoAgendado = novoPrazo;
+        agenda_.push(Agendamento{novoPrazo, proximo.id});
+    }
+}
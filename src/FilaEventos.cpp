@@ -1,36 +1,205 @@
 // src/FilaEventos.cpp
 #include "FilaEventos.hpp"
 
-// posta um evento na fila e acorda uma thread que estiver esperando
-void FilaEventos::postar(const Evento& evento) {
+#include <cstdint>
+
+namespace {
+    std::size_t proximaPotenciaDeDois(std::size_t n) {
+        std::size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+FilaEventos::FilaEventos(std::size_t capacidade, PoliticaEstouro politica)
+    : celulas_(),
+      mascara_(proximaPotenciaDeDois(capacidade) - 1),
+      politica_(politica),
+      cauda_(0),
+      cabeca_(0),
+      descartados_(0),
+      consumidoresEsperando_(0),
+      produtoresEsperando_(0)
+{
+    celulas_.reset(new Celula[mascara_ + 1]);
+    for (std::size_t i = 0; i <= mascara_; ++i) {
+        celulas_[i].sequencia.store(i, std::memory_order_relaxed);
+    }
+}
+
+// anel limitado com numero de sequencia por celula: o produtor reserva a posicao com CAS
+// na cauda e so publica a celula depois de copiar o evento, o consumidor faz o mesmo na
+// cabeca; a politica DescartarMaisAntigo faz o produtor retirar pela cabeca tambem
+bool FilaEventos::tentarEnfileirar(const Evento& evento) {
+    std::size_t pos = cauda_.load(std::memory_order_relaxed);
+    for (;;) {
+        Celula& c = celulas_[pos & mascara_];
+        std::size_t seq = c.sequencia.load(std::memory_order_acquire);
+        std::intptr_t dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (dif == 0) {
+            if (cauda_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                c.evento = evento;
+                c.sequencia.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false; // cheia
+        } else {
+            pos = cauda_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool FilaEventos::tentarDesenfileirar(Evento& out) {
+    std::size_t pos = cabeca_.load(std::memory_order_relaxed);
+    for (;;) {
+        Celula& c = celulas_[pos & mascara_];
+        std::size_t seq = c.sequencia.load(std::memory_order_acquire);
+        std::intptr_t dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+        if (dif == 0) {
+            if (cabeca_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                out = c.evento;
+                c.sequencia.store(pos + mascara_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false; // vazia
+        } else {
+            pos = cabeca_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool FilaEventos::temEvento() const {
+    std::size_t pos = cabeca_.load(std::memory_order_relaxed);
+    return celulas_[pos & mascara_].sequencia.load(std::memory_order_acquire) == pos + 1;
+}
+
+bool FilaEventos::temEspaco() const {
+    std::size_t pos = cauda_.load(std::memory_order_relaxed);
+    std::size_t seq = celulas_[pos & mascara_].sequencia.load(std::memory_order_acquire);
+    return static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) >= 0;
+}
+
+// o contador de espera e a fence formam o par com a fence do outro lado:
+// ou quem posta ve o consumidor esperando, ou o consumidor ve o evento antes de dormir
+void FilaEventos::acordarConsumidor() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumidoresEsperando_.load(std::memory_order_relaxed) > 0) {
+        { std::lock_guard<std::mutex> lock(mtx_); }
+        cvEvento_.notify_one();
+    }
+}
+
+void FilaEventos::acordarProdutores() {
+    if (politica_ != PoliticaEstouro::Bloquear) return;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (produtoresEsperando_.load(std::memory_order_relaxed) > 0) {
+        { std::lock_guard<std::mutex> lock(mtx_); }
+        cvEspaco_.notify_all();
+    }
+}
+
+bool FilaEventos::esperarEvento(const std::chrono::steady_clock::time_point* limite) {
+    consumidoresEsperando_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool ok;
     {
-        std::lock_guard<std::mutex> lock(mtx_);
-        fila_.push(evento);
+        std::unique_lock<std::mutex> lock(mtx_);
+        auto pronto = [this] { return temEvento(); };
+        if (limite) {
+            ok = cvEvento_.wait_until(lock, *limite, pronto);
+        } else {
+            cvEvento_.wait(lock, pronto);
+            ok = true;
+        }
     }
-    cv_.notify_one();
+    consumidoresEsperando_.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+}
+
+// posta um evento na fila e acorda o consumidor se ele estiver esperando
+bool FilaEventos::postar(const Evento& evento) {
+    while (!tentarEnfileirar(evento)) {
+        if (politica_ == PoliticaEstouro::DescartarNovo) {
+            descartados_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (politica_ == PoliticaEstouro::DescartarMaisAntigo) {
+            Evento velho{};
+            if (tentarDesenfileirar(velho)) {
+                descartados_.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        // Bloquear: dorme ate o consumidor liberar alguma celula
+        produtoresEsperando_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cvEspaco_.wait(lock, [this] { return temEspaco(); });
+        }
+        produtoresEsperando_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    acordarConsumidor();
+    return true;
 }
 
 // espera ate existir pelo menos um evento na fila e devolve o primeiro
 Evento FilaEventos::esperarProximo() {
-    std::unique_lock<std::mutex> lock(mtx_);
-    cv_.wait(lock, [this] { return !fila_.empty(); });
-    Evento ev = fila_.front();
-    fila_.pop();
+    Evento ev{};
+    while (!tentarRetirar(ev)) {
+        esperarEvento(nullptr);
+    }
     return ev;
 }
 
+bool FilaEventos::esperarProximo(Evento& out, std::chrono::milliseconds espera) {
+    const auto limite = std::chrono::steady_clock::now() + espera;
+    while (!tentarRetirar(out)) {
+        if (!esperarEvento(&limite)) {
+            return tentarRetirar(out);
+        }
+    }
+    return true;
+}
+
 // tenta pegar um evento sem bloquear, retorna false se a fila estiver vazia
 bool FilaEventos::tentarRetirar(Evento& out) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    if (fila_.empty()) {
+    if (!tentarDesenfileirar(out)) {
         return false;
     }
-    out = fila_.front();
-    fila_.pop();
+    acordarProdutores();
     return true;
 }
 
+std::size_t FilaEventos::drenar(std::vector<Evento>& lote, std::size_t maximo) {
+    lote.clear();
+    Evento ev{};
+    while (lote.size() < maximo && tentarDesenfileirar(ev)) {
+        lote.push_back(ev);
+    }
+    if (!lote.empty()) acordarProdutores();
+    return lote.size();
+}
+
+std::size_t FilaEventos::drenar(std::vector<Evento>& lote, std::size_t maximo,
+                                std::chrono::milliseconds espera) {
+    const auto limite = std::chrono::steady_clock::now() + espera;
+    for (;;) {
+        std::size_t n = drenar(lote, maximo);
+        if (n > 0 || maximo == 0) return n;
+        if (!esperarEvento(&limite)) return drenar(lote, maximo);
+    }
+}
+
 std::size_t FilaEventos::tamanho() const {
-    std::lock_guard<std::mutex> lock(mtx_);
-    return fila_.size();
-}
\ No newline at end of file
+    std::size_t cabeca = cabeca_.load(std::memory_order_acquire);
+    std::size_t cauda  = cauda_.load(std::memory_order_acquire);
+    if (cauda <= cabeca) return 0;
+    std::size_t n = cauda - cabeca;
+    return n > mascara_ + 1 ? mascara_ + 1 : n;
+}
@@ -0,0 +1,247 @@
+// src/FisicaFrota.cpp
+#include "FisicaFrota.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FISICA_FROTA_AVX2 1
+#endif
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr int DIR_MIN = -180;
+    constexpr int DIR_MAX =  180;
+}
+
+FisicaFrota::FisicaFrota()
+    : tabCos_(DIR_MAX - DIR_MIN + 1),
+      tabSin_(DIR_MAX - DIR_MIN + 1)
+{
+    // mesma expressao usada antes no controle: rad = ang * PI / 180
+    for (int d = DIR_MIN; d <= DIR_MAX; ++d) {
+        double rad = static_cast<double>(d) * PI / 180.0;
+        tabCos_[static_cast<std::size_t>(d - DIR_MIN)] = std::cos(rad);
+        tabSin_[static_cast<std::size_t>(d - DIR_MIN)] = std::sin(rad);
+    }
+}
+
+std::size_t FisicaFrota::adicionar(double pos_x, double pos_y, double ang_deg, double temp_C) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!livres_.empty()) {
+        std::pop_heap(livres_.begin(), livres_.end(), std::greater<std::size_t>());
+        const std::size_t i = livres_.back();
+        livres_.pop_back();
+        pos_x_[i]   = pos_x;
+        pos_y_[i]   = pos_y;
+        vel_[i]     = 0.0;
+        ang_deg_[i] = ang_deg;
+        temp_C_[i]  = temp_C;
+        acel_[i]    = 0;
+        dir_[i]     = 0;
+        livre_[i]   = 0;
+        return i;
+    }
+
+    pos_x_.push_back(pos_x);
+    pos_y_.push_back(pos_y);
+    vel_.push_back(0.0);
+    ang_deg_.push_back(ang_deg);
+    temp_C_.push_back(temp_C);
+    acel_.push_back(0);
+    dir_.push_back(0);
+    livre_.push_back(0);
+    return pos_x_.size() - 1;
+}
+
+void FisicaFrota::liberar(std::size_t i) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (i >= livre_.size() || livre_[i]) return;
+    livre_[i] = 1;
+    acel_[i]  = 0;
+    dir_[i]   = 0;
+    vel_[i]   = 0.0;
+
+    if (i + 1 < livre_.size()) {
+        livres_.push_back(i);
+        std::push_heap(livres_.begin(), livres_.end(), std::greater<std::size_t>());
+        return;
+    }
+
+    // o ultimo indice saiu: os arrays encolhem ate o ultimo em uso, e os livres que ficaram
+    // alem do fim saem do heap (raro, e so na saida de caminhoes)
+    std::size_t n = livre_.size();
+    while (n > 0 && livre_[n - 1]) --n;
+    pos_x_.resize(n);
+    pos_y_.resize(n);
+    vel_.resize(n);
+    ang_deg_.resize(n);
+    temp_C_.resize(n);
+    acel_.resize(n);
+    dir_.resize(n);
+    livre_.resize(n);
+    livres_.erase(std::remove_if(livres_.begin(), livres_.end(), [n](std::size_t k) { return k >= n; }),
+                  livres_.end());
+    std::make_heap(livres_.begin(), livres_.end(), std::greater<std::size_t>());
+}
+
+FisicaFrota::EstadoFisico FisicaFrota::ler(std::size_t i) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return EstadoFisico{pos_x_[i], pos_y_[i], vel_[i], ang_deg_[i], temp_C_[i]};
+}
+
+double FisicaFrota::velocidade(std::size_t i) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return vel_[i];
+}
+
+void FisicaFrota::reposicionar(std::size_t i, double pos_x, double pos_y, double ang_deg) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pos_x_[i]   = pos_x;
+    pos_y_[i]   = pos_y;
+    vel_[i]     = 0.0;
+    ang_deg_[i] = ang_deg;
+}
+
+void FisicaFrota::zerarVelocidade(std::size_t i) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    vel_[i] = 0.0;
+}
+
+void FisicaFrota::restaurar(std::size_t i, const EstadoFisico& e) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pos_x_[i]   = e.pos_x;
+    pos_y_[i]   = e.pos_y;
+    vel_[i]     = e.vel;
+    ang_deg_[i] = e.ang_deg;
+    temp_C_[i]  = e.temp_C;
+}
+
+void FisicaFrota::definirAtuacao(std::size_t i, int aceleracao, int direcao) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    acel_[i] = aceleracao;
+    dir_[i]  = direcao;
+}
+
+std::size_t FisicaFrota::tamanho() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return pos_x_.size() - livres_.size();
+}
+
+bool FisicaFrota::usandoAvx2() {
+#ifdef FISICA_FROTA_AVX2
+    static const bool suportado = __builtin_cpu_supports("avx2");
+    return suportado;
+#else
+    return false;
+#endif
+}
+
+void FisicaFrota::integrar(double dt) {
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    const std::size_t n = pos_x_.size();
+    std::size_t feitos = 0;
+    if (usandoAvx2()) feitos = integrarAvx2(n, dt);
+    integrarEscalar(feitos, n, dt); // sobra que nao completa um vetor de 4
+}
+
+void FisicaFrota::integrarEscalar(std::size_t inicio, std::size_t fim, double dt) {
+    for (std::size_t i = inicio; i < fim; ++i) {
+        if (livre_[i]) continue;
+        const int dir = dir_[i];
+        ang_deg_[i] = static_cast<double>(dir);
+
+        double c, s;
+        if (dir >= DIR_MIN && dir <= DIR_MAX) {
+            c = tabCos_[static_cast<std::size_t>(dir - DIR_MIN)];
+            s = tabSin_[static_cast<std::size_t>(dir - DIR_MIN)];
+        } else {
+            double rad = ang_deg_[i] * PI / 180.0;
+            c = std::cos(rad);
+            s = std::sin(rad);
+        }
+
+        double a = (static_cast<double>(acel_[i]) / 100.0) * A_MAX;
+
+        double v = vel_[i];
+        v += a * dt;
+        v -= FRICCAO * v * dt;
+        vel_[i] = v;
+
+        pos_x_[i] += v * c * dt;
+        pos_y_[i] += v * s * dt;
+
+        double alvoTemp = TEMP_BASE_C + 2.0 * std::fabs(v);
+        temp_C_[i] += 0.5 * (alvoTemp - temp_C_[i]) * dt;
+    }
+}
+
+#ifdef FISICA_FROTA_AVX2
+// mesmas operacoes e mesma ordem do caminho escalar, sem FMA, para dar resultados identicos
+__attribute__((target("avx2")))
+std::size_t FisicaFrota::integrarAvx2(std::size_t n, double dt) {
+    const __m256d vDt    = _mm256_set1_pd(dt);
+    const __m256d vCem   = _mm256_set1_pd(100.0);
+    const __m256d vAmax  = _mm256_set1_pd(A_MAX);
+    const __m256d vFric  = _mm256_set1_pd(FRICCAO);
+    const __m256d vBase  = _mm256_set1_pd(TEMP_BASE_C);
+    const __m256d vDois  = _mm256_set1_pd(2.0);
+    const __m256d vMeio  = _mm256_set1_pd(0.5);
+    const __m256d vSinal = _mm256_set1_pd(-0.0);
+    const __m128i vMin   = _mm_set1_epi32(DIR_MIN);
+    const __m128i vMax   = _mm_set1_epi32(DIR_MAX);
+    const __m128i vDesl  = _mm_set1_epi32(-DIR_MIN);
+    const __m256d vTodos = _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); // mascara do gather com as 4 posicoes
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i dir = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&dir_[i]));
+
+        // direcao fora da tabela ou indice livre no grupo sao casos raros, esse grupo vai
+        // pelo caminho escalar
+        std::uint32_t livres;
+        std::memcpy(&livres, &livre_[i], sizeof(livres));
+        __m128i fora = _mm_or_si128(_mm_cmplt_epi32(dir, vMin), _mm_cmpgt_epi32(dir, vMax));
+        if (livres != 0 || _mm_movemask_epi8(fora) != 0) {
+            integrarEscalar(i, i + 4, dt);
+            continue;
+        }
+
+        __m128i idx = _mm_add_epi32(dir, vDesl);
+        __m256d c = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tabCos_.data(), idx, vTodos, 8);
+        __m256d s = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tabSin_.data(), idx, vTodos, 8);
+
+        _mm256_storeu_pd(&ang_deg_[i], _mm256_cvtepi32_pd(dir));
+
+        __m128i acelI = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&acel_[i]));
+        __m256d a = _mm256_mul_pd(_mm256_div_pd(_mm256_cvtepi32_pd(acelI), vCem), vAmax);
+
+        __m256d v = _mm256_loadu_pd(&vel_[i]);
+        v = _mm256_add_pd(v, _mm256_mul_pd(a, vDt));
+        v = _mm256_sub_pd(v, _mm256_mul_pd(_mm256_mul_pd(vFric, v), vDt));
+        _mm256_storeu_pd(&vel_[i], v);
+
+        __m256d px = _mm256_loadu_pd(&pos_x_[i]);
+        __m256d py = _mm256_loadu_pd(&pos_y_[i]);
+        px = _mm256_add_pd(px, _mm256_mul_pd(_mm256_mul_pd(v, c), vDt));
+        py = _mm256_add_pd(py, _mm256_mul_pd(_mm256_mul_pd(v, s), vDt));
+        _mm256_storeu_pd(&pos_x_[i], px);
+        _mm256_storeu_pd(&pos_y_[i], py);
+
+        __m256d absV = _mm256_andnot_pd(vSinal, v);
+        __m256d alvo = _mm256_add_pd(vBase, _mm256_mul_pd(vDois, absV));
+        __m256d t    = _mm256_loadu_pd(&temp_C_[i]);
+        t = _mm256_add_pd(t, _mm256_mul_pd(_mm256_mul_pd(vMeio, _mm256_sub_pd(alvo, t)), vDt));
+        _mm256_storeu_pd(&temp_C_[i], t);
+    }
+    return i;
+}
+#else
+std::size_t FisicaFrota::integrarAvx2(std::size_t, double) {
+    return 0;
+}
+#endif
@@ -0,0 +1,18 @@
+// src/GradeEspacial.cpp
+#include "GradeEspacial.hpp"
+
+GradeEspacial::GradeEspacial(double tamanhoCelula)
+    : tamanhoCelula_(tamanhoCelula > 0.0 ? tamanhoCelula : 1.0) {}
+
+void GradeEspacial::reconstruir(const std::vector<Ponto>& pontos) {
+    // os vetores internos sao reaproveitados entre ciclos, sem realocar no regime permanente
+    pontos_.assign(pontos.begin(), pontos.end());
+    ordenados_.clear();
+    ordenados_.reserve(pontos_.size());
+
+    for (std::size_t i = 0; i < pontos_.size(); ++i) {
+        ordenados_.emplace_back(chaveCelula(celula(pontos_[i].x), celula(pontos_[i].y)), i);
+    }
+
+    std::sort(ordenados_.begin(), ordenados_.end());
+}
@@ -0,0 +1,84 @@
+// src/HistogramaLogLinear.cpp
+#include "HistogramaLogLinear.hpp"
+
+HistogramaLogLinear::HistogramaLogLinear()
+    : contagem_(0),
+      soma_(0),
+      maximo_(0)
+{
+    for (auto& f : faixas_) f.store(0, std::memory_order_relaxed);
+}
+
+std::size_t HistogramaLogLinear::indiceFaixa(std::uint64_t valor) {
+    // valores pequenos tem uma faixa por valor
+    if (valor < FAIXAS_POR_GRUPO) return static_cast<std::size_t>(valor);
+
+    const int expoente = 63 - __builtin_clzll(valor); // >= BITS_SUB
+    const std::size_t sub = static_cast<std::size_t>(valor >> (expoente - BITS_SUB)) & (FAIXAS_POR_GRUPO - 1);
+    return static_cast<std::size_t>(expoente - BITS_SUB + 1) * FAIXAS_POR_GRUPO + sub;
+}
+
+std::uint64_t HistogramaLogLinear::limiteSuperior(std::size_t indice) {
+    if (indice < FAIXAS_POR_GRUPO) return indice;
+
+    const std::size_t grupo = indice / FAIXAS_POR_GRUPO;
+    const std::size_t sub   = indice % FAIXAS_POR_GRUPO;
+    const int deslocamento  = static_cast<int>(grupo) - 1; // expoente - BITS_SUB
+    const std::uint64_t inicio = static_cast<std::uint64_t>(FAIXAS_POR_GRUPO + sub) << deslocamento;
+    return inicio + ((std::uint64_t(1) << deslocamento) - 1);
+}
+
+void HistogramaLogLinear::registrar(std::uint64_t valor) {
+    faixas_[indiceFaixa(valor)].fetch_add(1, std::memory_order_relaxed);
+    contagem_.fetch_add(1, std::memory_order_relaxed);
+    soma_.fetch_add(valor, std::memory_order_relaxed);
+
+    std::uint64_t atual = maximo_.load(std::memory_order_relaxed);
+    while (valor > atual &&
+           !maximo_.compare_exchange_weak(atual, valor, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t HistogramaLogLinear::contagem() const {
+    return contagem_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t HistogramaLogLinear::maximo() const {
+    return maximo_.load(std::memory_order_relaxed);
+}
+
+double HistogramaLogLinear::media() const {
+    std::uint64_t n = contagem();
+    if (n == 0) return 0.0;
+    return static_cast<double>(soma_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+std::uint64_t HistogramaLogLinear::percentil(double p) const {
+    // o total vem das proprias faixas para ficar coerente com a varredura
+    std::uint64_t total = 0;
+    for (const auto& f : faixas_) total += f.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    if (p < 0.0) p = 0.0;
+    if (p > 1.0) p = 1.0;
+    std::uint64_t alvo = static_cast<std::uint64_t>(p * static_cast<double>(total - 1)) + 1;
+
+    std::uint64_t acumulado = 0;
+    for (std::size_t i = 0; i < NUM_FAIXAS; ++i) {
+        acumulado += faixas_[i].load(std::memory_order_relaxed);
+        if (acumulado >= alvo) {
+            // a faixa pode ir alem do maior valor visto
+            std::uint64_t limite = limiteSuperior(i);
+            std::uint64_t maxVisto = maximo();
+            return (maxVisto != 0 && limite > maxVisto) ? maxVisto : limite;
+        }
+    }
+    return maximo();
+}
+
+void HistogramaLogLinear::zerar() {
+    for (auto& f : faixas_) f.store(0, std::memory_order_relaxed);
+    contagem_.store(0, std::memory_order_relaxed);
+    soma_.store(0, std::memory_order_relaxed);
+    maximo_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,432 @@
+// src/Log.cpp
+#include "Log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+    using Relogio = std::chrono::steady_clock;
+
+    // sem mensagem nova, a thread de descarga dorme isso entre as varreduras dos aneis
+    constexpr auto PAUSA_DESCARGA    = std::chrono::milliseconds(5);
+    // resumo das repeticoes e das mensagens descartadas
+    constexpr auto PERIODO_RELATORIO = std::chrono::seconds(1);
+
+    const char* COR_AMARELA  = "\033[1;33m";
+    const char* COR_VERMELHA = "\033[1;31m";
+    const char* COR_RESET    = "\033[0m";
+
+    struct Entrada {
+        Relogio::rep  instante;
+        NivelLog      nivel;
+        std::uint16_t tamanho;
+        char          texto[Log::TAM_MENSAGEM];
+    };
+
+    // contadores que so crescem: escrita pela thread dona, leitura pela thread de descarga
+    struct Anel {
+        alignas(64) std::atomic<std::uint64_t> escrita{0};
+        std::atomic<std::uint64_t> descartadas{0};
+        alignas(64) std::atomic<std::uint64_t> leitura{0};
+        std::atomic<bool> abandonado{false};  // a thread dona terminou; sai da lista depois de esvaziar
+        std::array<Entrada, Log::CAPACIDADE_ANEL> entradas;
+    };
+
+    class Registro {
+    public:
+        // nunca destruido: threads que ainda registram durante o encerramento do processo
+        // nao podem encontrar o registro ja destruido
+        static Registro& instancia() {
+            static Registro* r = criar();
+            return *r;
+        }
+
+        static Registro* existente() { return criado_.load(std::memory_order_acquire); }
+
+        Anel* novoAnel() {
+            auto a = std::make_unique<Anel>();
+            Anel* p = a.get();
+            std::lock_guard<std::mutex> lock(mtxAneis_);
+            aneis_.push_back(std::move(a));
+            return p;
+        }
+
+        bool habilitado(NivelLog nivel) const {
+            return static_cast<int>(nivel) >= nivelMinimo_.load(std::memory_order_relaxed);
+        }
+
+        bool configurar(const Log::Configuracao& c) {
+            nivelMinimo_.store(static_cast<int>(c.nivelMinimo), std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mtxSaida_);
+            cores_ = c.cores;
+            if (arquivo_.is_open()) arquivo_.close();
+            if (c.arquivo.empty()) return true;
+            arquivo_.open(c.arquivo, std::ios::out | std::ios::trunc);
+            return arquivo_.is_open();
+        }
+
+        void descarregar() {
+            std::unique_lock<std::mutex> lock(mtxDescarga_);
+            if (!rodando_) return;
+            const std::uint64_t pedido = ++pedidos_;
+            cv_.notify_all();
+            cv_.wait(lock, [&] { return concluidos_ >= pedido || !rodando_; });
+        }
+
+        // ultima descarga, no fim do processo
+        void encerrar() {
+            {
+                std::lock_guard<std::mutex> lock(mtxDescarga_);
+                if (!rodando_) return;
+                rodando_ = false;
+            }
+            cv_.notify_all();
+            if (th_.joinable()) th_.join();
+        }
+
+        Log::Estatisticas estatisticas() const {
+            Log::Estatisticas e;
+            e.escritas    = escritas_.load(std::memory_order_relaxed);
+            e.suprimidas  = suprimidas_.load(std::memory_order_relaxed);
+            e.descartadas = descartadas_.load(std::memory_order_relaxed);
+            return e;
+        }
+
+    private:
+        static Registro* criar() {
+            Registro* r = new Registro();
+            criado_.store(r, std::memory_order_release);
+            return r;
+        }
+
+        struct Repeticao {
+            Relogio::rep  inicio;     // primeira ocorrencia da janela
+            int           vezes;
+            std::uint64_t suprimidas;
+            NivelLog      nivel;
+        };
+
+        Registro()
+            : nivelMinimo_(static_cast<int>(NivelLog::Info)),
+              cores_(true),
+              terminalErro_(::isatty(STDERR_FILENO) != 0),
+              rodando_(true),
+              pedidos_(0),
+              concluidos_(0),
+              descartadasInformadas_(0),
+              inicio_(Relogio::now())
+        {
+            th_ = std::thread(&Registro::laco, this);
+        }
+
+        void laco() {
+            auto proximoRelatorio = Relogio::now() + PERIODO_RELATORIO;
+            for (;;) {
+                std::uint64_t pedido;
+                bool rodando;
+                {
+                    std::lock_guard<std::mutex> lock(mtxDescarga_);
+                    pedido  = pedidos_;
+                    rodando = rodando_;
+                }
+
+                // o pedido foi lido antes da coleta: tudo o que foi registrado antes dele entra nela
+                const bool coletou = coletar();
+                const auto agora = Relogio::now();
+                {
+                    std::lock_guard<std::mutex> lock(mtxSaida_);
+                    if (coletou) escrever();
+                    if (agora >= proximoRelatorio || !rodando) {
+                        relatar(agora.time_since_epoch().count(), !rodando);
+                        proximoRelatorio = agora + PERIODO_RELATORIO;
+                    }
+                    despejar();
+                }
+
+                std::unique_lock<std::mutex> lock(mtxDescarga_);
+                if (pedido > concluidos_) {
+                    concluidos_ = pedido;
+                    cv_.notify_all();
+                }
+                if (!rodando) {
+                    concluidos_ = pedidos_;
+                    cv_.notify_all();
+                    return;
+                }
+                if (!coletou) {
+                    cv_.wait_for(lock, PAUSA_DESCARGA, [&] { return pedidos_ > concluidos_ || !rodando_; });
+                }
+            }
+        }
+
+        // copia o que ha em cada anel para o lote, em ordem de instante
+        bool coletar() {
+            lote_.clear();
+            std::uint64_t descartadas = 0;
+            {
+                std::lock_guard<std::mutex> lock(mtxAneis_);
+                for (auto it = aneis_.begin(); it != aneis_.end();) {
+                    Anel& a = **it;
+                    // lido antes da escrita: abandonado e vazio depois da copia quer dizer vazio de vez
+                    const bool abandonado = a.abandonado.load(std::memory_order_acquire);
+                    std::uint64_t l = a.leitura.load(std::memory_order_relaxed);
+                    const std::uint64_t e = a.escrita.load(std::memory_order_acquire);
+                    for (; l < e; ++l) lote_.push_back(a.entradas[l % Log::CAPACIDADE_ANEL]);
+                    a.leitura.store(l, std::memory_order_release);
+
+                    if (abandonado) {
+                        descartadasAbandonadas_ += a.descartadas.load(std::memory_order_relaxed);
+                        it = aneis_.erase(it);
+                    } else {
+                        descartadas += a.descartadas.load(std::memory_order_relaxed);
+                        ++it;
+                    }
+                }
+            }
+            descartadas_.store(descartadas + descartadasAbandonadas_, std::memory_order_relaxed);
+
+            std::stable_sort(lote_.begin(), lote_.end(),
+                             [](const Entrada& a, const Entrada& b) { return a.instante < b.instante; });
+            return !lote_.empty();
+        }
+
+        // chamadas com mtxSaida_ travado
+        void escrever() {
+            for (const Entrada& e : lote_) {
+                chave_.assign(e.texto, e.tamanho);
+                auto it = repeticoes_.find(chave_);
+                if (it == repeticoes_.end()) {
+                    repeticoes_.emplace(chave_, Repeticao{e.instante, 1, 0, e.nivel});
+                } else {
+                    Repeticao& r = it->second;
+                    if (e.instante - r.inicio > duracaoJanela()) {
+                        resumirRepeticao(chave_, r);
+                        r = Repeticao{e.instante, 1, 0, e.nivel};
+                    } else if (++r.vezes > Log::LIMITE_REPETICOES) {
+                        ++r.suprimidas;
+                        suprimidas_.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                }
+                linha(e.nivel, e.instante, e.texto, e.tamanho);
+            }
+        }
+
+        // fecha as janelas de repeticao vencidas e avisa das mensagens descartadas
+        void relatar(Relogio::rep agora, bool tudo) {
+            for (auto it = repeticoes_.begin(); it != repeticoes_.end();) {
+                if (tudo || agora - it->second.inicio > duracaoJanela()) {
+                    resumirRepeticao(it->first, it->second);
+                    it = repeticoes_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            const std::uint64_t descartadas = descartadas_.load(std::memory_order_relaxed);
+            if (descartadas > descartadasInformadas_) {
+                char texto[96];
+                const int n = std::snprintf(texto, sizeof(texto), "[Log] %llu mensagens descartadas (anel da thread cheio)",
+                                            static_cast<unsigned long long>(descartadas - descartadasInformadas_));
+                linha(NivelLog::Aviso, agora, texto, static_cast<std::size_t>(std::max(n, 0)));
+                descartadasInformadas_ = descartadas;
+            }
+        }
+
+        void resumirRepeticao(const std::string& texto, const Repeticao& r) {
+            if (r.suprimidas == 0) return;
+            std::string s = "[Log] repetida mais " + std::to_string(r.suprimidas) + " vezes: " + texto;
+            linha(r.nivel, Relogio::now().time_since_epoch().count(), s.data(), s.size());
+        }
+
+        void linha(NivelLog nivel, Relogio::rep instante, const char* texto, std::size_t n) {
+            escritas_.fetch_add(1, std::memory_order_relaxed);
+            const bool problema = nivel >= NivelLog::Aviso;
+
+            if (arquivo_.is_open()) {
+                static const char* NOMES[] = {"DEPURACAO", "INFO", "AVISO", "ERRO"};
+                char prefixo[48];
+                const double t_s = std::chrono::duration<double>(Relogio::duration(instante) - inicio_.time_since_epoch()).count();
+                const int p = std::snprintf(prefixo, sizeof(prefixo), "%10.3f %-9s ", t_s, NOMES[static_cast<int>(nivel)]);
+                bufArquivo_.append(prefixo, static_cast<std::size_t>(std::max(p, 0)));
+                bufArquivo_.append(texto, n);
+                bufArquivo_ += '\n';
+                return;
+            }
+
+            std::string& b = problema ? bufErro_ : bufSaida_;
+            const bool cor = cores_ && problema && terminalErro_;
+            if (cor) b += nivel == NivelLog::Erro ? COR_VERMELHA : COR_AMARELA;
+            b.append(texto, n);
+            if (cor) b += COR_RESET;
+            b += '\n';
+        }
+
+        void despejar() {
+            if (!bufArquivo_.empty()) {
+                arquivo_.write(bufArquivo_.data(), static_cast<std::streamsize>(bufArquivo_.size()));
+                arquivo_.flush();
+                bufArquivo_.clear();
+            }
+            if (!bufSaida_.empty()) {
+                std::cout.write(bufSaida_.data(), static_cast<std::streamsize>(bufSaida_.size()));
+                std::cout.flush();
+                bufSaida_.clear();
+            }
+            if (!bufErro_.empty()) {
+                std::cerr.write(bufErro_.data(), static_cast<std::streamsize>(bufErro_.size()));
+                bufErro_.clear();
+            }
+        }
+
+        static Relogio::rep duracaoJanela() {
+            return std::chrono::duration_cast<Relogio::duration>(
+                       std::chrono::duration<double>(Log::JANELA_REPETICOES_S)).count();
+        }
+
+        std::mutex mtxAneis_;
+        std::vector<std::unique_ptr<Anel>> aneis_;
+        std::atomic<int> nivelMinimo_;
+
+        std::mutex mtxSaida_;  // configuracao e buffers de saida
+        std::ofstream arquivo_;
+        bool cores_;
+        bool terminalErro_;
+        std::string bufSaida_, bufErro_, bufArquivo_;
+
+        std::mutex mtxDescarga_;
+        std::condition_variable cv_;
+        bool rodando_;
+        std::uint64_t pedidos_;
+        std::uint64_t concluidos_;
+
+        // so a thread de descarga usa
+        std::vector<Entrada> lote_;
+        std::unordered_map<std::string, Repeticao> repeticoes_;
+        std::string chave_;
+        std::uint64_t descartadasInformadas_;
+        std::uint64_t descartadasAbandonadas_ = 0;
+
+        std::atomic<std::uint64_t> escritas_{0};
+        std::atomic<std::uint64_t> suprimidas_{0};
+        std::atomic<std::uint64_t> descartadas_{0};
+
+        Relogio::time_point inicio_;
+        std::thread th_;
+
+        static std::atomic<Registro*> criado_;
+    };
+
+    std::atomic<Registro*> Registro::criado_{nullptr};
+
+    // anel da thread; o destrutor roda quando a thread termina
+    struct AnelDaThread {
+        Anel* anel = nullptr;
+        ~AnelDaThread() {
+            if (anel) anel->abandonado.store(true, std::memory_order_release);
+            anel = nullptr;
+        }
+    };
+    thread_local AnelDaThread t_anel;
+
+    // descarga final na saida normal do processo (fim do main ou exit)
+    struct Encerramento {
+        ~Encerramento() {
+            if (Registro* r = Registro::existente()) r->encerrar();
+        }
+    };
+    Encerramento g_encerramento;
+}
+
+namespace Log {
+
+bool configurar(const Configuracao& configuracao) {
+    return Registro::instancia().configurar(configuracao);
+}
+
+bool habilitado(NivelLog nivel) {
+    return Registro::instancia().habilitado(nivel);
+}
+
+void registrarV(NivelLog nivel, const char* formato, va_list args) {
+    Registro& r = Registro::instancia();
+    if (!r.habilitado(nivel)) return;
+
+    Anel* a = t_anel.anel;
+    if (!a) a = t_anel.anel = r.novoAnel();
+
+    const std::uint64_t e = a->escrita.load(std::memory_order_relaxed);
+    if (e - a->leitura.load(std::memory_order_acquire) >= CAPACIDADE_ANEL) {
+        a->descartadas.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Entrada& s = a->entradas[e % CAPACIDADE_ANEL];
+    s.instante = Relogio::now().time_since_epoch().count();
+    s.nivel    = nivel;
+    int n = std::vsnprintf(s.texto, TAM_MENSAGEM, formato, args);
+    if (n < 0) n = 0;
+    if (static_cast<std::size_t>(n) >= TAM_MENSAGEM) n = static_cast<int>(TAM_MENSAGEM - 1);
+    while (n > 0 && s.texto[n - 1] == '\n') --n;  // a quebra de linha fica com a descarga
+    s.tamanho = static_cast<std::uint16_t>(n);
+
+    a->escrita.store(e + 1, std::memory_order_release);
+}
+
+void registrar(NivelLog nivel, const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    registrarV(nivel, formato, args);
+    va_end(args);
+}
+
+void depuracao(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    registrarV(NivelLog::Depuracao, formato, args);
+    va_end(args);
+}
+
+void info(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    registrarV(NivelLog::Info, formato, args);
+    va_end(args);
+}
+
+void aviso(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    registrarV(NivelLog::Aviso, formato, args);
+    va_end(args);
+}
+
+void erro(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    registrarV(NivelLog::Erro, formato, args);
+    va_end(args);
+}
+
+void descarregar() {
+    Registro::instancia().descarregar();
+}
+
+Estatisticas estatisticas() {
+    return Registro::instancia().estatisticas();
+}
+
+}
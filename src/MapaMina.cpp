@@ -0,0 +1,90 @@
+// src/MapaMina.cpp
+#include "MapaMina.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+bool MapaMina::Grade::celulaDe(double x, double y, int& cx, int& cy) const {
+    double fx = std::floor((x - x0) / celula);
+    double fy = std::floor((y - y0) / celula);
+    if (!(fx >= 0.0 && fx < nx && fy >= 0.0 && fy < ny)) return false;
+    cx = static_cast<int>(fx);
+    cy = static_cast<int>(fy);
+    return true;
+}
+
+MapaMina::MapaMina(double xMin, double xMax, double yMin, double yMax, double celula, double margem)
+    : xMin_(xMin),
+      xMax_(xMax),
+      yMin_(yMin),
+      yMax_(yMax),
+      celula_(celula),
+      margem_(margem),
+      versao_(0)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    publicar();
+}
+
+std::vector<MapaMina::Obstaculo> MapaMina::obstaculosPadrao() {
+    // a GUI desenha com 4 px por metro e o eixo y para cima:
+    // cava de raio externo 130 px em (-150, +100) px da origem e base do britador de
+    // 160 x 120 px em (+200, -150) px
+    return {
+        Obstaculo::circulo(-37.5, -25.0, 32.5),
+        Obstaculo::retangulo(50.0, 37.5, 40.0, 30.0),
+    };
+}
+
+void MapaMina::definirObstaculos(std::vector<Obstaculo> obstaculos) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    obstaculos_ = std::move(obstaculos);
+    publicar();
+}
+
+void MapaMina::adicionarObstaculo(const Obstaculo& obstaculo) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    obstaculos_.push_back(obstaculo);
+    publicar();
+}
+
+std::shared_ptr<const MapaMina::Grade> MapaMina::grade() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return grade_;
+}
+
+void MapaMina::publicar() {
+    auto g = std::make_shared<Grade>();
+    g->x0     = xMin_;
+    g->y0     = yMin_;
+    g->celula = celula_;
+    g->nx     = static_cast<int>(std::ceil((xMax_ - xMin_) / celula_));
+    g->ny     = static_cast<int>(std::ceil((yMax_ - yMin_) / celula_));
+    g->versao = versao_.load(std::memory_order_relaxed) + 1;
+    g->bloqueada.assign(static_cast<std::size_t>(g->nx) * static_cast<std::size_t>(g->ny), 0);
+
+    // celula bloqueada se o centro dela cai no obstaculo inflado pela margem
+    for (const Obstaculo& o : obstaculos_) {
+        const double extX = (o.forma == Obstaculo::Forma::Circulo ? o.raio : o.largura / 2.0) + margem_;
+        const double extY = (o.forma == Obstaculo::Forma::Circulo ? o.raio : o.altura  / 2.0) + margem_;
+        const int cxIni = std::max(0, static_cast<int>(std::floor((o.cx - extX - g->x0) / celula_)));
+        const int cxFim = std::min(g->nx - 1, static_cast<int>(std::floor((o.cx + extX - g->x0) / celula_)));
+        const int cyIni = std::max(0, static_cast<int>(std::floor((o.cy - extY - g->y0) / celula_)));
+        const int cyFim = std::min(g->ny - 1, static_cast<int>(std::floor((o.cy + extY - g->y0) / celula_)));
+        const double r2 = (o.raio + margem_) * (o.raio + margem_);
+
+        for (int cy = cyIni; cy <= cyFim; ++cy) {
+            for (int cx = cxIni; cx <= cxFim; ++cx) {
+                GradeEspacial::Ponto c = g->centro(cx, cy);
+                double dx = c.x - o.cx;
+                double dy = c.y - o.cy;
+                bool dentro = (o.forma == Obstaculo::Forma::Circulo)
+                    ? dx*dx + dy*dy <= r2
+                    : std::abs(dx) <= extX && std::abs(dy) <= extY;
+                if (dentro) g->bloqueada[static_cast<std::size_t>(g->indice(cx, cy))] = 1;
+            }
+        }
+    }
+    grade_ = std::move(g);
+    versao_.store(grade_->versao, std::memory_order_release);
+}
@@ -0,0 +1,46 @@
+// src/ParticaoMina.cpp
+#include "ParticaoMina.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ParticaoMina::ParticaoMina(int shards, double xMin, double xMax, double margemMigracao, double larguraBorda)
+    : shards_(std::max(shards, 1)),
+      xMin_(xMin),
+      largura_((xMax - xMin) / std::max(shards, 1)),
+      margemMigracao_(margemMigracao),
+      larguraBorda_(larguraBorda)
+{
+}
+
+double ParticaoMina::inicio(int s) const {
+    if (s <= 0) return -std::numeric_limits<double>::infinity();
+    return xMin_ + s * largura_;
+}
+
+double ParticaoMina::fim(int s) const {
+    if (s >= shards_ - 1) return std::numeric_limits<double>::infinity();
+    return xMin_ + (s + 1) * largura_;
+}
+
+int ParticaoMina::shardDe(double x) const {
+    if (shards_ == 1) return 0;
+    double f = std::floor((x - xMin_) / largura_);
+    if (!(f >= 0.0)) return 0;
+    if (f >= shards_ - 1) return shards_ - 1;
+    return static_cast<int>(f);
+}
+
+int ParticaoMina::donoDe(double x, int atual) const {
+    if (atual < 0 || atual >= shards_) return shardDe(x);
+    if (x >= inicio(atual) - margemMigracao_ && x < fim(atual) + margemMigracao_) return atual;
+    return shardDe(x);
+}
+
+void ParticaoMina::vizinhosDe(double x, int dono, std::vector<int>& out) const {
+    out.clear();
+    for (int s = 0; s < shards_; ++s) {
+        if (s != dono && x >= inicio(s) - larguraBorda_ && x < fim(s) + larguraBorda_) out.push_back(s);
+    }
+}
@@ -0,0 +1,288 @@
+// src/PlanejadorRotas.cpp
+#include "PlanejadorRotas.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // custos inteiros (10 reto, 14 diagonal): com float, o erro acumulado em g desfaz os
+    // empates de f e a busca se espalha pelo terreno aberto
+    constexpr std::int32_t CUSTO_RETO     = 10;
+    constexpr std::int32_t CUSTO_DIAGONAL = 14;
+
+    // partida ou chegada dentro de obstaculo (carregar na cava, por exemplo) usam a celula
+    // livre mais proxima ate esta distancia, em celulas
+    constexpr int RAIO_CELULA_LIVRE = 16;
+
+    const int VIZINHOS[8][2] = {
+        { 1, 0}, {-1, 0}, { 0, 1}, { 0, -1},
+        { 1, 1}, { 1, -1}, {-1, 1}, {-1, -1},
+    };
+
+    struct NoAberto {
+        std::int32_t f;
+        std::int32_t h;
+        std::int32_t celula;
+    };
+
+    // estado do A* reaproveitado entre buscas da mesma thread; a marca de geracao evita
+    // limpar os vetores a cada busca
+    struct EscopoBusca {
+        std::vector<std::int32_t>  g;
+        std::vector<std::int32_t>  pai;
+        std::vector<std::uint32_t> marca;
+        std::vector<std::uint8_t>  fechado;
+        std::vector<NoAberto>      abertos;  // heap
+        std::uint32_t geracao = 0;
+
+        void preparar(std::size_t n) {
+            if (marca.size() != n) {
+                g.assign(n, 0);
+                pai.assign(n, -1);
+                marca.assign(n, 0);
+                fechado.assign(n, 0);
+                geracao = 0;
+            }
+            if (++geracao == 0) {
+                std::fill(marca.begin(), marca.end(), 0u);
+                geracao = 1;
+            }
+            abertos.clear();
+        }
+    };
+
+    // menor f primeiro; no empate, o mais perto da chegada (em terreno aberto ha muitos nos
+    // com o mesmo f e isso evita expandir todos) e por fim o indice, para a ordem de expansao
+    // nao depender do heap
+    bool maiorPrioridade(const NoAberto& a, const NoAberto& b) {
+        if (a.f != b.f) return a.f > b.f;
+        if (a.h != b.h) return a.h > b.h;
+        return a.celula > b.celula;
+    }
+
+    std::int32_t octil(int ax, int ay, int bx, int by) {
+        int dx = std::abs(ax - bx);
+        int dy = std::abs(ay - by);
+        return CUSTO_RETO * (std::max(dx, dy) - std::min(dx, dy)) + CUSTO_DIAGONAL * std::min(dx, dy);
+    }
+
+    bool bloqueada(const MapaMina::Grade& g, int cx, int cy) {
+        return g.dentro(cx, cy) && g.bloqueada[static_cast<std::size_t>(g.indice(cx, cy))];
+    }
+
+    bool celulaLivreMaisProxima(const MapaMina::Grade& g, int& cx, int& cy) {
+        if (g.livre(cx, cy)) return true;
+        for (int r = 1; r <= RAIO_CELULA_LIVRE; ++r) {
+            int melhorX = 0, melhorY = 0, melhorD = std::numeric_limits<int>::max();
+            auto testa = [&](int x, int y) {
+                if (!g.livre(x, y)) return;
+                int d = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                if (d < melhorD) { melhorD = d; melhorX = x; melhorY = y; }
+            };
+            for (int x = cx - r; x <= cx + r; ++x) { testa(x, cy - r); testa(x, cy + r); }
+            for (int y = cy - r + 1; y <= cy + r - 1; ++y) { testa(cx - r, y); testa(cx + r, y); }
+            if (melhorD != std::numeric_limits<int>::max()) {
+                cx = melhorX;
+                cy = melhorY;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+PlanejadorRotas::PlanejadorRotas(const MapaMina& mapa, std::size_t capacidadeCache)
+    : mapa_(mapa),
+      capacidadeCache_(capacidadeCache),
+      versaoCache_(0)
+{
+}
+
+PlanejadorRotas::Rota PlanejadorRotas::planejar(double x0, double y0, double x1, double y1) {
+    pedidos_.fetch_add(1, std::memory_order_relaxed);
+
+    std::shared_ptr<const MapaMina::Grade> grade = mapa_.grade();
+    int ox, oy, dx, dy;
+    if (!grade->celulaDe(x0, y0, ox, oy) || !grade->celulaDe(x1, y1, dx, dy)) {
+        semCaminho_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    const std::uint64_t chave = (static_cast<std::uint64_t>(grade->indice(ox, oy)) << 32) |
+                                 static_cast<std::uint32_t>(grade->indice(dx, dy));
+
+    // com grade mais velha que a do cache (mapa trocado no meio do pedido) o cache fica de fora
+    bool usarCache = capacidadeCache_ > 0;
+    if (usarCache) {
+        std::lock_guard<std::mutex> lock(mtxCache_);
+        if (grade->versao > versaoCache_) {
+            lru_.clear();
+            indice_.clear();
+            versaoCache_ = grade->versao;
+        }
+        usarCache = grade->versao == versaoCache_;
+        auto it = usarCache ? indice_.find(chave) : indice_.end();
+        if (it != indice_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            acertos_.fetch_add(1, std::memory_order_relaxed);
+            if (!it->second->rota) semCaminho_.fetch_add(1, std::memory_order_relaxed);
+            return it->second->rota;
+        }
+    }
+
+    // busca fora da trava; dois pedidos iguais ao mesmo tempo buscam os dois, com o mesmo resultado
+    Rota rota = buscar(*grade, grade->indice(ox, oy), grade->indice(dx, dy));
+    if (!rota) semCaminho_.fetch_add(1, std::memory_order_relaxed);
+
+    if (usarCache) {
+        std::lock_guard<std::mutex> lock(mtxCache_);
+        if (grade->versao == versaoCache_ && indice_.find(chave) == indice_.end()) {
+            lru_.push_front({chave, rota});
+            indice_[chave] = lru_.begin();
+            if (lru_.size() > capacidadeCache_) {
+                indice_.erase(lru_.back().chave);
+                lru_.pop_back();
+            }
+        }
+    }
+    return rota;
+}
+
+PlanejadorRotas::Rota PlanejadorRotas::buscar(const MapaMina::Grade& grade, int origem, int destino) const {
+    const auto inicio = std::chrono::steady_clock::now();
+
+    int ox = origem % grade.nx, oy = origem / grade.nx;
+    int dx = destino % grade.nx, dy = destino / grade.nx;
+    if (!celulaLivreMaisProxima(grade, ox, oy) || !celulaLivreMaisProxima(grade, dx, dy)) return nullptr;
+    const bool origemDeslocada = grade.indice(ox, oy) != origem;
+    origem  = grade.indice(ox, oy);
+    destino = grade.indice(dx, dy);
+
+    thread_local EscopoBusca b;
+    b.preparar(grade.bloqueada.size());
+
+    auto abrir = [&](int celula, std::int32_t g, int pai, int cx, int cy) {
+        const std::size_t i = static_cast<std::size_t>(celula);
+        if (b.marca[i] == b.geracao) {
+            if (b.fechado[i] || g >= b.g[i]) return;
+        } else {
+            b.marca[i]   = b.geracao;
+            b.fechado[i] = 0;
+        }
+        b.g[i]   = g;
+        b.pai[i] = pai;
+        const std::int32_t h = octil(cx, cy, dx, dy);
+        b.abertos.push_back({g + h, h, celula});
+        std::push_heap(b.abertos.begin(), b.abertos.end(), maiorPrioridade);
+    };
+
+    abrir(origem, 0, -1, ox, oy);
+    bool achou = false;
+    while (!b.abertos.empty()) {
+        std::pop_heap(b.abertos.begin(), b.abertos.end(), maiorPrioridade);
+        const int atual = b.abertos.back().celula;
+        b.abertos.pop_back();
+
+        const std::size_t ia = static_cast<std::size_t>(atual);
+        if (b.fechado[ia]) continue;
+        b.fechado[ia] = 1;
+        if (atual == destino) {
+            achou = true;
+            break;
+        }
+
+        const int cx = atual % grade.nx;
+        const int cy = atual / grade.nx;
+        for (int v = 0; v < 8; ++v) {
+            const int nx = cx + VIZINHOS[v][0];
+            const int ny = cy + VIZINHOS[v][1];
+            if (!grade.livre(nx, ny)) continue;
+            const bool diagonal = v >= 4;
+            if (diagonal && (!grade.livre(nx, cy) || !grade.livre(cx, ny))) continue;  // nao corta quina
+            abrir(grade.indice(nx, ny), b.g[ia] + (diagonal ? CUSTO_DIAGONAL : CUSTO_RETO), atual, nx, ny);
+        }
+    }
+
+    Rota resultado;
+    if (achou) {
+        std::vector<int> celulas;
+        for (int c = destino; c >= 0; c = b.pai[static_cast<std::size_t>(c)]) celulas.push_back(c);
+        std::reverse(celulas.begin(), celulas.end());
+
+        auto centro = [&](int c) { return grade.centro(c % grade.nx, c / grade.nx); };
+
+        // de cada ancora avanca enquanto a linha de visada continua livre
+        auto pontos = std::make_shared<std::vector<GradeEspacial::Ponto>>();
+        if (origemDeslocada) pontos->push_back(centro(origem));  // primeiro sai do obstaculo
+        std::size_t ancora = 0;
+        while (ancora + 1 < celulas.size()) {
+            std::size_t proximo = ancora + 1;
+            while (proximo + 1 < celulas.size() &&
+                   segmentoLivre(grade, centro(celulas[ancora]), centro(celulas[proximo + 1]))) {
+                ++proximo;
+            }
+            pontos->push_back(centro(celulas[proximo]));
+            ancora = proximo;
+        }
+        if (pontos->empty()) pontos->push_back(centro(destino));
+        resultado = std::move(pontos);
+    }
+
+    buscas_.fetch_add(1, std::memory_order_relaxed);
+    nsBusca_.fetch_add(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - inicio).count()),
+        std::memory_order_relaxed);
+    return resultado;
+}
+
+bool PlanejadorRotas::segmentoLivre(const MapaMina::Grade& grade, const GradeEspacial::Ponto& a,
+                                    const GradeEspacial::Ponto& b) {
+    // travessia de celulas (Amanatides-Woo) em coordenadas de celula; passando exatamente
+    // por uma quina, as duas celulas laterais tambem precisam estar livres
+    const double ax = (a.x - grade.x0) / grade.celula, ay = (a.y - grade.y0) / grade.celula;
+    const double bx = (b.x - grade.x0) / grade.celula, by = (b.y - grade.y0) / grade.celula;
+    int cx = static_cast<int>(std::floor(ax)), cy = static_cast<int>(std::floor(ay));
+    const int ex = static_cast<int>(std::floor(bx)), ey = static_cast<int>(std::floor(by));
+    if (bloqueada(grade, cx, cy)) return false;
+
+    const double ddx = bx - ax, ddy = by - ay;
+    const int passoX = ddx > 0 ? 1 : (ddx < 0 ? -1 : 0);
+    const int passoY = ddy > 0 ? 1 : (ddy < 0 ? -1 : 0);
+    const double inf = std::numeric_limits<double>::infinity();
+    const double deltaX = passoX != 0 ? 1.0 / std::abs(ddx) : inf;
+    const double deltaY = passoY != 0 ? 1.0 / std::abs(ddy) : inf;
+    double tX = passoX > 0 ? (std::floor(ax) + 1.0 - ax) * deltaX : (passoX < 0 ? (ax - std::floor(ax)) * deltaX : inf);
+    double tY = passoY > 0 ? (std::floor(ay) + 1.0 - ay) * deltaY : (passoY < 0 ? (ay - std::floor(ay)) * deltaY : inf);
+
+    constexpr double EPS = 1e-9;
+    int restantes = std::abs(ex - cx) + std::abs(ey - cy);
+    while ((cx != ex || cy != ey) && restantes-- > 0) {
+        if (tX < tY - EPS) {
+            cx += passoX;
+            tX += deltaX;
+        } else if (tY < tX - EPS) {
+            cy += passoY;
+            tY += deltaY;
+        } else {
+            if (bloqueada(grade, cx + passoX, cy) || bloqueada(grade, cx, cy + passoY)) return false;
+            cx += passoX;
+            cy += passoY;
+            tX += deltaX;
+            tY += deltaY;
+            --restantes;
+        }
+        if (bloqueada(grade, cx, cy)) return false;
+    }
+    return true;
+}
+
+PlanejadorRotas::Estatisticas PlanejadorRotas::estatisticas() const {
+    Estatisticas e;
+    e.pedidos      = pedidos_.load(std::memory_order_relaxed);
+    e.acertosCache = acertos_.load(std::memory_order_relaxed);
+    e.semCaminho   = semCaminho_.load(std::memory_order_relaxed);
+    const std::uint64_t buscas = buscas_.load(std::memory_order_relaxed);
+    if (buscas > 0) e.buscaMedia_us = static_cast<double>(nsBusca_.load(std::memory_order_relaxed)) / 1000.0 / static_cast<double>(buscas);
+    return e;
+}
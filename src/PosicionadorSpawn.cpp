@@ -0,0 +1,228 @@
+// src/PosicionadorSpawn.cpp
+#include "PosicionadorSpawn.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+    using Ponto = GradeEspacial::Ponto;
+
+    constexpr double PI = 3.14159265358979323846;
+
+    // as vagas nao dependem da semente de spawn: o conjunto eh o mesmo em toda execucao,
+    // e o sorteio da ordem de uso fica com o rng do chamador
+    constexpr std::uint32_t SEMENTE_VAGAS    = 0x5a17u;
+    constexpr int           TENTATIVAS_DISCO = 30;  // candidatos por ponto ativo, o k de Bridson
+
+    // celulas a ate duas de distancia, das mais proximas para as mais distantes, para que numa
+    // area cheia o conflito apareca logo; os cantos (+-2, +-2) ficam de fora porque distam
+    // pelo menos distMin de qualquer ponto da celula central
+    constexpr int VIZINHANCA[21][2] = {
+        { 0,  0},
+        {-1,  0}, { 1,  0}, { 0, -1}, { 0,  1},
+        {-1, -1}, { 1, -1}, {-1,  1}, { 1,  1},
+        {-2,  0}, { 2,  0}, { 0, -2}, { 0,  2},
+        {-2, -1}, {-2,  1}, { 2, -1}, { 2,  1}, {-1, -2}, { 1, -2}, {-1,  2}, { 1,  2},
+    };
+
+    // grade de ocupacao sobre um retangulo mais uma margem de distMin
+    // com celulas de lado distMin/sqrt(2), qualquer ponto a menos de distMin esta a no maximo
+    // duas celulas de distancia; cada celula guarda uma lista ligada (cabeca_/proximo_), ja que
+    // caminhoes em movimento podem estar mais perto que distMin entre si
+    class GradeOcupacao {
+    public:
+        GradeOcupacao(double xMin, double xMax, double yMin, double yMax, double distMin)
+            : x0_(xMin - distMin),
+              y0_(yMin - distMin),
+              celula_(distMin / std::sqrt(2.0)),
+              dist2_(distMin * distMin),
+              nx_(static_cast<int>(std::ceil((xMax - xMin + 2.0 * distMin) / celula_)) + 1),
+              ny_(static_cast<int>(std::ceil((yMax - yMin + 2.0 * distMin) / celula_)) + 1),
+              cabeca_(static_cast<std::size_t>(nx_) * static_cast<std::size_t>(ny_), -1)
+        {
+        }
+
+        // pontos fora do retangulo com margem nao alcancam nenhum candidato e sao ignorados
+        void inserir(const Ponto& p) {
+            int cx, cy;
+            if (!celulaDe(p, cx, cy)) return;
+            const std::size_t c = indice(cx, cy);
+            pontos_.push_back(p);
+            proximo_.push_back(cabeca_[c]);
+            cabeca_[c] = static_cast<int>(pontos_.size() - 1);
+        }
+
+        bool livre(const Ponto& p) const {
+            int cx, cy;
+            if (!celulaDe(p, cx, cy)) return false;
+            for (const auto& v : VIZINHANCA) {
+                const int x = cx + v[0];
+                const int y = cy + v[1];
+                if (x < 0 || x >= nx_ || y < 0 || y >= ny_) continue;
+                for (int i = cabeca_[indice(x, y)]; i >= 0; i = proximo_[static_cast<std::size_t>(i)]) {
+                    const Ponto& q = pontos_[static_cast<std::size_t>(i)];
+                    double dx = p.x - q.x;
+                    double dy = p.y - q.y;
+                    if (dx*dx + dy*dy < dist2_) return false;
+                }
+            }
+            return true;
+        }
+
+        void reservar(std::size_t n) {
+            pontos_.reserve(n);
+            proximo_.reserve(n);
+        }
+
+    private:
+        bool celulaDe(const Ponto& p, int& cx, int& cy) const {
+            double fx = std::floor((p.x - x0_) / celula_);
+            double fy = std::floor((p.y - y0_) / celula_);
+            if (!(fx >= 0.0 && fx < nx_ && fy >= 0.0 && fy < ny_)) return false;
+            cx = static_cast<int>(fx);
+            cy = static_cast<int>(fy);
+            return true;
+        }
+        std::size_t indice(int cx, int cy) const {
+            return static_cast<std::size_t>(cy) * static_cast<std::size_t>(nx_) + static_cast<std::size_t>(cx);
+        }
+
+        double x0_, y0_;
+        double celula_;
+        double dist2_;
+        int nx_, ny_;
+        std::vector<int> cabeca_;
+        std::vector<int> proximo_;
+        std::vector<Ponto> pontos_;
+    };
+
+    // amostragem de Poisson-disk de Bridson: pontos a pelo menos distMin entre si cobrindo a area
+    std::vector<Ponto> gerarVagas(const PosicionadorSpawn::Area& area, double distMin) {
+        std::vector<Ponto> vagas;
+        if (distMin <= 0.0 || area.xMax <= area.xMin || area.yMax <= area.yMin) return vagas;
+
+        std::mt19937 rng(SEMENTE_VAGAS);
+        std::uniform_real_distribution<double> distX(area.xMin, area.xMax);
+        std::uniform_real_distribution<double> distY(area.yMin, area.yMax);
+        std::uniform_real_distribution<double> distAngulo(0.0, 2.0 * PI);
+        std::uniform_real_distribution<double> distRaio(distMin, 2.0 * distMin);
+
+        GradeOcupacao grade(area.xMin, area.xMax, area.yMin, area.yMax, distMin);
+        std::vector<std::size_t> ativos;
+
+        auto aceitar = [&](const Ponto& p) {
+            grade.inserir(p);
+            ativos.push_back(vagas.size());
+            vagas.push_back(p);
+        };
+        aceitar({distX(rng), distY(rng)});
+
+        while (!ativos.empty()) {
+            std::uniform_int_distribution<std::size_t> distAtivo(0, ativos.size() - 1);
+            const std::size_t k = distAtivo(rng);
+            const Ponto base = vagas[ativos[k]];
+
+            bool achou = false;
+            for (int t = 0; t < TENTATIVAS_DISCO && !achou; ++t) {
+                double ang  = distAngulo(rng);
+                double raio = distRaio(rng);
+                Ponto p{base.x + raio * std::cos(ang), base.y + raio * std::sin(ang)};
+                if (p.x < area.xMin || p.x > area.xMax || p.y < area.yMin || p.y > area.yMax) continue;
+                if (!grade.livre(p)) continue;
+                aceitar(p);
+                achou = true;
+            }
+            if (!achou) {
+                ativos[k] = ativos.back();
+                ativos.pop_back();
+            }
+        }
+        return vagas;
+    }
+}
+
+PosicionadorSpawn::PosicionadorSpawn(Area area, double distMin, int maxTentativas)
+    : PosicionadorSpawn(area, distMin, maxTentativas, Area{area.xMin, area.xMax, area.yMin, area.yMin})
+{
+}
+
+PosicionadorSpawn::PosicionadorSpawn(Area area, double distMin, int maxTentativas, Area garagem)
+    : area_(area),
+      garagem_(garagem),
+      distMin_(distMin),
+      maxTentativas_(maxTentativas),
+      vagas_(gerarVagas(area, distMin))
+{
+}
+
+void PosicionadorSpawn::escolherLote(const std::vector<GradeEspacial::Ponto>& ocupados, std::mt19937& rng,
+                                     std::size_t n, std::vector<Vaga>& out) const {
+    if (n == 0) return;
+
+    // fileiras dentro do retangulo da garagem, alternando abaixo e acima da area pela
+    // distancia ate ela
+    std::vector<double> fileirasGaragem;
+    for (std::size_t k = 1; ; ++k) {
+        const double abaixo = area_.yMin - distMin_ * static_cast<double>(k);
+        const double acima  = area_.yMax + distMin_ * static_cast<double>(k);
+        const bool cabeAbaixo = abaixo >= garagem_.yMin;
+        const bool cabeAcima  = acima <= garagem_.yMax;
+        if (!cabeAbaixo && !cabeAcima) break;
+        if (cabeAbaixo) fileirasGaragem.push_back(abaixo);
+        if (cabeAcima)  fileirasGaragem.push_back(acima);
+    }
+    const double xMinGaragem = std::min(area_.xMin, garagem_.xMin);
+    const double xMaxGaragem = std::max(area_.xMax, garagem_.xMax);
+    const std::size_t porFileira = static_cast<std::size_t>(std::floor((xMaxGaragem - xMinGaragem) / distMin_)) + 1;
+
+    // abaixo da garagem, cada ponto ocupado bloqueia no maximo 4 lugares, entao estas
+    // fileiras sempre bastam para os n caminhoes
+    const double topoExtra = std::min(area_.yMin, garagem_.yMin);
+    const std::size_t abaixo = static_cast<std::size_t>(std::count_if(ocupados.begin(), ocupados.end(),
+        [topoExtra](const GradeEspacial::Ponto& p) { return p.y < topoExtra; }));
+    const std::size_t fileiras = (n + 4 * abaixo) / porFileira + 1;
+    const double fundo = topoExtra - distMin_ * static_cast<double>(fileiras);
+
+    GradeOcupacao grade(xMinGaragem, xMaxGaragem, fundo, std::max(area_.yMax, garagem_.yMax), distMin_);
+    grade.reservar(ocupados.size() + n);
+    for (const auto& p : ocupados) grade.inserir(p);
+
+    std::size_t faltam = n;
+    auto aceitar = [&](const GradeEspacial::Ponto& p, bool garagem) {
+        grade.inserir(p);
+        out.push_back({p, garagem});
+        --faltam;
+    };
+
+    // vagas pre-geradas em ordem sorteada (Fisher-Yates parcial, cada vaga testada uma vez)
+    std::vector<std::uint32_t> ordem(vagas_.size());
+    std::iota(ordem.begin(), ordem.end(), 0u);
+    for (std::size_t restantes = ordem.size(); faltam > 0 && restantes > 0; ) {
+        std::uniform_int_distribution<std::size_t> distIndice(0, restantes - 1);
+        const std::size_t k = distIndice(rng);
+        const GradeEspacial::Ponto& p = vagas_[ordem[k]];
+        ordem[k] = ordem[--restantes];
+        if (grade.livre(p)) aceitar(p, false);
+    }
+
+    // caminhoes que sairam das vagas deixam espacos fora delas
+    std::uniform_real_distribution<double> distX(area_.xMin, area_.xMax);
+    std::uniform_real_distribution<double> distY(area_.yMin, area_.yMax);
+    for (int tentativa = 0; faltam > 0 && tentativa < maxTentativas_; ++tentativa) {
+        GradeEspacial::Ponto p{distX(rng), distY(rng)};
+        if (grade.livre(p)) aceitar(p, false);
+    }
+
+    auto preencherFileira = [&](double y) {
+        for (std::size_t coluna = 0; faltam > 0 && coluna < porFileira; ++coluna) {
+            GradeEspacial::Ponto p{xMinGaragem + distMin_ * static_cast<double>(coluna), y};
+            if (grade.livre(p)) aceitar(p, true);
+        }
+    };
+    for (std::size_t f = 0; faltam > 0 && f < fileirasGaragem.size(); ++f) preencherFileira(fileirasGaragem[f]);
+    for (std::size_t f = 0; faltam > 0 && f < fileiras; ++f) {
+        preencherFileira(topoExtra - distMin_ * static_cast<double>(f + 1));
+    }
+}
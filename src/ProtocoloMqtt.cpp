@@ -0,0 +1,547 @@
+// src/ProtocoloMqtt.cpp
+#include "ProtocoloMqtt.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace ProtocoloMqtt {
+namespace {
+    std::int16_t saturar16(int v) {
+        if (v > std::numeric_limits<std::int16_t>::max()) return std::numeric_limits<std::int16_t>::max();
+        if (v < std::numeric_limits<std::int16_t>::min()) return std::numeric_limits<std::int16_t>::min();
+        return static_cast<std::int16_t>(v);
+    }
+
+    std::uint16_t saturarU16(int v) {
+        if (v < 0) return 0;
+        if (v > std::numeric_limits<std::uint16_t>::max()) return std::numeric_limits<std::uint16_t>::max();
+        return static_cast<std::uint16_t>(v);
+    }
+
+    // escrita e leitura little endian byte a byte, independente do host
+    void poeU16(char* p, std::uint16_t v) {
+        p[0] = static_cast<char>(v & 0xff);
+        p[1] = static_cast<char>(v >> 8);
+    }
+
+    void poeI64(char* p, std::int64_t v) {
+        std::uint64_t u = static_cast<std::uint64_t>(v);
+        for (int b = 0; b < 8; ++b) p[b] = static_cast<char>((u >> (8 * b)) & 0xff);
+    }
+
+    std::uint16_t tiraU16(const char* p) {
+        return static_cast<std::uint16_t>(static_cast<unsigned char>(p[0]) |
+                                          (static_cast<unsigned char>(p[1]) << 8));
+    }
+
+    std::int16_t tiraI16(const char* p) {
+        return static_cast<std::int16_t>(tiraU16(p));
+    }
+
+    std::int64_t tiraI64(const char* p) {
+        std::uint64_t u = 0;
+        for (int b = 0; b < 8; ++b) u |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+        return static_cast<std::int64_t>(u);
+    }
+
+    void poeU64(char* p, std::uint64_t v) {
+        poeI64(p, static_cast<std::int64_t>(v));
+    }
+
+    void poeI32(char* p, std::int32_t v) {
+        std::uint32_t u = static_cast<std::uint32_t>(v);
+        for (int b = 0; b < 4; ++b) p[b] = static_cast<char>((u >> (8 * b)) & 0xff);
+    }
+
+    void poeF64(char* p, double v) {
+        std::uint64_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        poeU64(p, u);
+    }
+
+    std::uint64_t tiraU64(const char* p) {
+        return static_cast<std::uint64_t>(tiraI64(p));
+    }
+
+    std::int32_t tiraI32(const char* p) {
+        std::uint32_t u = 0;
+        for (int b = 0; b < 4; ++b) u |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+        return static_cast<std::int32_t>(u);
+    }
+
+    double tiraF64(const char* p) {
+        std::uint64_t u = tiraU64(p);
+        double v;
+        std::memcpy(&v, &u, sizeof(v));
+        return v;
+    }
+
+    void poeCabecalho(char* p, TipoMensagem tipo) {
+        p[0] = MAGICO[0];
+        p[1] = MAGICO[1];
+        p[2] = static_cast<char>(VERSAO);
+        p[3] = static_cast<char>(tipo);
+    }
+
+    bool confereCabecalho(const char* dados, std::size_t n, TipoMensagem tipo, std::size_t minimo) {
+        return n >= minimo && ehBinario(dados, n) &&
+               static_cast<std::uint8_t>(dados[2]) == VERSAO &&
+               static_cast<std::uint8_t>(dados[3]) == static_cast<std::uint8_t>(tipo);
+    }
+
+    void poeRegistro(char* p, const EstadoFio& e) {
+        poeU16(p,     saturarU16(e.id));
+        poeU16(p + 2, static_cast<std::uint16_t>(saturar16(e.x)));
+        poeU16(p + 4, static_cast<std::uint16_t>(saturar16(e.y)));
+        poeU16(p + 6, static_cast<std::uint16_t>(saturar16(e.temp)));
+        p[8] = static_cast<char>((e.defeito ? 1 : 0) | (e.automatico ? 2 : 0));
+    }
+
+    EstadoFio tiraRegistro(const char* p) {
+        EstadoFio e;
+        e.id         = tiraU16(p);
+        e.x          = tiraI16(p + 2);
+        e.y          = tiraI16(p + 4);
+        e.temp       = tiraI16(p + 6);
+        e.defeito    = (p[8] & 1) != 0;
+        e.automatico = (p[8] & 2) != 0;
+        return e;
+    }
+
+    // entre shards o id vai em int32; saturado em 16 bits, ids acima de 65535 se confundiriam
+    void poeAmostraBorda(char* p, const AmostraBorda& a) {
+        poeI32(p,      a.id);
+        poeU16(p + 4,  static_cast<std::uint16_t>(saturar16(a.x)));
+        poeU16(p + 6,  static_cast<std::uint16_t>(saturar16(a.y)));
+        poeF64(p + 8,  a.vx);
+        poeF64(p + 16, a.vy);
+        poeU16(p + 24, static_cast<std::uint16_t>(saturar16(a.rumo_graus)));
+        p[26] = static_cast<char>(a.emMissao ? 1 : 0);
+    }
+
+    AmostraBorda tiraAmostraBorda(const char* p) {
+        AmostraBorda a;
+        a.id         = tiraI32(p);
+        a.x          = tiraI16(p + 4);
+        a.y          = tiraI16(p + 6);
+        a.vx         = tiraF64(p + 8);
+        a.vy         = tiraF64(p + 16);
+        a.rumo_graus = tiraI16(p + 24);
+        a.emMissao   = (p[26] & 1) != 0;
+        return a;
+    }
+
+    // cursores de escrita e leitura do layout fixo da migracao
+    struct Escrita {
+        char* p;
+        void u8(unsigned v)      { *p++ = static_cast<char>(v); }
+        void i16(int v)          { poeU16(p, static_cast<std::uint16_t>(saturar16(v))); p += 2; }
+        void i32(std::int32_t v) { poeI32(p, v); p += 4; }
+        void f64(double v)       { poeF64(p, v); p += 8; }
+    };
+
+    struct Leitura {
+        const char* p;
+        unsigned u8()     { return static_cast<unsigned char>(*p++); }
+        int i16()         { int v = tiraI16(p); p += 2; return v; }
+        std::int32_t i32() { std::int32_t v = tiraI32(p); p += 4; return v; }
+        double f64()      { double v = tiraF64(p); p += 8; return v; }
+    };
+
+    unsigned bitsEstados(const EstadosCaminhao& e) {
+        return (e.e_defeito ? 1u : 0u) | (e.e_automatico ? 2u : 0u) | (e.e_bloqueio_rearme ? 4u : 0u);
+    }
+
+    EstadosCaminhao estadosDe(unsigned b) {
+        return {(b & 1u) != 0, (b & 2u) != 0, (b & 4u) != 0};
+    }
+
+    unsigned bitsComandos(const ComandosCaminhao& c) {
+        return (c.c_automatico ? 1u : 0u) | (c.c_man ? 2u : 0u) | (c.c_rearme ? 4u : 0u) |
+               (c.c_acelera ? 8u : 0u) | (c.c_direita ? 16u : 0u) | (c.c_esquerda ? 32u : 0u);
+    }
+
+    ComandosCaminhao comandosDe(unsigned b) {
+        return {(b & 1u) != 0, (b & 2u) != 0, (b & 4u) != 0, (b & 8u) != 0, (b & 16u) != 0, (b & 32u) != 0};
+    }
+
+    void poeRegistroCompleto(Escrita& w, const RegistroBuffer& r) {
+        w.f64(r.tempoSimulacao_s);
+        w.u8(static_cast<unsigned>(r.estado));
+        w.i32(r.sensores.i_posicao_x);
+        w.i32(r.sensores.i_posicao_y);
+        w.i32(r.sensores.i_angulo_x);
+        w.i32(r.sensores.i_temperatura);
+        w.u8((r.sensores.i_falha_eletrica ? 1u : 0u) | (r.sensores.i_falha_hidraulica ? 2u : 0u));
+        w.i16(r.atuadores.o_aceleracao);
+        w.i16(r.atuadores.o_direcao);
+        w.u8(bitsEstados(r.estados));
+        w.u8(bitsComandos(r.comandos));
+        w.i32(r.setpoints.sp_posicao_x);
+        w.i32(r.setpoints.sp_posicao_y);
+        w.i32(r.setpoints.sp_angulo_x);
+    }
+
+    bool tiraRegistroCompleto(Leitura& l, int id, RegistroBuffer& r) {
+        r.tempoSimulacao_s = l.f64();
+        r.id_caminhao      = id;
+        unsigned estado    = l.u8();
+        if (estado > static_cast<unsigned>(EstadoCaminhao::EmFalha)) return false;
+        r.estado                     = static_cast<EstadoCaminhao>(estado);
+        r.sensores.i_posicao_x       = l.i32();
+        r.sensores.i_posicao_y       = l.i32();
+        r.sensores.i_angulo_x        = l.i32();
+        r.sensores.i_temperatura     = l.i32();
+        unsigned falhas              = l.u8();
+        r.sensores.i_falha_eletrica   = (falhas & 1u) != 0;
+        r.sensores.i_falha_hidraulica = (falhas & 2u) != 0;
+        r.atuadores.o_aceleracao     = l.i16();
+        r.atuadores.o_direcao        = l.i16();
+        r.estados                    = estadosDe(l.u8());
+        r.comandos                   = comandosDe(l.u8());
+        r.setpoints.sp_posicao_x     = l.i32();
+        r.setpoints.sp_posicao_y     = l.i32();
+        r.setpoints.sp_angulo_x      = l.i32();
+        return true;
+    }
+
+    // texto do topico cmd; o inteiro tem que ocupar o resto da mensagem
+    bool lerInteiro(const char* ini, const char* fim, int& out) {
+        if (ini == fim) return false;
+        auto r = std::from_chars(ini, fim, out);
+        return r.ec == std::errc() && r.ptr == fim;
+    }
+
+    bool comecaCom(const char* dados, std::size_t n, const char* prefixo, std::size_t& tam) {
+        tam = std::strlen(prefixo);
+        return n >= tam && std::memcmp(dados, prefixo, tam) == 0;
+    }
+
+    struct ComandoTexto {
+        const char*   texto;
+        CodigoComando codigo;
+    };
+
+    // comandos sem argumento, comparados inteiros
+    constexpr ComandoTexto COMANDOS_SIMPLES[] = {
+        {"CMD:AUTO",            CodigoComando::Automatico},
+        {"CMD:MANUAL",          CodigoComando::Manual},
+        {"CMD:REARME",          CodigoComando::Rearme},
+        {"CMD:CRIAR_CAMINHAO",  CodigoComando::CriarCaminhao},
+    };
+
+    // comandos de tecla, seguidos de 0 ou 1
+    constexpr ComandoTexto COMANDOS_TECLA[] = {
+        {"CMD:ACELERA:",  CodigoComando::Acelera},
+        {"CMD:DIREITA:",  CodigoComando::Direita},
+        {"CMD:ESQUERDA:", CodigoComando::Esquerda},
+    };
+
+    // comandos seguidos do id do caminhao
+    constexpr ComandoTexto COMANDOS_ID[] = {
+        {"CMD:REMOVER_CAMINHAO:", CodigoComando::RemoverCaminhao},
+        {"CMD:FALHA_TEMP:",       CodigoComando::FalhaTemperatura},
+        {"CMD:FALHA_ELET:",       CodigoComando::FalhaEletrica},
+        {"CMD:FALHA_HIDR:",       CodigoComando::FalhaHidraulica},
+    };
+
+    // criacao em massa, seguido da quantidade
+    constexpr const char* PREFIXO_CRIAR_CAMINHOES = "CMD:CRIAR_CAMINHOES:";
+
+    const char* textoDe(const ComandoTexto* tabela, std::size_t n, CodigoComando codigo) {
+        for (std::size_t i = 0; i < n; ++i) if (tabela[i].codigo == codigo) return tabela[i].texto;
+        return nullptr;
+    }
+
+    bool decodificarTexto(const char* dados, std::size_t n, Comando& out) {
+        out = Comando{};
+        const char* fim = dados + n;
+        std::size_t tam = 0;
+
+        for (const auto& c : COMANDOS_SIMPLES) {
+            if (n == std::strlen(c.texto) && std::memcmp(dados, c.texto, n) == 0) {
+                out.codigo = c.codigo;
+                return true;
+            }
+        }
+        for (const auto& c : COMANDOS_TECLA) {
+            if (comecaCom(dados, n, c.texto, tam)) {
+                if (n != tam + 1 || (dados[tam] != '0' && dados[tam] != '1')) return false;
+                out.codigo = c.codigo;
+                out.valor  = dados[tam] - '0';
+                return true;
+            }
+        }
+        for (const auto& c : COMANDOS_ID) {
+            if (comecaCom(dados, n, c.texto, tam)) {
+                if (!lerInteiro(dados + tam, fim, out.idCaminhao)) return false;
+                out.codigo = c.codigo;
+                return true;
+            }
+        }
+        if (comecaCom(dados, n, PREFIXO_CRIAR_CAMINHOES, tam)) {
+            if (!lerInteiro(dados + tam, fim, out.quantidade) || out.quantidade <= 0) return false;
+            out.codigo = CodigoComando::CriarCaminhoes;
+            return true;
+        }
+        if (comecaCom(dados, n, "ROTA:", tam)) {
+            int* campos[4] = {&out.x1, &out.y1, &out.x2, &out.y2};
+            const char* p = dados + tam;
+            for (int i = 0; i < 4; ++i) {
+                const char* sep = (i < 3) ? static_cast<const char*>(std::memchr(p, ',', static_cast<std::size_t>(fim - p))) : fim;
+                if (!sep || !lerInteiro(p, sep, *campos[i])) return false;
+                p = sep + 1;
+            }
+            out.codigo = CodigoComando::Rota;
+            return true;
+        }
+        return false;
+    }
+}
+
+EstadoFio estadoDe(int id, const RegistroBuffer& reg) {
+    return EstadoFio{id, reg.sensores.i_posicao_x, reg.sensores.i_posicao_y, reg.sensores.i_temperatura,
+                     reg.estados.e_defeito, reg.estados.e_automatico};
+}
+
+bool ehBinario(const char* dados, std::size_t n) {
+    return n >= TAM_CABECALHO && dados[0] == MAGICO[0] && dados[1] == MAGICO[1];
+}
+
+void codificarEstado(const EstadoFio& e, Formato f, std::string& out) {
+    if (f == Formato::Binario) {
+        out.resize(TAM_ESTADO);
+        poeCabecalho(&out[0], TipoMensagem::EstadoCaminhao);
+        poeRegistro(&out[TAM_CABECALHO], e);
+        return;
+    }
+    char json[128];
+    int n = std::snprintf(json, sizeof(json),
+                          "{ \"id\": %d, \"x\": %d, \"y\": %d, \"temp\": %d, \"defeito\": %s, \"auto\": %s }",
+                          e.id, e.x, e.y, e.temp, e.defeito ? "true" : "false", e.automatico ? "true" : "false");
+    out.assign(json, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+void iniciarQuadro(std::int64_t t_ms, Formato f, std::string& out) {
+    out.clear();
+    if (f == Formato::Binario) {
+        out.resize(TAM_QUADRO_FIXO);
+        poeCabecalho(&out[0], TipoMensagem::QuadroFrota);
+        poeI64(&out[TAM_CABECALHO], t_ms);
+        poeU16(&out[TAM_CABECALHO + 8], 0);
+        return;
+    }
+    char cab[48];
+    int n = std::snprintf(cab, sizeof(cab), "{\"t\":%lld,", static_cast<long long>(t_ms));
+    if (n > 0) out.append(cab, static_cast<std::size_t>(n));
+    out += "\"campos\":[\"id\",\"x\",\"y\",\"temp\",\"defeito\",\"auto\"],\"frota\":[";
+}
+
+void anexarAoQuadro(const EstadoFio& e, Formato f, std::string& out) {
+    if (f == Formato::Binario) {
+        std::uint16_t qtd = tiraU16(&out[TAM_CABECALHO + 8]);
+        if (qtd == MAX_CAMINHOES_QUADRO) return;
+        std::size_t pos = out.size();
+        out.resize(pos + TAM_REGISTRO);
+        poeRegistro(&out[pos], e);
+        poeU16(&out[TAM_CABECALHO + 8], static_cast<std::uint16_t>(qtd + 1));
+        return;
+    }
+    char linha[96];
+    int n = std::snprintf(linha, sizeof(linha), "%s[%d,%d,%d,%d,%d,%d]",
+                          out.back() == '[' ? "" : ",",
+                          e.id, e.x, e.y, e.temp, e.defeito ? 1 : 0, e.automatico ? 1 : 0);
+    if (n > 0) out.append(linha, static_cast<std::size_t>(n));
+}
+
+void fecharQuadro(Formato f, std::string& out) {
+    if (f == Formato::Json) out += "]}";
+}
+
+void codificarComando(const Comando& c, Formato f, std::string& out) {
+    if (f == Formato::Binario) {
+        out.resize(TAM_COMANDO);
+        char* p = &out[0];
+        poeCabecalho(p, TipoMensagem::Comando);
+        p[4] = static_cast<char>(c.codigo);
+        p[5] = static_cast<char>(c.valor != 0 ? 1 : 0);
+        poeU16(p + 6,  saturarU16(c.codigo == CodigoComando::CriarCaminhoes ? c.quantidade : c.idCaminhao));
+        poeU16(p + 8,  static_cast<std::uint16_t>(saturar16(c.x1)));
+        poeU16(p + 10, static_cast<std::uint16_t>(saturar16(c.y1)));
+        poeU16(p + 12, static_cast<std::uint16_t>(saturar16(c.x2)));
+        poeU16(p + 14, static_cast<std::uint16_t>(saturar16(c.y2)));
+        return;
+    }
+
+    const std::size_t nSimples = sizeof(COMANDOS_SIMPLES) / sizeof(COMANDOS_SIMPLES[0]);
+    const std::size_t nTecla   = sizeof(COMANDOS_TECLA) / sizeof(COMANDOS_TECLA[0]);
+    const std::size_t nId      = sizeof(COMANDOS_ID) / sizeof(COMANDOS_ID[0]);
+
+    char texto[80];
+    int n = 0;
+    if (const char* t = textoDe(COMANDOS_SIMPLES, nSimples, c.codigo)) {
+        n = std::snprintf(texto, sizeof(texto), "%s", t);
+    } else if (const char* t = textoDe(COMANDOS_TECLA, nTecla, c.codigo)) {
+        n = std::snprintf(texto, sizeof(texto), "%s%d", t, c.valor != 0 ? 1 : 0);
+    } else if (const char* t = textoDe(COMANDOS_ID, nId, c.codigo)) {
+        n = std::snprintf(texto, sizeof(texto), "%s%d", t, c.idCaminhao);
+    } else if (c.codigo == CodigoComando::CriarCaminhoes) {
+        n = std::snprintf(texto, sizeof(texto), "%s%d", PREFIXO_CRIAR_CAMINHOES, c.quantidade);
+    } else if (c.codigo == CodigoComando::Rota) {
+        n = std::snprintf(texto, sizeof(texto), "ROTA:%d,%d,%d,%d", c.x1, c.y1, c.x2, c.y2);
+    }
+    out.assign(texto, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+bool decodificarComando(const char* dados, std::size_t n, Comando& out) {
+    if (!ehBinario(dados, n)) return decodificarTexto(dados, n, out);
+    if (!confereCabecalho(dados, n, TipoMensagem::Comando, TAM_COMANDO)) return false;
+
+    std::uint8_t codigo = static_cast<std::uint8_t>(dados[4]);
+    if (codigo == 0 || codigo > static_cast<std::uint8_t>(CodigoComando::CriarCaminhoes)) return false;
+
+    out = Comando{};
+    out.codigo     = static_cast<CodigoComando>(codigo);
+    out.valor      = dados[5] != 0 ? 1 : 0;
+    if (out.codigo == CodigoComando::CriarCaminhoes) out.quantidade = tiraU16(dados + 6);
+    else                                             out.idCaminhao = tiraU16(dados + 6);
+    out.x1         = tiraI16(dados + 8);
+    out.y1         = tiraI16(dados + 10);
+    out.x2         = tiraI16(dados + 12);
+    out.y2         = tiraI16(dados + 14);
+    return true;
+}
+
+bool decodificarEstado(const char* dados, std::size_t n, EstadoFio& out) {
+    if (!confereCabecalho(dados, n, TipoMensagem::EstadoCaminhao, TAM_ESTADO)) return false;
+    out = tiraRegistro(dados + TAM_CABECALHO);
+    return true;
+}
+
+bool decodificarQuadro(const char* dados, std::size_t n, std::int64_t& t_ms, std::vector<EstadoFio>& out) {
+    out.clear();
+    if (!confereCabecalho(dados, n, TipoMensagem::QuadroFrota, TAM_QUADRO_FIXO)) return false;
+
+    t_ms = tiraI64(dados + TAM_CABECALHO);
+    std::size_t qtd = tiraU16(dados + TAM_CABECALHO + 8);
+    if (n < TAM_QUADRO_FIXO + qtd * TAM_REGISTRO) return false;
+
+    out.reserve(qtd);
+    for (std::size_t i = 0; i < qtd; ++i) out.push_back(tiraRegistro(dados + TAM_QUADRO_FIXO + i * TAM_REGISTRO));
+    return true;
+}
+
+bool tipoDe(const char* dados, std::size_t n, TipoMensagem& out) {
+    if (!ehBinario(dados, n) || static_cast<std::uint8_t>(dados[2]) != VERSAO) return false;
+    std::uint8_t tipo = static_cast<std::uint8_t>(dados[3]);
+    if (tipo == 0 || tipo > static_cast<std::uint8_t>(TipoMensagem::Migracao)) return false;
+    out = static_cast<TipoMensagem>(tipo);
+    return true;
+}
+
+void codificarPresenca(int origem, bool completo, std::string& out) {
+    out.resize(TAM_PRESENCA);
+    poeCabecalho(&out[0], TipoMensagem::Presenca);
+    out[TAM_CABECALHO]     = static_cast<char>(origem);
+    out[TAM_CABECALHO + 1] = static_cast<char>(completo ? 1 : 0);
+}
+
+bool decodificarPresenca(const char* dados, std::size_t n, int& origem, bool& completo) {
+    if (!confereCabecalho(dados, n, TipoMensagem::Presenca, TAM_PRESENCA)) return false;
+    origem   = static_cast<unsigned char>(dados[TAM_CABECALHO]);
+    completo = dados[TAM_CABECALHO + 1] != 0;
+    return true;
+}
+
+void iniciarBorda(int origem, std::uint64_t passo, std::string& out) {
+    out.resize(TAM_BORDA_FIXO);
+    poeCabecalho(&out[0], TipoMensagem::QuadroBorda);
+    out[TAM_CABECALHO] = static_cast<char>(origem);
+    poeU64(&out[TAM_CABECALHO + 1], passo);
+    poeU16(&out[TAM_CABECALHO + 9], 0);
+}
+
+void anexarABorda(const AmostraBorda& a, std::string& out) {
+    std::uint16_t qtd = tiraU16(&out[TAM_CABECALHO + 9]);
+    if (qtd == MAX_CAMINHOES_QUADRO) return;
+    std::size_t pos = out.size();
+    out.resize(pos + TAM_AMOSTRA_BORDA);
+    poeAmostraBorda(&out[pos], a);
+    poeU16(&out[TAM_CABECALHO + 9], static_cast<std::uint16_t>(qtd + 1));
+}
+
+bool decodificarBorda(const char* dados, std::size_t n, int& origem, std::uint64_t& passo,
+                      std::vector<AmostraBorda>& out) {
+    out.clear();
+    if (!confereCabecalho(dados, n, TipoMensagem::QuadroBorda, TAM_BORDA_FIXO)) return false;
+
+    origem = static_cast<unsigned char>(dados[TAM_CABECALHO]);
+    passo  = tiraU64(dados + TAM_CABECALHO + 1);
+    std::size_t qtd = tiraU16(dados + TAM_CABECALHO + 9);
+    if (n < TAM_BORDA_FIXO + qtd * TAM_AMOSTRA_BORDA) return false;
+
+    out.reserve(qtd);
+    for (std::size_t i = 0; i < qtd; ++i) out.push_back(tiraAmostraBorda(dados + TAM_BORDA_FIXO + i * TAM_AMOSTRA_BORDA));
+    return true;
+}
+
+void codificarMigracao(int origem, std::uint64_t passo, const EstadoMigracao& e, std::string& out) {
+    out.resize(TAM_MIGRACAO);
+    poeCabecalho(&out[0], TipoMensagem::Migracao);
+    out[TAM_CABECALHO] = static_cast<char>(origem);
+    poeU64(&out[TAM_CABECALHO + 1], passo);
+
+    Escrita w{&out[TAM_CABECALHO + 9]};
+    w.i32(e.id_caminhao);
+    w.f64(e.tempoSimulacao_s);
+    w.f64(e.pos_x);
+    w.f64(e.pos_y);
+    w.f64(e.vel);
+    w.f64(e.ang_deg);
+    w.f64(e.temp_C);
+    w.i16(e.atuadores.o_aceleracao);
+    w.i16(e.atuadores.o_direcao);
+    w.u8(e.rota_definida ? 1u : 0u);
+    w.i32(e.rota_destino_x);
+    w.i32(e.rota_destino_y);
+    w.u8(static_cast<unsigned>(e.estado));
+    w.u8(bitsEstados(e.estados));
+    w.u8(bitsComandos(e.comandos));
+    w.u8((e.falha_temperatura ? 1u : 0u) | (e.falha_eletrica ? 2u : 0u) | (e.falha_hidraulica ? 4u : 0u));
+    poeRegistroCompleto(w, e.ultimo);
+}
+
+bool decodificarMigracao(const char* dados, std::size_t n, int& origem, std::uint64_t& passo,
+                         EstadoMigracao& out) {
+    if (!confereCabecalho(dados, n, TipoMensagem::Migracao, TAM_MIGRACAO)) return false;
+    origem = static_cast<unsigned char>(dados[TAM_CABECALHO]);
+    passo  = tiraU64(dados + TAM_CABECALHO + 1);
+
+    Leitura l{dados + TAM_CABECALHO + 9};
+    out = EstadoMigracao{};
+    out.id_caminhao      = l.i32();
+    out.tempoSimulacao_s = l.f64();
+    out.pos_x            = l.f64();
+    out.pos_y            = l.f64();
+    out.vel              = l.f64();
+    out.ang_deg          = l.f64();
+    out.temp_C           = l.f64();
+    out.atuadores.o_aceleracao = l.i16();
+    out.atuadores.o_direcao    = l.i16();
+    out.rota_definida    = (l.u8() & 1u) != 0;
+    out.rota_destino_x   = l.i32();
+    out.rota_destino_y   = l.i32();
+    unsigned estado      = l.u8();
+    if (estado > static_cast<unsigned>(EstadoCaminhao::EmFalha)) return false;
+    out.estado           = static_cast<EstadoCaminhao>(estado);
+    out.estados          = estadosDe(l.u8());
+    out.comandos         = comandosDe(l.u8());
+    unsigned falhas      = l.u8();
+    out.falha_temperatura = (falhas & 1u) != 0;
+    out.falha_eletrica    = (falhas & 2u) != 0;
+    out.falha_hidraulica  = (falhas & 4u) != 0;
+    return tiraRegistroCompleto(l, out.id_caminhao, out.ultimo);
+}
+}
@@ -0,0 +1,260 @@
+// src/RegistradorTelemetria.cpp
+#include "RegistradorTelemetria.hpp"
+
+#include <cstring>
+
+#include "Log.hpp"
+
+namespace {
+    using FormatoTelemetria::TipoColuna;
+
+    struct Coluna {
+        const char* nome;
+        TipoColuna  tipo;
+    };
+
+    // esquema fixo, na mesma ordem das colunas do CSV original
+    const Coluna COLUNAS[] = {
+        {"tempo_s",       TipoColuna::F64},
+        {"id_caminhao",   TipoColuna::I32},
+        {"estado",        TipoColuna::U8},
+        {"e_defeito",     TipoColuna::U8},
+        {"e_automatico",  TipoColuna::U8},
+        {"i_posicao_x",   TipoColuna::I32},
+        {"i_posicao_y",   TipoColuna::I32},
+        {"i_angulo_x",    TipoColuna::I32},
+        {"i_temperatura", TipoColuna::I32},
+        {"o_aceleracao",  TipoColuna::I32},
+        {"o_direcao",     TipoColuna::I32},
+        {"evento",        TipoColuna::U8},
+    };
+    constexpr std::size_t NUM_COLUNAS = sizeof(COLUNAS) / sizeof(COLUNAS[0]);
+
+    std::size_t larguraColuna(TipoColuna t) {
+        switch (t) {
+            case TipoColuna::F64: return 8;
+            case TipoColuna::I32: return 4;
+            case TipoColuna::U8:  return 1;
+        }
+        return 0;
+    }
+
+    // bytes de uma linha somando todas as colunas
+    std::size_t larguraLinha() {
+        std::size_t total = 0;
+        for (const auto& c : COLUNAS) total += larguraColuna(c.tipo);
+        return total;
+    }
+
+    template <typename T>
+    void anexar(std::vector<char>& buf, T valor) {
+        const char* p = reinterpret_cast<const char*>(&valor);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    template <typename T>
+    T extrair(const char*& p) {
+        T valor;
+        std::memcpy(&valor, p, sizeof(T));
+        p += sizeof(T);
+        return valor;
+    }
+}
+
+RegistradorTelemetria::RegistradorTelemetria(const std::string& caminhoArquivo,
+                                             std::size_t amostrasPorBloco,
+                                             std::chrono::milliseconds intervaloDescarga)
+    : arquivo_(caminhoArquivo, std::ios::out | std::ios::binary | std::ios::trunc),
+      amostrasPorBloco_(amostrasPorBloco > 0 ? amostrasPorBloco : 1),
+      intervaloDescarga_(intervaloDescarga),
+      rodando_(true),
+      gravadas_(0)
+{
+    if (!arquivo_.is_open()) {
+        Log::erro("[Telemetria] Nao foi possivel abrir %s", caminhoArquivo.c_str());
+    } else {
+        escreverCabecalho();
+        Log::info("[Telemetria] Log binario da frota em: %s", caminhoArquivo.c_str());
+    }
+
+    pendentes_.reserve(amostrasPorBloco_);
+    thEscrita_ = std::thread(&RegistradorTelemetria::lacoEscrita, this);
+}
+
+RegistradorTelemetria::~RegistradorTelemetria() {
+    encerrar();
+}
+
+void RegistradorTelemetria::registrar(const AmostraTelemetria& amostra) {
+    bool blocoCheio = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!rodando_) return;
+        pendentes_.push_back(amostra);
+        blocoCheio = pendentes_.size() >= amostrasPorBloco_;
+    }
+    if (blocoCheio) cv_.notify_one();
+}
+
+void RegistradorTelemetria::encerrar() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!rodando_) return;
+        rodando_ = false;
+    }
+    cv_.notify_one();
+    if (thEscrita_.joinable()) thEscrita_.join();
+}
+
+bool RegistradorTelemetria::aberto() const {
+    return arquivo_.is_open();
+}
+
+std::uint64_t RegistradorTelemetria::amostrasGravadas() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return gravadas_;
+}
+
+void RegistradorTelemetria::lacoEscrita() {
+    std::vector<AmostraTelemetria> lote;
+    lote.reserve(amostrasPorBloco_);
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (;;) {
+        // acorda com bloco cheio, no intervalo de descarga ou no encerramento
+        cv_.wait_for(lock, intervaloDescarga_, [this] {
+            return !rodando_ || pendentes_.size() >= amostrasPorBloco_;
+        });
+
+        bool continuar = rodando_;
+        lote.swap(pendentes_); // troca de buffers, os produtores seguem sem esperar o disco
+        lock.unlock();
+
+        for (std::size_t i = 0; i < lote.size(); i += amostrasPorBloco_) {
+            std::size_t n = std::min(amostrasPorBloco_, lote.size() - i);
+            escreverBloco(lote.data() + i, n);
+        }
+        if (!lote.empty() && arquivo_.is_open()) arquivo_.flush();
+
+        lock.lock();
+        gravadas_ += lote.size();
+        lote.clear();
+
+        if (!continuar && pendentes_.empty()) break;
+    }
+}
+
+void RegistradorTelemetria::escreverCabecalho() {
+    std::vector<char> cab;
+    cab.insert(cab.end(), FormatoTelemetria::MAGICO, FormatoTelemetria::MAGICO + 8);
+    anexar<std::uint32_t>(cab, FormatoTelemetria::VERSAO);
+    anexar<std::uint32_t>(cab, static_cast<std::uint32_t>(NUM_COLUNAS));
+    for (const auto& c : COLUNAS) {
+        std::uint8_t tam = static_cast<std::uint8_t>(std::strlen(c.nome));
+        anexar<std::uint8_t>(cab, static_cast<std::uint8_t>(c.tipo));
+        anexar<std::uint8_t>(cab, tam);
+        cab.insert(cab.end(), c.nome, c.nome + tam);
+    }
+    arquivo_.write(cab.data(), static_cast<std::streamsize>(cab.size()));
+    arquivo_.flush();
+}
+
+void RegistradorTelemetria::escreverBloco(const AmostraTelemetria* a, std::size_t n) {
+    if (!arquivo_.is_open() || n == 0) return;
+
+    std::vector<char>& buf = bufferBloco_;
+    buf.clear();
+    buf.reserve(8 + n * larguraLinha());
+
+    anexar<std::uint32_t>(buf, FormatoTelemetria::MARCADOR_BLOCO);
+    anexar<std::uint32_t>(buf, static_cast<std::uint32_t>(n));
+
+    // uma coluna inteira por vez, na ordem de COLUNAS
+    for (std::size_t i = 0; i < n; ++i) anexar<double>(buf, a[i].tempo_s);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].id_caminhao);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::uint8_t>(buf, static_cast<std::uint8_t>(a[i].estado));
+    for (std::size_t i = 0; i < n; ++i) anexar<std::uint8_t>(buf, a[i].e_defeito ? 1 : 0);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::uint8_t>(buf, a[i].e_automatico ? 1 : 0);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].i_posicao_x);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].i_posicao_y);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].i_angulo_x);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].i_temperatura);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].o_aceleracao);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::int32_t>(buf, a[i].o_direcao);
+    for (std::size_t i = 0; i < n; ++i) anexar<std::uint8_t>(buf, static_cast<std::uint8_t>(a[i].evento));
+
+    arquivo_.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+bool LeitorTelemetria::abrir(const std::string& caminhoArquivo) {
+    arquivo_.open(caminhoArquivo, std::ios::in | std::ios::binary);
+    if (!arquivo_.is_open()) {
+        erro_ = "nao foi possivel abrir " + caminhoArquivo;
+        return false;
+    }
+
+    char magico[8];
+    std::uint32_t versao = 0, numColunas = 0;
+    arquivo_.read(magico, 8);
+    arquivo_.read(reinterpret_cast<char*>(&versao), sizeof(versao));
+    arquivo_.read(reinterpret_cast<char*>(&numColunas), sizeof(numColunas));
+    if (!arquivo_ || std::memcmp(magico, FormatoTelemetria::MAGICO, 8) != 0) {
+        erro_ = "arquivo nao eh um log de telemetria";
+        return false;
+    }
+    if (versao != FormatoTelemetria::VERSAO) {
+        erro_ = "versao de formato nao suportada: " + std::to_string(versao);
+        return false;
+    }
+    if (numColunas != NUM_COLUNAS) {
+        erro_ = "esquema com quantidade de colunas inesperada";
+        return false;
+    }
+
+    for (std::size_t c = 0; c < NUM_COLUNAS; ++c) {
+        std::uint8_t tipo = 0, tam = 0;
+        arquivo_.read(reinterpret_cast<char*>(&tipo), 1);
+        arquivo_.read(reinterpret_cast<char*>(&tam), 1);
+        std::string nome(tam, '\0');
+        arquivo_.read(&nome[0], tam);
+        if (!arquivo_ || nome != COLUNAS[c].nome || tipo != static_cast<std::uint8_t>(COLUNAS[c].tipo)) {
+            erro_ = "esquema de colunas diferente do esperado na coluna " + std::to_string(c);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LeitorTelemetria::proximoBloco(std::vector<AmostraTelemetria>& out) {
+    std::uint32_t marcador = 0, n = 0;
+    arquivo_.read(reinterpret_cast<char*>(&marcador), sizeof(marcador));
+    if (arquivo_.gcount() == 0) return false; // fim normal do arquivo
+    arquivo_.read(reinterpret_cast<char*>(&n), sizeof(n));
+    if (!arquivo_ || marcador != FormatoTelemetria::MARCADOR_BLOCO) {
+        erro_ = "bloco corrompido";
+        return false;
+    }
+
+    bufferBloco_.resize(static_cast<std::size_t>(n) * larguraLinha());
+    arquivo_.read(bufferBloco_.data(), static_cast<std::streamsize>(bufferBloco_.size()));
+    if (!arquivo_) {
+        erro_ = "bloco truncado";
+        return false;
+    }
+
+    out.assign(n, AmostraTelemetria{});
+    const char* p = bufferBloco_.data();
+    for (auto& a : out) a.tempo_s       = extrair<double>(p);
+    for (auto& a : out) a.id_caminhao   = extrair<std::int32_t>(p);
+    for (auto& a : out) a.estado        = static_cast<EstadoCaminhao>(extrair<std::uint8_t>(p));
+    for (auto& a : out) a.e_defeito     = extrair<std::uint8_t>(p) != 0;
+    for (auto& a : out) a.e_automatico  = extrair<std::uint8_t>(p) != 0;
+    for (auto& a : out) a.i_posicao_x   = extrair<std::int32_t>(p);
+    for (auto& a : out) a.i_posicao_y   = extrair<std::int32_t>(p);
+    for (auto& a : out) a.i_angulo_x    = extrair<std::int32_t>(p);
+    for (auto& a : out) a.i_temperatura = extrair<std::int32_t>(p);
+    for (auto& a : out) a.o_aceleracao  = extrair<std::int32_t>(p);
+    for (auto& a : out) a.o_direcao     = extrair<std::int32_t>(p);
+    for (auto& a : out) a.evento        = static_cast<EventoTelemetria>(extrair<std::uint8_t>(p));
+    return true;
+}
@@ -0,0 +1,148 @@
+// src/RegistroCaminhoes.cpp
+#include "RegistroCaminhoes.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "Caminhao.hpp"
+
+RegistroCaminhoes::Leitura::Leitura(const RegistroCaminhoes& registro, unsigned paridade, const Tabela* tabela)
+    : registro_(registro),
+      paridade_(paridade),
+      tabela_(tabela)
+{
+}
+
+RegistroCaminhoes::Leitura::~Leitura() {
+    registro_.leitores_[paridade_].n.fetch_sub(1, std::memory_order_release);
+}
+
+Caminhao* RegistroCaminhoes::Leitura::buscar(int id) const {
+    if (id < 1 || static_cast<std::size_t>(id) > tabela_->porId.size()) return nullptr;
+    return tabela_->porId[static_cast<std::size_t>(id) - 1];
+}
+
+RegistroCaminhoes::RegistroCaminhoes()
+    : epoca_(0),
+      tabela_(new Tabela()),
+      proximoId_(1),
+      passoIds_(1)
+{
+}
+
+RegistroCaminhoes::~RegistroCaminhoes() {
+    delete tabela_.load();
+}
+
+RegistroCaminhoes::Leitura RegistroCaminhoes::ler() const {
+    for (;;) {
+        std::uint64_t e = epoca_.load();
+        unsigned p = static_cast<unsigned>(e & 1);
+        leitores_[p].n.fetch_add(1);
+
+        // se a epoca virou entre a leitura e a contagem, o escritor pode nao ter visto
+        // este leitor; desconta e entra de novo na epoca nova
+        if (epoca_.load() == e) return Leitura(*this, p, tabela_.load());
+        leitores_[p].n.fetch_sub(1);
+    }
+}
+
+int RegistroCaminhoes::proximoId() const {
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+    return proximoId_;
+}
+
+void RegistroCaminhoes::definirSequenciaIds(int primeiro, int passo) {
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+    if (!donos_.empty() || primeiro < 1 || passo < 1) {
+        throw std::logic_error("sequencia de ids so pode ser trocada com o registro vazio");
+    }
+    proximoId_ = primeiro;
+    passoIds_  = passo;
+}
+
+int RegistroCaminhoes::passoIds() const {
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+    return passoIds_;
+}
+
+void RegistroCaminhoes::adicionar(std::unique_ptr<Caminhao> caminhao) {
+    std::vector<std::unique_ptr<Caminhao>> lote;
+    lote.push_back(std::move(caminhao));
+    adicionarLote(lote);
+}
+
+void RegistroCaminhoes::adicionarLote(std::vector<std::unique_ptr<Caminhao>>& lote) {
+    if (lote.empty()) return;
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+
+    for (std::size_t i = 0; i < lote.size(); ++i) {
+        int esperado = proximoId_ + static_cast<int>(i) * passoIds_;
+        if (lote[i]->getId() != esperado) {
+            throw std::invalid_argument("id " + std::to_string(lote[i]->getId()) +
+                                        " fora de ordem, esperado " + std::to_string(esperado));
+        }
+    }
+
+    auto nova = std::make_unique<Tabela>(*tabela_.load());
+    const std::size_t tam = static_cast<std::size_t>(lote.back()->getId());
+    if (nova->porId.size() < tam) nova->porId.resize(tam, nullptr);
+    if (donos_.size() < tam) donos_.resize(tam);
+    nova->frota.reserve(nova->frota.size() + lote.size());
+    for (auto& c : lote) {
+        const std::size_t pos = static_cast<std::size_t>(c->getId()) - 1;
+        nova->porId[pos] = c.get();
+        nova->frota.push_back(c.get());
+        donos_[pos] = std::move(c);
+    }
+    proximoId_ += static_cast<int>(lote.size()) * passoIds_;
+    lote.clear();
+    publicar(std::move(nova));
+}
+
+bool RegistroCaminhoes::adotar(std::unique_ptr<Caminhao> caminhao) {
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+
+    const int id = caminhao->getId();
+    const std::size_t pos = static_cast<std::size_t>(id) - 1;
+    if (id < 1 || (pos < donos_.size() && donos_[pos])) return false;
+
+    auto nova = std::make_unique<Tabela>(*tabela_.load());
+    if (nova->porId.size() <= pos) nova->porId.resize(pos + 1, nullptr);
+    if (donos_.size() <= pos) donos_.resize(pos + 1);
+    nova->porId[pos] = caminhao.get();
+    nova->frota.push_back(caminhao.get());
+    donos_[pos] = std::move(caminhao);
+    publicar(std::move(nova));
+    return true;
+}
+
+std::unique_ptr<Caminhao> RegistroCaminhoes::remover(int id) {
+    std::lock_guard<std::mutex> lock(mtxEscrita_);
+
+    if (id < 1 || static_cast<std::size_t>(id) > donos_.size() || !donos_[id - 1]) return nullptr;
+    std::unique_ptr<Caminhao> caminhao = std::move(donos_[id - 1]);
+
+    auto nova = std::make_unique<Tabela>(*tabela_.load());
+    nova->porId[id - 1] = nullptr;
+    for (auto it = nova->frota.begin(); it != nova->frota.end(); ++it) {
+        if (*it == caminhao.get()) {
+            nova->frota.erase(it);
+            break;
+        }
+    }
+    publicar(std::move(nova));
+    return caminhao;
+}
+
+void RegistroCaminhoes::publicar(std::unique_ptr<Tabela> nova) {
+    const Tabela* antiga = tabela_.exchange(nova.release());
+
+    // quem entrar daqui em diante conta na outra paridade e ja ve a tabela nova
+    std::uint64_t e = epoca_.fetch_add(1);
+    unsigned p = static_cast<unsigned>(e & 1);
+    while (leitores_[p].n.load() != 0) std::this_thread::yield();
+
+    delete antiga;
+}
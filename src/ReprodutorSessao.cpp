@@ -0,0 +1,154 @@
+// src/ReprodutorSessao.cpp
+#include "ReprodutorSessao.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+#include "SimulacaoMina.hpp"
+
+namespace {
+    struct ParametrosSessao {
+        bool          lockstep   = true;
+        unsigned      semente    = 1;
+        unsigned      spawn      = 1;
+        std::size_t   caminhoes  = 0;
+        std::size_t   capacidade = 200;
+    };
+
+    bool lerInicio(const std::string& dados, ParametrosSessao& p) {
+        char modo[16] = {};
+        if (std::sscanf(dados.c_str(), "modo=%15s semente=%u spawn=%u caminhoes=%zu capacidade=%zu",
+                        modo, &p.semente, &p.spawn, &p.caminhoes, &p.capacidade) != 5) {
+            return false;
+        }
+        p.lockstep = std::string(modo) == "lockstep";
+        return true;
+    }
+
+    std::uint64_t passoDe(double tempo_s) {
+        long long passo = std::llround(tempo_s / Caminhao::PASSO_LOCKSTEP_S);
+        return passo > 0 ? static_cast<std::uint64_t>(passo) : 0;
+    }
+
+    std::string pontoControleAtual(const SimulacaoMina& mina) {
+        std::string dados;
+        char item[40];
+        for (const auto& par : mina.resumoPorCaminhao()) {
+            int n = std::snprintf(item, sizeof(item), "%s%d:%016llx", dados.empty() ? "" : ",",
+                                  par.first, static_cast<unsigned long long>(par.second));
+            if (n > 0) dados.append(item, static_cast<std::size_t>(n));
+        }
+        return dados;
+    }
+}
+
+ReprodutorSessao::ReprodutorSessao(std::vector<EntradaSessao> entradas)
+    : entradas_(std::move(entradas))
+{
+}
+
+ResultadoReproducao ReprodutorSessao::reproduzir(double velocidade, const std::string& arquivoGravacao) {
+    ResultadoReproducao r;
+
+    if (entradas_.empty() || entradas_.front().tipo != TipoEntradaSessao::Inicio) {
+        r.erro = "sessao sem entrada INICIO";
+        return r;
+    }
+    ParametrosSessao p;
+    if (!lerInicio(entradas_.front().dados, p)) {
+        r.erro = "entrada INICIO invalida: " + entradas_.front().dados;
+        return r;
+    }
+
+    // sem telemetria: a reproducao nao pode truncar o log da execucao gravada
+    SimulacaoMina mina(static_cast<int>(p.caminhoes), p.capacidade, "");
+    if (!arquivoGravacao.empty()) mina.gravarSessao(arquivoGravacao);
+    // a partida posiciona os caminhoes iniciais com a semente do spawn, e uma sessao em tempo
+    // real tem uma semente de spawn propria
+    mina.definirSementeSpawn(p.spawn);
+    mina.iniciarLockstep(p.semente);
+
+    // avanca ate o passo pedido; com velocidade > 0 cada passo espera o seu instante no relogio
+    const auto inicioReal = std::chrono::steady_clock::now();
+    auto avancarAte = [&](std::uint64_t passo) {
+        if (velocidade <= 0.0) {
+            if (passo > mina.passoLockstep()) mina.avancarLockstep(passo - mina.passoLockstep());
+            return;
+        }
+        while (mina.passoLockstep() < passo) {
+            mina.avancarLockstep(1);
+            auto alvo = inicioReal + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(mina.tempoLockstep_s() / velocidade));
+            std::this_thread::sleep_until(alvo);
+        }
+    };
+
+    for (std::size_t i = 1; i < entradas_.size(); ++i) {
+        const EntradaSessao& e = entradas_[i];
+        if (e.tipo == TipoEntradaSessao::Mqtt) continue; // so registro, as acoes vem em entradas proprias
+
+        avancarAte(passoDe(e.tempo_s));
+
+        try {
+            switch (e.tipo) {
+                case TipoEntradaSessao::CriarCaminhao: {
+                    // "<capacidade>" ou "<capacidade> <n>" para um lote de criarCaminhoes
+                    std::size_t capacidade = 0, n = 1;
+                    if (std::sscanf(e.dados.c_str(), "%zu %zu", &capacidade, &n) < 1 || n == 0) {
+                        throw std::invalid_argument("dados de criacao invalidos: " + e.dados);
+                    }
+                    ResultadoCriacao criados = mina.criarCaminhoes(n, capacidade);
+                    int id = criados.ids.empty() ? 0 : criados.ids.front();
+                    if (id != e.idCaminhao) {
+                        r.divergencia.encontrada = true;
+                        r.divergencia.tempo_s    = e.tempo_s;
+                        r.divergencia.esperado   = "CRIAR " + std::to_string(e.idCaminhao);
+                        r.divergencia.obtido     = "CRIAR " + std::to_string(id);
+                    }
+                    break;
+                }
+                case TipoEntradaSessao::RemoverCaminhao:
+                    if (!mina.removerCaminhao(e.idCaminhao)) {
+                        throw std::invalid_argument("caminhao " + std::to_string(e.idCaminhao) + " inexistente");
+                    }
+                    break;
+                case TipoEntradaSessao::Falha: {
+                    bool aplicada = false;
+                    if      (e.dados == "TEMP") aplicada = mina.injetarFalhaTemperatura(e.idCaminhao);
+                    else if (e.dados == "ELET") aplicada = mina.injetarFalhaEletrica(e.idCaminhao);
+                    else if (e.dados == "HIDR") aplicada = mina.injetarFalhaHidraulica(e.idCaminhao);
+                    else throw std::invalid_argument("falha desconhecida " + e.dados);
+                    if (!aplicada) {
+                        throw std::invalid_argument("caminhao " + std::to_string(e.idCaminhao) + " inexistente");
+                    }
+                    break;
+                }
+                case TipoEntradaSessao::Comando:
+                    if (!mina.comandarCaminhao(e.idCaminhao, e.dados)) {
+                        throw std::invalid_argument("comando nao aplicado ao caminhao " + std::to_string(e.idCaminhao));
+                    }
+                    break;
+                case TipoEntradaSessao::PontoControle:
+                    r.divergencia = compararPontosControle(e.tempo_s, e.dados, pontoControleAtual(mina));
+                    ++r.pontosVerificados;
+                    break;
+                default:
+                    break;
+            }
+        } catch (const std::exception& ex) {
+            r.erro = "entrada " + std::to_string(i) + " (" + tipoEntradaSessaoToString(e.tipo) + "): " + ex.what();
+            break;
+        }
+        ++r.entradasAplicadas;
+        if (r.divergencia.encontrada) break;
+    }
+
+    r.tempoFinal_s = mina.tempoLockstep_s();
+    r.resumoFinal  = mina.resumoEstado();
+    r.ok = r.erro.empty() && !r.divergencia.encontrada;
+    mina.parar();
+    return r;
+}
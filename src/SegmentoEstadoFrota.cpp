@@ -0,0 +1,340 @@
+// src/SegmentoEstadoFrota.cpp
+#include "SegmentoEstadoFrota.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Log.hpp"
+
+using SegmentoFrota::Cabecalho;
+using SegmentoFrota::Slot;
+using SegmentoFrota::PALAVRAS_ESTADO;
+
+namespace {
+    // um escritor que morreu no meio da copia deixaria o slot impar para sempre
+    constexpr int MAX_TENTATIVAS_LEITURA = 1 << 16;
+
+    bool processoVivo(std::int32_t pid) {
+        return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    // quem criou o segmento que ja ocupa 'nome', para a mensagem de erro
+    std::string descreverDono(const std::string& nome) {
+        int fd = ::shm_open(nome.c_str(), O_RDONLY, 0);
+        if (fd < 0) return "dono desconhecido";
+        std::string d = "nao eh um segmento da frota";
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= SegmentoFrota::TAM_CABECALHO) {
+            void* p = ::mmap(nullptr, SegmentoFrota::TAM_CABECALHO, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                const Cabecalho* c = static_cast<const Cabecalho*>(p);
+                if (c->magico.load(std::memory_order_acquire) == SegmentoFrota::MAGICO) {
+                    d = "criado pelo processo " + std::to_string(c->criador) +
+                        (processoVivo(c->criador) ? ", ainda em execucao" : ", que ja terminou");
+                }
+                ::munmap(p, SegmentoFrota::TAM_CABECALHO);
+            }
+        }
+        ::close(fd);
+        return d;
+    }
+}
+
+SegmentoEstadoFrota::SegmentoEstadoFrota(const std::string& nome, std::size_t capacidade)
+    : nome_(nome),
+      capacidade_(capacidade),
+      fd_(-1),
+      base_(nullptr),
+      tamanho_(SegmentoFrota::tamanhoSegmento(capacidade)),
+      idDoSlot_(capacidade, 0),
+      rodadaDoSlot_(capacidade, 0),
+      rodada_(0),
+      emUso_(0),
+      frotaMudou_(false)
+{
+}
+
+SegmentoEstadoFrota::~SegmentoEstadoFrota() {
+    if (base_) ::munmap(base_, tamanho_);
+    if (fd_ >= 0) {
+        // leitores com o segmento mapeado continuam vendo o ultimo estado; so o nome some
+        // se outro escritor assumiu o nome nesse meio tempo, o segmento dele fica
+        int fdAtual = ::shm_open(nome_.c_str(), O_RDONLY, 0);
+        if (fdAtual >= 0) {
+            struct stat nosso, atual;
+            if (::fstat(fd_, &nosso) == 0 && ::fstat(fdAtual, &atual) == 0 &&
+                nosso.st_dev == atual.st_dev && nosso.st_ino == atual.st_ino) {
+                ::shm_unlink(nome_.c_str());
+            }
+            ::close(fdAtual);
+        }
+        ::close(fd_);
+    }
+}
+
+bool SegmentoEstadoFrota::abrir(bool assumir) {
+    if (base_) return true;
+
+    fd_ = ::shm_open(nome_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0 && errno == EEXIST) {
+        const std::string dono = descreverDono(nome_);
+        if (!assumir) {
+            Log::erro("[SegmentoFrota] O segmento %s ja existe (%s); use outro nome ou assuma o segmento",
+                      nome_.c_str(), dono.c_str());
+            return false;
+        }
+        Log::aviso("[SegmentoFrota] Assumindo o segmento %s (%s)", nome_.c_str(), dono.c_str());
+        ::shm_unlink(nome_.c_str());
+        fd_ = ::shm_open(nome_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd_ < 0) {
+        Log::erro("[SegmentoFrota] Nao foi possivel criar o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+        return false;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(tamanho_)) != 0) {
+        Log::erro("[SegmentoFrota] Nao foi possivel dimensionar o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+        return false;
+    }
+    void* p = ::mmap(nullptr, tamanho_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        Log::erro("[SegmentoFrota] Nao foi possivel mapear o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+        return false;
+    }
+    base_ = p;
+
+    // o ftruncate zera o segmento: todo slot comeca com sequencia zero (nunca escrito)
+    Cabecalho* c = static_cast<Cabecalho*>(base_);
+    c->versao        = SegmentoFrota::VERSAO;
+    c->capacidade    = static_cast<std::uint32_t>(capacidade_);
+    c->tamanhoEstado = static_cast<std::uint32_t>(sizeof(EstadoCaminhaoSegmento));
+    c->criador       = static_cast<std::int32_t>(::getpid());
+    c->magico.store(SegmentoFrota::MAGICO, std::memory_order_release);
+    return true;
+}
+
+void SegmentoEstadoFrota::iniciarPublicacao() {
+    ++rodada_;
+}
+
+bool SegmentoEstadoFrota::escrever(const EstadoCaminhaoSegmento& estado) {
+    if (!base_ || estado.id <= 0) return false;
+
+    const std::size_t id = static_cast<std::size_t>(estado.id);
+    if (id >= slotDoId_.size()) slotDoId_.resize(id + 1, -1);
+
+    std::int32_t slot = slotDoId_[id];
+    if (slot < 0) {
+        if (!livres_.empty()) {
+            slot = static_cast<std::int32_t>(livres_.back());
+            livres_.pop_back();
+        } else if (emUso_ < capacidade_) {
+            slot = static_cast<std::int32_t>(emUso_++);
+            static_cast<Cabecalho*>(base_)->slotsEmUso.store(emUso_, std::memory_order_release);
+        } else {
+            return false;
+        }
+        slotDoId_[id]   = slot;
+        idDoSlot_[slot] = estado.id;
+        frotaMudou_     = true;
+    }
+
+    rodadaDoSlot_[slot] = rodada_;
+    escreverSlot(static_cast<std::size_t>(slot), estado);
+    return true;
+}
+
+void SegmentoEstadoFrota::concluirPublicacao() {
+    if (!base_) return;
+
+    // quem nao apareceu nesta publicacao saiu da frota: o slot fica livre (id zero)
+    for (std::uint32_t s = 0; s < emUso_; ++s) {
+        if (idDoSlot_[s] == 0 || rodadaDoSlot_[s] == rodada_) continue;
+        slotDoId_[static_cast<std::size_t>(idDoSlot_[s])] = -1;
+        idDoSlot_[s] = 0;
+        EstadoCaminhaoSegmento livre{};
+        escreverSlot(s, livre);
+        livres_.push_back(s);
+        frotaMudou_ = true;
+    }
+
+    Cabecalho* c = static_cast<Cabecalho*>(base_);
+    if (frotaMudou_) {
+        c->geracao.fetch_add(1, std::memory_order_release);
+        frotaMudou_ = false;
+    }
+    c->publicacoes.fetch_add(1, std::memory_order_release);
+}
+
+void SegmentoEstadoFrota::escreverSlot(std::size_t slot, const EstadoCaminhaoSegmento& estado) {
+    Slot* s = reinterpret_cast<Slot*>(static_cast<char*>(base_) + SegmentoFrota::TAM_CABECALHO) + slot;
+
+    std::uint64_t palavras[PALAVRAS_ESTADO] = {};
+    std::memcpy(palavras, &estado, sizeof(EstadoCaminhaoSegmento));
+
+    // mesmo protocolo do slot do BufferCircular, com um escritor so
+    const std::uint64_t seq = s->seq.load(std::memory_order_relaxed);
+    s->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::size_t i = 0; i < PALAVRAS_ESTADO; ++i) {
+        s->palavras[i].store(palavras[i], std::memory_order_relaxed);
+    }
+
+    s->seq.store(seq + 2, std::memory_order_release);
+}
+
+EstadoCaminhaoSegmento SegmentoEstadoFrota::estadoDe(int id, const RegistroBuffer& reg,
+                                                     double pos_x, double pos_y, double vel, double ang_deg, double temp_C,
+                                                     NivelSeguranca nivel) {
+    EstadoCaminhaoSegmento e{};
+    e.id             = id;
+    e.estado         = static_cast<std::uint8_t>(reg.estado);
+    e.nivelSeguranca = static_cast<std::uint8_t>(nivel);
+    e.bits = static_cast<std::uint8_t>(
+        (reg.estados.e_automatico        ? EstadoCaminhaoSegmento::BIT_AUTOMATICO       : 0) |
+        (reg.estados.e_defeito           ? EstadoCaminhaoSegmento::BIT_DEFEITO          : 0) |
+        (reg.estados.e_bloqueio_rearme   ? EstadoCaminhaoSegmento::BIT_BLOQUEIO_REARME  : 0) |
+        (reg.sensores.i_falha_eletrica   ? EstadoCaminhaoSegmento::BIT_FALHA_ELETRICA   : 0) |
+        (reg.sensores.i_falha_hidraulica ? EstadoCaminhaoSegmento::BIT_FALHA_HIDRAULICA : 0));
+    e.tempoSimulacao_s = reg.tempoSimulacao_s;
+
+    e.pos_x   = pos_x;
+    e.pos_y   = pos_y;
+    e.vel     = vel;
+    e.ang_deg = ang_deg;
+    e.temp_C  = temp_C;
+
+    e.i_posicao_x   = reg.sensores.i_posicao_x;
+    e.i_posicao_y   = reg.sensores.i_posicao_y;
+    e.i_angulo_x    = reg.sensores.i_angulo_x;
+    e.i_temperatura = reg.sensores.i_temperatura;
+    e.o_aceleracao  = reg.atuadores.o_aceleracao;
+    e.o_direcao     = reg.atuadores.o_direcao;
+    e.sp_posicao_x  = reg.setpoints.sp_posicao_x;
+    e.sp_posicao_y  = reg.setpoints.sp_posicao_y;
+    e.sp_angulo_x   = reg.setpoints.sp_angulo_x;
+    return e;
+}
+
+LeitorEstadoFrota::LeitorEstadoFrota()
+    : fd_(-1),
+      base_(nullptr),
+      tamanho_(0)
+{
+}
+
+LeitorEstadoFrota::~LeitorEstadoFrota() {
+    if (base_) ::munmap(const_cast<void*>(base_), tamanho_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool LeitorEstadoFrota::abrir(const std::string& nome) {
+    if (base_) return true;
+
+    int fd = ::shm_open(nome.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        erro_ = "segmento " + nome + " nao encontrado: " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < SegmentoFrota::TAM_CABECALHO) {
+        erro_ = "segmento " + nome + " ainda sem cabecalho";
+        ::close(fd);
+        return false;
+    }
+    const std::size_t tamanho = static_cast<std::size_t>(st.st_size);
+    void* p = ::mmap(nullptr, tamanho, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        erro_ = "nao foi possivel mapear " + nome + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    const Cabecalho* c = static_cast<const Cabecalho*>(p);
+    if (c->magico.load(std::memory_order_acquire) != SegmentoFrota::MAGICO ||
+        c->versao != SegmentoFrota::VERSAO ||
+        c->tamanhoEstado != sizeof(EstadoCaminhaoSegmento) ||
+        SegmentoFrota::tamanhoSegmento(c->capacidade) != tamanho) {
+        erro_ = "segmento " + nome + " com layout diferente (ou ainda sendo criado)";
+        ::munmap(p, tamanho);
+        ::close(fd);
+        return false;
+    }
+
+    fd_      = fd;
+    base_    = p;
+    tamanho_ = tamanho;
+    erro_.clear();
+    return true;
+}
+
+const Cabecalho* LeitorEstadoFrota::cabecalho() const {
+    return static_cast<const Cabecalho*>(base_);
+}
+
+const Slot* LeitorEstadoFrota::slot(std::size_t i) const {
+    return reinterpret_cast<const Slot*>(static_cast<const char*>(base_) + SegmentoFrota::TAM_CABECALHO) + i;
+}
+
+std::size_t LeitorEstadoFrota::capacidade() const {
+    return base_ ? cabecalho()->capacidade : 0;
+}
+
+std::size_t LeitorEstadoFrota::slotsEmUso() const {
+    return base_ ? cabecalho()->slotsEmUso.load(std::memory_order_acquire) : 0;
+}
+
+std::uint64_t LeitorEstadoFrota::geracao() const {
+    return base_ ? cabecalho()->geracao.load(std::memory_order_acquire) : 0;
+}
+
+std::uint64_t LeitorEstadoFrota::publicacoes() const {
+    return base_ ? cabecalho()->publicacoes.load(std::memory_order_acquire) : 0;
+}
+
+bool LeitorEstadoFrota::lerSlot(std::size_t i, EstadoCaminhaoSegmento& out) const {
+    std::uint64_t sequencia;
+    return lerSlot(i, out, sequencia);
+}
+
+bool LeitorEstadoFrota::lerSlot(std::size_t i, EstadoCaminhaoSegmento& out, std::uint64_t& sequencia) const {
+    if (!base_ || i >= capacidade()) return false;
+    const Slot* s = slot(i);
+
+    std::uint64_t palavras[PALAVRAS_ESTADO];
+    std::uint64_t antes = 0;
+    for (int tentativa = 0;; ++tentativa) {
+        if (tentativa == MAX_TENTATIVAS_LEITURA) return false;
+        antes = s->seq.load(std::memory_order_acquire);
+        if (antes == 0) return false;  // nunca escrito
+        if (antes & 1u) continue;      // escritor no meio da copia
+
+        for (std::size_t k = 0; k < PALAVRAS_ESTADO; ++k) {
+            palavras[k] = s->palavras[k].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->seq.load(std::memory_order_relaxed) == antes) break;
+    }
+
+    std::memcpy(&out, palavras, sizeof(EstadoCaminhaoSegmento));
+    sequencia = antes / 2;
+    return out.id != 0;
+}
+
+std::uint64_t LeitorEstadoFrota::lerFrota(std::vector<EstadoCaminhaoSegmento>& out) const {
+    out.clear();
+    const std::uint64_t g = geracao();
+    const std::size_t n = slotsEmUso();
+    EstadoCaminhaoSegmento e;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (lerSlot(i, e)) out.push_back(e);
+    }
+    return g;
+}
@@ -0,0 +1,419 @@
+// src/SerieTemporalFrota.cpp
+#include "SerieTemporalFrota.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+    constexpr double RESOLUCOES_S[] = {0.0, 1.0, 10.0, 60.0};
+    constexpr std::size_t RESERVA_INICIAL = 64;  // pontos por nivel na primeira amostra
+    constexpr std::size_t NUM_CANAIS_SERIE = static_cast<std::size_t>(CanalSerie::Quantidade);
+
+    std::size_t capacidadePara(double retencao_s, double passo_s) {
+        if (retencao_s <= 0.0 || passo_s <= 0.0) return 1;
+        std::size_t n = static_cast<std::size_t>(std::ceil(retencao_s / passo_s));
+        return n == 0 ? 1 : n;
+    }
+
+    // mesmos canais e ordem de CanalSerie
+    std::array<float, NUM_CANAIS_SERIE> valoresDe(const RegistroBuffer& r) {
+        return {static_cast<float>(r.sensores.i_posicao_x),
+                static_cast<float>(r.sensores.i_posicao_y),
+                static_cast<float>(r.sensores.i_angulo_x),
+                static_cast<float>(r.sensores.i_temperatura),
+                static_cast<float>(r.atuadores.o_aceleracao),
+                static_cast<float>(r.atuadores.o_direcao)};
+    }
+
+    // uma posicao em todas as colunas de um nivel; o bruto so tem tempo e media
+    std::size_t bytesPorPontoDe(bool bruto) {
+        return sizeof(double) + (bruto ? NUM_CANAIS_SERIE * sizeof(float)
+                                       : sizeof(std::uint32_t) + 3 * NUM_CANAIS_SERIE * sizeof(float));
+    }
+
+    // reserva no orcamento da frota ate 'bytes', ou o que couber em multiplos de 'passo';
+    // devolve o que reservou
+    std::size_t reservarAte(std::atomic<std::size_t>& reservados, std::size_t maximo,
+                            std::size_t bytes, std::size_t passo) {
+        std::size_t atual = reservados.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::size_t livre = maximo > atual ? maximo - atual : 0;
+            const std::size_t r = std::min(bytes, livre / passo * passo);
+            if (r == 0) return 0;
+            if (reservados.compare_exchange_weak(atual, atual + r, std::memory_order_relaxed)) return r;
+        }
+    }
+}
+
+std::size_t SerieTemporalFrota::Nivel::bytesPorPonto() const {
+    return bytesPorPontoDe(resolucao_s <= 0.0);
+}
+
+// reserva a proxima posicao do anel, sobrescrevendo a mais antiga quando cheio
+// antes de encher o anel so cresce no fim (inicio == 0), entao idx == tempo.size()
+// sem orcamento para crescer, o anel fica do tamanho que ja tem e passa a sobrescrever
+std::size_t SerieTemporalFrota::Nivel::proximaEscrita(Limite& lim) {
+    if (quantidade < capacidade && quantidade == tempo.size() && !crescer(lim)) {
+        if (tempo.empty()) return SEM_POSICAO;
+        capacidade = tempo.size();
+    }
+    std::size_t idx = (inicio + quantidade) % capacidade;
+    if (quantidade < capacidade) {
+        ++quantidade;
+    } else {
+        inicio = (inicio + 1) % capacidade;
+    }
+    return idx;
+}
+
+// uma posicao a mais em todas as colunas; a reserva dobra ate a capacidade do nivel,
+// entao um caminhao que vive pouco nao paga a retencao inteira, e cada reserva sai do
+// orcamento da frota (se nao couber inteira, o que couber)
+bool SerieTemporalFrota::Nivel::crescer(Limite& lim) {
+    const bool bruto = (resolucao_s <= 0.0);
+    const std::size_t n = tempo.size() + 1;
+    if (n > reservados) {
+        const std::size_t desejada = std::min(capacidade, std::max<std::size_t>(RESERVA_INICIAL, 2 * reservados));
+        const std::size_t porPonto = bytesPorPonto();
+        const std::size_t extra = reservarAte(lim.reservadosFrota, lim.maximoFrota,
+                                              (desejada - reservados) * porPonto, porPonto);
+        if (extra == 0) return false;
+        lim.bytesSerie += extra;
+        reservados += extra / porPonto;
+
+        tempo.reserve(reservados);
+        for (std::size_t c = 0; c < NUM_CANAIS; ++c) {
+            media[c].reserve(reservados);
+            if (!bruto) {
+                minimo[c].reserve(reservados);
+                maximo[c].reserve(reservados);
+            }
+        }
+        if (!bruto) contagem.reserve(reservados);
+    }
+    tempo.resize(n);
+    for (std::size_t c = 0; c < NUM_CANAIS; ++c) {
+        media[c].resize(n);
+        if (!bruto) {
+            minimo[c].resize(n);
+            maximo[c].resize(n);
+        }
+    }
+    if (!bruto) contagem.resize(n);
+    return true;
+}
+
+// nova capacidade do anel, guardando os pontos mais novos que couberem; a reserva nunca
+// aumenta aqui (quem chama devolve a diferenca ao orcamento), o anel volta a crescer por
+// crescer se a capacidade nova for maior
+void SerieTemporalFrota::Nivel::redimensionar(std::size_t novaCapacidade) {
+    if (novaCapacidade == 0) novaCapacidade = 1;
+    if (novaCapacidade == capacidade) return;
+    if (inicio == 0 && quantidade == tempo.size() && reservados <= novaCapacidade) {
+        capacidade = novaCapacidade;  // ainda no crescimento inicial, nada a mover
+        return;
+    }
+
+    const bool bruto = (resolucao_s <= 0.0);
+    const std::size_t manter = std::min(quantidade, novaCapacidade);
+    auto recortar = [&](auto& coluna) {
+        typename std::remove_reference<decltype(coluna)>::type nova;
+        nova.reserve(manter);
+        for (std::size_t i = quantidade - manter; i < quantidade; ++i) nova.push_back(coluna[posicao(i)]);
+        coluna.swap(nova);
+    };
+    recortar(tempo);
+    for (std::size_t c = 0; c < NUM_CANAIS; ++c) {
+        recortar(media[c]);
+        if (!bruto) {
+            recortar(minimo[c]);
+            recortar(maximo[c]);
+        }
+    }
+    if (!bruto) recortar(contagem);
+
+    inicio     = 0;
+    quantidade = manter;
+    reservados = manter;
+    capacidade = novaCapacidade;
+}
+
+void SerieTemporalFrota::Nivel::fecharAberto(Limite& lim) {
+    if (!abertoValido) return;
+    abertoValido = false;
+    std::size_t idx = proximaEscrita(lim);
+    if (idx == SEM_POSICAO) return;
+    tempo[idx]    = static_cast<double>(abertoIndice) * resolucao_s;
+    contagem[idx] = abertoContagem;
+    for (std::size_t c = 0; c < NUM_CANAIS; ++c) {
+        minimo[c][idx] = abertoMinimo[c];
+        maximo[c][idx] = abertoMaximo[c];
+        media[c][idx]  = static_cast<float>(abertoSoma[c] / abertoContagem);
+    }
+}
+
+void SerieTemporalFrota::Nivel::acumular(double t_s, const std::array<float, NUM_CANAIS>& v, Limite& lim) {
+    if (resolucao_s <= 0.0) {
+        std::size_t idx = proximaEscrita(lim);
+        if (idx == SEM_POSICAO) return;
+        tempo[idx] = t_s;
+        for (std::size_t c = 0; c < NUM_CANAIS; ++c) media[c][idx] = v[c];
+        return;
+    }
+
+    std::int64_t balde = static_cast<std::int64_t>(std::floor(t_s / resolucao_s));
+    if (abertoValido && balde != abertoIndice) fecharAberto(lim);
+    if (!abertoValido) {
+        abertoValido   = true;
+        abertoIndice   = balde;
+        abertoContagem = 0;
+        abertoMinimo   = v;
+        abertoMaximo   = v;
+        abertoSoma.fill(0.0);
+    }
+    ++abertoContagem;
+    for (std::size_t c = 0; c < NUM_CANAIS; ++c) {
+        if (v[c] < abertoMinimo[c]) abertoMinimo[c] = v[c];
+        if (v[c] > abertoMaximo[c]) abertoMaximo[c] = v[c];
+        abertoSoma[c] += v[c];
+    }
+}
+
+// lower_bound e upper_bound sobre os indices logicos do anel
+std::size_t SerieTemporalFrota::Nivel::primeiroAPartirDe(double t_s) const {
+    std::size_t lo = 0, hi = quantidade;
+    while (lo < hi) {
+        std::size_t meio = lo + (hi - lo) / 2;
+        if (tempo[posicao(meio)] < t_s) lo = meio + 1;
+        else hi = meio;
+    }
+    return lo;
+}
+
+std::size_t SerieTemporalFrota::Nivel::primeiroDepoisDe(double t_s) const {
+    std::size_t lo = 0, hi = quantidade;
+    while (lo < hi) {
+        std::size_t meio = lo + (hi - lo) / 2;
+        if (tempo[posicao(meio)] <= t_s) lo = meio + 1;
+        else hi = meio;
+    }
+    return lo;
+}
+
+SerieTemporalFrota::SerieTemporalFrota(const ConfigSerieTemporal& cfg)
+    : cfg_(cfg),
+      bytesPorCaminhao_(0),
+      bytesMinimos_(0),
+      ignoradas_(0),
+      reservados_(0)
+{
+    for (std::size_t n = 0; n < NUM_NIVEIS; ++n) {
+        ResolucaoSerie r = static_cast<ResolucaoSerie>(n);
+        bool bruto = (r == ResolucaoSerie::Bruta);
+        capacidadeCheia_[n] = capacidadePara(retencao(r), bruto ? cfg_.periodoAmostra_s : RESOLUCOES_S[n]);
+        bytesPorCaminhao_ += capacidadeCheia_[n] * bytesPorPontoDe(bruto);
+        bytesMinimos_     += bytesPorPontoDe(bruto);
+    }
+}
+
+double SerieTemporalFrota::retencao(ResolucaoSerie r) const {
+    switch (r) {
+        case ResolucaoSerie::Bruta:       return cfg_.retencaoBruta_s;
+        case ResolucaoSerie::Segundo:     return cfg_.retencaoSegundo_s;
+        case ResolucaoSerie::DezSegundos: return cfg_.retencaoDezSegundos_s;
+        case ResolucaoSerie::Minuto:      return cfg_.retencaoMinuto_s;
+        default:                          return 0.0;
+    }
+}
+
+std::shared_ptr<SerieTemporalFrota::SerieCaminhao> SerieTemporalFrota::buscar(int idCaminhao) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = series_.find(idCaminhao);
+    return it == series_.end() ? nullptr : it->second;
+}
+
+// menor reducao (retencao dividida por 2^reducao) com que 'series' caminhoes cabem no orcamento
+unsigned SerieTemporalFrota::reducaoPara(std::size_t series) const {
+    unsigned reducao = 0;
+    while (reducao < 63 && (bytesPorCaminhao_ >> reducao) > 0 &&
+           series > cfg_.bytesMaximos / std::max<std::size_t>(bytesPorCaminhao_ >> reducao, 1)) {
+        ++reducao;
+    }
+    return reducao;
+}
+
+std::shared_ptr<SerieTemporalFrota::SerieCaminhao> SerieTemporalFrota::buscarOuCriar(int idCaminhao, unsigned& reducao) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = series_.find(idCaminhao);
+    if (it != series_.end()) {
+        reducao = reducaoPara(series_.size());
+        return it->second;
+    }
+    if (reservados_.load(std::memory_order_relaxed) + bytesMinimos_ > cfg_.bytesMaximos) return nullptr;
+
+    // os aneis comecam vazios e crescem com as amostras ate a capacidade (Nivel::crescer)
+    reducao = reducaoPara(series_.size() + 1);
+    auto s = std::make_shared<SerieCaminhao>();
+    s->reducao = reducao;
+    for (std::size_t n = 0; n < NUM_NIVEIS; ++n) {
+        Nivel& nv = s->niveis[n];
+        nv.resolucao_s = RESOLUCOES_S[n];
+        nv.capacidade  = std::max<std::size_t>(capacidadeCheia_[n] >> reducao, 1);
+    }
+
+    series_.emplace(idCaminhao, s);
+    return s;
+}
+
+// chamada com s.mtx; com a frota maior a retencao cai pela metade e a reserva que sobra volta
+// ao orcamento, com a frota menor a capacidade sobe e os aneis crescem de novo com as amostras
+void SerieTemporalFrota::ajustarRetencao(SerieCaminhao& s, unsigned reducao) {
+    if (s.reducao == reducao) return;
+    s.reducao = reducao;
+    std::size_t bytes = 0;
+    for (std::size_t n = 0; n < NUM_NIVEIS; ++n) {
+        s.niveis[n].redimensionar(std::max<std::size_t>(capacidadeCheia_[n] >> reducao, 1));
+        bytes += s.niveis[n].bytes();
+    }
+    reservados_.fetch_sub(s.bytes - bytes, std::memory_order_relaxed);
+    s.bytes = bytes;
+}
+
+std::size_t SerieTemporalFrota::inserir(int idCaminhao, const RegistroBuffer* registros, std::size_t n) {
+    if (n == 0) return 0;
+    unsigned reducao = 0;
+    std::shared_ptr<SerieCaminhao> s = buscarOuCriar(idCaminhao, reducao);
+    if (!s) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ignoradas_ += n;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(s->mtx);
+    if (s->removida) return 0;  // removida depois de buscada: fica fora do orcamento
+    ajustarRetencao(*s, reducao);
+
+    Limite lim{reservados_, cfg_.bytesMaximos, s->bytes};
+    std::size_t aceitas = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const RegistroBuffer& r = registros[i];
+        if (r.tempoSimulacao_s <= s->ultimoTempo_s) continue;
+        s->ultimoTempo_s = r.tempoSimulacao_s;
+
+        const auto v = valoresDe(r);
+        for (Nivel& nv : s->niveis) nv.acumular(r.tempoSimulacao_s, v, lim);
+        ++aceitas;
+    }
+    return aceitas;
+}
+
+bool SerieTemporalFrota::aceita(int idCaminhao) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (reservados_.load(std::memory_order_relaxed) + bytesMinimos_ <= cfg_.bytesMaximos) return true;
+    return series_.count(idCaminhao) > 0;
+}
+
+// quem ja buscou a serie (inserir, consultar) termina com ela; a memoria sai com o ultimo,
+// mas o orcamento volta na hora
+bool SerieTemporalFrota::remover(int idCaminhao) {
+    std::shared_ptr<SerieCaminhao> s;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = series_.find(idCaminhao);
+        if (it == series_.end()) return false;
+        s = std::move(it->second);
+        series_.erase(it);
+    }
+    std::lock_guard<std::mutex> lock(s->mtx);
+    s->removida = true;
+    reservados_.fetch_sub(s->bytes, std::memory_order_relaxed);
+    s->bytes = 0;
+    return true;
+}
+
+double SerieTemporalFrota::ultimoTempo(int idCaminhao) const {
+    std::shared_ptr<SerieCaminhao> s = buscar(idCaminhao);
+    if (!s) return -1.0;
+    std::lock_guard<std::mutex> lock(s->mtx);
+    return s->ultimoTempo_s;
+}
+
+std::size_t SerieTemporalFrota::consultar(int idCaminhao, CanalSerie canal, ResolucaoSerie resolucao,
+                                          double desde_s, double ate_s, std::vector<PontoSerie>& out) const {
+    out.clear();
+    std::size_t c = static_cast<std::size_t>(canal);
+    std::size_t n = static_cast<std::size_t>(resolucao);
+    if (c >= NUM_CANAIS || n >= NUM_NIVEIS) return 0;
+
+    std::shared_ptr<SerieCaminhao> s = buscar(idCaminhao);
+    if (!s) return 0;
+
+    std::lock_guard<std::mutex> lock(s->mtx);
+    const Nivel& nv = s->niveis[n];
+    std::size_t primeiro = nv.primeiroAPartirDe(desde_s);
+    std::size_t fim      = nv.primeiroDepoisDe(ate_s);
+    if (fim > primeiro) out.reserve(fim - primeiro + 1);
+
+    const bool bruto = (resolucao == ResolucaoSerie::Bruta);
+    for (std::size_t i = primeiro; i < fim; ++i) {
+        std::size_t p = nv.posicao(i);
+        if (bruto) {
+            float v = nv.media[c][p];
+            out.push_back(PontoSerie{nv.tempo[p], v, v, v, 1});
+        } else {
+            out.push_back(PontoSerie{nv.tempo[p], nv.minimo[c][p], nv.maximo[c][p], nv.media[c][p], nv.contagem[p]});
+        }
+    }
+
+    if (!bruto && nv.abertoValido) {
+        double t = static_cast<double>(nv.abertoIndice) * nv.resolucao_s;
+        if (t >= desde_s && t <= ate_s) {
+            out.push_back(PontoSerie{t, nv.abertoMinimo[c], nv.abertoMaximo[c],
+                                     static_cast<float>(nv.abertoSoma[c] / nv.abertoContagem), nv.abertoContagem});
+        }
+    }
+    return out.size();
+}
+
+ResolucaoSerie SerieTemporalFrota::resolucaoPara(int idCaminhao, double desde_s, double ate_s,
+                                                 std::size_t maxPontos) const {
+    std::shared_ptr<SerieCaminhao> s = buscar(idCaminhao);
+    double largura = ate_s > desde_s ? ate_s - desde_s : 0.0;
+
+    for (std::size_t n = 0; n < NUM_NIVEIS; ++n) {
+        ResolucaoSerie r = static_cast<ResolucaoSerie>(n);
+        double passo = (r == ResolucaoSerie::Bruta) ? cfg_.periodoAmostra_s : RESOLUCOES_S[n];
+        bool cabe    = passo > 0.0 && largura / passo <= static_cast<double>(maxPontos);
+        if (!cabe) continue;
+        if (!s) return r;
+
+        // o nivel retem desde_s se ainda nao descartou nada ou se o ponto mais antigo eh anterior
+        std::lock_guard<std::mutex> lock(s->mtx);
+        const Nivel& nv = s->niveis[n];
+        if (nv.quantidade < nv.capacidade || nv.tempo[nv.posicao(0)] <= desde_s) return r;
+    }
+    return ResolucaoSerie::Minuto;
+}
+
+std::size_t SerieTemporalFrota::bytesReservados() const {
+    return reservados_.load(std::memory_order_relaxed);
+}
+
+std::size_t SerieTemporalFrota::bytesMaximos() const {
+    return cfg_.bytesMaximos;
+}
+
+std::size_t SerieTemporalFrota::bytesPorCaminhao() const {
+    return bytesPorCaminhao_;
+}
+
+std::size_t SerieTemporalFrota::quantidadeCaminhoes() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return series_.size();
+}
+
+std::uint64_t SerieTemporalFrota::amostrasIgnoradas() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return ignoradas_;
+}
@@ -0,0 +1,197 @@
+// src/SessaoGravada.cpp
+#include "SessaoGravada.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    std::string escapar(const std::string& s) {
+        std::string r;
+        r.reserve(s.size());
+        for (char c : s) {
+            if      (c == '\\') r += "\\\\";
+            else if (c == '\t') r += "\\t";
+            else if (c == '\n') r += "\\n";
+            else                r += c;
+        }
+        return r;
+    }
+
+    std::string desescapar(const std::string& s) {
+        std::string r;
+        r.reserve(s.size());
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '\\' && i + 1 < s.size()) {
+                char c = s[++i];
+                r += (c == 't') ? '\t' : (c == 'n') ? '\n' : c;
+            } else {
+                r += s[i];
+            }
+        }
+        return r;
+    }
+
+    bool tipoDeTexto(const std::string& s, TipoEntradaSessao& out) {
+        for (int t = static_cast<int>(TipoEntradaSessao::Inicio); t <= static_cast<int>(TipoEntradaSessao::Fim); ++t) {
+            if (s == tipoEntradaSessaoToString(static_cast<TipoEntradaSessao>(t))) {
+                out = static_cast<TipoEntradaSessao>(t);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // dados de ponto de controle: "id:hash,id:hash,..." com hash em hexadecimal
+    std::vector<std::pair<int, std::string>> separarControle(const std::string& s) {
+        std::vector<std::pair<int, std::string>> r;
+        std::size_t pos = 0;
+        while (pos < s.size()) {
+            std::size_t fim = s.find(',', pos);
+            if (fim == std::string::npos) fim = s.size();
+            std::size_t dp = s.find(':', pos);
+            if (dp != std::string::npos && dp < fim) {
+                r.emplace_back(std::atoi(s.c_str() + pos), s.substr(dp + 1, fim - dp - 1));
+            }
+            pos = fim + 1;
+        }
+        return r;
+    }
+}
+
+const char* tipoEntradaSessaoToString(TipoEntradaSessao t) {
+    switch (t) {
+        case TipoEntradaSessao::Inicio:           return "INICIO";
+        case TipoEntradaSessao::Mqtt:             return "MQTT";
+        case TipoEntradaSessao::CriarCaminhao:    return "CRIAR";
+        case TipoEntradaSessao::RemoverCaminhao:  return "REMOVER";
+        case TipoEntradaSessao::Falha:            return "FALHA";
+        case TipoEntradaSessao::Comando:          return "COMANDO";
+        case TipoEntradaSessao::PontoControle:    return "CONTROLE";
+        case TipoEntradaSessao::Fim:              return "FIM";
+        default:                                  return "DESCONHECIDO";
+    }
+}
+
+GravadorSessao::GravadorSessao(const std::string& caminhoArquivo)
+    : arquivo_(caminhoArquivo, std::ios::out | std::ios::trunc)
+{
+    if (arquivo_.is_open()) {
+        arquivo_ << MAGICO_SESSAO << '\n';
+        arquivo_.flush();
+    }
+}
+
+void GravadorSessao::definirRelogio(std::function<double()> relogio) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    relogio_ = std::move(relogio);
+}
+
+void GravadorSessao::registrar(TipoEntradaSessao tipo, int idCaminhao, const std::string& dados) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!arquivo_.is_open()) return;
+
+    double t = relogio_ ? relogio_() : 0.0;
+    char prefixo[64];
+    std::snprintf(prefixo, sizeof(prefixo), "%.6f\t%s\t%d\t", t, tipoEntradaSessaoToString(tipo), idCaminhao);
+    arquivo_ << prefixo << escapar(dados) << '\n';
+
+    // uma entrada de acao precisa estar no disco se o processo cair logo depois
+    if (tipo != TipoEntradaSessao::PontoControle) arquivo_.flush();
+}
+
+bool lerSessao(const std::string& caminhoArquivo, std::vector<EntradaSessao>& out, std::string& erro) {
+    out.clear();
+    std::ifstream arq(caminhoArquivo);
+    if (!arq.is_open()) {
+        erro = "nao foi possivel abrir " + caminhoArquivo;
+        return false;
+    }
+
+    std::string linha;
+    if (!std::getline(arq, linha) || linha != MAGICO_SESSAO) {
+        erro = "cabecalho de sessao invalido";
+        return false;
+    }
+
+    std::size_t numLinha = 1;
+    while (std::getline(arq, linha)) {
+        ++numLinha;
+        if (linha.empty()) continue;
+
+        std::size_t t1 = linha.find('\t');
+        std::size_t t2 = (t1 == std::string::npos) ? t1 : linha.find('\t', t1 + 1);
+        std::size_t t3 = (t2 == std::string::npos) ? t2 : linha.find('\t', t2 + 1);
+        EntradaSessao e;
+        if (t3 == std::string::npos || !tipoDeTexto(linha.substr(t1 + 1, t2 - t1 - 1), e.tipo)) {
+            erro = "linha " + std::to_string(numLinha) + " invalida";
+            return false;
+        }
+        e.tempo_s    = std::strtod(linha.c_str(), nullptr);
+        e.idCaminhao = std::atoi(linha.c_str() + t2 + 1);
+        e.dados      = desescapar(linha.substr(t3 + 1));
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+DivergenciaSessao compararPontosControle(double tempo_s, const std::string& esperado, const std::string& obtido) {
+    DivergenciaSessao d;
+    if (esperado == obtido) return d;
+
+    d.encontrada = true;
+    d.tempo_s    = tempo_s;
+    auto a = separarControle(esperado);
+    auto b = separarControle(obtido);
+    for (std::size_t i = 0; i < a.size() || i < b.size(); ++i) {
+        bool temA = i < a.size(), temB = i < b.size();
+        if (temA && temB && a[i] == b[i]) continue;
+        d.idCaminhao = temA ? a[i].first : b[i].first;
+        d.esperado   = temA ? a[i].second : "(ausente)";
+        d.obtido     = temB ? b[i].second : "(ausente)";
+        break;
+    }
+    return d;
+}
+
+DivergenciaSessao compararSessoes(const std::vector<EntradaSessao>& a, const std::vector<EntradaSessao>& b) {
+    auto proxima = [](const std::vector<EntradaSessao>& v, std::size_t i) {
+        while (i < v.size() && v[i].tipo == TipoEntradaSessao::Mqtt) ++i;
+        return i;
+    };
+    auto descrever = [](const EntradaSessao& e) {
+        return std::string(tipoEntradaSessaoToString(e.tipo)) + " " + std::to_string(e.idCaminhao) + " " + e.dados;
+    };
+
+    std::size_t i = proxima(a, 0), j = proxima(b, 0);
+    while (i < a.size() && j < b.size()) {
+        const EntradaSessao& ea = a[i];
+        const EntradaSessao& eb = b[j];
+
+        if (ea.tipo == TipoEntradaSessao::PontoControle && eb.tipo == TipoEntradaSessao::PontoControle &&
+            std::fabs(ea.tempo_s - eb.tempo_s) < 1e-6) {
+            DivergenciaSessao d = compararPontosControle(ea.tempo_s, ea.dados, eb.dados);
+            if (d.encontrada) return d;
+        } else if (ea.tipo != eb.tipo || ea.idCaminhao != eb.idCaminhao || ea.dados != eb.dados ||
+                   std::fabs(ea.tempo_s - eb.tempo_s) >= 1e-6) {
+            DivergenciaSessao d;
+            d.encontrada = true;
+            d.tempo_s    = ea.tempo_s < eb.tempo_s ? ea.tempo_s : eb.tempo_s;
+            d.esperado   = descrever(ea);
+            d.obtido     = descrever(eb);
+            return d;
+        }
+        i = proxima(a, i + 1);
+        j = proxima(b, j + 1);
+    }
+
+    if (i < a.size() || j < b.size()) {
+        DivergenciaSessao d;
+        d.encontrada = true;
+        d.tempo_s    = (i < a.size()) ? a[i].tempo_s : b[j].tempo_s;
+        d.esperado   = (i < a.size()) ? descrever(a[i]) : "(fim)";
+        d.obtido     = (j < b.size()) ? descrever(b[j]) : "(fim)";
+        return d;
+    }
+    return DivergenciaSessao{};
+}
@@ -0,0 +1,268 @@
+// src/ShardMina.cpp
+#include "ShardMina.hpp"
+
+#include <algorithm>
+
+#include "Log.hpp"
+
+namespace {
+    // intervalo entre os anuncios de presenca enquanto os shards se procuram
+    constexpr auto PAUSA_PRESENCA = std::chrono::milliseconds(100);
+    // fatia da espera do lockstep entre duas consultas ao transporte
+    constexpr auto FATIA_ESPERA   = std::chrono::milliseconds(100);
+
+    // origem de uma mensagem de shard, -1 se nao for uma
+    int origemDe(const std::string& m, ProtocoloMqtt::TipoMensagem& tipo) {
+        using ProtocoloMqtt::TipoMensagem;
+        if (!ProtocoloMqtt::tipoDe(m.data(), m.size(), tipo)) return -1;
+        if (tipo != TipoMensagem::Presenca && tipo != TipoMensagem::QuadroBorda && tipo != TipoMensagem::Migracao) return -1;
+        if (m.size() <= ProtocoloMqtt::TAM_CABECALHO) return -1;
+        return static_cast<unsigned char>(m[ProtocoloMqtt::TAM_CABECALHO]);
+    }
+
+    ProtocoloMqtt::AmostraBorda paraBorda(const Anticolisao::Amostra& a) {
+        return {a.id,
+                static_cast<int>(a.pos.x), static_cast<int>(a.pos.y),
+                a.vx, a.vy,
+                static_cast<int>(a.rumo_graus),
+                a.emMissao};
+    }
+
+    Anticolisao::Amostra deBorda(const ProtocoloMqtt::AmostraBorda& b) {
+        return {b.id,
+                {static_cast<double>(b.x), static_cast<double>(b.y)},
+                b.vx, b.vy,
+                b.emMissao,
+                static_cast<double>(b.rumo_graus)};
+    }
+}
+
+ShardMina::ShardMina(const ParticaoMina& particao, int indice, std::unique_ptr<TransporteShards> transporte)
+    : particao_(particao),
+      indice_(indice),
+      transporte_(std::move(transporte)),
+      vizinhos_(static_cast<std::size_t>(particao.quantidade())),
+      lockstep_(false),
+      passoAtual_(0),
+      quadros_(static_cast<std::size_t>(particao.quantidade()))
+{
+}
+
+bool ShardMina::conectar(std::chrono::milliseconds prazo) {
+    if (!transporte_->abrir()) return false;
+
+    const int n = particao_.quantidade();
+    std::vector<char> visto(static_cast<std::size_t>(n), 0);
+    std::vector<char> pronto(static_cast<std::size_t>(n), 0);
+    visto[indice_]  = 1;
+    pronto[indice_] = 1;
+    auto todos = [](const std::vector<char>& v) { return std::all_of(v.begin(), v.end(), [](char c) { return c != 0; }); };
+
+    // cada shard se anuncia ate ter ouvido todos ("completo") e so sai depois de ouvir o
+    // completo de todos; o ultimo anuncio de quem sai ja eh completo, entao ninguem fica
+    // esperando por um shard que parou de se anunciar
+    // pelo MQTT um anuncio feito antes de o outro assinar se perde, por isso a repeticao
+    const auto limite = std::chrono::steady_clock::now() + prazo;
+    for (;;) {
+        const bool completo = todos(visto);
+        ProtocoloMqtt::codificarPresenca(indice_, completo, mensagem_);
+        for (int s = 0; s < n; ++s) {
+            if (s != indice_) transporte_->enviar(s, mensagem_);
+        }
+        if (completo && todos(pronto)) return true;
+        if (std::chrono::steady_clock::now() >= limite) {
+            Log::erro("[Shards] Shard %d: prazo vencido esperando os outros shards", indice_);
+            return false;
+        }
+
+        transporte_->esperar(PAUSA_PRESENCA);
+        recebidas_.clear();
+        transporte_->receber(recebidas_);
+        for (std::string& m : recebidas_) {
+            ProtocoloMqtt::TipoMensagem tipo;
+            const int origem = origemDe(m, tipo);
+            if (origem < 0 || origem >= n || origem == indice_) continue;
+            visto[origem] = 1;
+
+            int o;
+            bool oCompleto = false;
+            if (tipo == ProtocoloMqtt::TipoMensagem::Presenca) {
+                if (ProtocoloMqtt::decodificarPresenca(m.data(), m.size(), o, oCompleto) && oCompleto) pronto[origem] = 1;
+            } else {
+                // o vizinho ja saiu do anuncio e comecou a rodar
+                pronto[origem] = 1;
+                vizinhos_[origem].pendentes.push_back(std::move(m));
+            }
+        }
+    }
+}
+
+bool ShardMina::enviarMigracao(int destino, std::uint64_t passo, const EstadoMigracao& estado) {
+    ProtocoloMqtt::codificarMigracao(indice_, passo, estado, mensagem_);
+    const bool ok = transporte_->enviar(destino, mensagem_);
+
+    std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+    if (ok) ++estatisticas_.migracoesEnviadas;
+    else    ++estatisticas_.falhasEnvio;
+    return ok;
+}
+
+void ShardMina::publicarBorda(std::uint64_t passo, const std::vector<Anticolisao::Amostra>& amostras) {
+    const int n = particao_.quantidade();
+    for (int s = 0; s < n; ++s) {
+        if (s != indice_) ProtocoloMqtt::iniciarBorda(indice_, passo, quadros_[s]);
+    }
+    for (const Anticolisao::Amostra& a : amostras) {
+        particao_.vizinhosDe(a.pos.x, indice_, destinos_);
+        for (int d : destinos_) ProtocoloMqtt::anexarABorda(paraBorda(a), quadros_[d]);
+    }
+
+    std::uint64_t enviados = 0, falhas = 0;
+    for (int s = 0; s < n; ++s) {
+        if (s == indice_) continue;
+        if (transporte_->enviar(s, quadros_[s])) ++enviados;
+        else                                     ++falhas;
+    }
+
+    std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+    estatisticas_.quadrosEnviados += enviados;
+    estatisticas_.falhasEnvio     += falhas;
+}
+
+void ShardMina::distribuir() {
+    recebidas_.clear();
+    transporte_->receber(recebidas_);
+
+    std::uint64_t descartadas = 0;
+    for (std::string& m : recebidas_) {
+        ProtocoloMqtt::TipoMensagem tipo;
+        const int origem = origemDe(m, tipo);
+        if (origem < 0 || origem >= particao_.quantidade() || origem == indice_) {
+            ++descartadas;
+            continue;
+        }
+        // anuncios repetidos de quem ainda estava saindo do aperto de maos
+        if (tipo == ProtocoloMqtt::TipoMensagem::Presenca) continue;
+        vizinhos_[origem].pendentes.push_back(std::move(m));
+    }
+
+    if (descartadas > 0) {
+        std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+        estatisticas_.descartadas += descartadas;
+    }
+}
+
+void ShardMina::tratarPendentes(int origem, bool limitar, std::uint64_t ate, std::vector<EstadoMigracao>& chegadas) {
+    using ProtocoloMqtt::TipoMensagem;
+    Vizinho& v = vizinhos_[origem];
+    Estatisticas delta;
+
+    while (!v.pendentes.empty()) {
+        const std::string& m = v.pendentes.front();
+        TipoMensagem tipo;
+        int o;
+        std::uint64_t passo = 0;
+
+        if (ProtocoloMqtt::tipoDe(m.data(), m.size(), tipo) && tipo == TipoMensagem::QuadroBorda) {
+            if (!ProtocoloMqtt::decodificarBorda(m.data(), m.size(), o, passo, amostrasBorda_)) {
+                ++delta.descartadas;
+                v.pendentes.pop_front();
+                continue;
+            }
+            // quadro de um passo adiante: o vizinho ja avancou, fica para o proximo passo
+            if (limitar && passo > ate) break;
+
+            v.fantasmas.clear();
+            for (const auto& b : amostrasBorda_) v.fantasmas.push_back(deBorda(b));
+            v.passoQuadro   = passo;
+            v.temQuadro     = true;
+            v.chegadaQuadro = std::chrono::steady_clock::now();
+            ++delta.quadrosRecebidos;
+            delta.fantasmas += amostrasBorda_.size();
+            v.pendentes.pop_front();
+            if (limitar && passo == ate) break;
+            continue;
+        }
+
+        EstadoMigracao e;
+        if (ProtocoloMqtt::decodificarMigracao(m.data(), m.size(), o, passo, e)) {
+            chegadas.push_back(e);
+            ++delta.migracoesRecebidas;
+        } else {
+            ++delta.descartadas;
+        }
+        v.pendentes.pop_front();
+    }
+
+    std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+    estatisticas_.quadrosRecebidos   += delta.quadrosRecebidos;
+    estatisticas_.fantasmas          += delta.fantasmas;
+    estatisticas_.migracoesRecebidas += delta.migracoesRecebidas;
+    estatisticas_.descartadas        += delta.descartadas;
+}
+
+bool ShardMina::receber(bool esperarPasso, std::uint64_t passo, std::vector<EstadoMigracao>& chegadas) {
+    chegadas.clear();
+    lockstep_   = esperarPasso;
+    passoAtual_ = passo;
+    distribuir();
+
+    const int n = particao_.quantidade();
+    if (!esperarPasso) {
+        for (int s = 0; s < n; ++s) {
+            if (s != indice_) tratarPendentes(s, false, 0, chegadas);
+        }
+        return true;
+    }
+
+    const auto inicio = std::chrono::steady_clock::now();
+    const auto limite = inicio + PRAZO_PASSO;
+    bool completo = true;
+    for (int s = 0; s < n; ++s) {
+        if (s == indice_) continue;
+        Vizinho& v = vizinhos_[s];
+        for (;;) {
+            tratarPendentes(s, true, passo, chegadas);
+            if (v.perdido || (v.temQuadro && v.passoQuadro >= passo)) break;
+
+            const auto agora = std::chrono::steady_clock::now();
+            if (agora >= limite) {
+                // sem o vizinho o passo seguiria para sempre; os proximos nao esperam mais por ele
+                Log::erro("[Shards] Shard %d: shard %d nao respondeu no passo %llu, seguindo sem ele",
+                          indice_, s, static_cast<unsigned long long>(passo));
+                v.perdido = true;
+                completo  = false;
+                break;
+            }
+            transporte_->esperar(std::min<std::chrono::microseconds>(
+                std::chrono::duration_cast<std::chrono::microseconds>(limite - agora), FATIA_ESPERA));
+            distribuir();
+        }
+    }
+
+    const double espera_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+    estatisticas_.espera_s += espera_s;
+    if (!completo) ++estatisticas_.esperasVencidas;
+    return completo;
+}
+
+void ShardMina::anexarFantasmas(std::vector<Anticolisao::Amostra>& amostras, const std::vector<int>& ignorar) const {
+    const auto agora = std::chrono::steady_clock::now();
+    for (int s = 0; s < particao_.quantidade(); ++s) {
+        const Vizinho& v = vizinhos_[s];
+        if (s == indice_ || !v.temQuadro) continue;
+        // no lockstep so o quadro do proprio passo; em tempo real o mais recente, se nao for velho
+        if (lockstep_ && v.passoQuadro != passoAtual_) continue;
+        if (!lockstep_ && std::chrono::duration<double>(agora - v.chegadaQuadro).count() > VALIDADE_FANTASMAS_S) continue;
+
+        for (const Anticolisao::Amostra& a : v.fantasmas) {
+            if (std::find(ignorar.begin(), ignorar.end(), a.id) == ignorar.end()) amostras.push_back(a);
+        }
+    }
+}
+
+ShardMina::Estatisticas ShardMina::estatisticas() const {
+    std::lock_guard<std::mutex> lock(mtxEstatisticas_);
+    return estatisticas_;
+}
@@ -6,25 +6,155 @@
 #include <stdexcept>
 #include <cmath> 
 #include <random> 
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+
+#include "GradeEspacial.hpp"
+#include "Log.hpp"
 
 using namespace std::chrono_literals;
 
 namespace {
+    constexpr double PI = 3.14159265358979323846;
+
     constexpr double SPAWN_X_MIN      = -220.0;
     constexpr double SPAWN_X_MAX      =  220.0;
     constexpr double SPAWN_Y_MIN      = -120.0;
     constexpr double SPAWN_Y_MAX      =  120.0;
     constexpr double SPAWN_DIST_MIN   = 25.0; 
     constexpr int    SPAWN_MAX_TRIES  = 200;
+
+    // mapa do planejamento de rotas: cobre a area de spawn e a garagem em volta dela com
+    // folga; celulas de 4 m e
+    // obstaculos inflados em 4 m
+    constexpr double      MAPA_X_MIN   = -640.0;
+    constexpr double      MAPA_X_MAX   =  640.0;
+    constexpr double      MAPA_Y_MIN   = -640.0;
+    constexpr double      MAPA_Y_MAX   =  640.0;
+    constexpr double      MAPA_CELULA  = 4.0;
+    constexpr double      MAPA_MARGEM  = 4.0;
+    constexpr std::size_t CACHE_ROTAS  = 4096;
+
+    // garagem do spawn (area cheia) dentro do mapa, para as rotas alcancarem os estacionados;
+    // so uma frota maior do que o mapa comporta estaciona fora dele
+    constexpr double GARAGEM_FOLGA = 2.0 * MAPA_CELULA;
+
+    // mais longe que isso do destino, o caminhao em automatico ainda vai se mover
+    constexpr double DIST_EM_MISSAO = 2.0;
+
+    // mina em shards: as faixas dividem a area de spawn, onde ficam as rotas do ciclo de
+    // transporte; o caminhao so troca de shard 5 m depois do corte, e cada shard enxerga os
+    // vizinhos ate o raio do anticolisao alem dessa folga
+    constexpr double PARTICAO_X_MIN      = SPAWN_X_MIN;
+    constexpr double PARTICAO_X_MAX      = SPAWN_X_MAX;
+    constexpr double MARGEM_MIGRACAO     = 5.0;
+    constexpr int    MAX_SHARDS          = 255;  // a origem vai num byte
+    constexpr auto   PRAZO_CONEXAO_SHARDS = std::chrono::seconds(60);
+    constexpr auto   PERIODO_BORDA        = 50ms;  // em tempo real; no lockstep, todo passo
+
+    // criacao em massa: caminhoes por publicacao no registro e conexoes MQTT simultaneas na partida
+    constexpr std::size_t LOTE_CRIACAO       = 64;
+    constexpr std::size_t PARTIDAS_PARALELAS = 8;
+    const std::string TOPICO_CRIACAO = "mina/simulacao/criacao";
+
+    const std::string TOPICO_FROTA_ESTADO = "mina/frota/estado";
+    const std::string TOPICO_ESTADO_CAMINHOES = "mina/caminhao/+/estado";
+    const std::string TOPICO_CMD_CAMINHOES = "mina/caminhao/+/cmd";
+    constexpr auto PERIODO_PUBLICACAO_FROTA = 500ms; // mesmo periodo do coletor de dados
+    constexpr int  QOS_QUADRO_FROTA         = 0;     // telemetria periodica, o proximo quadro substitui o perdido
+    constexpr auto PERIODO_FISICA           = 50ms;  // mesmo periodo do antigo controle por caminhao
+
+    const std::string TOPICO_FROTA_ESTATISTICAS = "mina/frota/estatisticas";
+    constexpr auto PERIODO_ESTATISTICAS       = 5s;
+    constexpr auto PERIODO_SEGURANCA          = 10ms;
+
+    // o buffer de cada caminhao guarda ~20 s, bem mais que o periodo de ingestao
+    constexpr auto PERIODO_INGESTAO_SERIES    = 1s;
+    constexpr auto PERIODO_SEGMENTO_ESTADO    = 10ms;  // leitores locais querem mais que o MQTT
+    constexpr std::uint64_t PASSOS_POR_SEGUNDO_LOCKSTEP = 1000 / Caminhao::PASSO_LOCKSTEP_MS;
+
+    // amostra do anticolisao: posicao reportada pelo caminhao e velocidade do modelo fisico
+    // em missao: em automatico, sem falha e ainda longe do destino; o anticolisao preve o
+    // caminhao pela direcao da rota, mesmo parado esperando
+    Anticolisao::Amostra amostraDe(int id, const RegistroBuffer& reg, double vel, double ang_deg) {
+        const double px  = static_cast<double>(reg.sensores.i_posicao_x);
+        const double py  = static_cast<double>(reg.sensores.i_posicao_y);
+        const double rad = ang_deg * PI / 180.0;
+        const bool emMissao = reg.estados.e_automatico && !reg.estados.e_defeito &&
+                              reg.estado != EstadoCaminhao::EmFalha &&
+                              std::hypot(reg.setpoints.sp_posicao_x - px, reg.setpoints.sp_posicao_y - py) > DIST_EM_MISSAO;
+        return {id, {px, py}, vel * std::cos(rad), vel * std::sin(rad),
+                emMissao, static_cast<double>(reg.setpoints.sp_angulo_x)};
+    }
+
+    // FNV-1a sobre os campos do registro (e nao sobre os bytes, que incluem padding)
+    constexpr std::uint64_t FNV_BASE = 1469598103934665603ull;
+
+    std::uint64_t misturarRegistro(std::uint64_t h, const RegistroBuffer& reg) {
+        auto mistura = [&h](std::int64_t v) {
+            for (int b = 0; b < 8; ++b) {
+                h ^= static_cast<std::uint64_t>((v >> (8 * b)) & 0xff);
+                h *= 1099511628211ull;
+            }
+        };
+        mistura(reg.id_caminhao);
+        mistura(static_cast<std::int64_t>(std::llround(reg.tempoSimulacao_s * 1000.0)));
+        mistura(static_cast<std::int64_t>(reg.estado));
+        mistura(reg.sensores.i_posicao_x);
+        mistura(reg.sensores.i_posicao_y);
+        mistura(reg.sensores.i_angulo_x);
+        mistura(reg.sensores.i_temperatura);
+        mistura(reg.atuadores.o_aceleracao);
+        mistura(reg.atuadores.o_direcao);
+        mistura(reg.estados.e_defeito);
+        mistura(reg.estados.e_automatico);
+        mistura(reg.estados.e_bloqueio_rearme);
+        return h;
+    }
+
+    // pedido/resposta de janelas do historico
+    // pedido:   "<correlacao>;<id>;<desde_s>;<ate_s>", ate_s opcional; desde_s negativo sem ate_s
+    //           pede os ultimos |desde_s| segundos do caminhao
+    // resposta: JSON de historicoCaminhaoJson em mina/historico/resp/<correlacao>
+    const std::string TOPICO_HISTORICO_PEDIDO   = "mina/historico/req";
+    const std::string TOPICO_HISTORICO_RESPOSTA = "mina/historico/resp/";
+    constexpr int     QOS_HISTORICO             = 1;
 }
 
-SimulacaoMina::SimulacaoMina(int numCaminhoes, std::size_t capacidadeBufferPadrao)
-    : capacidadeBufferPadrao_(capacidadeBufferPadrao),
-      rodando_(false)
+SimulacaoMina::SimulacaoMina(int numCaminhoes, std::size_t capacidadeBufferPadrao,
+                             const std::string& arquivoTelemetria)
+    : executor_(),
+      telemetria_(arquivoTelemetria.empty() ? nullptr : std::make_unique<RegistradorTelemetria>(arquivoTelemetria)),
+      mapa_(MAPA_X_MIN, MAPA_X_MAX, MAPA_Y_MIN, MAPA_Y_MAX, MAPA_CELULA, MAPA_MARGEM),
+      planejador_(mapa_, CACHE_ROTAS),
+      capacidadeBufferPadrao_(capacidadeBufferPadrao),
+      rodando_(false),
+      encerrarCriacao_(false),
+      topicosPorCaminhao_(false),
+      tarPublicacaoFrota_(0),
+      formatoQuadro_(ProtocoloMqtt::Formato::Binario),
+      formatoEstadoCaminhoes_(ProtocoloMqtt::Formato::Binario),
+      tarFisica_(0),
+      tarPublicacaoEstatisticas_(0),
+      tarIngestaoSeries_(0),
+      tarSegmentoEstado_(0),
+      modoLockstep_(false),
+      sementeLockstep_(0),
+      passoLockstep_(0),
+      sementeSpawn_(std::random_device{}()),
+      sementeSpawnDefinida_(false),
+      rngSpawn_(sementeSpawn_),
+      posicionadorSpawn_({SPAWN_X_MIN, SPAWN_X_MAX, SPAWN_Y_MIN, SPAWN_Y_MAX}, SPAWN_DIST_MIN, SPAWN_MAX_TRIES,
+                         {MAPA_X_MIN + GARAGEM_FOLGA, MAPA_X_MAX - GARAGEM_FOLGA,
+                          MAPA_Y_MIN + GARAGEM_FOLGA, MAPA_Y_MAX - GARAGEM_FOLGA}),
+      cicloShard_(0),
+      inicioSessao_(std::chrono::steady_clock::now())
 {
-    if (numCaminhoes < 0) numCaminhoes = 0;
+    mapa_.definirObstaculos(MapaMina::obstaculosPadrao());
 
-    caminhoes_.reserve(static_cast<std::size_t>(numCaminhoes));
+    if (numCaminhoes < 0) numCaminhoes = 0;
 
     for (int i = 0; i < numCaminhoes; ++i) {
         criarNovoCaminhao(capacidadeBufferPadrao);
@@ -38,7 +168,12 @@ SimulacaoMina::~SimulacaoMina() {
 void SimulacaoMina::iniciar() {
     if (rodando_) return;
 
-    mqtt_ = std::make_unique<MqttInterface>("simulacao_central", 
+    inicioSessao_ = std::chrono::steady_clock::now();
+    registrarInicioSessao();
+
+    // cada shard eh um cliente do broker, e o id do cliente precisa ser unico
+    const std::string idCliente = shard_ ? "simulacao_central_" + std::to_string(shard_->indice()) : "simulacao_central";
+    mqtt_ = std::make_unique<MqttInterface>(idCliente, 
         [this](const std::string& topic, const std::string& payload) {
             this->processarMensagemCentral(topic, payload);
         }
@@ -46,225 +181,983 @@ void SimulacaoMina::iniciar() {
     
     mqtt_->conectar();
     mqtt_->assinar("mina/simulacao/cmd"); 
+    mqtt_->assinar(TOPICO_HISTORICO_PEDIDO);
+    if (!topicosPorCaminhao_) {
+        mqtt_->assinar(TOPICO_CMD_CAMINHOES);
+    }
 
-    std::cout << "[SimulacaoMina] Sistema iniciado. Aguardando comandos MQTT...\n";
+    Log::info("[SimulacaoMina] Sistema iniciado (%zu threads no executor). Aguardando comandos MQTT...",
+              static_cast<std::size_t>(executor_.numThreads()));
+    rngSpawn_.seed(sementeSpawn_);
+    posicionarCaminhoesIniciais();
     rodando_ = true;
 
+    paraCadaCaminhao([this](Caminhao& c) { iniciarCaminhao(c); });
+
+    // pedidos que chegaram durante a partida ficam na fila ate aqui
     {
-        std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-        for (auto& c : caminhoes_) {
-            c->iniciar();
-        }
+        std::lock_guard<std::mutex> lock(mtxPedidosCriacao_);
+        encerrarCriacao_ = false;
     }
+    thCriacao_ = std::thread(&SimulacaoMina::tarefaCriacao, this);
+
+    fisicaAnterior_ = std::chrono::steady_clock::now();
+    tarFisica_ = executor_.registrar([this] { passoFisica(); }, PERIODO_FISICA,
+                                     &estatisticas_.de(TipoTarefa::FisicaFrota));
 
     thSeguranca_ = std::thread(&SimulacaoMina::tarefaMonitoramentoSeguranca, this);
+    tarPublicacaoFrota_ = executor_.registrar([this] { publicarEstadoFrota(); }, PERIODO_PUBLICACAO_FROTA,
+                                              &estatisticas_.de(TipoTarefa::PublicacaoFrota));
+    tarPublicacaoEstatisticas_ = executor_.registrar([this] { publicarEstatisticas(); }, PERIODO_ESTATISTICAS);
+    tarIngestaoSeries_ = executor_.registrar([this] { ingerirSeries(); }, PERIODO_INGESTAO_SERIES);
+    if (segmentoEstado_) {
+        tarSegmentoEstado_ = executor_.registrar([this] { publicarSegmentoEstado(); }, PERIODO_SEGMENTO_ESTADO);
+    }
+}
+
+void SimulacaoMina::habilitarTopicosPorCaminhao(bool habilitar) {
+    topicosPorCaminhao_ = habilitar;
+}
+
+bool SimulacaoMina::definirFormatoTopico(const std::string& topico, ProtocoloMqtt::Formato formato) {
+    if (topico == TOPICO_FROTA_ESTADO) {
+        formatoQuadro_ = formato;
+        return true;
+    }
+    if (topico == TOPICO_ESTADO_CAMINHOES) {
+        formatoEstadoCaminhoes_ = formato;
+        return true;
+    }
+    return false;
+}
+
+void SimulacaoMina::iniciarLockstep(std::uint32_t semente) {
+    if (rodando_) return;
+
+    modoLockstep_    = true;
+    sementeLockstep_ = semente;
+    passoLockstep_   = 0;
+    if (!sementeSpawnDefinida_) sementeSpawn_ = semente;
+    rngSpawn_.seed(sementeSpawn_);
+    registrarInicioSessao();
+
+    Log::info("[SimulacaoMina] Modo lockstep iniciado (semente %u, passo %d ms).",
+              static_cast<unsigned>(semente), static_cast<int>(Caminhao::PASSO_LOCKSTEP_MS));
+    posicionarCaminhoesIniciais();
+    rodando_ = true;
+
+    paraCadaCaminhao([this](Caminhao& c) { iniciarCaminhao(c); });
+}
+
+void SimulacaoMina::avancarLockstep(std::uint64_t passos) {
+    if (!rodando_ || !modoLockstep_) return;
+
+    for (std::uint64_t n = 0; n < passos; ++n) {
+        fisica_.integrar(Caminhao::PASSO_LOCKSTEP_S);
+        paraCadaCaminhao([this](Caminhao& c) { c.avancarLockstep(passoLockstep_); });
+        if (shard_) migrarSaidas(passoLockstep_);
+        cicloMonitoramentoSeguranca(Caminhao::PASSO_LOCKSTEP_S);
+        if (shard_) adotarChegadas();
+        if (segmentoEstado_) publicarSegmentoEstado();
+        ++passoLockstep_;
+        if (passoLockstep_ % PASSOS_POR_SEGUNDO_LOCKSTEP == 0) {
+            ingerirSeries();
+            if (gravador_) registrarPontoControle();
+        }
+    }
+}
+
+double SimulacaoMina::tempoLockstep_s() const {
+    return static_cast<double>(passoLockstep_) * Caminhao::PASSO_LOCKSTEP_S;
+}
+
+std::uint64_t SimulacaoMina::resumoEstado() const {
+    std::uint64_t h = FNV_BASE;
+    paraCadaCaminhao([&h](const Caminhao& c) {
+        RegistroBuffer reg{};
+        if (c.lerUltimoRegistro(reg)) h = misturarRegistro(h, reg);
+    });
+    return h;
+}
+
+std::vector<std::pair<int, std::uint64_t>> SimulacaoMina::resumoPorCaminhao() const {
+    std::vector<std::pair<int, std::uint64_t>> r;
+    paraCadaCaminhao([&r](const Caminhao& c) {
+        RegistroBuffer reg{};
+        if (c.lerUltimoRegistro(reg)) r.emplace_back(c.getId(), misturarRegistro(FNV_BASE, reg));
+    });
+    return r;
+}
+
+std::uint64_t SimulacaoMina::passoLockstep() const {
+    return passoLockstep_;
+}
+
+bool SimulacaoMina::gravarSessao(const std::string& arquivo) {
+    if (rodando_) return false;
+    if (shard_) {
+        Log::erro("[SimulacaoMina] Sessao gravada nao combina com a mina em shards");
+        return false;
+    }
+    auto g = std::make_unique<GravadorSessao>(arquivo);
+    if (!g->aberto()) {
+        Log::erro("[SimulacaoMina] Nao foi possivel gravar a sessao em %s", arquivo.c_str());
+        return false;
+    }
+    g->definirRelogio([this] { return tempoSessao_s(); });
+    gravador_ = std::move(g);
+    return true;
+}
+
+double SimulacaoMina::tempoSessao_s() const {
+    if (modoLockstep_) return tempoLockstep_s();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioSessao_).count();
+}
+
+void SimulacaoMina::definirSementeSpawn(std::uint32_t semente) {
+    sementeSpawn_ = semente;
+    sementeSpawnDefinida_ = true;
+    rngSpawn_.seed(semente);
+}
+
+bool SimulacaoMina::configurarShards(int indice, int shards, std::unique_ptr<TransporteShards> transporte) {
+    if (rodando_ || shard_ || quantidadeCaminhoes() > 0) {
+        Log::erro("[SimulacaoMina] Shards devem ser configurados antes de criar caminhoes e de iniciar");
+        return false;
+    }
+    if (gravador_) {
+        Log::erro("[SimulacaoMina] Sessao gravada nao combina com a mina em shards");
+        return false;
+    }
+    if (shards < 1 || shards > MAX_SHARDS || indice < 0 || indice >= shards || !transporte) {
+        Log::erro("[SimulacaoMina] Shard %d de %d invalido", indice, shards);
+        return false;
+    }
+
+    ParticaoMina particao(shards, PARTICAO_X_MIN, PARTICAO_X_MAX, MARGEM_MIGRACAO,
+                          Anticolisao::RAIO_PREDICAO + MARGEM_MIGRACAO);
+    auto shard = std::make_unique<ShardMina>(particao, indice, std::move(transporte));
+    Log::info("[SimulacaoMina] Shard %d de %d: esperando os outros shards...", indice, shards);
+    if (!shard->conectar(PRAZO_CONEXAO_SHARDS)) return false;
+
+    // ids intercalados entre os shards, unicos na mina inteira
+    registro_.definirSequenciaIds(indice + 1, shards);
+    shard_ = std::move(shard);
+    Log::info("[SimulacaoMina] Shard %d de %d conectado.", indice, shards);
+    return true;
+}
+
+const ShardMina* SimulacaoMina::shard() const {
+    return shard_.get();
+}
+
+bool SimulacaoMina::publicarEstadoCompartilhado(const std::string& nome, std::size_t capacidade, bool assumir) {
+    if (rodando_ || segmentoEstado_ || capacidade == 0) return false;
+    auto seg = std::make_unique<SegmentoEstadoFrota>(nome, capacidade);
+    if (!seg->abrir(assumir)) return false;
+    segmentoEstado_ = std::move(seg);
+    Log::info("[SimulacaoMina] Estado da frota publicado no segmento %s (%zu caminhoes).", nome.c_str(), capacidade);
+    return true;
+}
+
+// tudo o que a reproducao precisa para recriar a simulacao antes da primeira entrada
+void SimulacaoMina::registrarInicioSessao() {
+    if (!gravador_) return;
+    std::size_t n = quantidadeCaminhoes();
+    char dados[160];
+    std::snprintf(dados, sizeof(dados), "modo=%s semente=%u spawn=%u caminhoes=%zu capacidade=%zu",
+                  modoLockstep_ ? "lockstep" : "tempo_real", sementeLockstep_, sementeSpawn_,
+                  n, capacidadeBufferPadrao_);
+    gravador_->registrar(TipoEntradaSessao::Inicio, 0, dados);
+}
+
+void SimulacaoMina::registrarPontoControle() {
+    std::string dados;
+    char item[40];
+    for (const auto& par : resumoPorCaminhao()) {
+        int n = std::snprintf(item, sizeof(item), "%s%d:%016llx", dados.empty() ? "" : ",",
+                              par.first, static_cast<unsigned long long>(par.second));
+        if (n > 0) dados.append(item, static_cast<std::size_t>(n));
+    }
+    gravador_->registrar(TipoEntradaSessao::PontoControle, 0, dados);
+}
+
+void SimulacaoMina::iniciarCaminhao(Caminhao& caminhao) {
+    caminhao.gravador_ = gravador_.get();
+    caminhao.definirFormatoEstado(formatoEstadoCaminhoes_);
+    if (modoLockstep_) caminhao.iniciarLockstep(sementeLockstep_);
+    else               caminhao.iniciar(executor_, topicosPorCaminhao_, &estatisticas_);
+}
+
+void SimulacaoMina::publicarEstadoFrota() {
+    if (!mqtt_) return;
+
+    // um unico quadro com o ultimo registro de cada caminhao, no formato do topico
+    std::string& q = quadroFrota_;
+    ProtocoloMqtt::iniciarQuadro(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch()).count(),
+                                 formatoQuadro_, q);
+
+    // a publicacao fica fora da secao de leitura, que so cobre a montagem do quadro
+    paraCadaCaminhao([&](const Caminhao& c) {
+        RegistroBuffer reg;
+        if (!c.lerUltimoRegistro(reg)) return;
+        ProtocoloMqtt::anexarAoQuadro(ProtocoloMqtt::estadoDe(c.getId(), reg), formatoQuadro_, q);
+    });
+    ProtocoloMqtt::fecharQuadro(formatoQuadro_, q);
+
+    mqtt_->publicar(TOPICO_FROTA_ESTADO, q, QOS_QUADRO_FROTA);
+}
+
+std::string SimulacaoMina::historicoCaminhaoJson(int idCaminhao, double desde_s, double ate_s) const {
+    std::string j;
+    char linha[160];
+    int n = std::snprintf(linha, sizeof(linha), "{\"id\":%d,\"desde\":%.3f,\"ate\":%.3f,", idCaminhao, desde_s, ate_s);
+    if (n > 0) j.append(linha, static_cast<std::size_t>(n));
+    j += "\"campos\":[\"t\",\"x\",\"y\",\"ang\",\"temp\",\"acel\",\"dir\",\"defeito\",\"auto\"],\"registros\":[";
+
+    // formata direto do anel; o buffer fica travado so durante a formatacao da janela
+    const bool existe = comCaminhao(idCaminhao, [&](const Caminhao& c) {
+        c.visitarHistorico(desde_s, ate_s, [&](const VisaoHistorico& v) {
+            j.reserve(j.size() + v.tamanho() * 48 + 2);
+            bool primeiro = true;
+            v.paraCada([&](const RegistroBuffer& r) {
+                int m = std::snprintf(linha, sizeof(linha), "%s[%.3f,%d,%d,%d,%d,%d,%d,%d,%d]",
+                                      primeiro ? "" : ",", r.tempoSimulacao_s,
+                                      r.sensores.i_posicao_x, r.sensores.i_posicao_y, r.sensores.i_angulo_x,
+                                      r.sensores.i_temperatura, r.atuadores.o_aceleracao, r.atuadores.o_direcao,
+                                      r.estados.e_defeito ? 1 : 0, r.estados.e_automatico ? 1 : 0);
+                if (m > 0) j.append(linha, static_cast<std::size_t>(m));
+                primeiro = false;
+            });
+        });
+    });
+    if (!existe) throw std::out_of_range("Nao encontrado");
+    j += "]}";
+    return j;
+}
+
+void SimulacaoMina::responderHistorico(const std::string& payload) {
+    if (!mqtt_) return;
+
+    // campos separados por ';': correlacao, id, desde_s e ate_s (opcional)
+    std::string campos[4];
+    std::size_t qtd = 0, pos = 0;
+    while (qtd < 4) {
+        std::size_t fim = payload.find(';', pos);
+        campos[qtd++] = payload.substr(pos, fim == std::string::npos ? std::string::npos : fim - pos);
+        if (fim == std::string::npos) break;
+        pos = fim + 1;
+    }
+
+    const std::string topicoResposta = TOPICO_HISTORICO_RESPOSTA + campos[0];
+    if (qtd < 3 || campos[0].empty()) {
+        if (shard_ && shard_->indice() != 0) return;
+        mqtt_->publicar(topicoResposta, "{\"erro\":\"pedido invalido\"}", QOS_HISTORICO);
+        return;
+    }
+
+    try {
+        int id        = std::stoi(campos[1]);
+        double desde_s = std::stod(campos[2]);
+        double ate_s   = 0.0;
+        if (qtd == 4 && !campos[3].empty()) {
+            ate_s = std::stod(campos[3]);
+        } else {
+            // sem ate_s a janela vai ate a amostra mais recente; desde_s negativo
+            // pede os ultimos |desde_s| segundos contados a partir dela
+            RegistroBuffer reg;
+            bool temRegistro = false;
+            if (!comCaminhao(id, [&](const Caminhao& c) { temRegistro = c.lerUltimoRegistro(reg); })) {
+                throw std::out_of_range("Nao encontrado");
+            }
+            ate_s = temRegistro ? reg.tempoSimulacao_s : 0.0;
+            if (desde_s < 0.0) desde_s = ate_s + desde_s;
+        }
+        mqtt_->publicar(topicoResposta, historicoCaminhaoJson(id, desde_s, ate_s), QOS_HISTORICO);
+    } catch (const std::out_of_range&) {
+        // com shards responde so quem tem o caminhao
+        if (shard_) return;
+        mqtt_->publicar(topicoResposta, "{\"erro\":\"caminhao inexistente\"}", QOS_HISTORICO);
+    } catch (const std::invalid_argument&) {
+        if (shard_ && shard_->indice() != 0) return;
+        mqtt_->publicar(topicoResposta, "{\"erro\":\"pedido invalido\"}", QOS_HISTORICO);
+    }
+}
+
+std::vector<ResumoTarefa> SimulacaoMina::estatisticasTarefas() const {
+    return estatisticas_.resumo();
+}
+
+std::string SimulacaoMina::estatisticasTarefasJson() const {
+    return estatisticas_.json();
+}
+
+void SimulacaoMina::zerarEstatisticasTarefas() {
+    estatisticas_.zerar();
+}
+
+ResumoLatencia SimulacaoMina::latenciaSensorAtuador() const {
+    return estatisticas_.resumoLatencia();
+}
+
+void SimulacaoMina::publicarEstatisticas() {
+    if (!mqtt_) return;
+    mqtt_->publicar(TOPICO_FROTA_ESTATISTICAS, estatisticas_.json(), QOS_QUADRO_FROTA);
+}
+
+const SerieTemporalFrota& SimulacaoMina::seriesFrota() const {
+    return series_;
+}
+
+MapaMina& SimulacaoMina::mapa() {
+    return mapa_;
+}
+
+PlanejadorRotas::Estatisticas SimulacaoMina::estatisticasRotas() const {
+    return planejador_.estatisticas();
+}
+
+Anticolisao::Resumo SimulacaoMina::resumoAnticolisao() const {
+    return anticolisao_.resumo();
+}
+
+// um slot por caminhao, escrito pelo seqlock do slot; os leitores de outros processos nunca
+// travam a frota nem esperam esta tarefa
+void SimulacaoMina::publicarSegmentoEstado() {
+    SegmentoEstadoFrota& seg = *segmentoEstado_;
+    seg.iniciarPublicacao();
+    paraCadaCaminhao([&](const Caminhao& c) {
+        RegistroBuffer reg;
+        if (!c.lerUltimoRegistro(reg)) return;
+        const FisicaFrota::EstadoFisico f = c.estadoFisico();
+        seg.escrever(SegmentoEstadoFrota::estadoDe(c.getId(), reg, f.pos_x, f.pos_y, f.vel, f.ang_deg, f.temp_C,
+                                                   c.nivelSeguranca()));
+    });
+    seg.concluirPublicacao();
+}
+
+// copia de cada buffer so o que chegou desde a ultima ingestao; a insercao nas series
+// acontece fora do lock do buffer, entao o tratamento de sensores nunca espera por ela
+void SimulacaoMina::ingerirSeries() {
+    paraCadaCaminhao([this](const Caminhao& c) {
+        int id = c.getId();
+        if (!series_.aceita(id)) return;
+        c.copiarHistorico(series_.ultimoTempo(id), std::numeric_limits<double>::infinity(), loteSeries_);
+        series_.inserir(id, loteSeries_.data(), loteSeries_.size());
+    });
+}
+
+void SimulacaoMina::passoFisica() {
+    auto agora = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(agora - fisicaAnterior_).count();
+    fisicaAnterior_ = agora;
+    if (dt <= 0.0) dt = 0.01;
+
+    fisica_.integrar(dt);
 }
 
 void SimulacaoMina::parar() {
     bool expected = true;
     if (!rodando_.compare_exchange_strong(expected, false)) return;
 
-    std::cout << "[SimulacaoMina] Parando sistema...\n";
-    
+    Log::info("[SimulacaoMina] Parando sistema...");
+    if (gravador_) gravador_->registrar(TipoEntradaSessao::Fim, 0, "");
+
+    // antes de parar os caminhoes: o pedido de criacao em andamento termina antes da frota
+    // ser parada, e pedidos ainda na fila sao descartados; so o lote que ja tinha lido
+    // rodando_ da a partida, os seguintes saem sem posicao (idsSemPosicao_, posicionados
+    // na proxima partida)
+    std::size_t pedidosDescartados = 0;
     {
-        std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-        for (auto& c : caminhoes_) {
-            c->parar();
-        }
+        std::lock_guard<std::mutex> lock(mtxPedidosCriacao_);
+        encerrarCriacao_ = true;
+        pedidosDescartados = pedidosCriacao_.size();
+        pedidosCriacao_.clear();
+    }
+    cvPedidosCriacao_.notify_all();
+    if (thCriacao_.joinable()) thCriacao_.join();
+    if (pedidosDescartados > 0) {
+        Log::aviso("[SimulacaoMina] %zu pedidos de criacao descartados na parada.", pedidosDescartados);
+    }
+
+    if (tarPublicacaoFrota_ != 0) {
+        executor_.cancelar(tarPublicacaoFrota_);
+        tarPublicacaoFrota_ = 0;
+    }
+    if (tarFisica_ != 0) {
+        executor_.cancelar(tarFisica_);
+        tarFisica_ = 0;
+    }
+    if (tarPublicacaoEstatisticas_ != 0) {
+        executor_.cancelar(tarPublicacaoEstatisticas_);
+        tarPublicacaoEstatisticas_ = 0;
+    }
+    if (tarIngestaoSeries_ != 0) {
+        executor_.cancelar(tarIngestaoSeries_);
+        tarIngestaoSeries_ = 0;
+    }
+    if (tarSegmentoEstado_ != 0) {
+        executor_.cancelar(tarSegmentoEstado_);
+        tarSegmentoEstado_ = 0;
     }
+    
+    paraCadaCaminhao([](Caminhao& c) { c.parar(); });
 
     if (thSeguranca_.joinable()) thSeguranca_.join();
     if (mqtt_) mqtt_->desconectar();
+    modoLockstep_ = false;
+
+    // quem chamou costuma escrever o resumo da execucao logo em seguida
+    Log::descarregar();
 }
 
 int SimulacaoMina::criarNovoCaminhao(std::size_t capacidadeBuffer) {
-    std::lock_guard<std::mutex> lock(mtxCaminhoes_); 
+    ResultadoCriacao r = criarCaminhoes(1, capacidadeBuffer);
+    return r.ids.empty() ? 0 : r.ids.front();
+}
 
+ResultadoCriacao SimulacaoMina::criarCaminhoes(std::size_t n, std::size_t capacidadeBuffer) {
     if (capacidadeBuffer == 0) capacidadeBuffer = capacidadeBufferPadrao_;
 
-    int novoId = static_cast<int>(caminhoes_.size()) + 1;
-    auto cam = std::make_unique<Caminhao>(novoId, capacidadeBuffer);
-
-    Caminhao* ptrCru = cam.get();
+    const auto inicio = std::chrono::steady_clock::now();
+    ResultadoCriacao r;
+    r.ids.reserve(n);
 
-    if (!rodando_) {
-        int posX = (novoId - 1) * 30; 
-        int posY = 0;
-        cam->definirRota(posX, posY, posX, posY);
-
-        caminhoes_.push_back(std::move(cam));
+    // a partida de cada lote segue o que o proprio lote viu: um lote sem posicao (criado
+    // antes da partida ou depois da parada) nao pode dar a partida
+    bool emExecucao = false;
+    for (std::size_t feitos = 0; feitos < n; ) {
+        std::vector<int> ids = criarLote(std::min(LOTE_CRIACAO, n - feitos), capacidadeBuffer, emExecucao);
+        if (emExecucao) iniciarLote(ids);
+        r.ids.insert(r.ids.end(), ids.begin(), ids.end());
+        feitos += ids.size();
+    }
 
-        std::cout << "[SimulacaoMina] Novo caminhao ID " << novoId 
-                  << " criado na garagem (X=" << posX << ", Y=" << posY << ").\n";
+    r.duracao_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
 
-        return novoId;
+    // uma entrada por chamada: a reproducao repete a mesma chamada, com os mesmos lotes e sorteios
+    if (gravador_ && emExecucao && !r.ids.empty()) {
+        std::string dados = std::to_string(capacidadeBuffer);
+        if (n > 1) dados += " " + std::to_string(n);
+        gravador_->registrar(TipoEntradaSessao::CriarCaminhao, r.ids.front(), dados);
     }
+    if (n > 1) {
+        Log::info("[SimulacaoMina] %zu caminhoes criados (IDs %d a %d) em %g ms (%g caminhoes/s).",
+                  r.ids.size(), r.ids.front(), r.ids.back(), r.duracao_s * 1000.0, r.caminhoesPorSegundo());
+    }
+    return r;
+}
 
-    static std::mt19937 rng(std::random_device{}());
-    std::uniform_real_distribution<double> distX(SPAWN_X_MIN, SPAWN_X_MAX);
-    std::uniform_real_distribution<double> distY(SPAWN_Y_MIN, SPAWN_Y_MAX);
-
-    double spawnX = 0.0;
-    double spawnY = 0.0;
-    bool   found  = false;
+std::vector<int> SimulacaoMina::criarLote(std::size_t n, std::size_t capacidadeBuffer, bool& emExecucao) {
+    std::lock_guard<std::mutex> lock(mtxCriacao_);
 
-    for (int tentativa = 0; tentativa < SPAWN_MAX_TRIES && !found; ++tentativa) {
-        double candX = distX(rng);
-        double candY = distY(rng);
+    // lido uma vez: iniciar() ou parar() podem virar rodando_ no meio do lote, e as vagas
+    // so existem se o lote foi posicionado
+    emExecucao = rodando_;
 
-        bool ok = true;
+    const int primeiroId = registro_.proximoId();
+    const int passoIds   = registro_.passoIds();
 
-        for (auto& cPtr : caminhoes_) {
+    // posicoes lidas uma vez por lote; caminhoes ainda sem amostra no buffer (recem-criados,
+    // inclusive dos lotes anteriores) entram pela posicao do modelo fisico
+    std::vector<PosicionadorSpawn::Vaga> vagas;
+    if (emExecucao) {
+        std::vector<GradeEspacial::Ponto> ocupados;
+        paraCadaCaminhao([&ocupados](const Caminhao& c) {
             RegistroBuffer reg{};
-            if (!cPtr->lerUltimoRegistro(reg)) {
-                continue;
+            if (c.lerUltimoRegistro(reg)) {
+                ocupados.push_back({static_cast<double>(reg.sensores.i_posicao_x),
+                                    static_cast<double>(reg.sensores.i_posicao_y)});
+            } else {
+                FisicaFrota::EstadoFisico fis = c.estadoFisico();
+                ocupados.push_back({fis.pos_x, fis.pos_y});
             }
+        });
+        vagas.reserve(n);
+        posicionadorSpawn_.escolherLote(ocupados, rngSpawn_, n, vagas);
+    }
 
-            double dx = candX - static_cast<double>(reg.sensores.i_posicao_x);
-            double dy = candY - static_cast<double>(reg.sensores.i_posicao_y);
-            double d2 = dx*dx + dy*dy;
+    std::vector<std::unique_ptr<Caminhao>> lote;
+    std::vector<int> ids;
+    lote.reserve(n);
+    ids.reserve(n);
+    std::size_t naGaragem = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const int novoId = primeiroId + static_cast<int>(i) * passoIds;
+        auto cam = std::make_unique<Caminhao>(novoId, fisica_, capacidadeBuffer, telemetria_.get());
+        cam->definirPlanejador(&planejador_);
 
-            if (d2 < SPAWN_DIST_MIN * SPAWN_DIST_MIN) {
-                ok = false;
-                break;
+        // fora de execucao a posicao so eh sorteada na partida, com a semente do spawn ja
+        // definida, para a reproducao da sessao refazer o mesmo sorteio
+        if (!emExecucao) {
+            idsSemPosicao_.push_back(novoId);
+            if (n == 1) Log::info("[SimulacaoMina] Novo caminhao ID %d criado; posicao sorteada na partida.", novoId);
+        } else {
+            const PosicionadorSpawn::Vaga& v = vagas[i];
+            const int posX = static_cast<int>(std::lround(v.ponto.x));
+            const int posY = static_cast<int>(std::lround(v.ponto.y));
+            if (v.garagem) ++naGaragem;
+            if (v.garagem && n == 1) {
+                Log::aviso("[SimulacaoMina] Area de spawn cheia para ID %d. Usando garagem fora da area: X=%d, Y=%d.",
+                           novoId, posX, posY);
+            } else if (n == 1) {
+                Log::info("[SimulacaoMina] Novo caminhao ID %d spawnado em (%d, %d) dentro da tela.", novoId, posX, posY);
             }
+            cam->definirRota(posX, posY, posX, posY);
         }
 
-        if (ok) {
-            spawnX = candX;
-            spawnY = candY;
-            found  = true;
-        }
+        lote.push_back(std::move(cam));
+        ids.push_back(novoId);
     }
 
-    if (!found) {
-        int posX = (novoId - 1) * 30;
-        int posY = 0;
-        cam->definirRota(posX, posY, posX, posY);
+    if (naGaragem > 0 && n > 1) {
+        Log::aviso("[SimulacaoMina] Area de spawn cheia: %zu de %zu caminhoes do lote (IDs %d a %d) na garagem fora da area.",
+                   static_cast<std::size_t>(naGaragem), static_cast<std::size_t>(n), primeiroId, ids.back());
+    }
+
+    registro_.adicionarLote(lote);
 
-        caminhoes_.push_back(std::move(cam));
+    return ids;
+}
 
-        std::cout << "[SimulacaoMina] [AVISO] Nao foi possivel achar spawn sem colisao para ID "
-                  << novoId << ". Usando fallback (garagem): X=" << posX << ", Y=" << posY << ".\n";
+// os caminhoes criados antes da partida entram todos num lote do posicionador, na ordem de
+// criacao, como se tivessem sido criados juntos ja com a simulacao rodando
+void SimulacaoMina::posicionarCaminhoesIniciais() {
+    std::lock_guard<std::mutex> lock(mtxCriacao_);
+    if (idsSemPosicao_.empty()) return;
 
-        ptrCru->iniciar();
-        return novoId;
+    auto leitura = registro_.ler();
+    std::vector<Caminhao*> pendentes;
+    pendentes.reserve(idsSemPosicao_.size());
+    for (int id : idsSemPosicao_) {
+        if (Caminhao* c = leitura.buscar(id)) pendentes.push_back(c);
     }
+    idsSemPosicao_.clear();
+    if (pendentes.empty()) return;
 
-    int spawnXi = static_cast<int>(std::lround(spawnX));
-    int spawnYi = static_cast<int>(std::lround(spawnY));
+    std::vector<PosicionadorSpawn::Vaga> vagas;
+    vagas.reserve(pendentes.size());
+    posicionadorSpawn_.escolherLote({}, rngSpawn_, pendentes.size(), vagas);
 
-    cam->definirRota(spawnXi, spawnYi, spawnXi, spawnYi);
-    caminhoes_.push_back(std::move(cam));
+    std::size_t naGaragem = 0;
+    for (std::size_t i = 0; i < pendentes.size(); ++i) {
+        const int posX = static_cast<int>(std::lround(vagas[i].ponto.x));
+        const int posY = static_cast<int>(std::lround(vagas[i].ponto.y));
+        if (vagas[i].garagem) ++naGaragem;
+        pendentes[i]->definirRota(posX, posY, posX, posY);
+    }
 
-    std::cout << "[SimulacaoMina] Novo caminhao ID " << novoId
-              << " spawnado em (" << spawnXi << ", " << spawnYi << ") dentro da tela.\n";
+    Log::info("[SimulacaoMina] %zu caminhoes criados antes da partida posicionados na area de spawn.", pendentes.size());
+    if (naGaragem > 0) {
+        Log::aviso("[SimulacaoMina] Area de spawn cheia: %zu de %zu caminhoes na garagem fora da area.",
+                   naGaragem, pendentes.size());
+    }
+}
 
-    ptrCru->iniciar();
+void SimulacaoMina::iniciarLote(const std::vector<int>& ids) {
+    // a partida roda sem mtxCriacao_ e sem secao de leitura, que segurariam remover/adotar
+    // (e a migracao entre shards) enquanto cada caminhao espera o broker; marcados em
+    // idsEmPartida_, os caminhoes nao saem da frota ate o fim, entao os ponteiros valem
+    std::vector<Caminhao*> partida;
+    {
+        std::lock_guard<std::mutex> lock(mtxCriacao_);
+        auto leitura = registro_.ler();
+        partida.reserve(ids.size());
+        for (int id : ids) {
+            if (Caminhao* c = leitura.buscar(id)) {
+                partida.push_back(c);
+                idsEmPartida_.push_back(id);
+            }
+        }
+    }
 
-    return novoId;
+    // com topicos por caminhao cada partida conecta um cliente MQTT e espera o broker;
+    // as conexoes do lote correm em paralelo
+    if (!topicosPorCaminhao_ || modoLockstep_ || partida.size() < 2) {
+        for (Caminhao* c : partida) iniciarCaminhao(*c);
+    } else {
+        const std::size_t nThreads = std::min(PARTIDAS_PARALELAS, partida.size());
+        std::vector<std::thread> threads;
+        threads.reserve(nThreads);
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            threads.emplace_back([this, &partida, t, nThreads] {
+                for (std::size_t i = t; i < partida.size(); i += nThreads) iniciarCaminhao(*partida[i]);
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtxCriacao_);
+        for (Caminhao* c : partida) {
+            auto it = std::find(idsEmPartida_.begin(), idsEmPartida_.end(), c->getId());
+            if (it != idsEmPartida_.end()) idsEmPartida_.erase(it);
+        }
+    }
+    cvPartida_.notify_all();
 }
 
-void SimulacaoMina::processarMensagemCentral(const std::string& /*topico*/, const std::string& payload) {
-    std::cout << "[Mina Recv] " << payload << "\n";
-    
-    if (payload == "CMD:CRIAR_CAMINHAO") {
-        std::thread([this]() {
-            this->criarNovoCaminhao();
-        }).detach();
+bool SimulacaoMina::removerCaminhao(int id) {
+    std::unique_ptr<Caminhao> c;
+    {
+        std::unique_lock<std::mutex> lock(mtxCriacao_);
+        // um caminhao dando a partida sai depois dela; as outras partidas nao seguram ninguem
+        cvPartida_.wait(lock, [&] {
+            return std::find(idsEmPartida_.begin(), idsEmPartida_.end(), id) == idsEmPartida_.end();
+        });
+        c = registro_.remover(id);
+        if (!c) return false;
+        if (gravador_ && rodando_) gravador_->registrar(TipoEntradaSessao::RemoverCaminhao, id, "");
     }
-    
-    else if (payload.rfind("CMD:FALHA_TEMP:", 0) == 0) {
-        int id = std::stoi(payload.substr(15));
-        try { 
-            injetarFalhaTemperatura(id); 
-            std::cout << "[Simulacao] Injetando Falha de Temperatura no ID " << id << "\n"; 
-        } catch(...) { std::cerr << "Erro ao injetar falha (ID invalido?)\n"; }
+
+    // ja fora da tabela publicada: ninguem mais o alcanca pelo registro, e a ingestao
+    // das series nao recria a serie liberada aqui
+    c->parar();
+    c.reset();
+    series_.remover(id);
+    Log::info("[SimulacaoMina] Caminhao ID %d removido.", id);
+    return true;
+}
+
+void SimulacaoMina::processarMensagemCentral(const std::string& topico, const std::string& payload) {
+    if (topico == TOPICO_HISTORICO_PEDIDO) {
+        if (gravador_) gravador_->registrar(TipoEntradaSessao::Mqtt, 0, topico + " " + payload);
+        responderHistorico(payload);
+        return;
+    }
+
+    // comandos em binario ou texto; o log e a sessao ficam sempre com a forma de texto
+    ProtocoloMqtt::Comando cmd;
+    bool valido = ProtocoloMqtt::decodificarComando(payload, cmd);
+    std::string texto;
+    if (valido) ProtocoloMqtt::codificarComando(cmd, ProtocoloMqtt::Formato::Json, texto);
+    if (gravador_) gravador_->registrar(TipoEntradaSessao::Mqtt, 0, topico + " " + (valido ? texto : payload));
+    if (!valido) {
+        Log::aviso("[Mina Recv] Comando nao reconhecido em %s (%zu bytes)", topico.c_str(), payload.size());
+        return;
+    }
+
+    // comandos de caminhao que chegam pela assinatura agregada mina/caminhao/+/cmd
+    const std::string prefixoCaminhao = "mina/caminhao/";
+    if (topico.rfind(prefixoCaminhao, 0) == 0) {
+        int id = std::atoi(topico.c_str() + prefixoCaminhao.size());
+        Log::info("[MQTT Recv %d] %s", id, texto.c_str());
+        // com shards o caminhao pode estar em outro processo, que tambem recebe o comando
+        if (!comandarCaminhao(id, cmd) && !shard_) {
+            Log::aviso("[Mina Recv] Comando para caminhao inexistente (ID %d)", id);
+        }
+        return;
     }
-    else if (payload.rfind("CMD:FALHA_ELET:", 0) == 0) {
-        int id = std::stoi(payload.substr(15));
-        try { 
-            injetarFalhaEletrica(id); 
-            std::cout << "[Simulacao] Injetando Falha Eletrica no ID " << id << "\n"; 
-        } catch(...) { std::cerr << "Erro ao injetar falha\n"; }
+
+    Log::info("[Mina Recv] %s", texto.c_str());
+
+    using ProtocoloMqtt::CodigoComando;
+    const int id = cmd.idCaminhao;
+    // com shards so o shard 0 cria; o caminhao passa para o shard da faixa onde aparecer
+    const bool cria = !shard_ || shard_->indice() == 0;
+    bool inexistente = false;
+    switch (cmd.codigo) {
+        case CodigoComando::CriarCaminhao:
+            if (cria) pedirCriacao(1, false);
+            break;
+        case CodigoComando::CriarCaminhoes:
+            if (cria) pedirCriacao(static_cast<std::size_t>(std::max(cmd.quantidade, 0)), true);
+            break;
+        case CodigoComando::RemoverCaminhao:
+            if (!removerCaminhao(id) && !shard_) Log::aviso("[Mina Recv] Remocao de caminhao inexistente (ID %d)", id);
+            break;
+        case CodigoComando::FalhaTemperatura:
+            if (injetarFalhaTemperatura(id)) Log::aviso("[Simulacao] Injetando Falha de Temperatura no ID %d", id);
+            else inexistente = true;
+            break;
+        case CodigoComando::FalhaEletrica:
+            if (injetarFalhaEletrica(id)) Log::aviso("[Simulacao] Injetando Falha Eletrica no ID %d", id);
+            else inexistente = true;
+            break;
+        case CodigoComando::FalhaHidraulica:
+            if (injetarFalhaHidraulica(id)) Log::aviso("[Simulacao] Injetando Falha Hidraulica no ID %d", id);
+            else inexistente = true;
+            break;
+        default:
+            Log::aviso("[Mina Recv] Comando de caminhao sem id no topico da simulacao: %s", texto.c_str());
+            break;
     }
-    else if (payload.rfind("CMD:FALHA_HIDR:", 0) == 0) {
-        int id = std::stoi(payload.substr(15));
-        try { 
-            injetarFalhaHidraulica(id); 
-            std::cout << "[Simulacao] Injetando Falha Hidraulica no ID " << id << "\n"; 
-        } catch(...) { std::cerr << "Erro ao injetar falha\n"; }
+    // com shards o caminhao pode estar em outro processo, que tambem recebe o comando
+    if (inexistente && !shard_) Log::erro("Erro ao injetar falha (ID %d invalido?)", id);
+}
+
+void SimulacaoMina::pedirCriacao(std::size_t n, bool responder) {
+    {
+        std::lock_guard<std::mutex> lock(mtxPedidosCriacao_);
+        if (encerrarCriacao_) return;
+        pedidosCriacao_.push_back({n, responder});
+    }
+    cvPedidosCriacao_.notify_one();
+}
+
+void SimulacaoMina::tarefaCriacao() {
+    for (;;) {
+        PedidoCriacao pedido;
+        {
+            std::unique_lock<std::mutex> lock(mtxPedidosCriacao_);
+            cvPedidosCriacao_.wait(lock, [this] { return encerrarCriacao_ || !pedidosCriacao_.empty(); });
+            if (encerrarCriacao_) return;
+            pedido = pedidosCriacao_.front();
+            pedidosCriacao_.pop_front();
+        }
+
+        ResultadoCriacao r = criarCaminhoes(pedido.n);
+        if (!pedido.responder || !mqtt_) continue;
+
+        char json[160];
+        int tam = std::snprintf(json, sizeof(json),
+            "{\"pedidos\":%zu,\"criados\":%zu,\"primeiro\":%d,\"ultimo\":%d,"
+            "\"duracao_ms\":%.3f,\"por_segundo\":%.1f}",
+            pedido.n, r.ids.size(), r.ids.empty() ? 0 : r.ids.front(), r.ids.empty() ? 0 : r.ids.back(),
+            r.duracao_s * 1000.0, r.caminhoesPorSegundo());
+        if (tam > 0) mqtt_->publicar(TOPICO_CRIACAO, std::string(json, static_cast<std::size_t>(tam)), 1);
     }
 }
 
 void SimulacaoMina::tarefaMonitoramentoSeguranca() {
-    const double DIST_ALERTA  = 20.0;
-    const double DIST_CRITICA = 12.0;
+    using Relogio = EstatisticasTarefa::Relogio;
+    EstatisticasTarefa& est = estatisticas_.de(TipoTarefa::MonitoramentoSeguranca);
 
+    // o prazo de cada ciclo eh um periodo depois do inicio do anterior, entao o jitter
+    // inclui o tempo de execucao mais o excesso do sleep
+    Relogio::time_point inicioAnterior{};
+    bool primeiro = true;
     while (rodando_) {
+        Relogio::time_point inicio = Relogio::now();
+        const double dt_s = primeiro ? std::chrono::duration<double>(PERIODO_SEGURANCA).count()
+                                     : std::chrono::duration<double>(inicio - inicioAnterior).count();
+        if (shard_) migrarSaidas(cicloShard_);
+        cicloMonitoramentoSeguranca(dt_s);
+        if (shard_) adotarChegadas();
+        Relogio::time_point fim = Relogio::now();
+
+        Relogio::time_point prazo = primeiro ? inicio : inicioAnterior + PERIODO_SEGURANCA;
+        est.registrarCiclo(prazo, inicio, fim, inicioAnterior, PERIODO_SEGURANCA, primeiro);
+        inicioAnterior = inicio;
+        primeiro = false;
+
+        std::this_thread::sleep_for(PERIODO_SEGURANCA);
+    }
+}
+
+void SimulacaoMina::cicloMonitoramentoSeguranca(double dt_s) {
+    // o ciclo inteiro numa secao de leitura: uma remocao concorrente espera o ciclo acabar
+    auto leitura = registro_.ler();
+    const auto& frota = leitura.frota();
+    auto& amostras    = amostrasSeguranca_;
+    auto& indiceFrota = indiceSeguranca_;
+
+    // posicao reportada pelo caminhao e velocidade do modelo fisico (o velocimetro), uma
+    // leitura de cada por caminhao por ciclo
+    amostras.clear();
+    indiceFrota.clear();
+    for (std::size_t i = 0; i < frota.size(); ++i) {
+        RegistroBuffer reg;
+        if (!frota[i]->lerUltimoRegistro(reg)) continue;
+        FisicaFrota::EstadoFisico f = frota[i]->estadoFisico();
+        amostras.push_back(amostraDe(frota[i]->getId(), reg, f.vel, f.ang_deg));
+        indiceFrota.push_back(i);
+    }
+
+    // com shards: [proprios | que acabaram de sair | que chegaram | fantasmas dos vizinhos]
+    // os que sairam vao no quadro deste passo e so recebem resposta no shard novo; os que
+    // chegaram sao avaliados aqui e recebem a resposta ao serem adotados
+    std::size_t inicioChegadas = amostras.size();
+    if (shard_) {
+        for (const EstadoMigracao& e : emigrados_) {
+            if (e.ultimo.tempoSimulacao_s >= 0.0) amostras.push_back(amostraDe(e.id_caminhao, e.ultimo, e.vel, e.ang_deg));
+        }
+
+        const std::uint64_t passo = modoLockstep_ ? passoLockstep_ : cicloShard_++;
+        const auto agora = std::chrono::steady_clock::now();
+        if (modoLockstep_ || agora - ultimaBorda_ >= PERIODO_BORDA) {
+            shard_->publicarBorda(passo, amostras);
+            ultimaBorda_ = agora;
+        }
+        shard_->receber(modoLockstep_, passo, chegadas_);
+
+        inicioChegadas = amostras.size();
+        idsChegadas_.clear();
+        for (const EstadoMigracao& e : chegadas_) {
+            idsChegadas_.push_back(e.id_caminhao);
+            RegistroBuffer reg = e.ultimo;
+            if (reg.tempoSimulacao_s < 0.0) {
+                reg = RegistroBuffer{};
+                reg.sensores.i_posicao_x = static_cast<int>(std::lround(e.pos_x));
+                reg.sensores.i_posicao_y = static_cast<int>(std::lround(e.pos_y));
+            }
+            amostras.push_back(amostraDe(e.id_caminhao, reg, e.vel, e.ang_deg));
+        }
+        shard_->anexarFantasmas(amostras, idsChegadas_);
+    }
+
+    anticolisao_.avaliar(amostras, dt_s, respostasSeguranca_);
+
+    if (shard_) {
+        respostasChegadas_.assign(respostasSeguranca_.begin() + static_cast<std::ptrdiff_t>(inicioChegadas),
+                                  respostasSeguranca_.begin() + static_cast<std::ptrdiff_t>(inicioChegadas + chegadas_.size()));
+    }
+
+    // sem amostra ainda, nada a evitar
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < frota.size(); ++i) {
+        if (k < indiceFrota.size() && indiceFrota[k] == i) {
+            const Anticolisao::Resposta& r = respostasSeguranca_[k++];
+            frota[i]->definirNivelSeguranca(r.nivel, r.desvio_graus);
+        } else {
+            frota[i]->definirNivelSeguranca(NivelSeguranca::Livre);
+        }
+    }
+}
+
+// caminhoes cuja posicao reportada passou para a faixa de outro shard; saem da frota e
+// seguem como EstadoMigracao, antes do quadro de borda do mesmo passo
+// se o envio falhar (anel cheio, broker fora) o caminhao volta para a frota com o estado
+// exportado e a saida eh tentada de novo no proximo passo, ainda fora da faixa
+// a saida segue o caminho de removerCaminhao: mtxCriacao_ serializa com criar/remover/adotar
+// e registro_.remover so devolve o caminhao depois que toda secao de leitura que podia ve-lo
+// terminou; como o acesso de fora (comandos, MQTT, GUI) so acontece dentro de comCaminhao,
+// ninguem mais tem o caminhao quando ele eh destruido aqui
+void SimulacaoMina::migrarSaidas(std::uint64_t passo) {
+    const int proprio = shard_->indice();
+    emigrados_.clear();
+    saidas_.clear();
+    paraCadaCaminhao([&](const Caminhao& c) {
+        RegistroBuffer reg;
+        const double x = c.lerUltimoRegistro(reg) ? static_cast<double>(reg.sensores.i_posicao_x)
+                                                  : c.estadoFisico().pos_x;
+        const int dono = shard_->particao().donoDe(x, proprio);
+        if (dono != proprio) saidas_.push_back({c.getId(), dono});
+    });
+
+    for (const auto& saida : saidas_) {
+        std::unique_ptr<Caminhao> c;
         {
-            std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-            std::vector<bool> precisaReduzir(caminhoes_.size(), false);
-
-            for (size_t i = 0; i < caminhoes_.size(); ++i) {
-                for (size_t j = i + 1; j < caminhoes_.size(); ++j) {
-                    RegistroBuffer rI, rJ;
-                    if (!caminhoes_[i]->lerUltimoRegistro(rI)) continue;
-                    if (!caminhoes_[j]->lerUltimoRegistro(rJ)) continue;
-
-                    double dx = static_cast<double>(rI.sensores.i_posicao_x - rJ.sensores.i_posicao_x);
-                    double dy = static_cast<double>(rI.sensores.i_posicao_y - rJ.sensores.i_posicao_y);
-                    double dist = std::sqrt(dx*dx + dy*dy);
-
-                    if (dist < DIST_CRITICA) {
-                        std::cerr << "[COLISAO] EMERGENCIA! ID " << rI.id_caminhao 
-                                  << " e " << rJ.id_caminhao << " (Dist: " << dist << "m)\n";
-                        caminhoes_[i]->comandarParadaEmergencia();
-                        caminhoes_[j]->comandarParadaEmergencia();
-                    }
-
-                    else if (dist < DIST_ALERTA) {
-                        precisaReduzir[i] = true;
-                        precisaReduzir[j] = true;
-                    }
-                }
+            std::lock_guard<std::mutex> lock(mtxCriacao_);
+            // ainda dando a partida: sai no proximo passo, sem esperar o broker aqui
+            if (std::find(idsEmPartida_.begin(), idsEmPartida_.end(), saida.first) != idsEmPartida_.end()) continue;
+            c = registro_.remover(saida.first);
+        }
+        if (!c) continue;
+
+        c->parar();
+        EstadoMigracao estado = c->exportarEstado();
+        if (!shard_->enviarMigracao(saida.second, passo, estado)) {
+            c->importarEstado(estado);
+            {
+                std::lock_guard<std::mutex> lock(mtxCriacao_);
+                registro_.adotar(std::move(c));  // o id acabou de sair do registro
             }
+            auto leitura = registro_.ler();
+            if (Caminhao* volta = leitura.buscar(saida.first)) {
+                if (rodando_) iniciarCaminhao(*volta);
+            }
+            Log::aviso("[SimulacaoMina] Caminhao ID %d nao passou para o shard %d; nova tentativa no proximo passo.",
+                       saida.first, saida.second);
+            continue;
+        }
 
-            for (size_t i = 0; i < caminhoes_.size(); ++i) {
-                caminhoes_[i]->setReducaoSeguranca(precisaReduzir[i]);
+        emigrados_.push_back(estado);
+        c.reset();
+        series_.remover(saida.first);  // o historico longo nao migra
+        Log::info("[SimulacaoMina] Caminhao ID %d passou para o shard %d.", saida.first, saida.second);
+    }
+}
+
+void SimulacaoMina::adotarChegadas() {
+    for (std::size_t i = 0; i < chegadas_.size(); ++i) {
+        const EstadoMigracao& e = chegadas_[i];
+        auto cam = std::make_unique<Caminhao>(e.id_caminhao, fisica_, capacidadeBufferPadrao_, telemetria_.get());
+        cam->definirPlanejador(&planejador_);
+        cam->importarEstado(e);
+        {
+            std::lock_guard<std::mutex> lock(mtxCriacao_);
+            if (!registro_.adotar(std::move(cam))) {
+                Log::erro("[SimulacaoMina] Caminhao ID %d chegou de outro shard, mas o id ja esta na frota", e.id_caminhao);
+                continue;
             }
-        } 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        auto leitura = registro_.ler();
+        if (Caminhao* c = leitura.buscar(e.id_caminhao)) {
+            if (rodando_) iniciarCaminhao(*c);
+            c->definirNivelSeguranca(respostasChegadas_[i].nivel, respostasChegadas_[i].desvio_graus);
+        }
+        Log::info("[SimulacaoMina] Caminhao ID %d chegou de outro shard.", e.id_caminhao);
     }
+    chegadas_.clear();
 }
 
-Caminhao& SimulacaoMina::getCaminhaoPorId(int id) {
-    std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-    for (auto& c : caminhoes_) if (c->getId() == id) return *c;
-    throw std::out_of_range("Nao encontrado");
+bool SimulacaoMina::existeCaminhao(int id) const {
+    return registro_.ler().buscar(id) != nullptr;
 }
 
-const Caminhao& SimulacaoMina::getCaminhaoPorId(int id) const {
-    for (const auto& c : caminhoes_) if (c->getId() == id) return *c;
-    throw std::out_of_range("Nao encontrado");
+bool SimulacaoMina::injetarFalhaTemperatura(int id) {
+    return comCaminhao(id, [&](Caminhao& c) {
+        if (gravador_) gravador_->registrar(TipoEntradaSessao::Falha, id, "TEMP");
+        c.injetarFalhaTemperaturaAlta();
+    });
 }
 
-void SimulacaoMina::injetarFalhaTemperatura(int id) { getCaminhaoPorId(id).injetarFalhaTemperaturaAlta(); }
-void SimulacaoMina::injetarFalhaEletrica(int id)   { getCaminhaoPorId(id).injetarFalhaEletrica(); }
-void SimulacaoMina::injetarFalhaHidraulica(int id) { getCaminhaoPorId(id).injetarFalhaHidraulica(); }
+bool SimulacaoMina::injetarFalhaEletrica(int id) {
+    return comCaminhao(id, [&](Caminhao& c) {
+        if (gravador_) gravador_->registrar(TipoEntradaSessao::Falha, id, "ELET");
+        c.injetarFalhaEletrica();
+    });
+}
 
-void SimulacaoMina::definirRotaCaminhao(int id, int x1, int y1, int x2, int y2) {
-    getCaminhaoPorId(id).definirRota(x1, y1, x2, y2);
+bool SimulacaoMina::injetarFalhaHidraulica(int id) {
+    return comCaminhao(id, [&](Caminhao& c) {
+        if (gravador_) gravador_->registrar(TipoEntradaSessao::Falha, id, "HIDR");
+        c.injetarFalhaHidraulica();
+    });
+}
+
+bool SimulacaoMina::definirRotaCaminhao(int id, int x1, int y1, int x2, int y2) {
+    return comCaminhao(id, [&](Caminhao& c) {
+        if (gravador_) {
+            char rota[64];
+            std::snprintf(rota, sizeof(rota), "ROTA:%d,%d,%d,%d", x1, y1, x2, y2);
+            gravador_->registrar(TipoEntradaSessao::Comando, id, rota);
+        }
+        c.definirRota(x1, y1, x2, y2);
+    });
+}
+
+bool SimulacaoMina::comandarCaminhao(int id, const std::string& comando) {
+    ProtocoloMqtt::Comando cmd;
+    if (!ProtocoloMqtt::decodificarComando(comando, cmd)) {
+        Log::aviso("[SimulacaoMina] Comando nao reconhecido para o caminhao %d: %s", id, comando.c_str());
+        return false;
+    }
+    return comandarCaminhao(id, cmd);
+}
+
+bool SimulacaoMina::comandarCaminhao(int id, const ProtocoloMqtt::Comando& comando) {
+    return comCaminhao(id, [&](Caminhao& c) {
+        if (gravador_) {
+            std::string texto;
+            ProtocoloMqtt::codificarComando(comando, ProtocoloMqtt::Formato::Json, texto);
+            gravador_->registrar(TipoEntradaSessao::Comando, id, texto);
+        }
+        c.aplicarComando(comando);
+    });
 }
 
 void SimulacaoMina::imprimirMapaTexto() const {
-    for (const auto& cPtr : caminhoes_) {
+    paraCadaCaminhao([](const Caminhao& c) {
         RegistroBuffer reg{};
-        if (cPtr->lerUltimoRegistro(reg))
-            std::cout << "ID: " << cPtr->getId()
+        if (c.lerUltimoRegistro(reg))
+            std::cout << "ID: " << c.getId()
                       << " Pos: (" << reg.sensores.i_posicao_x << ", "
                                    << reg.sensores.i_posicao_y << ")\n";
-    }
+    });
 }
 
 void SimulacaoMina::rodarPorSegundos(int segundos) {
@@ -274,16 +1167,6 @@ void SimulacaoMina::rodarPorSegundos(int segundos) {
     }
 }
 
-Caminhao& SimulacaoMina::getCaminhao(std::size_t indice) {
-    std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-    return *caminhoes_.at(indice);
-}
-
-const Caminhao& SimulacaoMina::getCaminhao(std::size_t indice) const {
-    return *caminhoes_.at(indice);
-}
-
 std::size_t SimulacaoMina::quantidadeCaminhoes() const {
-    std::lock_guard<std::mutex> lock(mtxCaminhoes_);
-    return caminhoes_.size();
+    return registro_.ler().frota().size();
 }
\ No newline at end of file
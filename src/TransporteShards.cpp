@@ -0,0 +1,281 @@
+// src/TransporteShards.cpp
+#include "TransporteShards.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Log.hpp"
+#include "MqttInterface.hpp"
+
+namespace {
+    const std::string PREFIXO_TOPICO = "mina/shard/";
+    const std::string SUFIXO_TOPICO  = "/entrada";
+
+    std::string topicoEntrada(int shard) {
+        return PREFIXO_TOPICO + std::to_string(shard) + SUFIXO_TOPICO;
+    }
+
+    // "TPSH" e versao do layout do segmento
+    constexpr std::uint32_t MAGICO_SEGMENTO = 0x48535054u;
+    constexpr std::uint32_t VERSAO_SEGMENTO = 1;
+    constexpr std::size_t   TAM_PREFIXO     = 4;  // uint32 com o tamanho de cada mensagem no anel
+
+    // o shard 0 pode demorar a subir; os outros esperam o segmento ate este prazo
+    constexpr auto PRAZO_ABERTURA   = std::chrono::seconds(30);
+    constexpr auto PAUSA_ABERTURA   = std::chrono::milliseconds(50);
+    // anel cheio: o consumidor esta atrasado, espera ele abrir espaco antes de desistir
+    constexpr auto PRAZO_ANEL_CHEIO = std::chrono::seconds(1);
+    // esperar() gira um pouco antes de dormir entre as consultas
+    constexpr int  GIROS_ESPERA     = 200;
+    constexpr auto PAUSA_ESPERA     = std::chrono::microseconds(50);
+
+    bool processoVivo(std::int32_t pid) {
+        return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+    }
+}
+
+TransporteShardsMqtt::TransporteShardsMqtt(int indice, int shards)
+    : indice_(indice),
+      shards_(shards)
+{
+}
+
+TransporteShardsMqtt::~TransporteShardsMqtt() = default;
+
+bool TransporteShardsMqtt::abrir() {
+    mqtt_ = std::make_unique<MqttInterface>("simulacao_shard_" + std::to_string(indice_),
+        [this](const std::string&, const std::string& payload) {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                chegadas_.push_back(payload);
+            }
+            cv_.notify_one();
+        }
+    );
+    mqtt_->conectar();
+    if (!mqtt_->conectado()) return false;
+    mqtt_->assinar(topicoEntrada(indice_));
+    return true;
+}
+
+bool TransporteShardsMqtt::enviar(int destino, const std::string& mensagem) {
+    if (!mqtt_ || !mqtt_->conectado() || destino < 0 || destino >= shards_ || destino == indice_) return false;
+    // QoS 1: o broker entrega na ordem de publicacao, e nada se perde entre os passos
+    mqtt_->publicar(topicoEntrada(destino), mensagem, 1);
+    return true;
+}
+
+std::size_t TransporteShardsMqtt::receber(std::vector<std::string>& out) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const std::size_t n = chegadas_.size();
+    for (auto& m : chegadas_) out.push_back(std::move(m));
+    chegadas_.clear();
+    return n;
+}
+
+bool TransporteShardsMqtt::esperar(std::chrono::microseconds prazo) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    return cv_.wait_for(lock, prazo, [this] { return !chegadas_.empty(); });
+}
+
+// segmento: cabecalho e, a partir de INICIO_ANEIS, shards * shards aneis indexados por
+// origem * shards + destino (a diagonal fica sem uso)
+// o segmento nasce zerado pelo ftruncate, que ja eh o estado de um anel vazio
+struct TransporteShardsMemoria::Cabecalho {
+    std::atomic<std::uint32_t> magico;  // gravado por ultimo pelo shard 0
+    std::uint32_t versao;
+    std::uint32_t shards;
+    std::uint32_t capacidade;
+    std::int32_t  criador;              // pid do shard 0; um segmento orfao eh ignorado
+};
+
+// contadores de bytes que so crescem, cada um escrito por um lado so
+struct TransporteShardsMemoria::Anel {
+    alignas(64) std::atomic<std::uint64_t> escrita;
+    alignas(64) std::atomic<std::uint64_t> leitura;
+    alignas(64) char dados[CAPACIDADE_ANEL];
+};
+
+namespace {
+    constexpr std::size_t INICIO_ANEIS = 64;
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "os aneis entre processos precisam de atomicos sem trava");
+
+    template <typename Anel>
+    void copiarParaAnel(Anel* a, std::uint64_t pos, const char* src, std::size_t n, std::size_t cap) {
+        const std::size_t ini = static_cast<std::size_t>(pos % cap);
+        const std::size_t primeiro = std::min(n, cap - ini);
+        std::memcpy(a->dados + ini, src, primeiro);
+        std::memcpy(a->dados, src + primeiro, n - primeiro);
+    }
+
+    template <typename Anel>
+    void copiarDoAnel(const Anel* a, std::uint64_t pos, char* dst, std::size_t n, std::size_t cap) {
+        const std::size_t ini = static_cast<std::size_t>(pos % cap);
+        const std::size_t primeiro = std::min(n, cap - ini);
+        std::memcpy(dst, a->dados + ini, primeiro);
+        std::memcpy(dst + primeiro, a->dados, n - primeiro);
+    }
+}
+
+TransporteShardsMemoria::TransporteShardsMemoria(const std::string& nome, int indice, int shards)
+    : nome_(nome),
+      indice_(indice),
+      shards_(shards),
+      fd_(-1),
+      base_(nullptr),
+      tamanho_(INICIO_ANEIS + static_cast<std::size_t>(shards) * static_cast<std::size_t>(shards) * sizeof(Anel))
+{
+}
+
+TransporteShardsMemoria::~TransporteShardsMemoria() {
+    if (base_) ::munmap(base_, tamanho_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        // quem ainda estiver com o segmento mapeado continua lendo; so o nome some
+        if (indice_ == 0) ::shm_unlink(nome_.c_str());
+    }
+}
+
+TransporteShardsMemoria::Anel* TransporteShardsMemoria::anel(int origem, int destino) const {
+    char* p = static_cast<char*>(base_) + INICIO_ANEIS +
+              (static_cast<std::size_t>(origem) * static_cast<std::size_t>(shards_) +
+               static_cast<std::size_t>(destino)) * sizeof(Anel);
+    return reinterpret_cast<Anel*>(p);
+}
+
+bool TransporteShardsMemoria::abrir() {
+    if (base_) return true;
+
+    if (indice_ == 0) {
+        // um segmento que sobrou de uma execucao anterior teria mensagens velhas nos aneis
+        ::shm_unlink(nome_.c_str());
+        fd_ = ::shm_open(nome_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd_ < 0) {
+            Log::erro("[Shards] Nao foi possivel criar o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+            return false;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(tamanho_)) != 0) {
+            Log::erro("[Shards] Nao foi possivel dimensionar o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+            return false;
+        }
+        void* p = ::mmap(nullptr, tamanho_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            Log::erro("[Shards] Nao foi possivel mapear o segmento %s: %s", nome_.c_str(), std::strerror(errno));
+            return false;
+        }
+        base_ = p;
+
+        Cabecalho* c = reinterpret_cast<Cabecalho*>(base_);
+        c->versao     = VERSAO_SEGMENTO;
+        c->shards     = static_cast<std::uint32_t>(shards_);
+        c->capacidade = static_cast<std::uint32_t>(CAPACIDADE_ANEL);
+        c->criador    = static_cast<std::int32_t>(::getpid());
+        c->magico.store(MAGICO_SEGMENTO, std::memory_order_release);
+        return true;
+    }
+
+    const auto limite = std::chrono::steady_clock::now() + PRAZO_ABERTURA;
+    while (std::chrono::steady_clock::now() < limite) {
+        int fd = ::shm_open(nome_.c_str(), O_RDWR, 0);
+        if (fd >= 0) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) == tamanho_) {
+                void* p = ::mmap(nullptr, tamanho_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED) {
+                    const Cabecalho* c = reinterpret_cast<const Cabecalho*>(p);
+                    if (c->magico.load(std::memory_order_acquire) == MAGICO_SEGMENTO &&
+                        c->versao == VERSAO_SEGMENTO && c->shards == static_cast<std::uint32_t>(shards_) &&
+                        c->capacidade == CAPACIDADE_ANEL && processoVivo(c->criador)) {
+                        fd_   = fd;
+                        base_ = p;
+                        return true;
+                    }
+                    ::munmap(p, tamanho_);
+                }
+            }
+            ::close(fd);
+        }
+        std::this_thread::sleep_for(PAUSA_ABERTURA);
+    }
+    Log::erro("[Shards] O segmento %s do shard 0 nao apareceu (mesmo numero de shards?)", nome_.c_str());
+    return false;
+}
+
+bool TransporteShardsMemoria::enviar(int destino, const std::string& mensagem) {
+    if (!base_ || destino < 0 || destino >= shards_ || destino == indice_) return false;
+    const std::size_t n = TAM_PREFIXO + mensagem.size();
+    if (n > CAPACIDADE_ANEL) return false;
+
+    Anel* a = anel(indice_, destino);
+    const std::uint64_t e = a->escrita.load(std::memory_order_relaxed);
+    const auto limite = std::chrono::steady_clock::now() + PRAZO_ANEL_CHEIO;
+    while (CAPACIDADE_ANEL - (e - a->leitura.load(std::memory_order_acquire)) < n) {
+        if (std::chrono::steady_clock::now() >= limite) return false;
+        std::this_thread::yield();
+    }
+
+    char prefixo[TAM_PREFIXO];
+    const std::uint32_t tam = static_cast<std::uint32_t>(mensagem.size());
+    for (std::size_t b = 0; b < TAM_PREFIXO; ++b) prefixo[b] = static_cast<char>((tam >> (8 * b)) & 0xff);
+    copiarParaAnel(a, e, prefixo, TAM_PREFIXO, CAPACIDADE_ANEL);
+    copiarParaAnel(a, e + TAM_PREFIXO, mensagem.data(), mensagem.size(), CAPACIDADE_ANEL);
+    a->escrita.store(e + n, std::memory_order_release);
+    return true;
+}
+
+std::size_t TransporteShardsMemoria::receber(std::vector<std::string>& out) {
+    if (!base_) return 0;
+    std::size_t recebidas = 0;
+    for (int origem = 0; origem < shards_; ++origem) {
+        if (origem == indice_) continue;
+        Anel* a = anel(origem, indice_);
+        std::uint64_t l = a->leitura.load(std::memory_order_relaxed);
+        const std::uint64_t e = a->escrita.load(std::memory_order_acquire);
+        while (l < e) {
+            unsigned char prefixo[TAM_PREFIXO];
+            copiarDoAnel(a, l, reinterpret_cast<char*>(prefixo), TAM_PREFIXO, CAPACIDADE_ANEL);
+            std::uint32_t tam = 0;
+            for (std::size_t b = 0; b < TAM_PREFIXO; ++b) tam |= static_cast<std::uint32_t>(prefixo[b]) << (8 * b);
+
+            std::string m(tam, '\0');
+            copiarDoAnel(a, l + TAM_PREFIXO, &m[0], tam, CAPACIDADE_ANEL);
+            out.push_back(std::move(m));
+            l += TAM_PREFIXO + tam;
+            ++recebidas;
+        }
+        a->leitura.store(l, std::memory_order_release);
+    }
+    return recebidas;
+}
+
+bool TransporteShardsMemoria::haMensagem() const {
+    for (int origem = 0; origem < shards_; ++origem) {
+        if (origem == indice_) continue;
+        const Anel* a = anel(origem, indice_);
+        if (a->leitura.load(std::memory_order_relaxed) != a->escrita.load(std::memory_order_acquire)) return true;
+    }
+    return false;
+}
+
+bool TransporteShardsMemoria::esperar(std::chrono::microseconds prazo) {
+    if (!base_) return false;
+    const auto limite = std::chrono::steady_clock::now() + prazo;
+    for (int giro = 0;; ++giro) {
+        if (haMensagem()) return true;
+        if (std::chrono::steady_clock::now() >= limite) return false;
+        if (giro < GIROS_ESPERA) std::this_thread::yield();
+        else                     std::this_thread::sleep_for(PAUSA_ESPERA);
+    }
+}
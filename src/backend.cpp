@@ -0,0 +1,452 @@
+// src/backend.cpp
+// backend headless da simulacao da mina, sem interface grafica
+//
+// uso: simulacao_backend [--caminhoes N] [--segundos S] [--lockstep] [--semente K] [--silencioso]
+//                        [--mqtt-por-caminhao] [--json TOPICO]... [--gravar ARQ] [--criar N]
+//                        [--shard K/N [--transporte memoria|mqtt] [--segmento NOME]]
+//                        [--estado-compartilhado NOME [--estado-compartilhado-assumir]]
+//                        [--log-nivel N] [--log-arquivo ARQ] [--telemetria ARQ]
+//        simulacao_backend --reproduzir ARQ [--velocidade V] [--gravar ARQ2]
+//        simulacao_backend --comparar ARQ1 ARQ2
+//   tempo real (padrao): roda com MQTT e executor ate Ctrl+C ou ate S segundos
+//               publica o quadro agregado em mina/frota/estado; --mqtt-por-caminhao
+//               liga tambem os clientes e topicos individuais de cada caminhao
+//   --json:     publica o topico de estado em JSON em vez do binario (mina/frota/estado ou
+//               mina/caminhao/+/estado); pode ser repetido
+//   --lockstep: relogio virtual de passo fixo, sem MQTT e sem sleeps, roda S segundos
+//               simulados o mais rapido possivel e imprime um resumo reprodutivel
+//   --criar:    depois de iniciar, cria N caminhoes de uma vez com criarCaminhoes (spawn
+//               sorteado) e imprime a vazao de criacao
+//   --shard:    roda o shard K (0 a N-1) da mina dividida em N faixas; um processo por shard,
+//               cada um com a sua parte de --caminhoes e --criar e semente K + --semente
+//               os shards trocam caminhoes e quadros de borda pela memoria compartilhada
+//               (--segmento, padrao /tp_atr_mina) ou pelo broker MQTT; nao combina com --gravar
+//   --estado-compartilhado: publica o estado de cada caminhao no segmento de memoria
+//               compartilhada NOME (lido por monitor_frota); com --shard, NOME_K
+//               falha se NOME ja existir; --estado-compartilhado-assumir toma o lugar do
+//               segmento existente (de uma execucao interrompida, por exemplo)
+//   --log-nivel: depuracao, info (padrao), aviso ou erro; --silencioso equivale a aviso
+//   --log-arquivo: log da simulacao num arquivo, com instante e nivel, em vez do terminal
+//   --telemetria: log binario da frota (padrao telemetria_frota.tlm, truncado a cada
+//               execucao); com --shard, ARQ_K antes da extensao; "" desliga
+//   --gravar:   grava as entradas externas da sessao (e, no lockstep, pontos de controle)
+//   --reproduzir: re-executa uma sessao gravada em lockstep, a V vezes o tempo real
+//               (V = 0, o padrao, roda o mais rapido possivel) e para na primeira divergencia
+//   --comparar: aponta a primeira diferenca entre duas sessoes gravadas
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SimulacaoMina.hpp"
+#include "Log.hpp"
+#include "ReprodutorSessao.hpp"
+
+namespace {
+    volatile std::sig_atomic_t g_interrompido = 0;
+
+    void tratarSinal(int) { g_interrompido = 1; }
+
+    struct Opcoes {
+        int caminhoes       = 0;
+        int criar           = 0;     // caminhoes criados em massa depois de iniciar
+        long segundos       = 0;     // zero em tempo real significa rodar ate Ctrl+C
+        bool lockstep       = false;
+        std::uint32_t semente = 1;
+        bool silencioso     = false;
+        bool mqttPorCaminhao = false;
+        std::vector<std::string> topicosJson;
+        std::string gravar;
+        std::string reproduzir;
+        double velocidade   = 0.0;
+        std::string compararA, compararB;
+        int shard           = -1;    // -1: mina inteira num processo so
+        int shards          = 1;
+        std::string transporte = "memoria";
+        std::string segmento   = "/tp_atr_mina";
+        std::string estadoCompartilhado;
+        bool assumirEstadoCompartilhado = false;
+        NivelLog nivelLog   = NivelLog::Info;
+        std::string arquivoLog;
+        std::string telemetria = "telemetria_frota.tlm";
+    };
+
+    bool lerNivelLog(const std::string& v, NivelLog& nivel) {
+        if (v == "depuracao")  nivel = NivelLog::Depuracao;
+        else if (v == "info")  nivel = NivelLog::Info;
+        else if (v == "aviso") nivel = NivelLog::Aviso;
+        else if (v == "erro")  nivel = NivelLog::Erro;
+        else return false;
+        return true;
+    }
+
+    // "K/N"
+    bool lerShard(const char* v, Opcoes& op) {
+        char* fim = nullptr;
+        const long k = std::strtol(v, &fim, 10);
+        if (fim == v || *fim != '/') return false;
+        const char* resto = fim + 1;
+        const long n = std::strtol(resto, &fim, 10);
+        if (fim == resto || *fim != '\0' || n < 1 || k < 0 || k >= n) return false;
+        op.shard  = static_cast<int>(k);
+        op.shards = static_cast<int>(n);
+        return true;
+    }
+
+    bool lerOpcoes(int argc, char** argv, Opcoes& op) {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            auto valor = [&](const char* nome) -> const char* {
+                if (i + 1 >= argc) {
+                    std::cerr << "[Backend] Falta valor para " << nome << "\n";
+                    return nullptr;
+                }
+                return argv[++i];
+            };
+
+            if (a == "--lockstep")        op.lockstep = true;
+            else if (a == "--silencioso") op.silencioso = true;
+            else if (a == "--mqtt-por-caminhao") op.mqttPorCaminhao = true;
+            else if (a == "--estado-compartilhado-assumir") op.assumirEstadoCompartilhado = true;
+            else if (a == "--json")       { const char* v = valor("--json");       if (!v) return false; op.topicosJson.push_back(v); }
+            else if (a == "--caminhoes")  { const char* v = valor("--caminhoes"); if (!v) return false; op.caminhoes = std::atoi(v); }
+            else if (a == "--criar")      { const char* v = valor("--criar");     if (!v) return false; op.criar     = std::atoi(v); }
+            else if (a == "--segundos")   { const char* v = valor("--segundos");  if (!v) return false; op.segundos  = std::atol(v); }
+            else if (a == "--gravar")     { const char* v = valor("--gravar");     if (!v) return false; op.gravar = v; }
+            else if (a == "--reproduzir") { const char* v = valor("--reproduzir"); if (!v) return false; op.reproduzir = v; }
+            else if (a == "--velocidade") { const char* v = valor("--velocidade"); if (!v) return false; op.velocidade = std::atof(v); }
+            else if (a == "--shard") {
+                const char* v = valor("--shard"); if (!v) return false;
+                if (!lerShard(v, op)) {
+                    std::cerr << "[Backend] --shard espera K/N, com 0 <= K < N: " << v << "\n";
+                    return false;
+                }
+            }
+            else if (a == "--transporte") {
+                const char* v = valor("--transporte"); if (!v) return false;
+                op.transporte = v;
+                if (op.transporte != "memoria" && op.transporte != "mqtt") {
+                    std::cerr << "[Backend] Transporte desconhecido: " << v << "\n";
+                    return false;
+                }
+            }
+            else if (a == "--telemetria") {
+                const char* v = valor("--telemetria"); if (!v) return false;
+                op.telemetria = v;
+            }
+            else if (a == "--estado-compartilhado") {
+                const char* v = valor("--estado-compartilhado"); if (!v) return false;
+                op.estadoCompartilhado = v;
+            }
+            else if (a == "--log-nivel") {
+                const char* v = valor("--log-nivel"); if (!v) return false;
+                if (!lerNivelLog(v, op.nivelLog)) {
+                    std::cerr << "[Backend] Nivel de log desconhecido: " << v << "\n";
+                    return false;
+                }
+            }
+            else if (a == "--log-arquivo") { const char* v = valor("--log-arquivo"); if (!v) return false; op.arquivoLog = v; }
+            else if (a == "--segmento")   { const char* v = valor("--segmento");  if (!v) return false; op.segmento = v; }
+            else if (a == "--comparar") {
+                const char* v1 = valor("--comparar"); if (!v1) return false;
+                const char* v2 = valor("--comparar"); if (!v2) return false;
+                op.compararA = v1;
+                op.compararB = v2;
+            }
+            else if (a == "--semente")    { const char* v = valor("--semente");   if (!v) return false; op.semente   = static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10)); }
+            else {
+                std::cerr << "[Backend] Opcao desconhecida: " << a << "\n";
+                return false;
+            }
+        }
+        if (op.shard >= 0 && !op.gravar.empty()) {
+            std::cerr << "[Backend] --gravar nao combina com --shard\n";
+            return false;
+        }
+        return true;
+    }
+
+    // parte de um total que cabe ao shard: os primeiros recebem o resto da divisao
+    int parteDoShard(int total, const Opcoes& op) {
+        if (op.shard < 0 || total <= 0) return total;
+        return total / op.shards + (op.shard < total % op.shards ? 1 : 0);
+    }
+
+    std::uint32_t sementeDoShard(const Opcoes& op) {
+        return op.shard < 0 ? op.semente : op.semente + static_cast<std::uint32_t>(op.shard);
+    }
+
+    // cada shard grava a propria telemetria: telemetria_frota.tlm vira telemetria_frota_K.tlm
+    std::string telemetriaDoShard(const Opcoes& op) {
+        if (op.shard < 0 || op.telemetria.empty()) return op.telemetria;
+        const std::string sufixo = "_" + std::to_string(op.shard);
+        const std::size_t barra = op.telemetria.find_last_of('/');
+        const std::size_t ponto = op.telemetria.find_last_of('.');
+        if (ponto == std::string::npos || (barra != std::string::npos && ponto < barra)) return op.telemetria + sufixo;
+        return op.telemetria.substr(0, ponto) + sufixo + op.telemetria.substr(ponto);
+    }
+
+    // com --shard, liga a mina (ainda sem caminhoes) aos outros shards e cria a parte dela
+    bool prepararMina(SimulacaoMina& mina, const Opcoes& op) {
+        if (op.shard >= 0) {
+            std::unique_ptr<TransporteShards> transporte;
+            if (op.transporte == "mqtt") transporte = std::make_unique<TransporteShardsMqtt>(op.shard, op.shards);
+            else                         transporte = std::make_unique<TransporteShardsMemoria>(op.segmento, op.shard, op.shards);
+            if (!mina.configurarShards(op.shard, op.shards, std::move(transporte))) return false;
+        }
+        if (!op.estadoCompartilhado.empty()) {
+            const std::string nome = op.shard < 0 ? op.estadoCompartilhado
+                                                  : op.estadoCompartilhado + "_" + std::to_string(op.shard);
+            if (!mina.publicarEstadoCompartilhado(nome, SegmentoFrota::CAPACIDADE_PADRAO,
+                                                  op.assumirEstadoCompartilhado)) return false;
+        }
+        const int n = parteDoShard(op.caminhoes, op);
+        for (int i = 0; i < n; ++i) mina.criarNovoCaminhao();
+        return true;
+    }
+
+    // cenario de ciclo de transporte: cada caminhao parado no destino recebe um novo
+    // destino sorteado, com RNG semeado para que o lockstep seja reprodutivel
+    void atualizarRotas(SimulacaoMina& mina, std::mt19937& rng) {
+        std::uniform_int_distribution<int> distX(-200, 200);
+        std::uniform_int_distribution<int> distY(-110, 110);
+
+        // os que chegaram sao coletados numa passada pela frota e recebem a rota depois,
+        // fora da secao de leitura, na ordem de criacao
+        std::vector<std::pair<int, RegistroBuffer>> chegaram;
+        mina.paraCadaCaminhao([&](const Caminhao& c) {
+            RegistroBuffer reg{};
+            if (!c.lerUltimoRegistro(reg)) return;
+            if (!reg.estados.e_automatico || reg.estados.e_defeito) return;
+
+            int dx = reg.setpoints.sp_posicao_x - reg.sensores.i_posicao_x;
+            int dy = reg.setpoints.sp_posicao_y - reg.sensores.i_posicao_y;
+            if (std::abs(dx) > 2 || std::abs(dy) > 2) return; // ainda a caminho
+
+            chegaram.push_back({c.getId(), reg});
+        });
+
+        for (const auto& [id, reg] : chegaram) {
+            mina.definirRotaCaminhao(id,
+                                     reg.sensores.i_posicao_x, reg.sensores.i_posicao_y,
+                                     distX(rng), distY(rng));
+        }
+    }
+
+    // tabela com o resumo de cada tipo de tarefa, no fim da execucao em tempo real
+    void imprimirEstatisticas(const SimulacaoMina& mina) {
+        std::cerr << "[Backend] Tarefas (us): ciclos estouros | periodo media/p99/max"
+                     " | execucao media/p99/max | jitter p99/max\n";
+        for (const auto& r : mina.estatisticasTarefas()) {
+            std::cerr << "  " << r.tarefa << ": " << r.ciclos << " " << r.estouros
+                      << " | " << static_cast<long long>(r.periodoMedio_us) << "/" << r.periodoP99_us << "/" << r.periodoMax_us
+                      << " | " << static_cast<long long>(r.execucaoMedia_us) << "/" << r.execucaoP99_us << "/" << r.execucaoMax_us
+                      << " | " << r.jitterP99_us << "/" << r.jitterMax_us << "\n";
+        }
+        ResumoLatencia lat = mina.latenciaSensorAtuador();
+        std::cerr << "[Backend] Latencia sensor->atuador (us): " << lat.amostras << " amostras"
+                  << " | media/p50/p99/max " << static_cast<long long>(lat.media_us) << "/" << lat.p50_us
+                  << "/" << lat.p99_us << "/" << lat.max_us << "\n";
+    }
+
+    void imprimirSeries(const SimulacaoMina& mina) {
+        const SerieTemporalFrota& st = mina.seriesFrota();
+        std::cerr << "[Backend] Series: " << st.quantidadeCaminhoes() << " caminhoes, "
+                  << st.bytesReservados() / 1024 << " KiB reservados de " << st.bytesMaximos() / 1024
+                  << " KiB (retencao inteira: " << st.bytesPorCaminhao() / 1024 << " KiB por caminhao)";
+        if (st.amostrasIgnoradas() > 0) std::cerr << ", " << st.amostrasIgnoradas() << " amostras sem espaco";
+        std::cerr << "\n";
+    }
+
+    void imprimirRotas(const SimulacaoMina& mina) {
+        PlanejadorRotas::Estatisticas e = mina.estatisticasRotas();
+        std::cerr << "[Backend] Rotas: " << e.pedidos << " pedidos, " << e.acertosCache << " no cache, "
+                  << e.semCaminho << " sem caminho, busca A* media " << e.buscaMedia_us << " us\n";
+    }
+
+    void imprimirAnticolisao(const SimulacaoMina& mina) {
+        Anticolisao::Resumo r = mina.resumoAnticolisao();
+        std::cerr << "[Backend] Anticolisao: " << r.limites << " limites de velocidade, " << r.cedencias
+                  << " cedencias, " << r.paradas << " paradas, " << r.desvios
+                  << " desvios; a regra antiga teria feito "
+                  << r.paradasRegraAntiga << " paradas em MANUAL (" << r.paradasEvitadas() << " evitadas, "
+                  << r.tempoPreservado_s << " caminhao-s de transporte preservados)\n";
+    }
+
+    void imprimirShard(const SimulacaoMina& mina) {
+        const ShardMina* shard = mina.shard();
+        if (!shard) return;
+        ShardMina::Estatisticas e = shard->estatisticas();
+        std::cerr << "[Backend] Shard " << shard->indice() << " de " << shard->particao().quantidade() << ": "
+                  << e.migracoesEnviadas << " caminhoes enviados, " << e.migracoesRecebidas << " recebidos, "
+                  << e.quadrosEnviados << "/" << e.quadrosRecebidos << " quadros de borda enviados/recebidos ("
+                  << e.fantasmas << " fantasmas), " << e.falhasEnvio << " falhas de envio, "
+                  << e.descartadas << " mensagens descartadas, " << e.esperasVencidas << " esperas vencidas, "
+                  << e.espera_s << " s esperando os vizinhos\n";
+    }
+
+    void imprimirLog() {
+        Log::Estatisticas e = Log::estatisticas();
+        std::cerr << "[Backend] Log: " << e.escritas << " linhas, " << e.suprimidas << " repeticoes suprimidas, "
+                  << e.descartadas << " descartadas com o anel cheio\n";
+    }
+
+    void criarEmMassa(SimulacaoMina& mina, int n) {
+        if (n <= 0) return;
+        ResultadoCriacao r = mina.criarCaminhoes(static_cast<std::size_t>(n));
+        std::cerr << "[Backend] Criacao em massa: " << r.ids.size() << " caminhoes em "
+                  << r.duracao_s * 1000.0 << " ms (" << static_cast<long long>(r.caminhoesPorSegundo())
+                  << " caminhoes/s)\n";
+    }
+
+    int rodarLockstep(const Opcoes& op) {
+        SimulacaoMina mina(0, 200, telemetriaDoShard(op));
+        if (!prepararMina(mina, op)) return 1;
+        if (!op.gravar.empty() && !mina.gravarSessao(op.gravar)) return 1;
+        mina.iniciarLockstep(sementeDoShard(op));
+        criarEmMassa(mina, parteDoShard(op.criar, op));
+
+        std::mt19937 rngRotas(sementeDoShard(op));
+        const long segundos = op.segundos > 0 ? op.segundos : 3600;
+        const std::uint64_t passosPorSegundo = 1000 / Caminhao::PASSO_LOCKSTEP_MS;
+
+        auto inicio = std::chrono::steady_clock::now();
+        for (long s = 0; s < segundos && !g_interrompido; ++s) {
+            atualizarRotas(mina, rngRotas);
+            mina.avancarLockstep(passosPorSegundo);
+        }
+        double real_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+        std::uint64_t resumo = mina.resumoEstado();
+        std::size_t n = mina.quantidadeCaminhoes();
+        mina.parar();
+
+        std::cerr << "[Backend] Lockstep: " << mina.tempoLockstep_s() << " s simulados em "
+                  << real_s << " s reais (" << (real_s > 0.0 ? mina.tempoLockstep_s() / real_s : 0.0)
+                  << "x), " << n << " caminhoes, resumo=" << std::hex << resumo << std::dec << "\n";
+        imprimirSeries(mina);
+        imprimirRotas(mina);
+        imprimirAnticolisao(mina);
+        imprimirShard(mina);
+        imprimirLog();
+        return 0;
+    }
+
+    int rodarTempoReal(const Opcoes& op) {
+        SimulacaoMina mina(0, 200, telemetriaDoShard(op));
+        if (!prepararMina(mina, op)) return 1;
+        mina.habilitarTopicosPorCaminhao(op.mqttPorCaminhao);
+        for (const auto& t : op.topicosJson) {
+            if (!mina.definirFormatoTopico(t, ProtocoloMqtt::Formato::Json)) {
+                std::cerr << "[Backend] Topico sem formato configuravel: " << t << "\n";
+                return 1;
+            }
+        }
+        if (!op.gravar.empty() && !mina.gravarSessao(op.gravar)) return 1;
+        mina.iniciar();
+        criarEmMassa(mina, parteDoShard(op.criar, op));
+
+        auto inicio = std::chrono::steady_clock::now();
+        while (!g_interrompido) {
+            if (op.segundos > 0 &&
+                std::chrono::steady_clock::now() - inicio >= std::chrono::seconds(op.segundos)) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        mina.parar();
+        imprimirEstatisticas(mina);
+        imprimirSeries(mina);
+        imprimirRotas(mina);
+        imprimirAnticolisao(mina);
+        imprimirShard(mina);
+        imprimirLog();
+        return 0;
+    }
+
+    void imprimirDivergencia(const DivergenciaSessao& d) {
+        std::cerr << "[Backend] Primeira divergencia em t=" << d.tempo_s << " s";
+        if (d.idCaminhao != 0) std::cerr << ", caminhao " << d.idCaminhao;
+        std::cerr << "\n  esperado: " << d.esperado << "\n  obtido:   " << d.obtido << "\n";
+    }
+
+    int rodarReproducao(const Opcoes& op) {
+        std::vector<EntradaSessao> entradas;
+        std::string erro;
+        if (!lerSessao(op.reproduzir, entradas, erro)) {
+            std::cerr << "[Backend] " << erro << "\n";
+            return 1;
+        }
+
+        ReprodutorSessao reprodutor(std::move(entradas));
+        auto inicio = std::chrono::steady_clock::now();
+        ResultadoReproducao r = reprodutor.reproduzir(op.velocidade, op.gravar);
+        double real_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+        std::cerr << "[Backend] Reproducao: " << r.entradasAplicadas << " entradas, "
+                  << r.pontosVerificados << " pontos de controle, " << r.tempoFinal_s << " s simulados em "
+                  << real_s << " s reais, resumo=" << std::hex << r.resumoFinal << std::dec << "\n";
+        if (!r.erro.empty()) {
+            std::cerr << "[Backend] Erro: " << r.erro << "\n";
+            return 1;
+        }
+        if (r.divergencia.encontrada) {
+            imprimirDivergencia(r.divergencia);
+            return 2;
+        }
+        std::cerr << "[Backend] Sessao reproduzida sem divergencia\n";
+        return 0;
+    }
+
+    int rodarComparacao(const Opcoes& op) {
+        std::vector<EntradaSessao> a, b;
+        std::string erro;
+        if (!lerSessao(op.compararA, a, erro) || !lerSessao(op.compararB, b, erro)) {
+            std::cerr << "[Backend] " << erro << "\n";
+            return 1;
+        }
+        DivergenciaSessao d = compararSessoes(a, b);
+        if (d.encontrada) {
+            imprimirDivergencia(d);
+            return 2;
+        }
+        std::cerr << "[Backend] Sessoes equivalentes\n";
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Opcoes op;
+    if (!lerOpcoes(argc, argv, op)) return 1;
+
+    std::signal(SIGINT,  tratarSinal);
+    std::signal(SIGTERM, tratarSinal);
+
+    // no modo silencioso o log dos caminhoes e da simulacao fica so com avisos e erros
+    Log::Configuracao log;
+    log.nivelMinimo = op.silencioso ? std::max(op.nivelLog, NivelLog::Aviso) : op.nivelLog;
+    log.arquivo     = op.arquivoLog;
+    if (!Log::configurar(log)) {
+        std::cerr << "[Backend] Nao foi possivel abrir o arquivo de log " << op.arquivoLog << "\n";
+        return 1;
+    }
+
+    if (!op.compararA.empty()) return rodarComparacao(op);
+    if (!op.reproduzir.empty()) {
+        std::cerr << "[Backend] Reproducao da sessao " << op.reproduzir << "\n";
+        return rodarReproducao(op);
+    }
+
+    std::cerr << "[Backend] Simulacao da mina (" << (op.lockstep ? "lockstep" : "tempo real");
+    if (op.shard >= 0) std::cerr << ", shard " << op.shard << " de " << op.shards << " por " << op.transporte;
+    std::cerr << ")\n";
+    return op.lockstep ? rodarLockstep(op) : rodarTempoReal(op);
+}
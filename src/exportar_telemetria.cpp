@@ -0,0 +1,93 @@
+// src/exportar_telemetria.cpp
+// converte o log binario da frota de volta para os CSVs por caminhao (caminhao_<id>.csv),
+// no mesmo layout de colunas gravado antes pelo coletor de dados
+//
+// uso: exportar_telemetria <telemetria_frota.tlm> [diretorio_saida]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "RegistradorTelemetria.hpp"
+
+namespace {
+    const char* CABECALHO_CSV =
+        "tempo_s;id_caminhao;estado;e_defeito;e_automatico;"
+        "i_posicao_x;i_posicao_y;i_angulo_x;i_temperatura;"
+        "o_aceleracao;o_direcao;evento\n";
+
+    // acima disso o texto acumulado de um caminhao vai para o disco
+    constexpr std::size_t LIMITE_BUFFER = 1 << 20;
+
+    // um arquivo aberto por vez, para nao estourar o limite de descritores com frotas grandes
+    bool anexarArquivo(const std::string& caminho, const std::string& texto) {
+        std::ofstream f(caminho, std::ios::out | std::ios::app);
+        if (!f.is_open()) return false;
+        f << texto;
+        return static_cast<bool>(f);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "uso: " << argv[0] << " <telemetria_frota.tlm> [diretorio_saida]\n";
+        return 1;
+    }
+    std::string dirSaida = argc >= 3 ? std::string(argv[2]) + "/" : std::string();
+
+    LeitorTelemetria leitor;
+    if (!leitor.abrir(argv[1])) {
+        std::cerr << "[Exportar] Erro: " << leitor.erro() << "\n";
+        return 1;
+    }
+
+    std::map<int, std::string> pendentes; // texto ainda nao gravado, por caminhao
+    std::map<int, bool> iniciados;        // arquivo ja truncado e com cabecalho
+    std::vector<AmostraTelemetria> bloco;
+    std::ostringstream linha;
+    std::size_t total = 0;
+
+    auto descarregar = [&](int id) {
+        std::string caminho = dirSaida + "caminhao_" + std::to_string(id) + ".csv";
+        if (!iniciados[id]) {
+            std::ofstream f(caminho, std::ios::out | std::ios::trunc);
+            f << CABECALHO_CSV;
+            iniciados[id] = true;
+        }
+        if (!anexarArquivo(caminho, pendentes[id])) {
+            std::cerr << "[Exportar] Erro ao gravar " << caminho << "\n";
+        }
+        pendentes[id].clear();
+    };
+
+    while (leitor.proximoBloco(bloco)) {
+        for (const auto& a : bloco) {
+            // mesma formatacao do antigo operator<< do coletor (bool como 0/1)
+            linha.str("");
+            linha << a.tempo_s << ";" << a.id_caminhao << ";"
+                  << estadoToString(a.estado) << ";"
+                  << a.e_defeito << ";" << a.e_automatico << ";"
+                  << a.i_posicao_x << ";" << a.i_posicao_y << ";"
+                  << a.i_angulo_x << ";" << a.i_temperatura << ";"
+                  << a.o_aceleracao << ";" << a.o_direcao << ";"
+                  << eventoTelemetriaToString(a.evento) << "\n";
+
+            std::string& buf = pendentes[a.id_caminhao];
+            buf += linha.str();
+            if (buf.size() >= LIMITE_BUFFER) descarregar(a.id_caminhao);
+            ++total;
+        }
+    }
+
+    if (!leitor.erro().empty()) {
+        std::cerr << "[Exportar] Aviso: " << leitor.erro() << " (exportado ate aqui)\n";
+    }
+
+    for (auto& p : pendentes) descarregar(p.first);
+
+    std::cout << "[Exportar] " << total << " amostras de " << pendentes.size()
+              << " caminhoes exportadas.\n";
+    return 0;
+}
@@ -9,6 +9,82 @@
 
 namespace {
     constexpr double PI = 3.14159265358979323846;
+
+    // posicao e rotacao de um caminhao na tela, no mesmo formato das transformacoes do SFML
+    struct PoseTela {
+        float x;
+        float y;
+        float cosR;
+        float sinR;
+    };
+
+    PoseTela criarPose(float x, float y, float rotacaoGraus) {
+        float rad = rotacaoGraus * static_cast<float>(PI) / 180.f;
+        return PoseTela{x, y, std::cos(rad), std::sin(rad)};
+    }
+
+    sf::Vector2f transformar(const PoseTela& p, float lx, float ly) {
+        return sf::Vector2f(p.x + lx * p.cosR - ly * p.sinR,
+                            p.y + lx * p.sinR + ly * p.cosR);
+    }
+
+    // equivale a um sf::RectangleShape de tamanho (w, h) com origem (ox, oy) na pose dada,
+    // mas vira dois triangulos no vertex array da frota em vez de uma chamada de desenho
+    void adicionarRetangulo(sf::VertexArray& va, const PoseTela& p,
+                            float w, float h, float ox, float oy, sf::Color cor) {
+        sf::Vector2f a = transformar(p, -ox,     -oy);
+        sf::Vector2f b = transformar(p, w - ox,  -oy);
+        sf::Vector2f c = transformar(p, w - ox,  h - oy);
+        sf::Vector2f d = transformar(p, -ox,     h - oy);
+        va.append(sf::Vertex(a, cor));
+        va.append(sf::Vertex(b, cor));
+        va.append(sf::Vertex(c, cor));
+        va.append(sf::Vertex(a, cor));
+        va.append(sf::Vertex(c, cor));
+        va.append(sf::Vertex(d, cor));
+    }
+
+    // elipse centrada na pose, com raios rx e ry antes da rotacao, em leque de triangulos
+    void adicionarElipse(sf::VertexArray& va, const PoseTela& p, float rx, float ry, sf::Color cor) {
+        constexpr int SEGMENTOS = 16;
+        sf::Vector2f centro(p.x, p.y);
+        sf::Vector2f anterior = transformar(p, rx, 0.f);
+        for (int k = 1; k <= SEGMENTOS; ++k) {
+            float t = 2.f * static_cast<float>(PI) * static_cast<float>(k) / SEGMENTOS;
+            sf::Vector2f atual = transformar(p, rx * std::cos(t), ry * std::sin(t));
+            va.append(sf::Vertex(centro,   cor));
+            va.append(sf::Vertex(anterior, cor));
+            va.append(sf::Vertex(atual,    cor));
+            anterior = atual;
+        }
+    }
+
+    // todas as pecas de um caminhao, na mesma ordem e geometria dos shapes antigos
+    // (sombra, pneus, contorno de selecao, corpo, cacamba, cabine, vidro)
+    void adicionarCaminhao(sf::VertexArray& va, float xTela, float yTela, float rotacao,
+                           bool modoAuto, bool selecionado) {
+        adicionarElipse(va, criarPose(xTela + 4.f, yTela + 4.f, rotacao), 14.f * 1.5f, 14.f * 0.8f,
+                        sf::Color(0, 0, 0, 60));
+
+        PoseTela pose = criarPose(xTela, yTela, rotacao);
+
+        const sf::Color corPneu(20, 20, 20);
+        adicionarRetangulo(va, pose, 10.f, 4.f, 5.f - 8.f,  2.f - 10.f, corPneu);
+        adicionarRetangulo(va, pose, 10.f, 4.f, 5.f - 8.f,  2.f + 10.f, corPneu);
+        adicionarRetangulo(va, pose, 10.f, 4.f, 5.f + 8.f,  2.f - 10.f, corPneu);
+        adicionarRetangulo(va, pose, 10.f, 4.f, 5.f + 8.f,  2.f + 10.f, corPneu);
+
+        if (selecionado) {
+            // contorno de 2 px por fora do corpo
+            adicionarRetangulo(va, pose, 36.f, 22.f, 18.f, 11.f, sf::Color::White);
+        }
+        adicionarRetangulo(va, pose, 32.f, 18.f, 16.f, 9.f,
+                           modoAuto ? sf::Color(255, 204, 0) : sf::Color(230, 80, 0));
+
+        adicionarRetangulo(va, pose, 20.f, 14.f, 10.f - 5.f,  7.f, sf::Color(0, 0, 0, 30));
+        adicionarRetangulo(va, pose, 8.f,  12.f, 4.f - 10.f,  6.f, sf::Color(50, 50, 50));
+        adicionarRetangulo(va, pose, 4.f,  10.f, 2.f - 11.f,  5.f, sf::Color(100, 200, 255));
+    }
 }
 
 struct CaminhaoDrawInfo {
@@ -28,11 +104,16 @@ sf::RectangleShape criarBotaoEstiloso(sf::Vector2f tamanho, sf::Vector2f pos, sf
 }
 
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "GUI Gestao da Mina\n";
 
     SimulacaoMina mina(0, 200);
 
+    // --gravar ARQ grava a sessao para reproduzir depois com simulacao_backend --reproduzir
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--gravar" && !mina.gravarSessao(argv[i + 1])) return 1;
+    }
+
     mina.iniciar();
 
     const int   WINDOW_WIDTH  = 1920;
@@ -137,7 +218,120 @@ int main() {
     sf::RectangleShape painelBotaoFalhaElec = criarBotaoEstiloso(sf::Vector2f(90.f, 22.f), sf::Vector2f(falhaX, falhaY + 26.f), sf::Color::Black);
     sf::RectangleShape painelBotaoFalhaHid  = criarBotaoEstiloso(sf::Vector2f(90.f, 22.f), sf::Vector2f(falhaX, falhaY + 52.f), sf::Color::Black);
 
+    // mapa fixo (grade, eixos, cava e britador): desenhado uma vez em uma textura
+    // e reaproveitado como um unico sprite em todo frame
+    auto desenharMapaEstatico = [&](sf::RenderTarget& alvo) {
+        sf::Color gridColor(0, 0, 0, 20);
+        sf::VertexArray grade(sf::Lines);
+        for (int x = 0; x < WINDOW_WIDTH; x += 40) {
+            grade.append(sf::Vertex(sf::Vector2f(static_cast<float>(x), 0.f), gridColor));
+            grade.append(sf::Vertex(sf::Vector2f(static_cast<float>(x), static_cast<float>(WINDOW_HEIGHT)), gridColor));
+        }
+        for (int y = 0; y < WINDOW_HEIGHT; y += 40) {
+            grade.append(sf::Vertex(sf::Vector2f(0.f, static_cast<float>(y)), gridColor));
+            grade.append(sf::Vertex(sf::Vector2f(static_cast<float>(WINDOW_WIDTH), static_cast<float>(y)), gridColor));
+        }
+        alvo.draw(grade);
+
+        sf::Vertex eixoX[] = {
+            sf::Vertex(sf::Vector2f(0.f, ORIGEM_Y), sf::Color(100, 100, 100, 150)),
+            sf::Vertex(sf::Vector2f(static_cast<float>(WINDOW_WIDTH), ORIGEM_Y), sf::Color(100, 100, 100, 150))
+        };
+        sf::Vertex eixoY[] = {
+            sf::Vertex(sf::Vector2f(ORIGEM_X, 0.f), sf::Color(100, 100, 100, 150)),
+            sf::Vertex(sf::Vector2f(ORIGEM_X, static_cast<float>(WINDOW_HEIGHT)), sf::Color(100, 100, 100, 150))
+        };
+        alvo.draw(eixoX, 2, sf::Lines);
+        alvo.draw(eixoY, 2, sf::Lines);
+
+        {
+            float cavaX = ORIGEM_X - 150.f;
+            float cavaY = ORIGEM_Y + 100.f;
+        
+            sf::CircleShape cava1(130.f);
+            cava1.setFillColor(sf::Color(160, 130, 90));
+            cava1.setOrigin(130.f, 130.f);
+            cava1.setPosition(cavaX, cavaY);
+            alvo.draw(cava1);
+
+            sf::CircleShape cava2(100.f);
+            cava2.setFillColor(sf::Color(130, 100, 70));
+            cava2.setOrigin(100.f, 100.f);
+            cava2.setPosition(cavaX, cavaY);
+            alvo.draw(cava2);
+
+            sf::CircleShape cava3(70.f);
+            cava3.setFillColor(sf::Color(90, 60, 40));
+            cava3.setOrigin(70.f, 70.f);
+            cava3.setPosition(cavaX, cavaY);
+            alvo.draw(cava3);
+
+            if (fonteOk) {
+                sf::Text label = criarTexto("AREA DE LAVRA", cavaX - 50, cavaY - 10, 12, sf::Color(255,255,255,150));
+                alvo.draw(label);
+            }
+        }
+
+        {
+            float britX = ORIGEM_X + 200.f;
+            float britY = ORIGEM_Y - 150.f;
+        
+            sf::RectangleShape base(sf::Vector2f(160.f, 120.f));
+            base.setFillColor(sf::Color(120, 128, 130));
+            base.setOutlineColor(sf::Color(60, 60, 60));
+            base.setOutlineThickness(2.f);
+            base.setOrigin(80.f, 60.f);
+            base.setPosition(britX, britY);
+            alvo.draw(base);
+
+            sf::RectangleShape hopper(sf::Vector2f(60.f, 40.f));
+            hopper.setFillColor(sf::Color(50, 50, 60));
+            hopper.setOrigin(30.f, 20.f);
+            hopper.setPosition(britX, britY);
+            alvo.draw(hopper);
+
+            sf::RectangleShape esteira(sf::Vector2f(100.f, 10.f));
+            esteira.setFillColor(sf::Color(40, 40, 40));
+            esteira.setOrigin(0.f, 5.f);
+            esteira.setPosition(britX, britY);
+            esteira.setRotation(-45.f);
+            alvo.draw(esteira);
+
+            if (fonteOk) {
+                sf::Text label = criarTexto("BRITADOR PRIMARIO", britX - 60, britY + 40, 12, sf::Color::White);
+                alvo.draw(label);
+            }
+        }
+    };
+
+    sf::RenderTexture camadaEstatica;
+    sf::Sprite spriteEstatico;
+    bool camadaEstaticaOk = camadaEstatica.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (camadaEstaticaOk) {
+        camadaEstatica.clear(sf::Color(210, 200, 180));
+        desenharMapaEstatico(camadaEstatica);
+        camadaEstatica.display();
+        spriteEstatico.setTexture(camadaEstatica.getTexture());
+    } else {
+        std::cout << "[GUI] Nao foi possivel criar a textura do mapa. Desenhando o mapa a cada frame.\n";
+    }
+
+    // vertices de todos os caminhoes, reconstruido a cada frame e desenhado em uma chamada
+    sf::VertexArray verticesFrota(sf::Triangles);
+    // rota do selecionado (waypoints copiados do caminhao a cada frame)
+    sf::VertexArray linhaRota(sf::LineStrip);
+    std::vector<GradeEspacial::Ponto> waypointsSel;
+
+    // o selecionado tambem pode sumir entre o teste do frame e o clique (remocao por MQTT ou
+    // passagem para outro shard); um comando que nao acha o caminhao desfaz a selecao
+    auto comandarSelecionado = [&](const char* comando) {
+        if (idSelecionado != -1 && !mina.comandarCaminhao(idSelecionado, comando)) idSelecionado = -1;
+    };
+
     while (window.isOpen()) {
+        // o selecionado pode ter sido removido por MQTT desde o ultimo frame
+        if (idSelecionado != -1 && !mina.existeCaminhao(idSelecionado)) idSelecionado = -1;
+
         sf::Event event{};
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
@@ -168,27 +362,27 @@ int main() {
 
                 if (idSelecionado != -1 && painelVisivel) {
                     if (painelBotaoAuto.getGlobalBounds().contains(pixelF)) {
-                        mina.getCaminhaoPorId(idSelecionado).comandarAutomatico();
+                        comandarSelecionado("CMD:AUTO");
                         continue;
                     }
                     if (painelBotaoManual.getGlobalBounds().contains(pixelF)) {
-                        mina.getCaminhaoPorId(idSelecionado).comandarManual();
+                        comandarSelecionado("CMD:MANUAL");
                         continue;
                     }
                     if (painelBotaoRearme.getGlobalBounds().contains(pixelF)) {
-                        mina.getCaminhaoPorId(idSelecionado).comandarRearme();
+                        comandarSelecionado("CMD:REARME");
                         continue;
                     }
                     if (painelBotaoFalhaTemp.getGlobalBounds().contains(pixelF)) {
-                        mina.injetarFalhaTemperatura(idSelecionado);
+                        if (!mina.injetarFalhaTemperatura(idSelecionado)) idSelecionado = -1;
                         continue;
                     }
                     if (painelBotaoFalhaElec.getGlobalBounds().contains(pixelF)) {
-                        mina.injetarFalhaEletrica(idSelecionado);
+                        if (!mina.injetarFalhaEletrica(idSelecionado)) idSelecionado = -1;
                         continue;
                     }
                     if (painelBotaoFalhaHid.getGlobalBounds().contains(pixelF)) {
-                        mina.injetarFalhaHidraulica(idSelecionado);
+                        if (!mina.injetarFalhaHidraulica(idSelecionado)) idSelecionado = -1;
                         continue;
                     }
                 }
@@ -196,8 +390,7 @@ int main() {
                 std::vector<CaminhaoDrawInfo> infos;
                 infos.reserve(mina.quantidadeCaminhoes());
 
-                for (std::size_t i = 0; i < mina.quantidadeCaminhoes(); ++i) {
-                    Caminhao& c = mina.getCaminhao(i);
+                mina.paraCadaCaminhao([&](const Caminhao& c) {
                     RegistroBuffer reg{};
                     bool ok = c.lerUltimoRegistro(reg);
                     CaminhaoDrawInfo info{};
@@ -211,7 +404,7 @@ int main() {
                         info.yTela = ORIGEM_Y;
                     }
                     infos.push_back(info);
-                }
+                });
 
                 const float LIMITE_CLICK = 20.0f;
                 float melhorDist = 1e9f;
@@ -234,122 +427,53 @@ int main() {
                 } else if (idSelecionado != -1) {
                     double worldX = (static_cast<double>(pixel.x) - ORIGEM_X) / SCALE;
                     double worldY = (ORIGEM_Y - static_cast<double>(pixel.y)) / SCALE;
-                    Caminhao& cSel = mina.getCaminhaoPorId(idSelecionado);
                     RegistroBuffer reg{};
-                    if (cSel.lerUltimoRegistro(reg)) {
-                        cSel.definirRota(reg.sensores.i_posicao_x, reg.sensores.i_posicao_y,
-                                         static_cast<int>(std::lround(worldX)),
-                                         static_cast<int>(std::lround(worldY)));
-                        cSel.comandarAutomatico();
+                    bool temRegistro = false;
+                    if (!mina.comCaminhao(idSelecionado, [&](const Caminhao& c) { temRegistro = c.lerUltimoRegistro(reg); })) {
+                        idSelecionado = -1;
+                    } else if (temRegistro) {
+                        if (mina.definirRotaCaminhao(idSelecionado, reg.sensores.i_posicao_x, reg.sensores.i_posicao_y,
+                                                     static_cast<int>(std::lround(worldX)),
+                                                     static_cast<int>(std::lround(worldY)))) {
+                            comandarSelecionado("CMD:AUTO");
+                        } else {
+                            idSelecionado = -1;
+                        }
                         painelVisivel = true;
                     }
                 }
             }
             else if (event.type == sf::Event::KeyPressed) {
                 if (idSelecionado != -1) {
-                    Caminhao& cSel = mina.getCaminhaoPorId(idSelecionado);
-                    if (event.key.code == sf::Keyboard::W) cSel.setComandoAcelerar(true);
-                    if (event.key.code == sf::Keyboard::A) { cSel.setComandoEsquerda(true); cSel.setComandoDireita(false); }
-                    if (event.key.code == sf::Keyboard::D) { cSel.setComandoDireita(true); cSel.setComandoEsquerda(false); }
+                    // os comandos passam pela mina para entrarem na sessao gravada
+                    if (event.key.code == sf::Keyboard::W) comandarSelecionado("CMD:ACELERA:1");
+                    if (event.key.code == sf::Keyboard::A) {
+                        comandarSelecionado("CMD:ESQUERDA:1");
+                        comandarSelecionado("CMD:DIREITA:0");
+                    }
+                    if (event.key.code == sf::Keyboard::D) {
+                        comandarSelecionado("CMD:DIREITA:1");
+                        comandarSelecionado("CMD:ESQUERDA:0");
+                    }
+                    if (event.key.code == sf::Keyboard::Delete) {
+                        mina.removerCaminhao(idSelecionado);
+                        idSelecionado = -1;
+                    }
                 }
             }
             else if (event.type == sf::Event::KeyReleased) {
                 if (idSelecionado != -1) {
-                    Caminhao& cSel = mina.getCaminhaoPorId(idSelecionado);
-                    if (event.key.code == sf::Keyboard::W) cSel.setComandoAcelerar(false);
-                    if (event.key.code == sf::Keyboard::A) cSel.setComandoEsquerda(false);
-                    if (event.key.code == sf::Keyboard::D) cSel.setComandoDireita(false);
+                    if (event.key.code == sf::Keyboard::W) comandarSelecionado("CMD:ACELERA:0");
+                    if (event.key.code == sf::Keyboard::A) comandarSelecionado("CMD:ESQUERDA:0");
+                    if (event.key.code == sf::Keyboard::D) comandarSelecionado("CMD:DIREITA:0");
                 }
             }
         }
 
         window.clear(sf::Color(210, 200, 180)); 
 
-        sf::Color gridColor(0, 0, 0, 20);
-        for (int x = 0; x < WINDOW_WIDTH; x += 40) {
-            sf::Vertex line[] = {
-                sf::Vertex(sf::Vector2f(static_cast<float>(x), 0.f), gridColor),
-                sf::Vertex(sf::Vector2f(static_cast<float>(x), static_cast<float>(WINDOW_HEIGHT)), gridColor)
-            };
-            window.draw(line, 2, sf::Lines);
-        }
-        for (int y = 0; y < WINDOW_HEIGHT; y += 40) {
-            sf::Vertex line[] = {
-                sf::Vertex(sf::Vector2f(0.f, static_cast<float>(y)), gridColor),
-                sf::Vertex(sf::Vector2f(static_cast<float>(WINDOW_WIDTH), static_cast<float>(y)), gridColor)
-            };
-            window.draw(line, 2, sf::Lines);
-        }
-
-        sf::Vertex eixoX[] = {
-            sf::Vertex(sf::Vector2f(0.f, ORIGEM_Y), sf::Color(100, 100, 100, 150)),
-            sf::Vertex(sf::Vector2f(static_cast<float>(WINDOW_WIDTH), ORIGEM_Y), sf::Color(100, 100, 100, 150))
-        };
-        sf::Vertex eixoY[] = {
-            sf::Vertex(sf::Vector2f(ORIGEM_X, 0.f), sf::Color(100, 100, 100, 150)),
-            sf::Vertex(sf::Vector2f(ORIGEM_X, static_cast<float>(WINDOW_HEIGHT)), sf::Color(100, 100, 100, 150))
-        };
-        window.draw(eixoX, 2, sf::Lines);
-        window.draw(eixoY, 2, sf::Lines);
-
-        {
-            float cavaX = ORIGEM_X - 150.f;
-            float cavaY = ORIGEM_Y + 100.f;
-            
-            sf::CircleShape cava1(130.f);
-            cava1.setFillColor(sf::Color(160, 130, 90));
-            cava1.setOrigin(130.f, 130.f);
-            cava1.setPosition(cavaX, cavaY);
-            window.draw(cava1);
-
-            sf::CircleShape cava2(100.f);
-            cava2.setFillColor(sf::Color(130, 100, 70));
-            cava2.setOrigin(100.f, 100.f);
-            cava2.setPosition(cavaX, cavaY);
-            window.draw(cava2);
-
-            sf::CircleShape cava3(70.f);
-            cava3.setFillColor(sf::Color(90, 60, 40));
-            cava3.setOrigin(70.f, 70.f);
-            cava3.setPosition(cavaX, cavaY);
-            window.draw(cava3);
-
-            if (fonteOk) {
-                sf::Text label = criarTexto("AREA DE LAVRA", cavaX - 50, cavaY - 10, 12, sf::Color(255,255,255,150));
-                window.draw(label);
-            }
-        }
-
-        {
-            float britX = ORIGEM_X + 200.f;
-            float britY = ORIGEM_Y - 150.f;
-            
-            sf::RectangleShape base(sf::Vector2f(160.f, 120.f));
-            base.setFillColor(sf::Color(120, 128, 130));
-            base.setOutlineColor(sf::Color(60, 60, 60));
-            base.setOutlineThickness(2.f);
-            base.setOrigin(80.f, 60.f);
-            base.setPosition(britX, britY);
-            window.draw(base);
-
-            sf::RectangleShape hopper(sf::Vector2f(60.f, 40.f));
-            hopper.setFillColor(sf::Color(50, 50, 60));
-            hopper.setOrigin(30.f, 20.f);
-            hopper.setPosition(britX, britY);
-            window.draw(hopper);
-
-            sf::RectangleShape esteira(sf::Vector2f(100.f, 10.f));
-            esteira.setFillColor(sf::Color(40, 40, 40));
-            esteira.setOrigin(0.f, 5.f);
-            esteira.setPosition(britX, britY);
-            esteira.setRotation(-45.f);
-            window.draw(esteira);
-
-            if (fonteOk) {
-                sf::Text label = criarTexto("BRITADOR PRIMARIO", britX - 60, britY + 40, 12, sf::Color::White);
-                window.draw(label);
-            }
-        }
+        if (camadaEstaticaOk) window.draw(spriteEstatico);
+        else                  desenharMapaEstatico(window);
 
         window.draw(sombraBotaoNovo);
         window.draw(botaoNovo);
@@ -372,11 +496,16 @@ int main() {
         RegistroBuffer regSel{};
         bool temRegSel = false;
 
-        for (std::size_t i = 0; i < mina.quantidadeCaminhoes(); ++i) {
-            Caminhao& c = mina.getCaminhao(i);
+        // a rota do selecionado eh desenhada depois da frota, por cima dos caminhoes
+        bool temRotaSel = false;
+        sf::Vector2f rotaSelDe;
+        waypointsSel.clear();
 
+        verticesFrota.clear();
+
+        mina.paraCadaCaminhao([&](const Caminhao& c) {
             RegistroBuffer reg{};
-            if (!c.lerUltimoRegistro(reg)) continue;
+            if (!c.lerUltimoRegistro(reg)) return;
 
             float xTela = ORIGEM_X + static_cast<float>(reg.sensores.i_posicao_x) * SCALE;
             float yTela = ORIGEM_Y - static_cast<float>(reg.sensores.i_posicao_y) * SCALE;
@@ -386,88 +515,37 @@ int main() {
             
             float rotacaoVisual = -static_cast<float>(reg.sensores.i_angulo_x);
 
-            sf::CircleShape sombra(14.f);
-            sombra.setScale(1.5f, 0.8f);
-            sombra.setFillColor(sf::Color(0,0,0,60));
-            sombra.setOrigin(14.f, 14.f);
-            sombra.setPosition(xTela + 4.f, yTela + 4.f);
-            sombra.setRotation(rotacaoVisual);
-            window.draw(sombra);
-
-            sf::RectangleShape corpo(sf::Vector2f(32.f, 18.f));
-            corpo.setOrigin(16.f, 9.f);
-            corpo.setPosition(xTela, yTela);
-            corpo.setRotation(rotacaoVisual);
-            
-            if (modoAuto) {
-                corpo.setFillColor(sf::Color(255, 204, 0)); 
-            } else {
-                corpo.setFillColor(sf::Color(230, 80, 0));  
-            }
-            
-            if (selecionado) {
-                corpo.setOutlineColor(sf::Color::White);
-                corpo.setOutlineThickness(2.f);
-            } else {
-                corpo.setOutlineThickness(0.f);
-            }
-
-            sf::RectangleShape cacamba(sf::Vector2f(20.f, 14.f));
-            cacamba.setOrigin(10.f - 5.f, 7.f);
-            cacamba.setPosition(xTela, yTela);
-            cacamba.setRotation(rotacaoVisual);
-            cacamba.setFillColor(sf::Color(0,0,0,30));
-            
-            sf::RectangleShape cabine(sf::Vector2f(8.f, 12.f));
-            cabine.setOrigin(4.f - 10.f, 6.f);
-            cabine.setPosition(xTela, yTela);
-            cabine.setRotation(rotacaoVisual);
-            cabine.setFillColor(sf::Color(50, 50, 50));
-
-            sf::RectangleShape vidro(sf::Vector2f(4.f, 10.f));
-            vidro.setOrigin(2.f - 11.f, 5.f);
-            vidro.setPosition(xTela, yTela);
-            vidro.setRotation(rotacaoVisual);
-            vidro.setFillColor(sf::Color(100, 200, 255));
-
-            auto desenharPneu = [&](float offX, float offY) {
-                sf::RectangleShape p(sf::Vector2f(10.f, 4.f));
-                p.setFillColor(sf::Color(20, 20, 20));
-                p.setOrigin(5.f - offX, 2.f - offY);
-                p.setPosition(xTela, yTela);
-                p.setRotation(rotacaoVisual);
-                window.draw(p);
-            };
-            desenharPneu(8.f, 10.f);
-            desenharPneu(8.f, -10.f);
-            desenharPneu(-8.f, 10.f);
-            desenharPneu(-8.f, -10.f);
-
-            window.draw(corpo);
-            window.draw(cacamba);
-            window.draw(cabine);
-            window.draw(vidro);
+            adicionarCaminhao(verticesFrota, xTela, yTela, rotacaoVisual, modoAuto, selecionado);
 
             if (selecionado) {
                 regSel  = reg;
                 temRegSel = true;
                 
-                if (modoAuto) {
-                     float spX = ORIGEM_X + static_cast<float>(reg.setpoints.sp_posicao_x) * SCALE;
-                     float spY = ORIGEM_Y - static_cast<float>(reg.setpoints.sp_posicao_y) * SCALE;
-                     
-                     sf::Vertex linhaRota[] = {
-                          sf::Vertex(sf::Vector2f(xTela, yTela), sf::Color(0, 255, 0, 100)),
-                          sf::Vertex(sf::Vector2f(spX, spY),       sf::Color(0, 255, 0, 100))
-                     };
-                     window.draw(linhaRota, 2, sf::Lines);
-
-                     sf::CircleShape alvo(3.f);
-                     alvo.setFillColor(sf::Color::Green);
-                     alvo.setPosition(spX-3, spY-3);
-                     window.draw(alvo);
+                if (modoAuto && c.copiarRestoDaRota(waypointsSel) > 0) {
+                     temRotaSel = true;
+                     rotaSelDe  = sf::Vector2f(xTela, yTela);
                 }
             }
+        });
+
+        window.draw(verticesFrota);
+
+        if (temRotaSel) {
+            // caminho planejado: do caminhao pelos waypoints que faltam ate o destino
+            linhaRota.clear();
+            linhaRota.append(sf::Vertex(rotaSelDe, sf::Color(0, 255, 0, 100)));
+            sf::Vector2f rotaSelPara = rotaSelDe;
+            for (const auto& w : waypointsSel) {
+                rotaSelPara = sf::Vector2f(ORIGEM_X + static_cast<float>(w.x) * SCALE,
+                                           ORIGEM_Y - static_cast<float>(w.y) * SCALE);
+                linhaRota.append(sf::Vertex(rotaSelPara, sf::Color(0, 255, 0, 100)));
+            }
+            window.draw(linhaRota);
+
+            sf::CircleShape alvo(3.f);
+            alvo.setFillColor(sf::Color::Green);
+            alvo.setPosition(rotaSelPara.x - 3, rotaSelPara.y - 3);
+            window.draw(alvo);
         }
 
         if (painelVisivel && idSelecionado != -1 && temRegSel) {
@@ -0,0 +1,139 @@
+// src/monitor_frota.cpp
+// le a frota do segmento de memoria compartilhada publicado pelo backend
+// (--estado-compartilhado) e mostra uma tabela por segundo, com a taxa de leitura obtida
+//
+// uso: monitor_frota [NOME] [--hz H] [--segundos S] [--resumo]
+//   NOME:       segmento, padrao /tp_atr_frota
+//   --hz:       leituras da frota inteira por segundo (padrao 200; 0 = o mais rapido possivel)
+//   --segundos: para depois de S segundos (padrao: ate Ctrl+C)
+//   --resumo:   so a linha de taxa, sem a tabela dos caminhoes
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "SegmentoEstadoFrota.hpp"
+
+namespace {
+    volatile std::sig_atomic_t g_interrompido = 0;
+
+    void tratarSinal(int) { g_interrompido = 1; }
+
+    const char* nomeNivel(std::uint8_t n) {
+        switch (static_cast<NivelSeguranca>(n)) {
+            case NivelSeguranca::Livre:            return "livre";
+            case NivelSeguranca::LimiteVelocidade: return "limite";
+            case NivelSeguranca::Ceder:            return "ceder";
+            case NivelSeguranca::Parar:            return "parar";
+        }
+        return "?";
+    }
+
+    const char* nomeEstado(std::uint8_t e) {
+        switch (static_cast<EstadoCaminhao>(e)) {
+            case EstadoCaminhao::Parado:      return "parado";
+            case EstadoCaminhao::EmMovimento: return "movimento";
+            case EstadoCaminhao::EmFalha:     return "falha";
+        }
+        return "?";
+    }
+
+    void imprimirTabela(const std::vector<EstadoCaminhaoSegmento>& frota) {
+        std::printf("  %5s %9s %8s %8s %6s %6s %5s %-9s %-6s %s\n",
+                    "id", "t_s", "x", "y", "vel", "ang", "temp", "estado", "nivel", "modo");
+        for (const EstadoCaminhaoSegmento& e : frota) {
+            const bool automatico = (e.bits & EstadoCaminhaoSegmento::BIT_AUTOMATICO) != 0;
+            const bool defeito    = (e.bits & EstadoCaminhaoSegmento::BIT_DEFEITO) != 0;
+            std::printf("  %5d %9.2f %8.1f %8.1f %6.2f %6.1f %5.0f %-9s %-6s %s%s\n",
+                        e.id, e.tempoSimulacao_s, e.pos_x, e.pos_y, e.vel, e.ang_deg, e.temp_C,
+                        nomeEstado(e.estado), nomeNivel(e.nivelSeguranca),
+                        automatico ? "auto" : "manual", defeito ? " DEFEITO" : "");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string nome = "/tp_atr_frota";
+    double hz = 200.0;
+    long segundos = 0;
+    bool resumo = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--hz" && i + 1 < argc)            hz = std::atof(argv[++i]);
+        else if (a == "--segundos" && i + 1 < argc) segundos = std::atol(argv[++i]);
+        else if (a == "--resumo")                   resumo = true;
+        else if (!a.empty() && a[0] != '-')         nome = a;
+        else {
+            std::cerr << "uso: " << argv[0] << " [NOME] [--hz H] [--segundos S] [--resumo]\n";
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT,  tratarSinal);
+    std::signal(SIGTERM, tratarSinal);
+
+    LeitorEstadoFrota leitor;
+    if (!leitor.abrir(nome)) {
+        std::cerr << "[Monitor] Erro: " << leitor.erro() << "\n";
+        return 1;
+    }
+    std::cerr << "[Monitor] Segmento " << nome << ": " << leitor.capacidade() << " slots\n";
+
+    using Relogio = std::chrono::steady_clock;
+    const auto periodo = hz > 0.0 ? std::chrono::duration_cast<Relogio::duration>(std::chrono::duration<double>(1.0 / hz))
+                                  : Relogio::duration::zero();
+
+    std::vector<EstadoCaminhaoSegmento> frota;
+    frota.reserve(leitor.capacidade());
+
+    const auto inicio = Relogio::now();
+    auto proximaLeitura  = inicio;
+    auto proximoRelatorio = inicio + std::chrono::seconds(1);
+    std::uint64_t leituras = 0, mudancasFrota = 0;
+    std::uint64_t publicacoesAntes = leitor.publicacoes();
+    std::uint64_t geracaoAnterior = leitor.geracao();
+    double leitura_s = 0.0;
+
+    while (!g_interrompido) {
+        const auto antes = Relogio::now();
+        if (segundos > 0 && antes - inicio >= std::chrono::seconds(segundos)) break;
+
+        const std::uint64_t g = leitor.lerFrota(frota);
+        leitura_s += std::chrono::duration<double>(Relogio::now() - antes).count();
+        ++leituras;
+        if (g != geracaoAnterior) {
+            ++mudancasFrota;
+            geracaoAnterior = g;
+        }
+
+        const auto agora = Relogio::now();
+        if (agora >= proximoRelatorio) {
+            const std::uint64_t publicacoes = leitor.publicacoes();
+            if (!resumo) imprimirTabela(frota);
+            std::printf("[Monitor] %zu caminhoes | %llu leituras/s (%.2f us cada) | %llu publicacoes/s | "
+                        "geracao %llu (%llu mudancas)\n",
+                        frota.size(), static_cast<unsigned long long>(leituras),
+                        leituras > 0 ? leitura_s * 1e6 / static_cast<double>(leituras) : 0.0,
+                        static_cast<unsigned long long>(publicacoes - publicacoesAntes),
+                        static_cast<unsigned long long>(g), static_cast<unsigned long long>(mudancasFrota));
+            std::fflush(stdout);
+            publicacoesAntes = publicacoes;
+            leituras = 0;
+            mudancasFrota = 0;
+            leitura_s = 0.0;
+            proximoRelatorio += std::chrono::seconds(1);
+        }
+
+        if (periodo > Relogio::duration::zero()) {
+            proximaLeitura += periodo;
+            if (proximaLeitura > agora) std::this_thread::sleep_until(proximaLeitura);
+            else                        proximaLeitura = agora;
+        }
+    }
+    return 0;
+}